@@ -0,0 +1,107 @@
+// Test initial sync with initialSyncCloneThreads > 1, which copies large collections in _id
+// ranges over several connections and builds their indexes in parallel.
+
+(function() {
+    "use strict";
+
+    load("jstests/replsets/rslib.js");
+
+    var rst = new ReplSetTest({name: "initial_sync_parallel_clone", nodes: 1});
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var primaryDB = primary.getDB("test");
+
+    // _ids of every type the _id index can hold, so that the split points and ranges cross
+    // type boundaries. The numbers mix int, long and double values which interleave in order.
+    var ids = [MinKey, MaxKey, null, false, true, new Date(0), new Date(), {a: 1}, {a: "x"}];
+    for (var i = 0; i < 1000; i++) {
+        ids.push(i);
+        ids.push(NumberLong(1000 + i));
+        ids.push(i + 0.5);
+        ids.push("str" + i);
+        ids.push(ObjectId());
+    }
+
+    var bulk = primaryDB.mixed.initializeUnorderedBulkOp();
+    ids.forEach(function(id, i) {
+        bulk.insert({_id: id, x: i, s: "s" + (i % 37), u: i, pad: new Array(64).join("p")});
+    });
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(primaryDB.mixed.createIndex({x: 1}));
+    assert.commandWorked(primaryDB.mixed.createIndex({s: 1, x: -1}));
+    assert.commandWorked(primaryDB.mixed.createIndex({u: 1}, {unique: true}));
+
+    // A collection too small to be split and a capped collection, which is never split.
+    assert.writeOK(primaryDB.small.insert({_id: 0, x: 0}));
+    assert.commandWorked(primaryDB.small.createIndex({x: 1}));
+    assert.commandWorked(primaryDB.createCollection("capped", {capped: true, size: 64 * 1024}));
+    for (i = 0; i < 100; i++) {
+        assert.writeOK(primaryDB.capped.insert({_id: i}));
+    }
+
+    // A collection without an _id index, which cannot be split into _id ranges.
+    assert.commandWorked(primaryDB.createCollection("noIdIndex", {autoIndexId: false}));
+    for (i = 0; i < 1000; i++) {
+        assert.writeOK(primaryDB.noIdIndex.insert({_id: i, pad: new Array(64).join("p")}));
+    }
+
+    // Clone with several threads and ranges of about 16KB, so the mixed collection is split.
+    // Every clone thread stops after its first batch until the writes below are done.
+    var secondary = rst.add({setParameter: "initialSyncCloneThreads=4"});
+    assert.commandWorked(
+        secondary.adminCommand({setParameter: 1, parallelCloneRangeBytes: 16 * 1024}));
+    assert.commandWorked(secondary.adminCommand(
+        {configureFailPoint: "parallelCloneHangAfterBatch", mode: "alwaysOn"}));
+    rst.reInitiate();
+
+    // The member cannot be read from until initial sync is done, so wait for the clone to start
+    // in its log.
+    var cloneStarted = /cloning \d+ collections of test in \d+ ranges with 4 threads/;
+    assert.soon(function() {
+        var log = secondary.adminCommand({getLog: "global"}).log;
+        return log.some(function(line) {
+            return cloneStarted.test(line);
+        });
+    }, "the new member never started cloning");
+
+    // Change documents at both ends of the _id order and throughout it while the clone runs,
+    // so ranges may see documents which oplog application then fixes up. Removing and
+    // reinserting _ids may yield the same _id twice, which the _id index build must drop.
+    var grown = new Array(256).join("g");
+    for (i = 0; i + 1 < ids.length; i += 17) {
+        assert.writeOK(primaryDB.mixed.update({_id: ids[i]}, {$set: {grown: grown}}));
+        assert.writeOK(primaryDB.mixed.remove({_id: ids[i + 1]}));
+        assert.writeOK(primaryDB.mixed.insert({_id: ids[i + 1], x: -i, s: "moved", u: -i - 1}));
+    }
+
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "parallelCloneHangAfterBatch", mode: "off"}));
+
+    rst.awaitSecondaryNodes();
+    rst.awaitReplication();
+
+    // Every document and every index must have arrived once.
+    secondary.setSlaveOk();
+    var secondaryDB = secondary.getDB("test");
+    ["mixed", "small", "capped", "noIdIndex"].forEach(function(collName) {
+        assert.eq(primaryDB[collName].find().itcount(),
+                  secondaryDB[collName].find().itcount(),
+                  collName + " has different document counts");
+        assert.eq(primaryDB[collName].getIndexKeys().map(tojson).sort(),
+                  secondaryDB[collName].getIndexKeys().map(tojson).sort(),
+                  collName + " has different indexes");
+    });
+    assert.eq(ids.length, secondaryDB.mixed.find().hint({_id: 1}).itcount());
+    assert.eq(ids.length, secondaryDB.mixed.find().hint({u: 1}).itcount());
+
+    var primaryHash = primaryDB.runCommand({dbHash: 1});
+    var secondaryHash = secondaryDB.runCommand({dbHash: 1});
+    assert.commandWorked(primaryHash);
+    assert.commandWorked(secondaryHash);
+    assert.eq(primaryHash.collections, secondaryHash.collections);
+    assert.eq(primaryHash.md5, secondaryHash.md5);
+
+    rst.stopSet();
+})();
@@ -0,0 +1,71 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_field_offset_table.h"
+
+#include <cstring>
+
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+
+BSONFieldOffsetTable::BSONFieldOffsetTable(const BSONObj& obj) {
+    reset(obj);
+}
+
+void BSONFieldOffsetTable::reset(const BSONObj& obj) {
+    _objdata = obj.objdata();
+    _fields.clear();
+
+    BSONObjIterator it(obj);
+    while (it.more()) {
+        // next() sizes the element, which leaves its field name length cached.
+        BSONElement e = it.next();
+        _fields.push_back({static_cast<uint32_t>(e.rawdata() - _objdata),
+                           static_cast<uint32_t>(e.fieldNameSize() - 1)});
+    }
+}
+
+BSONElement BSONFieldOffsetTable::getField(StringData name) const {
+    for (const Field& field : _fields) {
+        if (field.nameSize != name.size()) {
+            continue;
+        }
+
+        const char* const element = _objdata + field.offset;
+        if (memcmp(element + 1, name.rawData(), name.size()) == 0) {
+            return BSONElement(element, field.nameSize + 1, BSONElement::FieldNameSizeTag());
+        }
+    }
+    return BSONElement();
+}
+
+}  // namespace mongo
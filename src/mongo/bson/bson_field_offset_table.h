@@ -0,0 +1,80 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+
+namespace mongo {
+
+class BSONObj;
+
+/**
+ * Where the top-level fields of an object are, found in a single pass over it. Looking up a field
+ * in the table compares the name lengths it recorded instead of walking and sizing every element
+ * before the field, so it pays off when many fields of the same object are looked up, as when a
+ * query has predicates on several fields.
+ *
+ * The table points into the object, which must outlive it.
+ */
+class BSONFieldOffsetTable {
+public:
+    BSONFieldOffsetTable() = default;
+    explicit BSONFieldOffsetTable(const BSONObj& obj);
+
+    /**
+     * Indexes the fields of 'obj' instead of the object the table was built for.
+     */
+    void reset(const BSONObj& obj);
+
+    /**
+     * Returns the first field named 'name', or an EOO element if there is none, like
+     * BSONObj::getField().
+     */
+    BSONElement getField(StringData name) const;
+
+    size_t size() const {
+        return _fields.size();
+    }
+
+private:
+    struct Field {
+        uint32_t offset;    // From the start of the object to the element.
+        uint32_t nameSize;  // Not counting the terminating NUL.
+    };
+
+    const char* _objdata = nullptr;
+    std::vector<Field> _fields;
+};
+
+}  // namespace mongo
@@ -0,0 +1,85 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_field_offset_table.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+TEST(BSONFieldOffsetTable, FindsEveryField) {
+    BSONObj obj = BSON("_id" << 1 << "a" << "x" << "bb" << BSON("c" << 2) << "ccc" << 3.5);
+    BSONFieldOffsetTable table(obj);
+    ASSERT_EQUALS(4U, table.size());
+
+    BSONObjIterator it(obj);
+    while (it.more()) {
+        BSONElement expected = it.next();
+        BSONElement actual = table.getField(expected.fieldNameStringData());
+        ASSERT_EQUALS(expected.rawdata(), actual.rawdata());
+        ASSERT_EQUALS(expected.size(), actual.size());
+        ASSERT_EQUALS(expected.fieldNameStringData(), actual.fieldNameStringData());
+    }
+}
+
+TEST(BSONFieldOffsetTable, MissingFieldIsEOO) {
+    BSONFieldOffsetTable table(BSON("a" << 1 << "ab" << 2));
+    ASSERT(table.getField("b").eoo());
+    ASSERT(table.getField("abc").eoo());
+    ASSERT(table.getField("").eoo());
+}
+
+TEST(BSONFieldOffsetTable, DuplicateFieldReturnsFirst) {
+    BSONObj obj = BSON("a" << 1 << "a" << 2);
+    BSONFieldOffsetTable table(obj);
+    ASSERT_EQUALS(1, table.getField("a").numberInt());
+    ASSERT_EQUALS(obj.getField("a").rawdata(), table.getField("a").rawdata());
+}
+
+TEST(BSONFieldOffsetTable, EmptyObject) {
+    BSONFieldOffsetTable table{BSONObj()};
+    ASSERT_EQUALS(0U, table.size());
+    ASSERT(table.getField("a").eoo());
+}
+
+TEST(BSONFieldOffsetTable, Reset) {
+    BSONObj first = BSON("a" << 1);
+    BSONObj second = BSON("b" << 2 << "c" << 3);
+    BSONFieldOffsetTable table(first);
+    table.reset(second);
+    ASSERT_EQUALS(2U, table.size());
+    ASSERT(table.getField("a").eoo());
+    ASSERT_EQUALS(3, table.getField("c").numberInt());
+}
+
+}  // namespace
@@ -538,4 +538,32 @@ TEST(Looping, Cpp11Auto) {
     ASSERT_EQUALS(count, 1 + 2 + 3);
 }
 
+TEST(Ownership, ShareOwnershipWithContainer) {
+    BSONObj child;
+    const char* childData;
+    {
+        BSONObj parent = BSON("a" << BSON("b" << 1));
+        BSONObj unowned = parent["a"].Obj();
+        ASSERT_FALSE(unowned.isOwned());
+
+        child = unowned.shareOwnershipWith(parent);
+        childData = unowned.objdata();
+    }
+
+    // The child points into the parent's buffer, which it keeps alive.
+    ASSERT_TRUE(child.isOwned());
+    ASSERT_EQUALS(childData, child.objdata());
+    ASSERT_EQUALS(BSON("b" << 1), child);
+}
+
+TEST(Ownership, ShareOwnershipWithUnownedContainerCopies) {
+    BSONObj parent = BSON("a" << BSON("b" << 1));
+    BSONObj unownedParent(parent.objdata());
+    BSONObj child = parent["a"].Obj().shareOwnershipWith(unownedParent);
+
+    ASSERT_TRUE(child.isOwned());
+    ASSERT_NOT_EQUALS(parent["a"].Obj().objdata(), child.objdata());
+    ASSERT_EQUALS(BSON("b" << 1), child);
+}
+
 }  // unnamed namespace
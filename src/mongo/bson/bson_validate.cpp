@@ -28,8 +28,8 @@
  */
 
 #include <cstring>
-#include <deque>
 #include <limits>
+#include <vector>
 
 #include "mongo/base/data_view.h"
 #include "mongo/bson/bson_validate.h"
@@ -169,6 +169,46 @@ private:
     int _startPosition;
 };
 
+/**
+ * The frames of the objects being validated. Documents rarely nest more than a few levels, so the
+ * first frames are kept inline and validating such a document does not allocate.
+ */
+class ValidationFrameStack {
+public:
+    ValidationObjectFrame* push() {
+        if (_size++ < kInlineFrames) {
+            return &_inline[_size - 1];
+        }
+        _overflow.push_back(ValidationObjectFrame());
+        return &_overflow.back();
+    }
+
+    void pop() {
+        if (_size-- > kInlineFrames) {
+            _overflow.pop_back();
+        }
+    }
+
+    ValidationObjectFrame* back() {
+        return _size > kInlineFrames ? &_overflow.back() : &_inline[_size - 1];
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+private:
+    static const size_t kInlineFrames = 16;
+
+    ValidationObjectFrame _inline[kInlineFrames];
+    std::vector<ValidationObjectFrame> _overflow;
+    size_t _size = 0;
+};
+
 /**
  * WARNING: only pass in a non-EOO idElem if it has been fully validated already!
  */
@@ -282,7 +322,7 @@ Status validateElementInfo(Buffer* buffer, ValidationState::State* nextState, BS
 }
 
 Status validateBSONIterative(Buffer* buffer) {
-    std::deque<ValidationObjectFrame> frames;
+    ValidationFrameStack frames;
     ValidationObjectFrame* curr = NULL;
     ValidationState::State state = ValidationState::BeginObj;
 
@@ -292,8 +332,7 @@ Status validateBSONIterative(Buffer* buffer) {
     while (state != ValidationState::Done) {
         switch (state) {
             case ValidationState::BeginObj:
-                frames.push_back(ValidationObjectFrame());
-                curr = &frames.back();
+                curr = frames.push();
                 curr->setStartPosition(buffer->position());
                 curr->setIsCodeWithScope(false);
                 if (!buffer->readNumber<int>(&curr->expectedSize)) {
@@ -332,11 +371,11 @@ Status validateBSONIterative(Buffer* buffer) {
                 if (actualLength != curr->expectedSize) {
                     return makeError("bson length doesn't match what we found", idElem);
                 }
-                frames.pop_back();
+                frames.pop();
                 if (frames.empty()) {
                     state = ValidationState::Done;
                 } else {
-                    curr = &frames.back();
+                    curr = frames.back();
                     if (curr->isCodeWithScope())
                         state = ValidationState::EndCodeWScope;
                     else
@@ -345,8 +384,7 @@ Status validateBSONIterative(Buffer* buffer) {
                 break;
             }
             case ValidationState::BeginCodeWScope: {
-                frames.push_back(ValidationObjectFrame());
-                curr = &frames.back();
+                curr = frames.push();
                 curr->setStartPosition(buffer->position());
                 curr->setIsCodeWithScope(true);
                 if (!buffer->readNumber<int>(&curr->expectedSize))
@@ -363,10 +401,10 @@ Status validateBSONIterative(Buffer* buffer) {
                     return makeError("bson length for CodeWScope doesn't match what we found",
                                      idElem);
                 }
-                frames.pop_back();
+                frames.pop();
                 if (frames.empty())
                     return makeError("unnested CodeWScope", idElem);
-                curr = &frames.back();
+                curr = frames.back();
                 state = ValidationState::WithinObj;
                 break;
             }
@@ -46,18 +46,51 @@
 namespace mongo {
 namespace str = mongoutils::str;
 
-using std::dec;
-using std::hex;
 using std::string;
 
+namespace {
+
+/**
+ * Appends 'number' the way "%.16g" formats it. Integral values, which most numbers stored as
+ * doubles are, are formatted without going through snprintf. The range check comes first, and
+ * is false for NaN, because converting a double outside the range of long long is undefined.
+ */
+void appendJSONDouble(StringBuilder& s, double number) {
+    if (std::abs(number) < 1e15 && number == static_cast<long long>(number) &&
+        !(number == 0 && std::signbit(number))) {
+        s << static_cast<long long>(number);
+        return;
+    }
+
+    char buf[32];
+    const int len = snprintf(buf, sizeof(buf), "%.16g", number);
+    verify(len > 0 && len < static_cast<int>(sizeof(buf)));
+    s.write(buf, len);
+}
+
+}  // namespace
+
 string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames, int pretty) const {
-    std::stringstream s;
-    if (includeFieldNames)
-        s << '"' << escape(fieldName()) << "\" : ";
+    StringBuilder s;
+    jsonStringStream(format, includeFieldNames, pretty, s);
+    return s.str();
+}
+
+void BSONElement::jsonStringStream(JsonStringFormat format,
+                                   bool includeFieldNames,
+                                   int pretty,
+                                   StringBuilder& s) const {
+    if (includeFieldNames) {
+        s << '"';
+        escape(s, fieldNameStringData());
+        s << "\" : ";
+    }
     switch (type()) {
         case mongo::String:
         case Symbol:
-            s << '"' << escape(string(valuestr(), valuestrsize() - 1)) << '"';
+            s << '"';
+            escape(s, StringData(valuestr(), valuestrsize() - 1));
+            s << '"';
             break;
         case NumberLong:
             if (format == TenGen) {
@@ -69,13 +102,14 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
         case NumberInt:
             if (format == JS) {
                 s << "NumberInt(" << _numberInt() << ")";
-                break;
+            } else {
+                s << _numberInt();
             }
+            break;
         case NumberDouble:
             if (number() >= -std::numeric_limits<double>::max() &&
                 number() <= std::numeric_limits<double>::max()) {
-                s.precision(16);
-                s << number();
+                appendJSONDouble(s, number());
             }
             // This is not valid JSON, but according to RFC-4627, "Numeric values that cannot be
             // represented as sequences of digits (such as Infinity and NaN) are not permitted." so
@@ -124,7 +158,7 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             }
             break;
         case Object:
-            s << embeddedObject().jsonString(format, pretty);
+            embeddedObject().jsonStringStream(format, pretty, false, s);
             break;
         case mongo::Array: {
             if (embeddedObject().isEmpty()) {
@@ -146,7 +180,7 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
                     if (strtol(e.fieldName(), 0, 10) > count) {
                         s << "undefined";
                     } else {
-                        s << e.jsonString(format, false, pretty ? pretty + 1 : 0);
+                        e.jsonStringStream(format, false, pretty ? pretty + 1 : 0, s);
                         e = i.next();
                     }
                     count++;
@@ -166,7 +200,7 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             s << '"' << valuestr() << "\", ";
             if (format != TenGen)
                 s << "\"$id\" : ";
-            s << '"' << mongo::OID::from(valuestr() + valuestrsize()) << "\" ";
+            s << '"' << mongo::OID::from(valuestr() + valuestrsize()).toString() << "\" ";
             if (format == TenGen)
                 s << ')';
             else
@@ -179,7 +213,7 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             } else {
                 s << "{ \"$oid\" : ";
             }
-            s << '"' << __oid() << '"';
+            s << '"' << __oid().toString() << '"';
             if (format == TenGen) {
                 s << " )";
             } else {
@@ -191,13 +225,10 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             const int len = reader.readAndAdvance<LittleEndian<int>>();
             BinDataType type = static_cast<BinDataType>(reader.readAndAdvance<uint8_t>());
 
-            s << "{ \"$binary\" : \"";
-            base64::encode(s, reader.view(), len);
-            s << "\", \"$type\" : \"" << hex;
-            s.width(2);
-            s.fill('0');
-            s << type << dec;
-            s << "\" }";
+            const char typeByte = type;
+
+            s << "{ \"$binary\" : \"" << base64::encode(reader.view(), len);
+            s << "\", \"$type\" : \"" << toHexLower(&typeByte, 1) << "\" }";
             break;
         }
         case mongo::Date:
@@ -241,10 +272,13 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             break;
         case RegEx:
             if (format == Strict) {
-                s << "{ \"$regex\" : \"" << escape(regex());
+                s << "{ \"$regex\" : \"";
+                escape(s, regex());
                 s << "\", \"$options\" : \"" << regexFlags() << "\" }";
             } else {
-                s << "/" << escape(regex(), true) << "/";
+                s << "/";
+                escape(s, regex(), true);
+                s << "/";
                 // FIXME Worry about alpha order?
                 for (const char* f = regexFlags(); *f; ++f) {
                     switch (*f) {
@@ -262,14 +296,20 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
         case CodeWScope: {
             BSONObj scope = codeWScopeObject();
             if (!scope.isEmpty()) {
-                s << "{ \"$code\" : \"" << escape(_asCode()) << "\" , "
-                  << "\"$scope\" : " << scope.jsonString() << " }";
+                s << "{ \"$code\" : \"";
+                escape(s, _asCode());
+                s << "\" , "
+                  << "\"$scope\" : ";
+                scope.jsonStringStream(Strict, 0, false, s);
+                s << " }";
                 break;
             }
         }
 
         case Code:
-            s << "\"" << escape(_asCode()) << "\"";
+            s << "\"";
+            escape(s, _asCode());
+            s << "\"";
             break;
 
         case bsonTimestamp:
@@ -298,7 +338,6 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             string message = ss.str();
             massert(10312, message.c_str(), false);
     }
-    return s.str();
 }
 
 namespace {
@@ -806,43 +845,54 @@ bool BSONObj::coerceVector(std::vector<T>* out) const {
 // used by jsonString()
 std::string escape(const std::string& s, bool escape_slash) {
     StringBuilder ret;
-    for (std::string::const_iterator i = s.begin(); i != s.end(); ++i) {
-        switch (*i) {
+    escape(ret, s, escape_slash);
+    return ret.str();
+}
+
+void escape(StringBuilder& out, StringData s, bool escape_slash) {
+    const char* const end = s.rawData() + s.size();
+    const char* run = s.rawData();
+    for (const char* i = run; i != end; ++i) {
+        const char c = *i;
+        if (c != '"' && c != '\\' && (c != '/' || !escape_slash) && !(c >= 0 && c <= 0x1f)) {
+            continue;
+        }
+
+        // Copy the characters that need no escaping in one go.
+        out.write(run, i - run);
+        run = i + 1;
+
+        switch (c) {
             case '"':
-                ret << "\\\"";
+                out << "\\\"";
                 break;
             case '\\':
-                ret << "\\\\";
+                out << "\\\\";
                 break;
             case '/':
-                ret << (escape_slash ? "\\/" : "/");
+                out << "\\/";
                 break;
             case '\b':
-                ret << "\\b";
+                out << "\\b";
                 break;
             case '\f':
-                ret << "\\f";
+                out << "\\f";
                 break;
             case '\n':
-                ret << "\\n";
+                out << "\\n";
                 break;
             case '\r':
-                ret << "\\r";
+                out << "\\r";
                 break;
             case '\t':
-                ret << "\\t";
+                out << "\\t";
                 break;
             default:
-                if (*i >= 0 && *i <= 0x1f) {
-                    // TODO: these should be utf16 code-units not bytes
-                    char c = *i;
-                    ret << "\\u00" << toHexLower(&c, 1);
-                } else {
-                    ret << *i;
-                }
+                // TODO: these should be utf16 code-units not bytes
+                out << "\\u00" << toHexLower(&c, 1);
         }
     }
-    return ret.str();
+    out.write(run, end - run);
 }
 
 /**
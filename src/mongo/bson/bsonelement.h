@@ -181,6 +181,11 @@ public:
     std::string jsonString(JsonStringFormat format,
                            bool includeFieldNames = true,
                            int pretty = 0) const;
+    /** Appends what jsonString() returns to 's', so nested elements all share one buffer. */
+    void jsonStringStream(JsonStringFormat format,
+                          bool includeFieldNames,
+                          int pretty,
+                          StringBuilder& s) const;
     operator std::string() const {
         return toString();
     }
@@ -801,4 +806,7 @@ inline BSONElement::BSONElement() {
 
 // TODO(SERVER-14596): move to a better place; take a StringData.
 std::string escape(const std::string& s, bool escape_slash = false);
+
+/** Like escape(), but appends the escaped string to 'out'. */
+void escape(StringBuilder& out, StringData s, bool escape_slash = false);
 }
@@ -181,6 +181,19 @@ public:
     */
     BSONObj getOwned() const;
 
+    /** Make this object owned by sharing the buffer of 'container', which must hold this
+        object's data (e.g. when this is a subobject of 'container'). No data is copied; the
+        buffer stays alive as long as any object sharing it.  Falls back to getOwned() if
+        'container' is not owned.
+    */
+    BSONObj shareOwnershipWith(const BSONObj& container) const {
+        if (!container.isOwned())
+            return getOwned();
+        BSONObj out(objdata());
+        out._ownedBuffer = container._ownedBuffer;
+        return out;
+    }
+
     /** @return a new full (and owned) copy of the object. */
     BSONObj copy() const;
 
@@ -198,6 +211,11 @@ public:
     std::string jsonString(JsonStringFormat format = Strict,
                            int pretty = 0,
                            bool isArray = false) const;
+    /** Appends what jsonString() returns to 's'. */
+    void jsonStringStream(JsonStringFormat format,
+                          int pretty,
+                          bool isArray,
+                          StringBuilder& s) const;
 
     /** note: addFields always adds _id even if not specified */
     int addFields(BSONObj& from, std::set<std::string>& fields); /* returns n added */
@@ -66,7 +66,6 @@ enum {
     PAT_RESERVE_SIZE = 4096,
     OPT_RESERVE_SIZE = 64,
     FIELD_RESERVE_SIZE = 4096,
-    STRINGVAL_RESERVE_SIZE = 4096,
     BINDATA_RESERVE_SIZE = 4096,
     BINDATATYPE_RESERVE_SIZE = 4096,
     NS_RESERVE_SIZE = 64,
@@ -95,6 +94,28 @@ Status JParse::parseError(StringData msg) {
 
 Status JParse::value(StringData fieldName, BSONObjBuilder& builder) {
     MONGO_JSON_DEBUG("fieldName: " << fieldName);
+    // Plain numbers and strings, which most values are, cannot start like any of the keywords
+    // and constructors below, so go straight to them rather than trying each of those first.
+    const char* next = _input;
+    while (next < _input_end && isspace(*reinterpret_cast<const unsigned char*>(next))) {
+        ++next;
+    }
+    if (next < _input_end) {
+        if (isdigit(*reinterpret_cast<const unsigned char*>(next)) ||
+            (*next == '-' && next + 1 < _input_end && next[1] != 'I')) {
+            return number(fieldName, builder);
+        }
+        if (*next == '"' || *next == '\'') {
+            _stringValue.clear();
+            Status ret = quotedString(&_stringValue);
+            if (ret != Status::OK()) {
+                return ret;
+            }
+            builder.append(fieldName, _stringValue);
+            return Status::OK();
+        }
+    }
+
     if (peekToken(LBRACE)) {
         Status ret = object(fieldName, builder);
         if (ret != Status::OK()) {
@@ -150,14 +171,6 @@ Status JParse::value(StringData fieldName, BSONObjBuilder& builder) {
         if (ret != Status::OK()) {
             return ret;
         }
-    } else if (peekToken(DOUBLEQUOTE) || peekToken(SINGLEQUOTE)) {
-        std::string valueString;
-        valueString.reserve(STRINGVAL_RESERVE_SIZE);
-        Status ret = quotedString(&valueString);
-        if (ret != Status::OK()) {
-            return ret;
-        }
-        builder.append(fieldName, valueString);
     } else if (readToken("true")) {
         builder.append(fieldName, true);
     } else if (readToken("false")) {
@@ -202,7 +215,6 @@ Status JParse::object(StringData fieldName, BSONObjBuilder& builder, bool subObj
 
     // Special object
     std::string firstField;
-    firstField.reserve(FIELD_RESERVE_SIZE);
     Status ret = field(&firstField);
     if (ret != Status::OK()) {
         return ret;
@@ -314,9 +326,10 @@ Status JParse::object(StringData fieldName, BSONObjBuilder& builder, bool subObj
         if (valueRet != Status::OK()) {
             return valueRet;
         }
+        // Reused for every field, so that long names only allocate once per object.
+        std::string fieldName;
         while (readToken(COMMA)) {
-            std::string fieldName;
-            fieldName.reserve(FIELD_RESERVE_SIZE);
+            fieldName.clear();
             Status fieldRet = field(&fieldName);
             if (fieldRet != Status::OK()) {
                 return fieldRet;
@@ -991,6 +1004,34 @@ Status JParse::regexOptCheck(StringData opt) {
 }
 
 Status JParse::number(StringData fieldName, BSONObjBuilder& builder) {
+    // Fast path for the common case of a plain decimal integer, which gives what the strtod and
+    // strtoll calls below would. Anything else, including integers too long to be sure they fit
+    // in 64 bits, is left to them.
+    const char* p = _input;
+    while (p < _input_end && isspace(*reinterpret_cast<const unsigned char*>(p))) {
+        ++p;
+    }
+    const bool negative = p < _input_end && *p == '-';
+    const char* const digitsStart = negative ? p + 1 : p;
+    const char* digitsEnd = digitsStart;
+    long long magnitude = 0;
+    while (digitsEnd < _input_end && digitsEnd - digitsStart < 18 &&
+           isdigit(*reinterpret_cast<const unsigned char*>(digitsEnd))) {
+        magnitude = magnitude * 10 + (*digitsEnd - '0');
+        ++digitsEnd;
+    }
+    if (digitsEnd != digitsStart && digitsEnd < _input_end &&
+        !isalnum(*reinterpret_cast<const unsigned char*>(digitsEnd)) && *digitsEnd != '.') {
+        const long long value = negative ? -magnitude : magnitude;
+        if (value == static_cast<int>(value)) {
+            builder.append(fieldName, static_cast<int>(value));
+        } else {
+            builder.append(fieldName, value);
+        }
+        _input = digitsEnd;
+        return Status::OK();
+    }
+
     char* endptrll;
     char* endptrd;
     long long retll;
@@ -1092,8 +1133,23 @@ Status JParse::chars(std::string* result, const char* terminalSet, const char* a
         return parseError("Unexpected end of input");
     }
     const char* q = _input;
+    // A quoted string ends at a single character. Copy the characters between escapes in one go
+    // instead of one at a time.
+    const bool singleTerminal = !allowedSet && terminalSet[0] != '\0' && terminalSet[1] == '\0';
     while (q < _input_end && !match(*q, terminalSet)) {
         MONGO_JSON_DEBUG("q: " << q);
+        if (singleTerminal) {
+            const char* runEnd = q;
+            while (runEnd < _input_end && *runEnd != terminalSet[0] && *runEnd != '\\' &&
+                   static_cast<unsigned char>(*runEnd) > 0x1F) {
+                ++runEnd;
+            }
+            if (runEnd != q) {
+                result->append(q, runEnd - q);
+                q = runEnd;
+                continue;
+            }
+        }
         if (allowedSet != NULL) {
             if (!match(*q, allowedSet)) {
                 _input = q;
@@ -1238,7 +1294,6 @@ bool JParse::readTokenImpl(const char* token, bool advance) {
 bool JParse::readField(StringData expectedField) {
     MONGO_JSON_DEBUG("expectedField: " << expectedField);
     std::string nextField;
-    nextField.reserve(FIELD_RESERVE_SIZE);
     Status ret = field(&nextField);
     if (ret != Status::OK()) {
         return false;
@@ -492,6 +492,9 @@ private:
     const char* const _buf;
     const char* _input;
     const char* const _input_end;
+
+    // Holds each string value while it is parsed, so that they do not each allocate.
+    std::string _stringValue;
 };
 
 }  // namespace mongo
@@ -34,6 +34,7 @@
 #include <stdio.h>
 #include <string>
 #include <string.h>
+#include <type_traits>
 
 
 #include "mongo/base/data_type_endian.h"
@@ -357,25 +358,25 @@ public:
         return SBNUM(x, MONGO_DBL_SIZE, "%g");
     }
     StringBuilderImpl& operator<<(int x) {
-        return SBNUM(x, MONGO_S32_SIZE, "%d");
+        return SBINT(x);
     }
     StringBuilderImpl& operator<<(unsigned x) {
-        return SBNUM(x, MONGO_U32_SIZE, "%u");
+        return SBINT(x);
     }
     StringBuilderImpl& operator<<(long x) {
-        return SBNUM(x, MONGO_S64_SIZE, "%ld");
+        return SBINT(x);
     }
     StringBuilderImpl& operator<<(unsigned long x) {
-        return SBNUM(x, MONGO_U64_SIZE, "%lu");
+        return SBINT(x);
     }
     StringBuilderImpl& operator<<(long long x) {
-        return SBNUM(x, MONGO_S64_SIZE, "%lld");
+        return SBINT(x);
     }
     StringBuilderImpl& operator<<(unsigned long long x) {
-        return SBNUM(x, MONGO_U64_SIZE, "%llu");
+        return SBINT(x);
     }
     StringBuilderImpl& operator<<(short x) {
-        return SBNUM(x, MONGO_S16_SIZE, "%hd");
+        return SBINT(x);
     }
     StringBuilderImpl& operator<<(const void* x) {
         if (sizeof(x) == 8) {
@@ -437,6 +438,30 @@ private:
     StringBuilderImpl(const StringBuilderImpl&);
     StringBuilderImpl& operator=(const StringBuilderImpl&);
 
+    /**
+     * Writes what the "%d" family of formats would, without the cost of going through snprintf.
+     */
+    template <typename T>
+    StringBuilderImpl& SBINT(T val) {
+        typedef typename std::make_unsigned<T>::type Unsigned;
+
+        char digits[MONGO_S64_SIZE];
+        char* const end = digits + sizeof(digits);
+        char* p = end;
+        const bool negative = val < 0;
+        // Negating in the unsigned type also handles the most negative value.
+        Unsigned magnitude = negative ? Unsigned(0) - static_cast<Unsigned>(val) : val;
+        do {
+            *--p = '0' + magnitude % 10;
+            magnitude /= 10;
+        } while (magnitude);
+        if (negative) {
+            *--p = '-';
+        }
+        write(p, end - p);
+        return *this;
+    }
+
     template <typename T>
     StringBuilderImpl& SBNUM(T val, int maxSize, const char* macro) {
         int prev = _buf.l;
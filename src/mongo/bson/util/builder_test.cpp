@@ -29,6 +29,8 @@
 
 #include "mongo/unittest/unittest.h"
 
+#include <limits>
+
 #include "mongo/bson/util/builder.h"
 
 namespace mongo {
@@ -66,4 +68,21 @@ TEST(Builder, StringBuilderAddress) {
     sb << nullPtr;
     ASSERT_EQUALS("0x0", sb.str());
 }
+
+TEST(Builder, StringBuilderIntegers) {
+    StringBuilder sb;
+    sb << 0 << ' ' << -1 << ' ' << std::numeric_limits<int>::min() << ' '
+       << std::numeric_limits<int>::max();
+    ASSERT_EQUALS("0 -1 -2147483648 2147483647", sb.str());
+
+    sb.reset();
+    sb << std::numeric_limits<long long>::min() << ' ' << std::numeric_limits<long long>::max();
+    ASSERT_EQUALS("-9223372036854775808 9223372036854775807", sb.str());
+
+    sb.reset();
+    sb << std::numeric_limits<unsigned long long>::max() << ' '
+       << std::numeric_limits<unsigned>::max() << ' ' << static_cast<short>(-32768) << ' '
+       << 10UL;
+    ASSERT_EQUALS("18446744073709551615 4294967295 -32768 10", sb.str());
+}
 }
@@ -44,7 +44,10 @@
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/rpc/metadata/server_selection_metadata.h"
+#include "mongo/s/stale_exception.h"
 #include "mongo/util/log.h"
+#include "mongo/util/net/socket_poll.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -125,6 +128,55 @@ ReadPreferenceSetting* _extractReadPref(const BSONObj& query, int queryOptions)
         : mongo::ReadPreference::PrimaryOnly;
     return new ReadPreferenceSetting(pref, TagSet());
 }
+
+/**
+ * Waits until a reply can be read from one of conns or timeoutMillis has elapsed. A negative
+ * timeout waits forever. Returns the index of the first connection with data available, or -1
+ * if none became readable.
+ */
+int waitForReply(DBClientConnection* const* conns, size_t numConns, int timeoutMillis) {
+    invariant(numConns <= 2);
+
+    // A reply the SSL layer has already pulled off the socket won't make the socket readable.
+    for (size_t i = 0; i < numConns; i++) {
+        if (conns[i]->port().psock->hasBufferedData())
+            return i;
+    }
+
+    pollfd fds[2];
+    for (size_t i = 0; i < numConns; i++) {
+        fds[i].fd = conns[i]->port().psock->rawFD();
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+
+    if (socketPoll(fds, numConns, timeoutMillis) <= 0)
+        return -1;
+
+    for (size_t i = 0; i < numConns; i++) {
+        if (fds[i].revents)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * Reads the single-batch reply for a findOne sent with DBClientCursor::initLazy.
+ */
+BSONObj finishFindOne(DBClientCursor* cursor) {
+    bool retry = false;
+    uassert(17480,
+            str::stream() << "findOne failed to receive a reply from " << cursor->originalHost(),
+            cursor->initLazyFinish(retry));
+
+    if (cursor->hasResultFlag(ResultFlag_ShardConfigStale)) {
+        BSONObj error;
+        cursor->peekError(&error);
+        throw RecvStaleConfigException("findOne stale config", error);
+    }
+
+    return cursor->more() ? cursor->nextSafe().getOwned() : BSONObj();
+}
 }  // namespace
 
 // --------------------------------
@@ -137,7 +189,7 @@ bool DBClientReplicaSet::_authPooledSecondaryConn = true;
 DBClientReplicaSet::DBClientReplicaSet(const string& name,
                                        const vector<HostAndPort>& servers,
                                        double so_timeout)
-    : _setName(name), _so_timeout(so_timeout) {
+    : _setName(name), _so_timeout(so_timeout), _hedgedReads(false) {
     ReplicaSetMonitor::createIfNeeded(name, set<HostAndPort>(servers.begin(), servers.end()));
 }
 
@@ -516,8 +568,11 @@ unique_ptr<DBClientCursor> DBClientReplicaSet::query(const string& ns,
                     break;
                 }
 
+                Timer timer;
                 unique_ptr<DBClientCursor> cursor = conn->query(
                     ns, query, nToReturn, nToSkip, fieldsToReturn, queryOptions, batchSize);
+                _getMonitor()->recordOperationLatency(_lastSlaveOkHost,
+                                                      Microseconds(timer.micros()));
 
                 return checkSlaveQueryResult(std::move(cursor));
             } catch (const DBException& dbExcep) {
@@ -569,7 +624,19 @@ BSONObj DBClientReplicaSet::findOne(const string& ns,
                     break;
                 }
 
-                return conn->findOne(ns, query, fieldsToReturn, queryOptions);
+                // PrimaryPreferred reads are not hedged since the hedge would go to a
+                // secondary even though the primary is up.
+                if (_hedgedReads && readPref->pref != ReadPreference::PrimaryPreferred &&
+                    isPollSupported()) {
+                    return _findOneHedged(
+                        conn, *readPref, ns, query, fieldsToReturn, queryOptions);
+                }
+
+                Timer timer;
+                BSONObj result = conn->findOne(ns, query, fieldsToReturn, queryOptions);
+                _getMonitor()->recordOperationLatency(_lastSlaveOkHost,
+                                                      Microseconds(timer.micros()));
+                return result;
             } catch (const DBException& dbExcep) {
                 StringBuilder errMsgBuilder;
                 errMsgBuilder << "can't findone replica set node " << _lastSlaveOkHost.toString()
@@ -685,33 +752,130 @@ DBClientConnection* DBClientReplicaSet::selectNodeUsingTags(
         return _master.get();
     }
 
+    _lastSlaveOkConn.reset(_getPooledConnection(_lastSlaveOkHost));
+
+    LOG(3) << "dbclient_rs selecting node " << _lastSlaveOkHost << endl;
+
+    return _lastSlaveOkConn.get();
+}
+
+DBClientConnection* DBClientReplicaSet::_getPooledConnection(const HostAndPort& host) {
     // Needs to perform a dynamic_cast because we need to set the replSet
     // callback. We should eventually not need this after we remove the
     // callback.
-    DBClientConnection* newConn = dynamic_cast<DBClientConnection*>(
-        globalConnPool.get(_lastSlaveOkHost.toString(), _so_timeout));
+    DBClientConnection* newConn =
+        dynamic_cast<DBClientConnection*>(globalConnPool.get(host.toString(), _so_timeout));
 
-    // Assert here instead of returning NULL since the contract of this method is such
+    // Assert here instead of returning NULL since the contract of selectNodeUsingTags is such
     // that returning NULL means none of the nodes were good, which is not the case here.
-    uassert(16532,
-            str::stream() << "Failed to connect to " << _lastSlaveOkHost.toString(),
-            newConn != NULL);
+    uassert(16532, str::stream() << "Failed to connect to " << host.toString(), newConn != NULL);
 
-    _lastSlaveOkConn.reset(newConn);
-    _lastSlaveOkConn->setParentReplSetName(_setName);
-    _lastSlaveOkConn->setRequestMetadataWriter(getRequestMetadataWriter());
-    _lastSlaveOkConn->setReplyMetadataReader(getReplyMetadataReader());
+    newConn->setParentReplSetName(_setName);
+    newConn->setRequestMetadataWriter(getRequestMetadataWriter());
+    newConn->setReplyMetadataReader(getReplyMetadataReader());
 
     if (_authPooledSecondaryConn) {
-        _auth(_lastSlaveOkConn.get());
+        _auth(newConn);
     } else {
         // Mongos pooled connections are authenticated through
         // ShardingConnectionHook::onCreate().
     }
 
-    LOG(3) << "dbclient_rs selecting node " << _lastSlaveOkHost << endl;
+    return newConn;
+}
 
-    return _lastSlaveOkConn.get();
+BSONObj DBClientReplicaSet::_findOneHedged(DBClientConnection* conn,
+                                           const ReadPreferenceSetting& readPref,
+                                           const string& ns,
+                                           const Query& query,
+                                           const BSONObj* fieldsToReturn,
+                                           int queryOptions) {
+    dassert(conn == _lastSlaveOkConn.get());
+
+    ReplicaSetMonitorPtr monitor = _getMonitor();
+    const HostAndPort firstHost = _lastSlaveOkHost;
+    const Milliseconds hedgeDelay = monitor->getHedgeDelay(firstHost);
+
+    // A negative nToReturn asks for a single batch so the server never leaves a cursor open
+    // on the member whose reply we end up ignoring.
+    Timer firstTimer;
+    DBClientCursor firstCursor(conn, ns, query.obj, -1, 0, fieldsToReturn, queryOptions, 0);
+    firstCursor.initLazy();
+
+    DBClientConnection* conns[] = {conn, NULL};
+    if (waitForReply(conns, 1, durationCount<Milliseconds>(hedgeDelay)) == 0) {
+        BSONObj result = finishFindOne(&firstCursor);
+        monitor->recordOperationLatency(firstHost, Microseconds(firstTimer.micros()));
+        return result;
+    }
+
+    // The hedge only ever goes to a secondary over a pooled connection. The primary
+    // connection is versioned by mongos and must never be left with an unread reply.
+    const HostAndPort hedgeHost = monitor->getHedgeHost(
+        ReadPreferenceSetting(ReadPreference::SecondaryOnly, readPref.tags), firstHost);
+    if (hedgeHost.empty()) {
+        BSONObj result = finishFindOne(&firstCursor);
+        monitor->recordOperationLatency(firstHost, Microseconds(firstTimer.micros()));
+        return result;
+    }
+
+    LOG(2) << "dbclient_rs hedging findOne on " << ns << " to " << hedgeHost << " after "
+           << hedgeDelay << " without a reply from " << firstHost;
+
+    // Declared before the cursor so that the cursor never outlives its connection.
+    unique_ptr<DBClientConnection> hedgeConn;
+    Timer hedgeTimer;
+    unique_ptr<DBClientCursor> hedgeCursor;
+    try {
+        hedgeConn.reset(_getPooledConnection(hedgeHost));
+        hedgeCursor.reset(new DBClientCursor(
+            hedgeConn.get(), ns, query.obj, -1, 0, fieldsToReturn, queryOptions, 0));
+        hedgeCursor->initLazy();
+    } catch (const DBException& ex) {
+        LOG(1) << "dbclient_rs failed to hedge findOne to " << hedgeHost << causedBy(ex);
+        if (hedgeConn) {
+            monitor->failedHost(hedgeHost);
+            hedgeCursor.reset();
+            hedgeConn.reset();
+        }
+
+        BSONObj result = finishFindOne(&firstCursor);
+        monitor->recordOperationLatency(firstHost, Microseconds(firstTimer.micros()));
+        return result;
+    }
+
+    conns[1] = hedgeConn.get();
+    const int timeoutMillis = _so_timeout > 0 ? static_cast<int>(_so_timeout * 1000) : -1;
+    if (waitForReply(conns, 2, timeoutMillis) != 1) {
+        // The first member answered (or neither did in time, in which case reading from it will
+        // report the error). The hedge connection still has a reply in flight, so close it.
+        hedgeCursor.reset();
+        hedgeConn.reset();
+
+        BSONObj result = finishFindOne(&firstCursor);
+        monitor->recordOperationLatency(firstHost, Microseconds(firstTimer.micros()));
+        return result;
+    }
+
+    // Pin subsequent reads to the member that answered first. This happens before reading the
+    // reply so that, should that fail, the retry logic blames the hedge host.
+    _discardLastSlaveOkConn();
+    _lastSlaveOkHost = hedgeHost;
+    _lastSlaveOkConn = std::move(hedgeConn);
+
+    BSONObj result = finishFindOne(hedgeCursor.get());
+    monitor->recordOperationLatency(hedgeHost, Microseconds(hedgeTimer.micros()));
+    return result;
+}
+
+void DBClientReplicaSet::_discardLastSlaveOkConn() {
+    if (_lastSlaveOkConn.get() == _master.get()) {
+        // Releases _lastSlaveOkConn as well.
+        resetMaster();
+    } else {
+        _lastSlaveOkConn.reset();
+        _lastSlaveOkHost = HostAndPort();
+    }
 }
 
 void DBClientReplicaSet::say(Message& toSend, bool isRetry, string* actualServer) {
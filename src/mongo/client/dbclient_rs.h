@@ -170,6 +170,22 @@ public:
         return _so_timeout;
     }
 
+    /**
+     * When enabled, findOne calls that may be served by a secondary are hedged: if the chosen
+     * member has not replied within its hedge delay (see ReplicaSetMonitor::getHedgeDelay),
+     * the same query is also sent to another secondary and whichever reply arrives first is
+     * used. The connection carrying the slower request is closed rather than reused.
+     *
+     * Only enable this for reads that are safe to run twice. Off by default.
+     */
+    void setHedgedReads(bool enabled) {
+        _hedgedReads = enabled;
+    }
+
+    bool getHedgedReads() const {
+        return _hedgedReads;
+    }
+
     std::string toString() const {
         return getServerAddress();
     }
@@ -256,6 +272,32 @@ private:
      */
     DBClientConnection* selectNodeUsingTags(std::shared_ptr<ReadPreferenceSetting> readPref);
 
+    /**
+     * Checks out a connection to host from the global pool and prepares it for use by this
+     * replica set connection. Never returns NULL.
+     *
+     * @throws DBException if no connection could be established.
+     */
+    DBClientConnection* _getPooledConnection(const HostAndPort& host);
+
+    /**
+     * Runs findOne against conn, which must be _lastSlaveOkConn, and hedges it to another
+     * secondary matching readPref if conn is slow to reply. If the hedge wins it becomes the
+     * new _lastSlaveOkConn.
+     */
+    BSONObj _findOneHedged(DBClientConnection* conn,
+                           const ReadPreferenceSetting& readPref,
+                           const std::string& ns,
+                           const Query& query,
+                           const BSONObj* fieldsToReturn,
+                           int queryOptions);
+
+    /**
+     * Destroys _lastSlaveOkConn without returning it to the pool. Used when the connection
+     * still has an unread reply pending and so cannot be reused.
+     */
+    void _discardLastSlaveOkConn();
+
     /**
      * @return true if the last host used in the last slaveOk query is still in the
      * set and can be used for the given read preference.
@@ -313,6 +355,8 @@ private:
 
     double _so_timeout;
 
+    bool _hedgedReads;
+
     // we need to store so that when we connect to a new node on failure
     // we can re-auth
     // this could be a security issue, as the password is stored in memory
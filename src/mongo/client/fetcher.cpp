@@ -60,6 +60,7 @@ const char* kNextBatchFieldName = "nextBatch";
  */
 Status parseCursorResponse(const BSONObj& obj,
                            const std::string& batchFieldName,
+                           Fetcher::DocumentOwnership ownership,
                            Fetcher::QueryResponse* batchData) {
     invariant(batchFieldName == kFirstBatchFieldName || batchFieldName == kNextBatchFieldName);
     invariant(batchData);
@@ -130,7 +131,10 @@ Status parseCursorResponse(const BSONObj& obj,
                                         << "'" << kCursorFieldName << "." << batchFieldName
                                         << "' field: " << obj);
         }
-        batchData->documents.push_back(itemElement.Obj().getOwned());
+        batchData->documents.push_back(
+            ownership == Fetcher::DocumentOwnership::kShareReplyBuffer
+                ? itemElement.Obj().shareOwnershipWith(obj)
+                : itemElement.Obj().getOwned());
     }
 
     return Status::OK();
@@ -152,13 +156,15 @@ Fetcher::Fetcher(executor::TaskExecutor* executor,
                  const std::string& dbname,
                  const BSONObj& findCmdObj,
                  const CallbackFn& work,
-                 const BSONObj& metadata)
+                 const BSONObj& metadata,
+                 DocumentOwnership ownership)
     : _executor(executor),
       _source(source),
       _dbname(dbname),
       _cmdObj(findCmdObj.getOwned()),
       _metadata(metadata.getOwned()),
       _work(work),
+      _ownership(ownership),
       _active(false),
       _first(true),
       _remoteCommandCallbackHandle() {
@@ -257,7 +263,7 @@ void Fetcher::_callback(const RemoteCommandCallbackArgs& rcbd, const char* batch
     }
 
     QueryResponse batchData;
-    status = parseCursorResponse(queryResponseObj, batchFieldName, &batchData);
+    status = parseCursorResponse(queryResponseObj, batchFieldName, _ownership, &batchData);
     if (!status.isOK()) {
         _work(StatusWith<Fetcher::QueryResponse>(status), nullptr, nullptr);
         _finishCallback();
@@ -77,6 +77,14 @@ public:
      */
     enum class NextAction : int { kInvalid = 0, kNoAction = 1, kGetMore = 2 };
 
+    /**
+     * How the documents of a query response hold their data. With kCopy each document owns a
+     * copy of itself. With kShareReplyBuffer the documents share the buffer of the reply they
+     * arrived in, which saves a copy per document but keeps the whole reply in memory for as long
+     * as any one of them is.
+     */
+    enum class DocumentOwnership : int { kCopy = 0, kShareReplyBuffer = 1 };
+
     /**
      * Type of a fetcher callback function.
      */
@@ -114,13 +122,17 @@ public:
      *
      * The callback function 'work' is not allowed to call into the Fetcher instance. This
      * behavior is undefined and may result in a deadlock.
+     *
+     * 'ownership' decides how the documents passed to 'work' hold their data; see
+     * DocumentOwnership.
      */
     Fetcher(executor::TaskExecutor* executor,
             const HostAndPort& source,
             const std::string& dbname,
             const BSONObj& cmdObj,
             const CallbackFn& work,
-            const BSONObj& metadata = rpc::makeEmptyMetadata());
+            const BSONObj& metadata = rpc::makeEmptyMetadata(),
+            DocumentOwnership ownership = DocumentOwnership::kCopy);
 
     virtual ~Fetcher();
 
@@ -184,6 +196,7 @@ private:
     BSONObj _cmdObj;
     BSONObj _metadata;
     CallbackFn _work;
+    const DocumentOwnership _ownership;
 
     // Protects member data of this Fetcher.
     mutable stdx::mutex _mutex;
@@ -424,6 +424,55 @@ TEST_F(FetcherTest, FetchOneDocument) {
     ASSERT_EQUALS(doc, documents.front());
 }
 
+TEST_F(FetcherTest, DocumentsAreCopiedOutOfTheReplyByDefault) {
+    ASSERT_OK(fetcher->schedule());
+    processNetworkResponse(
+        BSON("cursor" << BSON("id" << 0LL << "ns"
+                                   << "db.coll"
+                                   << "firstBatch" << BSON_ARRAY(BSON("_id" << 1)
+                                                                 << BSON("_id" << 2)))
+                      << "ok" << 1));
+    ASSERT_OK(status);
+    ASSERT_EQUALS(2U, documents.size());
+    ASSERT_TRUE(documents[0].isOwned());
+    ASSERT_TRUE(documents[1].isOwned());
+    // The elements of the batch array are separated by a type byte and the key "1".
+    ASSERT_NOT_EQUALS(documents[0].objdata() + documents[0].objsize() + 3,
+                      documents[1].objdata());
+}
+
+TEST_F(FetcherTest, DocumentsShareTheReplyBufferWhenAskedTo) {
+    fetcher.reset(new Fetcher(&getExecutor(),
+                              target,
+                              "db",
+                              findCmdObj,
+                              [this](const StatusWith<Fetcher::QueryResponse>& fetchResult,
+                                     Fetcher::NextAction*,
+                                     BSONObjBuilder*) {
+                                  status = fetchResult.getStatus();
+                                  if (status.isOK()) {
+                                      documents = fetchResult.getValue().documents;
+                                  }
+                              },
+                              rpc::makeEmptyMetadata(),
+                              Fetcher::DocumentOwnership::kShareReplyBuffer));
+    ASSERT_OK(fetcher->schedule());
+    processNetworkResponse(
+        BSON("cursor" << BSON("id" << 0LL << "ns"
+                                   << "db.coll"
+                                   << "firstBatch" << BSON_ARRAY(BSON("_id" << 1)
+                                                                 << BSON("_id" << 2)))
+                      << "ok" << 1));
+    ASSERT_OK(status);
+    ASSERT_EQUALS(2U, documents.size());
+    ASSERT_EQUALS(BSON("_id" << 1), documents[0]);
+    ASSERT_EQUALS(BSON("_id" << 2), documents[1]);
+    ASSERT_TRUE(documents[0].isOwned());
+    ASSERT_TRUE(documents[1].isOwned());
+    // Both documents still point into the batch array of the reply.
+    ASSERT_EQUALS(documents[0].objdata() + documents[0].objsize() + 3, documents[1].objdata());
+}
+
 TEST_F(FetcherTest, SetNextActionToContinueWhenNextBatchIsNotAvailable) {
     ASSERT_OK(fetcher->schedule());
     const BSONObj doc = BSON("_id" << 1);
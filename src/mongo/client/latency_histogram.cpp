@@ -0,0 +1,114 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/client/latency_histogram.h"
+
+#include <algorithm>
+
+#include "mongo/platform/bits.h"
+
+namespace mongo {
+
+const int LatencyHistogram::kSubBucketBits;
+const int LatencyHistogram::kSubBuckets;
+const int LatencyHistogram::kMaxExponent;
+const size_t LatencyHistogram::kNumBuckets;
+const uint64_t LatencyHistogram::kDefaultDecayThreshold;
+
+LatencyHistogram::LatencyHistogram(uint64_t decayThreshold)
+    : _count(0), _decayThreshold(std::max<uint64_t>(decayThreshold, 2)) {
+    _buckets.fill(0);
+}
+
+size_t LatencyHistogram::bucketFor(int64_t micros) {
+    if (micros < kSubBuckets)
+        return static_cast<size_t>(std::max<int64_t>(micros, 0));
+
+    const int exponent = 63 - countLeadingZeros64(static_cast<unsigned long long>(micros));
+    if (exponent >= kMaxExponent)
+        return kNumBuckets - 1;
+
+    // The kSubBucketBits bits below the leading one select the linear sub-bucket.
+    const int shift = exponent - kSubBucketBits;
+    const size_t subBucket = static_cast<size_t>(micros >> shift) - kSubBuckets;
+    return kSubBuckets + shift * kSubBuckets + subBucket;
+}
+
+int64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+    if (bucket < static_cast<size_t>(kSubBuckets))
+        return static_cast<int64_t>(bucket);
+
+    const int shift = static_cast<int>((bucket - kSubBuckets) / kSubBuckets);
+    const int64_t subBucket = (bucket - kSubBuckets) % kSubBuckets;
+    return ((kSubBuckets + subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(int64_t micros) {
+    if (micros < 0)
+        return;
+
+    _buckets[bucketFor(micros)]++;
+    if (++_count >= _decayThreshold)
+        _decay();
+}
+
+int64_t LatencyHistogram::percentile(double pct) const {
+    if (_count == 0)
+        return -1;
+
+    pct = std::min(std::max(pct, 0.0), 100.0);
+
+    // The rank of the sample we are looking for, counting from 1.
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(pct / 100.0 * _count + 0.5));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; i++) {
+        seen += _buckets[i];
+        if (seen >= rank)
+            return bucketUpperBound(i);
+    }
+
+    return bucketUpperBound(kNumBuckets - 1);
+}
+
+void LatencyHistogram::reset() {
+    _buckets.fill(0);
+    _count = 0;
+}
+
+void LatencyHistogram::_decay() {
+    _count = 0;
+    for (size_t i = 0; i < kNumBuckets; i++) {
+        _buckets[i] /= 2;
+        _count += _buckets[i];
+    }
+}
+
+}  // namespace mongo
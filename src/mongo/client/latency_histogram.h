@@ -0,0 +1,100 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace mongo {
+
+/**
+ * A fixed-size histogram of operation latencies in microseconds.
+ *
+ * Buckets are log-linear: every power of two is split into kSubBuckets equal-width buckets, so
+ * the relative error of percentile() is bounded by 1 / kSubBuckets regardless of magnitude.
+ * Once the number of recorded samples reaches the decay threshold all bucket counts are
+ * halved, which keeps the distribution biased towards recent behaviour without having to
+ * remember individual samples.
+ *
+ * Not thread safe. Callers are responsible for synchronization.
+ */
+class LatencyHistogram {
+public:
+    static const int kSubBucketBits = 2;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+
+    // Latencies at or above 2^kMaxExponent microseconds (about 76 hours) share the last bucket.
+    static const int kMaxExponent = 38;
+    static const size_t kNumBuckets = kSubBuckets * (kMaxExponent - kSubBucketBits + 1);
+
+    static const uint64_t kDefaultDecayThreshold = 1024;
+
+    explicit LatencyHistogram(uint64_t decayThreshold = kDefaultDecayThreshold);
+
+    /**
+     * Adds one sample. Negative latencies are ignored.
+     */
+    void record(int64_t micros);
+
+    /**
+     * Returns the number of samples currently contributing to the histogram. This can be less
+     * than the number of calls to record() because of decay.
+     */
+    uint64_t count() const {
+        return _count;
+    }
+
+    /**
+     * Returns an upper bound on the latency below which 'pct' percent of the recorded samples
+     * fall. 'pct' is clamped to [0, 100]. Returns -1 if there are no samples.
+     */
+    int64_t percentile(double pct) const;
+
+    /**
+     * Discards all samples.
+     */
+    void reset();
+
+    /**
+     * Exposed for testing. Maps a latency to its bucket and a bucket to the largest latency it
+     * can hold.
+     */
+    static size_t bucketFor(int64_t micros);
+    static int64_t bucketUpperBound(size_t bucket);
+
+private:
+    void _decay();
+
+    std::array<uint32_t, kNumBuckets> _buckets;
+    uint64_t _count;
+    uint64_t _decayThreshold;
+};
+
+}  // namespace mongo
@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <limits>
+
+#include "mongo/client/latency_histogram.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+TEST(LatencyHistogram, EmptyHasNoPercentile) {
+    LatencyHistogram histogram;
+    ASSERT_EQUALS(0U, histogram.count());
+    ASSERT_EQUALS(-1, histogram.percentile(50));
+}
+
+TEST(LatencyHistogram, NegativeLatenciesAreIgnored) {
+    LatencyHistogram histogram;
+    histogram.record(-5);
+    ASSERT_EQUALS(0U, histogram.count());
+}
+
+TEST(LatencyHistogram, BucketsCoverAllValuesInOrder) {
+    int64_t previousUpperBound = -1;
+    for (size_t bucket = 0; bucket < LatencyHistogram::kNumBuckets - 1; bucket++) {
+        const int64_t upperBound = LatencyHistogram::bucketUpperBound(bucket);
+        ASSERT_LESS_THAN(previousUpperBound, upperBound);
+        ASSERT_EQUALS(bucket, LatencyHistogram::bucketFor(previousUpperBound + 1));
+        ASSERT_EQUALS(bucket, LatencyHistogram::bucketFor(upperBound));
+        previousUpperBound = upperBound;
+    }
+}
+
+TEST(LatencyHistogram, RelativeErrorIsBounded) {
+    for (int64_t micros = 1; micros < (1LL << 30); micros = micros * 3 + 1) {
+        const int64_t upperBound =
+            LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketFor(micros));
+        ASSERT_GREATER_THAN_OR_EQUALS(upperBound, micros);
+        ASSERT_LESS_THAN_OR_EQUALS(upperBound - micros, micros / LatencyHistogram::kSubBuckets);
+    }
+}
+
+TEST(LatencyHistogram, HugeLatenciesShareLastBucket) {
+    ASSERT_EQUALS(LatencyHistogram::kNumBuckets - 1,
+                  LatencyHistogram::bucketFor(std::numeric_limits<int64_t>::max()));
+}
+
+TEST(LatencyHistogram, Percentiles) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 90; i++) {
+        histogram.record(1000);
+    }
+    for (int i = 0; i < 10; i++) {
+        histogram.record(100 * 1000);
+    }
+
+    ASSERT_EQUALS(100U, histogram.count());
+    ASSERT_EQUALS(LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketFor(1000)),
+                  histogram.percentile(50));
+    ASSERT_EQUALS(LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketFor(1000)),
+                  histogram.percentile(90));
+    ASSERT_EQUALS(LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketFor(100 * 1000)),
+                  histogram.percentile(95));
+    ASSERT_EQUALS(LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketFor(100 * 1000)),
+                  histogram.percentile(100));
+}
+
+TEST(LatencyHistogram, DecayFavorsRecentSamples) {
+    LatencyHistogram histogram(64);
+    for (int i = 0; i < 63; i++) {
+        histogram.record(100 * 1000);
+    }
+    ASSERT_EQUALS(63U, histogram.count());
+
+    // Every time the threshold is hit the old samples lose half their weight, so enough fast
+    // samples eventually push the slow ones out of the median.
+    for (int i = 0; i < 256; i++) {
+        histogram.record(10);
+    }
+    ASSERT_LESS_THAN(histogram.count(), 64U);
+    ASSERT_EQUALS(LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketFor(10)),
+                  histogram.percentile(50));
+}
+
+TEST(LatencyHistogram, Reset) {
+    LatencyHistogram histogram;
+    histogram.record(10);
+    histogram.reset();
+    ASSERT_EQUALS(0U, histogram.count());
+    ASSERT_EQUALS(-1, histogram.percentile(99));
+}
+
+}  // namespace
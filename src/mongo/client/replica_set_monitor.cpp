@@ -253,6 +253,13 @@ struct HostNotIn {
 // At 1 check every 10 seconds, 30 checks takes 5 minutes
 int ReplicaSetMonitor::maxConsecutiveFailedChecks = 30;
 
+// Hedge once a host is slower than 95% of its recent operations, but not after less than 2ms so
+// that sub-millisecond jitter on a healthy set does not double the read load.
+double ReplicaSetMonitor::hedgeDelayPercentile = 95.0;
+int ReplicaSetMonitor::hedgeDelayMinMillis = 2;
+int ReplicaSetMonitor::hedgeDelayDefaultMillis = 50;
+int ReplicaSetMonitor::hedgeDelayMinSamples = 20;
+
 // Defaults to random selection as required by the spec
 bool ReplicaSetMonitor::useDeterministicHostSelection = false;
 
@@ -306,6 +313,37 @@ void ReplicaSetMonitor::failedHost(const HostAndPort& host) {
     DEV _state->checkInvariants();
 }
 
+void ReplicaSetMonitor::recordOperationLatency(const HostAndPort& host, Microseconds latency) {
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    Node* node = _state->findNode(host);
+    if (node)
+        node->operationLatencies.record(durationCount<Microseconds>(latency));
+}
+
+Milliseconds ReplicaSetMonitor::getHedgeDelay(const HostAndPort& host) const {
+    int64_t delayMicros = -1;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+        Node* node = _state->findNode(host);
+        if (node && node->operationLatencies.count() >=
+                static_cast<uint64_t>(std::max(hedgeDelayMinSamples, 1))) {
+            delayMicros = node->operationLatencies.percentile(hedgeDelayPercentile);
+        }
+    }
+
+    if (delayMicros < 0)
+        return Milliseconds(hedgeDelayDefaultMillis);
+
+    // Round up so that a delay is never shorter than the percentile it was derived from.
+    return std::max(Milliseconds(hedgeDelayMinMillis), Milliseconds((delayMicros + 999) / 1000));
+}
+
+HostAndPort ReplicaSetMonitor::getHedgeHost(const ReadPreferenceSetting& criteria,
+                                            const HostAndPort& excluded) const {
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    return _state->getMatchingHost(criteria, excluded);
+}
+
 bool ReplicaSetMonitor::isPrimary(const HostAndPort& host) const {
     stdx::lock_guard<stdx::mutex> lk(_state->mutex);
     Node* node = _state->findNode(host);
@@ -387,6 +425,15 @@ void ReplicaSetMonitor::appendInfo(BSONObjBuilder& bsonObjBuilder) const {
         }
         builder.append("pingTimeMillis", pingTimeMillis);
 
+        const LatencyHistogram& opLatencies = node.operationLatencies;
+        if (opLatencies.count() > 0) {
+            BSONObjBuilder latencies(builder.subobjStart("opLatencyMicros"));
+            latencies.append("p50", static_cast<long long>(opLatencies.percentile(50)));
+            latencies.append("p95", static_cast<long long>(opLatencies.percentile(95)));
+            latencies.append("p99", static_cast<long long>(opLatencies.percentile(99)));
+            latencies.done();
+        }
+
         if (!node.tags.isEmpty()) {
             builder.append("tags", node.tags);
         }
@@ -854,33 +901,34 @@ SetState::SetState(StringData name, const std::set<HostAndPort>& seedNodes)
     DEV checkInvariants();
 }
 
-HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) const {
+HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria,
+                                      const HostAndPort& excluded) const {
     switch (criteria.pref) {
         // "Prefered" read preferences are defined in terms of other preferences
         case ReadPreference::PrimaryPreferred: {
-            HostAndPort out =
-                getMatchingHost(ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags));
+            HostAndPort out = getMatchingHost(
+                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags), excluded);
             // NOTE: the spec says we should use the primary even if tags don't match
             if (!out.empty())
                 return out;
             return getMatchingHost(
-                ReadPreferenceSetting(ReadPreference::SecondaryOnly, criteria.tags));
+                ReadPreferenceSetting(ReadPreference::SecondaryOnly, criteria.tags), excluded);
         }
 
         case ReadPreference::SecondaryPreferred: {
             HostAndPort out = getMatchingHost(
-                ReadPreferenceSetting(ReadPreference::SecondaryOnly, criteria.tags));
+                ReadPreferenceSetting(ReadPreference::SecondaryOnly, criteria.tags), excluded);
             if (!out.empty())
                 return out;
             // NOTE: the spec says we should use the primary even if tags don't match
             return getMatchingHost(
-                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags));
+                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags), excluded);
         }
 
         case ReadPreference::PrimaryOnly: {
             // NOTE: isMaster implies isUp
             Nodes::const_iterator it = std::find_if(nodes.begin(), nodes.end(), isMaster);
-            if (it == nodes.end())
+            if (it == nodes.end() || it->host == excluded)
                 return HostAndPort();
             return it->host;
         }
@@ -894,7 +942,8 @@ HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) con
 
                 std::vector<const Node*> matchingNodes;
                 for (size_t i = 0; i < nodes.size(); i++) {
-                    if (nodes[i].matches(criteria.pref) && nodes[i].matches(tag)) {
+                    if (nodes[i].host != excluded && nodes[i].matches(criteria.pref) &&
+                        nodes[i].matches(tag)) {
                         matchingNodes.push_back(&nodes[i]);
                     }
                 }
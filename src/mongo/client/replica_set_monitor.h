@@ -34,6 +34,7 @@
 #include "mongo/base/string_data.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -95,6 +96,29 @@ public:
      */
     void failedHost(const HostAndPort& host);
 
+    /**
+     * Records how long an operation against host took, from sending the request to receiving
+     * the reply. Used to pick the delay for hedged reads. Unknown hosts are ignored.
+     */
+    void recordOperationLatency(const HostAndPort& host, Microseconds latency);
+
+    /**
+     * Returns how long a hedged read should wait for host before sending the same request to
+     * a second member. This is the hedgeDelayPercentile of the recorded operation latencies
+     * for host, but never less than hedgeDelayMinMillis. Falls back to
+     * hedgeDelayDefaultMillis until enough latencies have been recorded.
+     */
+    Milliseconds getHedgeDelay(const HostAndPort& host) const;
+
+    /**
+     * Returns a host other than excluded which matches criteria, or an empty HostAndPort if
+     * there is none. Used to pick the second member for a hedged read.
+     *
+     * Note: Uses only local data and does not go over the network.
+     */
+    HostAndPort getHedgeHost(const ReadPreferenceSetting& criteria,
+                             const HostAndPort& excluded) const;
+
     /**
      * Returns true if this node is the master based ONLY on local data. Be careful, return may
      * be stale.
@@ -178,6 +202,15 @@ public:
      */
     static int maxConsecutiveFailedChecks;
 
+    /**
+     * Tuning for getHedgeDelay(). A hedged read goes to a second member once the first has
+     * been slower than hedgeDelayPercentile percent of its recent operations.
+     */
+    static double hedgeDelayPercentile;
+    static int hedgeDelayMinMillis;
+    static int hedgeDelayDefaultMillis;
+    static int hedgeDelayMinSamples;
+
     //
     // internal types (defined in replica_set_monitor_internal.h)
     //
@@ -40,6 +40,7 @@
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/client/latency_histogram.h"
 #include "mongo/client/read_preference.h"
 #include "mongo/client/replica_set_monitor.h"
 #include "mongo/db/jsobj.h"
@@ -122,6 +123,11 @@ public:
         bool isMaster;          // implies isUp
         int64_t latencyMicros;  // unknownLatency if unknown
         BSONObj tags;           // owned
+
+        // Round trip times of operations run against this host, as reported through
+        // ReplicaSetMonitor::recordOperationLatency. Unlike latencyMicros, which only tracks
+        // isMaster pings, this reflects the tail behaviour seen by real reads.
+        LatencyHistogram operationLatencies;
     };
 
     typedef std::vector<Node> Nodes;
@@ -132,11 +138,13 @@ public:
     SetState(StringData name, const std::set<HostAndPort>& seedNodes);
 
     /**
-     * Returns a host matching criteria or an empty host if no known host matches.
+     * Returns a host matching criteria or an empty host if no known host matches. If excluded
+     * is not empty, that host is never returned.
      *
      * Note: Uses only local data and does not go over the network.
      */
-    HostAndPort getMatchingHost(const ReadPreferenceSetting& criteria) const;
+    HostAndPort getMatchingHost(const ReadPreferenceSetting& criteria,
+                                const HostAndPort& excluded = HostAndPort()) const;
 
     /**
      * Returns the Node with the given host, or NULL if no Node has that host.
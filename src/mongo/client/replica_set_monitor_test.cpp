@@ -768,6 +768,58 @@ TEST(ReplicaSetMonitor, OutOfBandFailedHost) {
     }
 }
 
+TEST(ReplicaSetMonitor, HedgeHostExcludesFirstChoice) {
+    SetStatePtr state = std::make_shared<SetState>("name", basicSeedsSet);
+    ReplicaSetMonitorPtr rsm = std::make_shared<ReplicaSetMonitor>(state);
+    for (size_t i = 0; i != basicSeeds.size(); ++i) {
+        Node* node = state->findOrCreateNode(basicSeeds[i]);
+        node->isUp = true;
+        node->isMaster = (i == 0);
+    }
+
+    const ReadPreferenceSetting secondaryPreferred(ReadPreference::SecondaryPreferred, TagSet());
+    HostAndPort first = rsm->getHedgeHost(secondaryPreferred, HostAndPort());
+    ASSERT_NOT_EQUALS(HostAndPort("a"), first);
+
+    HostAndPort second = rsm->getHedgeHost(secondaryPreferred, first);
+    ASSERT_FALSE(second.empty());
+    ASSERT_NOT_EQUALS(first, second);
+    ASSERT_NOT_EQUALS(HostAndPort("a"), second);
+
+    // With only one secondary left the hedge falls back to the primary, but never to the host
+    // being hedged against.
+    state->findNode(second)->markFailed();
+    ASSERT_EQUALS(HostAndPort("a"), rsm->getHedgeHost(secondaryPreferred, first));
+
+    const ReadPreferenceSetting primaryOnly(ReadPreference::PrimaryOnly, TagSet());
+    ASSERT(rsm->getHedgeHost(primaryOnly, HostAndPort("a")).empty());
+}
+
+TEST(ReplicaSetMonitor, HedgeDelayFollowsOperationLatencies) {
+    SetStatePtr state = std::make_shared<SetState>("name", basicSeedsSet);
+    ReplicaSetMonitorPtr rsm = std::make_shared<ReplicaSetMonitor>(state);
+    const HostAndPort host("b");
+    state->findOrCreateNode(host)->isUp = true;
+
+    // Too few samples to trust the histogram yet.
+    ASSERT_EQUALS(Milliseconds(ReplicaSetMonitor::hedgeDelayDefaultMillis),
+                  rsm->getHedgeDelay(host));
+    ASSERT_EQUALS(Milliseconds(ReplicaSetMonitor::hedgeDelayDefaultMillis),
+                  rsm->getHedgeDelay(HostAndPort("unknown")));
+
+    for (int i = 0; i < ReplicaSetMonitor::hedgeDelayMinSamples; i++) {
+        rsm->recordOperationLatency(host, Microseconds(100));
+    }
+    ASSERT_EQUALS(Milliseconds(ReplicaSetMonitor::hedgeDelayMinMillis), rsm->getHedgeDelay(host));
+
+    for (int i = 0; i < ReplicaSetMonitor::hedgeDelayMinSamples * 10; i++) {
+        rsm->recordOperationLatency(host, Milliseconds(200));
+    }
+    const Milliseconds delay = rsm->getHedgeDelay(host);
+    ASSERT_GREATER_THAN_OR_EQUALS(delay, Milliseconds(200));
+    ASSERT_LESS_THAN(delay, Milliseconds(300));
+}
+
 // Newly elected primary with electionId >= maximum electionId seen by the Refresher
 TEST(ReplicaSetMonitorTests, NewPrimaryWithMaxElectionId) {
     SetStatePtr state = std::make_shared<SetState>("name", basicSeedsSet);
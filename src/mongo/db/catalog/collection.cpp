@@ -82,6 +82,24 @@ Status checkValidatorForBannedExpressions(const BSONObj& validator) {
 
     return Status::OK();
 }
+
+/**
+ * Notifies awaitData cursors about a capped insert once it commits, which is when it can
+ * become visible to them.
+ */
+class NotifyCappedWaitersOnCommit : public RecoveryUnit::Change {
+public:
+    explicit NotifyCappedWaitersOnCommit(Collection* collection) : _collection(collection) {}
+
+    virtual void commit() {
+        _collection->notifyCappedWaitersIfNeeded();
+    }
+
+    virtual void rollback() {}
+
+private:
+    Collection* const _collection;
+};
 }
 
 using std::unique_ptr;
@@ -295,16 +313,34 @@ StatusWith<RecordId> Collection::insertDocument(OperationContext* txn,
     // we cannot call into the OpObserver here because the document being written is not present
     // fortunately, this is currently only used for adding entries to the oplog.
 
-    // If there is a notifier object and another thread is waiting on it, then we notify waiters
-    // of this document insert. Waiters keep a shared_ptr to '_cappedNotifier', so there are
-    // waiters if this Collection's shared_ptr is not unique.
-    if (_cappedNotifier && !_cappedNotifier.unique()) {
-        _cappedNotifier->notifyOfInsert();
+    if (_cappedNotifier) {
+        txn->recoveryUnit()->registerChange(new NotifyCappedWaitersOnCommit(this));
     }
 
     return StatusWith<RecordId>(loc);
 }
 
+Status Collection::insertDocumentsForOplog(OperationContext* txn,
+                                           const DocWriter* const* docs,
+                                           size_t nDocs) {
+    invariant(!_validator || documentValidationDisabled(txn));
+    dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
+    invariant(!_indexCatalog.haveAnyIndexes());
+
+    if (_mustTakeCappedLockOnInsert)
+        synchronizeOnCappedInFlightResource(txn->lockState());
+
+    Status status = _recordStore->insertRecordsWithDocWriter(txn, docs, nDocs, false, nullptr);
+    if (!status.isOK())
+        return status;
+
+    if (_cappedNotifier) {
+        txn->recoveryUnit()->registerChange(new NotifyCappedWaitersOnCommit(this));
+    }
+
+    return Status::OK();
+}
+
 StatusWith<RecordId> Collection::insertDocument(OperationContext* txn,
                                                 const BSONObj& docToInsert,
                                                 bool enforceQuota,
@@ -334,17 +370,53 @@ StatusWith<RecordId> Collection::insertDocument(OperationContext* txn,
     if (res.isOK()) {
         getGlobalServiceContext()->getOpObserver()->onInsert(txn, ns(), docToInsert, fromMigrate);
 
-        // If there is a notifier object and another thread is waiting on it, then we notify
-        // waiters of this document insert. Waiters keep a shared_ptr to '_cappedNotifier', so
-        // there are waiters if this Collection's shared_ptr is not unique.
-        if (_cappedNotifier && !_cappedNotifier.unique()) {
-            _cappedNotifier->notifyOfInsert();
+        if (_cappedNotifier) {
+            txn->recoveryUnit()->registerChange(new NotifyCappedWaitersOnCommit(this));
         }
     }
 
     return res;
 }
 
+Status Collection::insertDocuments(OperationContext* txn,
+                                   const std::vector<BSONObj>::const_iterator begin,
+                                   const std::vector<BSONObj>::const_iterator end,
+                                   bool enforceQuota,
+                                   bool fromMigrate) {
+    const bool hasIdIndex = _indexCatalog.findIdIndex(txn);
+    for (auto it = begin; it != end; ++it) {
+        if (hasIdIndex && (*it)["_id"].eoo()) {
+            return Status(ErrorCodes::InternalError,
+                          str::stream() << "Collection::insertDocument got "
+                                           "document without _id for ns:" << _ns.ns());
+        }
+
+        auto status = checkValidation(txn, *it);
+        if (!status.isOK())
+            return status;
+    }
+
+    const SnapshotId sid = txn->recoveryUnit()->getSnapshotId();
+
+    if (_mustTakeCappedLockOnInsert)
+        synchronizeOnCappedInFlightResource(txn->lockState());
+
+    for (auto it = begin; it != end; ++it) {
+        StatusWith<RecordId> res = _insertDocument(txn, *it, enforceQuota);
+        if (!res.isOK())
+            return res.getStatus();
+    }
+    invariant(sid == txn->recoveryUnit()->getSnapshotId());
+
+    getGlobalServiceContext()->getOpObserver()->onInserts(txn, ns(), begin, end, fromMigrate);
+
+    if (_cappedNotifier) {
+        txn->recoveryUnit()->registerChange(new NotifyCappedWaitersOnCommit(this));
+    }
+
+    return Status::OK();
+}
+
 StatusWith<RecordId> Collection::insertDocument(OperationContext* txn,
                                                 const BSONObj& doc,
                                                 MultiIndexBlock* indexBlock,
@@ -372,11 +444,8 @@ StatusWith<RecordId> Collection::insertDocument(OperationContext* txn,
 
     getGlobalServiceContext()->getOpObserver()->onInsert(txn, ns(), doc);
 
-    // If there is a notifier object and another thread is waiting on it, then we notify waiters
-    // of this document insert. Waiters keep a shared_ptr to '_cappedNotifier', so there are
-    // waiters if this Collection's shared_ptr is not unique.
-    if (_cappedNotifier && !_cappedNotifier.unique()) {
-        _cappedNotifier->notifyOfInsert();
+    if (_cappedNotifier) {
+        txn->recoveryUnit()->registerChange(new NotifyCappedWaitersOnCommit(this));
     }
 
     return loc;
@@ -645,6 +714,15 @@ std::shared_ptr<CappedInsertNotifier> Collection::getCappedInsertNotifier() cons
     return _cappedNotifier;
 }
 
+void Collection::notifyCappedWaitersIfNeeded() {
+    // If there is a notifier object and another thread is waiting on it, then we notify waiters
+    // of this document insert. Waiters keep a shared_ptr to '_cappedNotifier', so there are
+    // waiters if this Collection's shared_ptr is not unique.
+    if (_cappedNotifier && !_cappedNotifier.unique()) {
+        _cappedNotifier->notifyOfInsert();
+    }
+}
+
 uint64_t Collection::numRecords(OperationContext* txn) const {
     return _recordStore->numRecords(txn);
 }
@@ -33,6 +33,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
@@ -228,6 +229,18 @@ public:
                                         bool enforceQuota,
                                         bool fromMigrate = false);
 
+    /**
+     * Inserts the documents in [begin, end) like insertDocument() does, but notifies the
+     * OpObserver once for all of them, so they are logged to the oplog as one batch. Nothing is
+     * inserted unless all of the documents pass validation. If an insert fails, the caller must
+     * roll back the WriteUnitOfWork.
+     */
+    Status insertDocuments(OperationContext* txn,
+                           std::vector<BSONObj>::const_iterator begin,
+                           std::vector<BSONObj>::const_iterator end,
+                           bool enforceQuota,
+                           bool fromMigrate = false);
+
     /**
      * Callers must ensure no document validation is performed for this collection when calling
      * this method.
@@ -236,6 +249,14 @@ public:
                                         const DocWriter* doc,
                                         bool enforceQuota);
 
+    /**
+     * Inserts 'nDocs' oplog entries with one call into the record store. The same restrictions
+     * as for insertDocument(const DocWriter*) apply.
+     */
+    Status insertDocumentsForOplog(OperationContext* txn,
+                                   const DocWriter* const* docs,
+                                   size_t nDocs);
+
     StatusWith<RecordId> insertDocument(OperationContext* txn,
                                         const BSONObj& doc,
                                         MultiIndexBlock* indexBlock,
@@ -340,6 +361,13 @@ public:
      */
     std::shared_ptr<CappedInsertNotifier> getCappedInsertNotifier() const;
 
+    /**
+     * Wakes up threads waiting on the capped insert notifier, if there are any. Inserts call
+     * this when they commit, and record stores that hide uncommitted inserts call it when
+     * earlier commits become visible.
+     */
+    void notifyCappedWaitersIfNeeded();
+
     uint64_t numRecords(OperationContext* txn) const;
 
     uint64_t dataSize(OperationContext* txn) const;
@@ -40,11 +40,14 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/internal_user_auth.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/copydb.h"
 #include "mongo/db/commands/rename_collection.h"
@@ -53,16 +56,26 @@
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/index_builder.h"
+#include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/op_observer.h"
+#include "mongo/db/operation_context_impl.h"
 #include "mongo/db/repl/isself.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/old_thread_pool.h"
+#include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -111,6 +124,470 @@ BSONObj fixindex(const string& newDbName, BSONObj o) {
     return res;
 }
 
+namespace {
+
+// Collections bigger than this many bytes are copied in _id ranges of about this size by a
+// parallel clone.
+MONGO_EXPORT_SERVER_PARAMETER(parallelCloneRangeBytes, long long, 256 * 1024 * 1024);
+
+const long long kParallelCloneMaxRanges = 1024;
+// Each split point is picked from this many sampled _ids.
+const int kParallelCloneSamplesPerRange = 10;
+
+// Holds every thread of a parallel clone after it has inserted a batch, until turned off.
+MONGO_FP_DECLARE(parallelCloneHangAfterBatch);
+
+Status createCollectionForClone(OperationContext* txn,
+                                const string& toDBName,
+                                const NamespaceString& to_name,
+                                const BSONObj& options,
+                                bool mayBeInterrupted) {
+    Database* db = dbHolder().openDb(txn, toDBName);
+
+    MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+        if (mayBeInterrupted) {
+            txn->checkForInterrupt();
+        }
+
+        WriteUnitOfWork wunit(txn);
+
+        // we defer building id index for performance - building it in batch is much
+        // faster
+        Status createStatus = userCreateNS(txn, db, to_name.ns(), options, false);
+        if (!createStatus.isOK()) {
+            return createStatus;
+        }
+
+        wunit.commit();
+    }
+    MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "createCollection", to_name.ns());
+    return Status::OK();
+}
+
+void buildIdIndex(OperationContext* txn, Collection* c, bool mayBeInterrupted) {
+    if (c->getIndexCatalog()->haveIdIndex(txn)) {
+        return;
+    }
+
+    // We need to drop objects with duplicate _ids because we didn't do a true
+    // snapshot and this is before applying oplog operations that occur during the
+    // initial sync.
+    set<RecordId> dups;
+
+    MultiIndexBlock indexer(txn, c);
+    if (mayBeInterrupted) {
+        indexer.allowInterruption();
+    }
+
+    uassertStatusOK(indexer.init(c->getIndexCatalog()->getDefaultIdIndexSpec()));
+    uassertStatusOK(indexer.insertAllDocumentsInCollection(&dups));
+
+    // This must be done before we commit the indexer. See the comment about
+    // dupsAllowed in IndexCatalog::_unindexRecord and SERVER-17487.
+    for (set<RecordId>::const_iterator it = dups.begin(); it != dups.end(); ++it) {
+        WriteUnitOfWork wunit(txn);
+        BSONObj id;
+
+        c->deleteDocument(txn, *it, true, true, txn->writesAreReplicated() ? &id : nullptr);
+        wunit.commit();
+    }
+
+    if (!dups.empty()) {
+        log() << "index build dropped: " << dups.size() << " dups";
+    }
+
+    WriteUnitOfWork wunit(txn);
+    indexer.commit();
+    if (txn->writesAreReplicated()) {
+        getGlobalServiceContext()->getOpObserver()->onCreateIndex(
+            txn,
+            c->ns().getSystemIndexesCollection().c_str(),
+            c->getIndexCatalog()->getDefaultIdIndexSpec());
+    }
+    wunit.commit();
+}
+
+void buildIndexes(OperationContext* txn,
+                  Collection* collection,
+                  vector<BSONObj> indexesToBuild,
+                  bool mayBeInterrupted) {
+    // TODO pass the MultiIndexBlock when inserting into the collection rather than building the
+    // indexes after the fact. This depends on holding a lock on the collection the whole time
+    // from creation to completion without yielding to ensure the index and the collection
+    // matches. It also wouldn't work on non-empty collections so we would need both
+    // implementations anyway as long as that is supported.
+    MultiIndexBlock indexer(txn, collection);
+    if (mayBeInterrupted)
+        indexer.allowInterruption();
+
+    indexer.removeExistingIndexes(&indexesToBuild);
+    if (indexesToBuild.empty())
+        return;
+
+    uassertStatusOK(indexer.init(indexesToBuild));
+    uassertStatusOK(indexer.insertAllDocumentsInCollection());
+
+    WriteUnitOfWork wunit(txn);
+    indexer.commit();
+    if (txn->writesAreReplicated()) {
+        const string targetSystemIndexesCollectionName =
+            collection->ns().getSystemIndexesCollection();
+        const char* createIndexNs = targetSystemIndexesCollectionName.c_str();
+        for (vector<BSONObj>::const_iterator it = indexesToBuild.begin();
+             it != indexesToBuild.end();
+             ++it) {
+            getGlobalServiceContext()->getOpObserver()->onCreateIndex(txn, createIndexNs, *it);
+        }
+    }
+    wunit.commit();
+}
+
+/**
+ * State shared by the threads of a parallel clone: spare connections to the source, the first
+ * error hit, and counters for the throughput report.
+ */
+class ParallelCloneState {
+    MONGO_DISALLOW_COPYING(ParallelCloneState);
+
+public:
+    ParallelCloneState(const ConnectionString& cs, OperationContext* txn, bool mayBeInterrupted)
+        : mayBeInterrupted(mayBeInterrupted),
+          _cs(cs),
+          _writesAreReplicated(txn->writesAreReplicated()),
+          _validationDisabled(documentValidationDisabled(txn)) {}
+
+    /**
+     * Schedules 'task' on 'pool', to be run by run(). Every scheduled task must be waited for
+     * with wait() before the state is destroyed.
+     */
+    void schedule(OldThreadPool* pool, const stdx::function<void(OperationContext*)>& task) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            ++_tasksPending;
+        }
+        pool->schedule([this, task] {
+            run(task);
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (--_tasksPending == 0) {
+                _tasksDone.notify_all();
+            }
+        });
+    }
+
+    /**
+     * Waits for the scheduled tasks to finish and returns the first failure. If the clone may be
+     * interrupted and 'callerTxn' is killed meanwhile, the operations of the running tasks are
+     * killed as well, and the tasks not started yet are skipped.
+     */
+    Status wait(OperationContext* callerTxn) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (_tasksPending > 0) {
+            _tasksDone.wait_for(lk, Milliseconds(100));
+            if (!mayBeInterrupted || !_status.isOK()) {
+                continue;
+            }
+            const Status interruptStatus = callerTxn->checkForInterruptNoAssert();
+            if (!interruptStatus.isOK()) {
+                _status = interruptStatus;
+                for (OperationContext* workerTxn : _workerTxns) {
+                    workerTxn->markKilled();
+                }
+            }
+        }
+        return _status;
+    }
+
+    /**
+     * Runs 'task' with an OperationContext set up like the one of the thread which started the
+     * clone. Does nothing once a task has failed; the first failure is kept for getStatus().
+     */
+    void run(const stdx::function<void(OperationContext*)>& task) {
+        if (!getStatus().isOK()) {
+            return;
+        }
+
+        if (!ClientBasic::getCurrent()) {
+            Client::initThreadIfNotAlready();
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+        }
+
+        try {
+            OperationContextImpl txn;
+            txn.setReplicatedWrites(_writesAreReplicated);
+            documentValidationDisabled(&txn) = _validationDisabled;
+
+            // Registered so that wait() can kill it along with the caller's operation.
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (!_status.isOK()) {
+                    return;
+                }
+                _workerTxns.insert(&txn);
+            }
+            ON_BLOCK_EXIT([this, &txn] {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                _workerTxns.erase(&txn);
+            });
+
+            task(&txn);
+        } catch (const DBException& ex) {
+            _setStatus(ex.toStatus());
+        } catch (const std::exception& ex) {
+            _setStatus(Status(ErrorCodes::InternalError, ex.what()));
+        }
+    }
+
+    Status getStatus() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _status;
+    }
+
+    /**
+     * Returns a connection to the source, reusing one handed back by releaseConnection() if
+     * possible. Throws if a new connection cannot be made.
+     */
+    std::unique_ptr<DBClientBase> acquireConnection() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (!_connections.empty()) {
+                std::unique_ptr<DBClientBase> conn = std::move(_connections.back());
+                _connections.pop_back();
+                return conn;
+            }
+        }
+
+        std::string errmsg;
+        std::unique_ptr<DBClientBase> conn(_cs.connect(errmsg));
+        uassert(ErrorCodes::HostUnreachable, errmsg, conn.get());
+        uassert(ErrorCodes::AuthenticationFailed,
+                "Unable to authenticate as internal user",
+                !getGlobalAuthorizationManager()->isAuthEnabled() ||
+                    conn->authenticateInternalUser());
+        return conn;
+    }
+
+    void releaseConnection(std::unique_ptr<DBClientBase> conn) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _connections.push_back(std::move(conn));
+    }
+
+    const bool mayBeInterrupted;
+
+    AtomicInt64 docsCopied;
+    AtomicInt64 bytesCopied;
+
+private:
+    void _setStatus(const Status& status) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_status.isOK()) {
+            _status = status;
+        }
+    }
+
+    const ConnectionString _cs;
+    const bool _writesAreReplicated;
+    const bool _validationDisabled;
+
+    mutable stdx::mutex _mutex;
+    Status _status = Status::OK();
+    vector<std::unique_ptr<DBClientBase>> _connections;
+    set<OperationContext*> _workerTxns;
+    int _tasksPending = 0;
+    stdx::condition_variable _tasksDone;
+};
+
+struct CloneRange {
+    NamespaceString from;
+    NamespaceString to;
+    // Bounds on _id, as {_id: <value>}. Empty for an open end.
+    BSONObj min;
+    BSONObj max;
+};
+
+/**
+ * Returns _id values which split 'ns' on the source into ranges of about
+ * parallelCloneRangeBytes, picked by sampling. Returns none if the collection is small, has no
+ * _id index to scan the ranges with, or if the source cannot provide them, in which case the
+ * collection is copied over a single cursor.
+ */
+vector<BSONObj> getIdSplitPoints(DBClientBase* conn, const NamespaceString& ns, int options) {
+    vector<BSONObj> splitPoints;
+
+    // Collections created with autoIndexId: false have no _id index.
+    bool hasIdIndex = false;
+    for (const auto& spec : conn->getIndexSpecs(ns.ns(), options)) {
+        if (IndexDescriptor::isIdIndexPattern(spec.getObjectField("key"))) {
+            hasIdIndex = true;
+            break;
+        }
+    }
+    if (!hasIdIndex) {
+        LOG(1) << "not splitting clone of " << ns << ", it has no _id index";
+        return splitPoints;
+    }
+
+    BSONObj stats;
+    if (!conn->runCommand(ns.db().toString(), BSON("collStats" << ns.coll()), stats, options)) {
+        LOG(1) << "not splitting clone of " << ns << ", collStats failed: " << stats;
+        return splitPoints;
+    }
+    const long long numRanges = std::min(
+        kParallelCloneMaxRanges,
+        stats["size"].safeNumberLong() / std::max(parallelCloneRangeBytes, 1LL));
+    if (numRanges <= 1) {
+        return splitPoints;
+    }
+
+    const int sampleSize = static_cast<int>(numRanges) * kParallelCloneSamplesPerRange;
+    BSONObj res;
+    const BSONObj cmd = BSON("aggregate" << ns.coll() << "pipeline"
+                                         << BSON_ARRAY(BSON("$sample" << BSON("size" << sampleSize))
+                                                       << BSON("$project" << BSON("_id" << 1)))
+                                         << "cursor" << BSON("batchSize" << sampleSize));
+    if (!conn->runCommand(ns.db().toString(), cmd, res, options) ||
+        res["cursor"]["firstBatch"].type() != Array) {
+        LOG(1) << "not splitting clone of " << ns << ", sampling _ids failed: " << res;
+        return splitPoints;
+    }
+    const long long cursorId = res["cursor"]["id"].safeNumberLong();
+    if (cursorId != 0) {
+        conn->killCursor(cursorId);
+    }
+
+    BSONObjSet samples;
+    for (auto&& sample : res["cursor"]["firstBatch"].Obj()) {
+        BSONElement id = sample.Obj()["_id"];
+        if (!id.eoo()) {
+            samples.insert(id.wrap("_id"));
+        }
+    }
+
+    int n = 0;
+    for (BSONObjSet::const_iterator it = samples.begin(); it != samples.end(); ++it) {
+        if (++n % kParallelCloneSamplesPerRange == 0) {
+            splitPoints.push_back(*it);
+        }
+    }
+    return splitPoints;
+}
+
+/**
+ * Inserts the documents of the current batch of 'it' into 'to', in one WriteUnitOfWork.
+ */
+void insertCloneBatch(ParallelCloneState* state,
+                      OperationContext* txn,
+                      const NamespaceString& from,
+                      const NamespaceString& to,
+                      DBClientCursorBatchIterator& it) {
+    vector<BSONObj> docs;
+    long long bytes = 0;
+    while (it.moreInCurrentBatch()) {
+        BSONObj doc = it.nextSafe();
+
+        /* assure object is valid.  note this will slow us down a little. */
+        const Status status = validateBSON(doc.objdata(), doc.objsize());
+        if (!status.isOK()) {
+            str::stream ss;
+            ss << "Cloner: found corrupt document in " << from.toString() << ": "
+               << status.reason();
+            if (skipCorruptDocumentsWhenCloning) {
+                warning() << ss.ss.str() << "; skipping";
+                continue;
+            }
+            msgasserted(28531, ss);
+        }
+
+        bytes += doc.objsize();
+        docs.push_back(doc);
+    }
+    if (docs.empty()) {
+        return;
+    }
+
+    ScopedTransaction transaction(txn, MODE_IX);
+    Lock::DBLock dbLock(txn->lockState(), to.db(), MODE_IX);
+    Lock::CollectionLock collLock(txn->lockState(), to.ns(), MODE_IX);
+    uassert(ErrorCodes::NotMaster,
+            str::stream() << "Not primary while cloning collection " << from.ns() << " to "
+                          << to.ns(),
+            !txn->writesAreReplicated() ||
+                repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(to));
+
+    Database* db = dbHolder().get(txn, to.db());
+    uassert(28787, str::stream() << "Database " << to.db() << " dropped while cloning", db);
+    Collection* collection = db->getCollection(to);
+    uassert(28788,
+            str::stream() << "Collection " << to.ns() << " dropped while cloning",
+            collection);
+
+    MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+        if (state->mayBeInterrupted) {
+            txn->checkForInterrupt();
+        }
+
+        WriteUnitOfWork wunit(txn);
+        uassertStatusOK(collection->insertDocuments(txn, docs.begin(), docs.end(), true));
+        wunit.commit();
+    }
+    MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "cloner insert", to.ns());
+
+    state->docsCopied.fetchAndAdd(docs.size());
+    state->bytesCopied.fetchAndAdd(bytes);
+
+    while (MONGO_FAIL_POINT(parallelCloneHangAfterBatch)) {
+        if (state->mayBeInterrupted) {
+            txn->checkForInterrupt();
+        }
+        sleepmillis(100);
+    }
+}
+
+void cloneRange(ParallelCloneState* state,
+                OperationContext* txn,
+                const CloneRange& range,
+                int options) {
+    Query query;
+    if (!range.min.isEmpty() || !range.max.isEmpty()) {
+        // $min and $max bound the _id index scan without the type bracketing of $gte and $lt.
+        query.hint(BSON("_id" << 1));
+        if (!range.min.isEmpty()) {
+            query.minKey(range.min);
+        }
+        if (!range.max.isEmpty()) {
+            query.maxKey(range.max);
+        }
+    }
+
+    LOG(2) << "\t\tcloning range of " << range.from << " to " << range.to << ": " << query;
+
+    std::unique_ptr<DBClientBase> conn = state->acquireConnection();
+    conn->query(stdx::function<void(DBClientCursorBatchIterator&)>(
+                    [&](DBClientCursorBatchIterator& it) {
+                        insertCloneBatch(state, txn, range.from, range.to, it);
+                    }),
+                range.from.ns(),
+                query,
+                0,
+                options);
+    state->releaseConnection(std::move(conn));
+}
+
+void logClonePhase(StringData phase,
+                   StringData dbName,
+                   const Timer& timer,
+                   long long numCollections,
+                   long long numDocs,
+                   long long numBytes) {
+    const long long millis = std::max(timer.millis(), 1);
+    log() << "clone " << phase << " of " << dbName << " done: " << numCollections
+          << " collections, " << numDocs << " documents, " << numBytes / (1024 * 1024)
+          << "MB in " << millis / 1000.0 << "s ("
+          << (numBytes * 1000 / millis) / (1024 * 1024) << "MB/s)";
+}
+
+}  // namespace
+
 Cloner::Cloner() {}
 
 struct Cloner::Fun {
@@ -350,34 +827,7 @@ void Cloner::copyIndexes(OperationContext* txn,
         MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "createCollection", to_collection.ns());
     }
 
-    // TODO pass the MultiIndexBlock when inserting into the collection rather than building the
-    // indexes after the fact. This depends on holding a lock on the collection the whole time
-    // from creation to completion without yielding to ensure the index and the collection
-    // matches. It also wouldn't work on non-empty collections so we would need both
-    // implementations anyway as long as that is supported.
-    MultiIndexBlock indexer(txn, collection);
-    if (mayBeInterrupted)
-        indexer.allowInterruption();
-
-    indexer.removeExistingIndexes(&indexesToBuild);
-    if (indexesToBuild.empty())
-        return;
-
-    uassertStatusOK(indexer.init(indexesToBuild));
-    uassertStatusOK(indexer.insertAllDocumentsInCollection());
-
-    WriteUnitOfWork wunit(txn);
-    indexer.commit();
-    if (txn->writesAreReplicated()) {
-        const string targetSystemIndexesCollectionName = to_collection.getSystemIndexesCollection();
-        const char* createIndexNs = targetSystemIndexesCollectionName.c_str();
-        for (vector<BSONObj>::const_iterator it = indexesToBuild.begin();
-             it != indexesToBuild.end();
-             ++it) {
-            getGlobalServiceContext()->getOpObserver()->onCreateIndex(txn, createIndexNs, *it);
-        }
-    }
-    wunit.commit();
+    buildIndexes(txn, collection, indexesToBuild, mayBeInterrupted);
 }
 
 bool Cloner::copyCollection(OperationContext* txn,
@@ -586,6 +1036,10 @@ Status Cloner::copyDb(OperationContext* txn,
             !txn->writesAreReplicated() ||
                 repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(toDBName));
 
+    if (opts.parallelism > 1 && !masterSameProcess && !opts.snapshot) {
+        return _copyDbParallel(txn, toDBName, cs, opts, toClone);
+    }
+
     if (opts.syncData) {
         for (list<BSONObj>::iterator i = toClone.begin(); i != toClone.end(); i++) {
             BSONObj collection = *i;
@@ -596,26 +1050,10 @@ Status Cloner::copyDb(OperationContext* txn,
             const NamespaceString from_name(opts.fromDB, collectionName);
             const NamespaceString to_name(toDBName, collectionName);
 
-            Database* db = dbHolder().openDb(txn, toDBName);
-
-            {
-                MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
-                    if (opts.mayBeInterrupted) {
-                        txn->checkForInterrupt();
-                    }
-
-                    WriteUnitOfWork wunit(txn);
-
-                    // we defer building id index for performance - building it in batch is much
-                    // faster
-                    Status createStatus = userCreateNS(txn, db, to_name.ns(), options, false);
-                    if (!createStatus.isOK()) {
-                        return createStatus;
-                    }
-
-                    wunit.commit();
-                }
-                MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "createCollection", to_name.ns());
+            Status createStatus =
+                createCollectionForClone(txn, toDBName, to_name, options, opts.mayBeInterrupted);
+            if (!createStatus.isOK()) {
+                return createStatus;
             }
 
             LOG(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
@@ -637,48 +1075,12 @@ Status Cloner::copyDb(OperationContext* txn,
             // Copy releases the lock, so we need to re-load the database. This should
             // probably throw if the database has changed in between, but for now preserve
             // the existing behaviour.
-            db = dbHolder().get(txn, toDBName);
+            Database* db = dbHolder().get(txn, toDBName);
             uassert(18645, str::stream() << "database " << toDBName << " dropped during clone", db);
 
             Collection* c = db->getCollection(to_name);
-            if (c && !c->getIndexCatalog()->haveIdIndex(txn)) {
-                // We need to drop objects with duplicate _ids because we didn't do a true
-                // snapshot and this is before applying oplog operations that occur during the
-                // initial sync.
-                set<RecordId> dups;
-
-                MultiIndexBlock indexer(txn, c);
-                if (opts.mayBeInterrupted) {
-                    indexer.allowInterruption();
-                }
-
-                uassertStatusOK(indexer.init(c->getIndexCatalog()->getDefaultIdIndexSpec()));
-                uassertStatusOK(indexer.insertAllDocumentsInCollection(&dups));
-
-                // This must be done before we commit the indexer. See the comment about
-                // dupsAllowed in IndexCatalog::_unindexRecord and SERVER-17487.
-                for (set<RecordId>::const_iterator it = dups.begin(); it != dups.end(); ++it) {
-                    WriteUnitOfWork wunit(txn);
-                    BSONObj id;
-
-                    c->deleteDocument(
-                        txn, *it, true, true, txn->writesAreReplicated() ? &id : nullptr);
-                    wunit.commit();
-                }
-
-                if (!dups.empty()) {
-                    log() << "index build dropped: " << dups.size() << " dups";
-                }
-
-                WriteUnitOfWork wunit(txn);
-                indexer.commit();
-                if (txn->writesAreReplicated()) {
-                    getGlobalServiceContext()->getOpObserver()->onCreateIndex(
-                        txn,
-                        c->ns().getSystemIndexesCollection().c_str(),
-                        c->getIndexCatalog()->getDefaultIdIndexSpec());
-                }
-                wunit.commit();
+            if (c) {
+                buildIdIndex(txn, c, opts.mayBeInterrupted);
             }
         }
     }
@@ -709,4 +1111,180 @@ Status Cloner::copyDb(OperationContext* txn,
     return Status::OK();
 }
 
+Status Cloner::_copyDbParallel(OperationContext* txn,
+                               const std::string& toDBName,
+                               const ConnectionString& cs,
+                               const CloneOptions& opts,
+                               const list<BSONObj>& toClone) {
+    ParallelCloneState state(cs, txn, opts.mayBeInterrupted);
+    const int queryOptions = QueryOption_NoCursorTimeout | (opts.slaveOk ? QueryOption_SlaveOk : 0);
+
+    vector<NamespaceString> toNames;
+    for (list<BSONObj>::const_iterator i = toClone.begin(); i != toClone.end(); ++i) {
+        toNames.push_back(NamespaceString(toDBName, (*i)["name"].valuestr()));
+    }
+
+    OldThreadPool pool(opts.parallelism, "clone worker ");
+
+    if (opts.syncData) {
+        Timer timer;
+
+        // Create the collections while the caller's locks are still held.
+        for (list<BSONObj>::const_iterator i = toClone.begin(); i != toClone.end(); ++i) {
+            LOG(2) << "  really will clone: " << *i << endl;
+            const NamespaceString to_name(toDBName, (*i)["name"].valuestr());
+            Status createStatus = createCollectionForClone(
+                txn, toDBName, to_name, i->getObjectField("options"), opts.mayBeInterrupted);
+            if (!createStatus.isOK()) {
+                return createStatus;
+            }
+        }
+
+        Lock::TempRelease tempRelease(txn->lockState());
+
+        // Split the large collections into _id ranges. Capped collections must be copied in
+        // natural order, so they are always copied over a single cursor.
+        vector<CloneRange> ranges;
+        for (list<BSONObj>::const_iterator i = toClone.begin(); i != toClone.end(); ++i) {
+            const char* collectionName = (*i)["name"].valuestr();
+            CloneRange range{NamespaceString(opts.fromDB, collectionName),
+                             NamespaceString(toDBName, collectionName),
+                             BSONObj(),
+                             BSONObj()};
+
+            vector<BSONObj> splitPoints;
+            if (!i->getObjectField("options").getBoolField("capped")) {
+                splitPoints = getIdSplitPoints(_conn.get(), range.from, queryOptions);
+            }
+            for (const auto& splitPoint : splitPoints) {
+                range.max = splitPoint;
+                ranges.push_back(range);
+                range.min = splitPoint;
+            }
+            range.max = BSONObj();
+            ranges.push_back(range);
+        }
+
+        log() << "cloning " << toClone.size() << " collections of " << toDBName << " in "
+              << ranges.size() << " ranges with " << opts.parallelism << " threads";
+
+        for (const auto& range : ranges) {
+            state.schedule(&pool, [&state, range, queryOptions](OperationContext* workerTxn) {
+                cloneRange(&state, workerTxn, range, queryOptions);
+            });
+        }
+        Status status = state.wait(txn);
+        if (!status.isOK()) {
+            return status;
+        }
+        logClonePhase("data copy",
+                      toDBName,
+                      timer,
+                      toClone.size(),
+                      state.docsCopied.load(),
+                      state.bytesCopied.load());
+
+        timer.reset();
+        for (const auto& to_name : toNames) {
+            state.schedule(&pool, [&state, to_name](OperationContext* workerTxn) {
+                ScopedTransaction transaction(workerTxn, MODE_IX);
+                Lock::DBLock dbLock(workerTxn->lockState(), to_name.db(), MODE_IX);
+                Lock::CollectionLock collLock(workerTxn->lockState(), to_name.ns(), MODE_X);
+
+                Database* db = dbHolder().get(workerTxn, to_name.db());
+                uassert(18645,
+                        str::stream() << "database " << to_name.db() << " dropped during clone",
+                        db);
+                Collection* c = db->getCollection(to_name);
+                if (c) {
+                    buildIdIndex(workerTxn, c, state.mayBeInterrupted);
+                }
+            });
+        }
+        status = state.wait(txn);
+        if (!status.isOK()) {
+            return status;
+        }
+        logClonePhase("_id index build",
+                      toDBName,
+                      timer,
+                      toNames.size(),
+                      state.docsCopied.load(),
+                      state.bytesCopied.load());
+    }
+
+    if (opts.syncIndexes) {
+        Timer timer;
+
+        // Fetch the index specs over the Cloner's connection, and make sure every collection
+        // exists, while the caller's locks are still held.
+        vector<vector<BSONObj>> indexSpecs;
+        long long numIndexes = 0;
+        for (list<BSONObj>::const_iterator i = toClone.begin(); i != toClone.end(); ++i) {
+            const NamespaceString from_name(opts.fromDB, (*i)["name"].valuestr());
+            const NamespaceString to_name(toDBName, (*i)["name"].valuestr());
+
+            vector<BSONObj> specs;
+            {
+                Lock::TempRelease tempRelease(txn->lockState());
+                list<BSONObj> sourceIndexes = _conn->getIndexSpecs(
+                    from_name.ns(), opts.slaveOk ? QueryOption_SlaveOk : 0);
+                for (const auto& sourceIndex : sourceIndexes) {
+                    specs.push_back(fixindex(toDBName, sourceIndex));
+                }
+            }
+            numIndexes += specs.size();
+            indexSpecs.push_back(std::move(specs));
+
+            Database* db = dbHolder().openDb(txn, toDBName);
+            if (!db->getCollection(to_name)) {
+                Status createStatus = createCollectionForClone(
+                    txn, toDBName, to_name, i->getObjectField("options"), opts.mayBeInterrupted);
+                if (!createStatus.isOK()) {
+                    return createStatus;
+                }
+            }
+        }
+
+        log() << "building " << numIndexes << " indexes on " << toNames.size()
+              << " collections of " << toDBName << " with " << opts.parallelism << " threads";
+
+        Lock::TempRelease tempRelease(txn->lockState());
+        for (size_t i = 0; i < toNames.size(); ++i) {
+            if (indexSpecs[i].empty()) {
+                continue;
+            }
+            const NamespaceString to_name = toNames[i];
+            const vector<BSONObj>& specs = indexSpecs[i];
+            state.schedule(&pool, [&state, to_name, &specs](OperationContext* workerTxn) {
+                ScopedTransaction transaction(workerTxn, MODE_IX);
+                Lock::DBLock dbLock(workerTxn->lockState(), to_name.db(), MODE_IX);
+                Lock::CollectionLock collLock(workerTxn->lockState(), to_name.ns(), MODE_X);
+
+                Database* db = dbHolder().get(workerTxn, to_name.db());
+                uassert(28789,
+                        str::stream() << "database " << to_name.db()
+                                      << " dropped while building indexes",
+                        db);
+                Collection* collection = db->getCollection(to_name);
+                uassert(28790,
+                        str::stream() << "collection " << to_name.ns()
+                                      << " dropped while building indexes",
+                        collection);
+                buildIndexes(workerTxn, collection, specs, state.mayBeInterrupted);
+            });
+        }
+        Status status = state.wait(txn);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        const long long millis = std::max(timer.millis(), 1);
+        log() << "clone index build of " << toDBName << " done: " << numIndexes << " indexes on "
+              << toNames.size() << " collections in " << millis / 1000.0 << "s";
+    }
+
+    return Status::OK();
+}
+
 }  // namespace mongo
@@ -30,12 +30,15 @@
 
 #pragma once
 
+#include <list>
+
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/base/disallow_copying.h"
 
 namespace mongo {
 
 struct CloneOptions;
+class ConnectionString;
 class DBClientBase;
 class NamespaceString;
 class OperationContext;
@@ -90,6 +93,17 @@ private:
                      bool mayYield,
                      bool mayBeInterrupted);
 
+    /**
+     * copyDb() for CloneOptions::parallelism > 1. Collections and _id ranges of large
+     * collections are copied over their own connections by a pool of threads, and the indexes
+     * of several collections are built at once. Runs without the locks of the caller.
+     */
+    Status _copyDbParallel(OperationContext* txn,
+                           const std::string& toDBName,
+                           const ConnectionString& cs,
+                           const CloneOptions& opts,
+                           const std::list<BSONObj>& toClone);
+
     struct Fun;
     std::unique_ptr<DBClientBase> _conn;
 };
@@ -111,6 +125,8 @@ struct CloneOptions {
 
         syncData = true;
         syncIndexes = true;
+
+        parallelism = 1;
     }
 
     std::string fromDB;
@@ -124,6 +140,10 @@ struct CloneOptions {
 
     bool syncData;
     bool syncIndexes;
+
+    // Number of collections or _id ranges copied, and of collections indexed, at once. 1 copies
+    // one collection at a time over the Cloner's own connection.
+    int parallelism;
 };
 
 }  // namespace mongo
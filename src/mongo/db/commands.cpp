@@ -53,6 +53,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/executor/async_connection_pool.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/rpc/metadata.h"
 #include "mongo/s/client/shard_connection.h"
@@ -558,6 +559,10 @@ public:
         globalConnPool.appendInfo(result);
         result.append("numDBClientConnection", DBClientConnection::getNumConnections());
         result.append("numAScopedConnection", AScopedConnection::getNumConnections());
+
+        BSONObjBuilder asioBuilder(result.subobjStart("asio"));
+        executor::appendAsyncConnectionPoolStats(&asioBuilder);
+        asioBuilder.doneFast();
         return true;
     }
     virtual bool slaveOk() const {
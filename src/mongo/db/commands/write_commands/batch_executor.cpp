@@ -222,6 +222,13 @@ bool checkShardVersion(OperationContext* txn,
 // TODO: Determine queueing behavior we want here
 MONGO_EXPORT_SERVER_PARAMETER(queueForMigrationCommit, bool, true);
 
+// Maximum number of documents from an insert batch that are written in one WriteUnitOfWork.
+// 1 writes every document in its own unit of work.
+MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize, int, 64);
+
+// Documents are not grouped into a unit of work beyond this many bytes.
+const size_t kInsertBatchMaxBytes = 256 * 1024;
+
 WriteBatchExecutor::WriteBatchExecutor(OperationContext* txn, OpCounters* opCounters, LastError* le)
     : _txn(txn), _opCounters(opCounters), _le(le), _stats(new WriteBatchStats) {}
 
@@ -678,6 +685,36 @@ private:
     Collection* _collection = nullptr;
 };
 
+// Returns the document to insert for the insert at "index", which must have been normalized
+// successfully.
+static const BSONObj& getInsertDocument(const WriteBatchExecutor::ExecInsertsState& state,
+                                        size_t index) {
+    const StatusWith<BSONObj>& normalizedInsert(state.normalizedInserts[index]);
+    return normalizedInsert.getValue().isEmpty()
+        ? state.request->getInsertRequest()->getDocumentsAt(index)
+        : normalizedInsert.getValue();
+}
+
+// Returns the end of the run of inserts starting at "state.currIndex" that can be written in one
+// WriteUnitOfWork. The run stops before the first document which failed normalization, and is
+// bounded by internalInsertMaxBatchSize and kInsertBatchMaxBytes.
+static size_t findInsertBatchEnd(const WriteBatchExecutor::ExecInsertsState& state) {
+    const size_t maxBatchSize = std::max(internalInsertMaxBatchSize, 1);
+    size_t batchBytes = 0;
+    size_t end = state.currIndex;
+    while (end < state.normalizedInserts.size() && end - state.currIndex < maxBatchSize) {
+        if (!state.normalizedInserts[end].isOK())
+            break;
+
+        batchBytes += getInsertDocument(state, end).objsize();
+        if (batchBytes > kInsertBatchMaxBytes && end > state.currIndex)
+            break;
+
+        ++end;
+    }
+    return end;
+}
+
 void WriteBatchExecutor::bulkExecute(const BatchedCommandRequest& request,
                                      std::vector<BatchedUpsertDetail*>* upsertedIds,
                                      std::vector<WriteErrorDetail*>* errors) {
@@ -814,6 +851,20 @@ void WriteBatchExecutor::execInserts(const BatchedCommandRequest& request,
             elapsedTracker.resetLastTime();
         }
 
+        if (!request.isInsertIndexRequest()) {
+            const size_t batchEnd = findInsertBatchEnd(state);
+            if (batchEnd - state.currIndex > 1) {
+                if (batchEnd == state.request->sizeWriteOps()) {
+                    setupSynchronousCommit(_txn);
+                }
+
+                if (execInsertBatch(&state, batchEnd)) {
+                    state.currIndex = batchEnd - 1;
+                    continue;
+                }
+            }
+        }
+
         WriteErrorDetail* error = NULL;
         execOneInsert(&state, &error);
         if (error) {
@@ -997,9 +1048,7 @@ static void insertOne(WriteBatchExecutor::ExecInsertsState* state, WriteOpResult
         return;
     }
 
-    const BSONObj& insertDoc = normalizedInsert.getValue().isEmpty()
-        ? state->request->getInsertRequest()->getDocumentsAt(state->currIndex)
-        : normalizedInsert.getValue();
+    const BSONObj& insertDoc = getInsertDocument(*state, state->currIndex);
 
     int attempt = 0;
     while (true) {
@@ -1059,6 +1108,55 @@ void WriteBatchExecutor::execOneInsert(ExecInsertsState* state, WriteErrorDetail
     }
 }
 
+bool WriteBatchExecutor::execInsertBatch(ExecInsertsState* state, size_t batchEnd) {
+    invariant(!_txn->lockState()->inAWriteUnitOfWork());
+
+    std::vector<BSONObj> docs;
+    docs.reserve(batchEnd - state->currIndex);
+    for (size_t i = state->currIndex; i < batchEnd; ++i) {
+        docs.push_back(getInsertDocument(*state, i));
+    }
+
+    // The whole batch is reported as one operation, with the first document as its query.
+    CurOp currentOp(_txn);
+    beginCurrentOp(_txn, BatchItemRef(state->request, state->currIndex));
+
+    try {
+        WriteOpResult lockResult;
+        if (!state->lockAndCheck(&lockResult)) {
+            // The single insert path runs the same checks and reports the error.
+            return false;
+        }
+
+        WriteUnitOfWork wunit(_txn);
+        Collection* collection = state->getCollection();
+        if (!collection->insertDocuments(_txn, docs.begin(), docs.end(), true).isOK()) {
+            return false;
+        }
+        wunit.commit();
+    } catch (const WriteConflictException&) {
+        state->unlock();
+        _txn->recoveryUnit()->abandonSnapshot();
+        return false;
+    } catch (const StaleConfigException&) {
+        return false;
+    } catch (const DBException& ex) {
+        if (ErrorCodes::isInterruption(ex.toStatus().code()))
+            throw;
+        return false;
+    }
+
+    WriteOpResult result;
+    result.getStats().n = 1;
+    for (size_t i = state->currIndex; i < batchEnd; ++i) {
+        BatchItemRef currInsertItem(state->request, i);
+        incOpStats(currInsertItem);
+        incWriteStats(currInsertItem, result.getStats(), NULL, &currentOp);
+    }
+    finishCurrentOp(_txn, NULL);
+    return true;
+}
+
 /**
  * Perform a single insert into a collection.  Requires the insert be preprocessed and the
  * collection already has been created.
@@ -97,6 +97,15 @@ private:
      */
     void execOneInsert(ExecInsertsState* state, WriteErrorDetail** error);
 
+    /**
+     * Tries to insert the documents from "state->currIndex" up to but not including "batchEnd"
+     * in one WriteUnitOfWork, so that their oplog entries share one optime reservation and one
+     * oplog write. Returns false, having written nothing, if any of the inserts fails. The
+     * caller then inserts the documents one at a time, which reports each error against the
+     * document that caused it.
+     */
+    bool execInsertBatch(ExecInsertsState* state, size_t batchEnd);
+
     /**
      * Executes an update item (which may update many documents or upsert), and returns the
      * upserted _id on upsert or error on failure.
@@ -35,8 +35,10 @@
 #include <boost/filesystem/operations.hpp>
 #include <fstream>
 
+#include "mongo/base/counter.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/db.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
@@ -54,8 +56,11 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/range_arithmetic.h"
+#include "mongo/db/range_deleter_throttle.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/top.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
@@ -77,6 +82,36 @@ using std::stringstream;
 
 using logger::LogComponent;
 
+namespace {
+
+// Number of documents removeRange deletes in a single storage transaction. A value of 1 deletes
+// one document per transaction, which is the behavior of older versions.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSize, int, 128);
+
+// If positive, removeRange backs off between batches whenever the average latency of foreground
+// operations on the collection rises above this multiple of its recent baseline. 0 disables it.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterLatencyThrottleFactor, double, 2.0);
+
+// Upper bound on the pause which the latency throttle inserts between two batches.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxThrottleMillis, int, 1000);
+
+// Longest uninterruptible sleep within a throttle pause
+const Milliseconds kThrottleStep(100);
+
+Counter64 rangeDeleterDocsDeletedCounter;
+ServerStatusMetricField<Counter64> displayRangeDeleterDocsDeleted(
+    "rangeDeleter.docsDeleted", &rangeDeleterDocsDeletedCounter);
+
+Counter64 rangeDeleterBatchesCounter;
+ServerStatusMetricField<Counter64> displayRangeDeleterBatches("rangeDeleter.batches",
+                                                              &rangeDeleterBatchesCounter);
+
+Counter64 rangeDeleterThrottledMillisCounter;
+ServerStatusMetricField<Counter64> displayRangeDeleterThrottledMillis(
+    "rangeDeleter.throttledMillis", &rangeDeleterThrottledMillisCounter);
+
+}  // namespace
+
 void Helpers::ensureIndex(OperationContext* txn,
                           Collection* collection,
                           BSONObj keyPattern,
@@ -336,7 +371,11 @@ long long Helpers::removeRange(OperationContext* txn,
 
     Milliseconds millisWaitingForReplication{0};
 
-    while (1) {
+    const size_t batchSize = std::max(1, static_cast<int>(rangeDeleterBatchSize));
+    RangeDeleterThrottle throttle(Top::get(txn->getServiceContext()), ns);
+    bool finished = false;
+
+    while (!finished) {
         // Scoping for write lock.
         {
             OldClientWriteContext ctx(txn, ns);
@@ -347,6 +386,9 @@ long long Helpers::removeRange(OperationContext* txn,
             IndexDescriptor* desc =
                 collection->getIndexCatalog()->findIndexByKeyPattern(txn, indexKeyPattern.toBSON());
 
+            // Collect the next batch of documents in shard key index order. The scan must not
+            // yield, so that the collected locations stay valid until they are deleted below
+            // while we still hold the write lock.
             unique_ptr<PlanExecutor> exec(
                 InternalPlanner::indexScan(txn,
                                            collection,
@@ -357,16 +399,19 @@ long long Helpers::removeRange(OperationContext* txn,
                                            PlanExecutor::YIELD_MANUAL,
                                            InternalPlanner::FORWARD,
                                            InternalPlanner::IXSCAN_FETCH));
-            exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
+
+            std::vector<std::pair<RecordId, BSONObj>> batch;
+            batch.reserve(batchSize);
 
             RecordId rloc;
             BSONObj obj;
-            PlanExecutor::ExecState state;
-            // This may yield so we cannot touch nsd after this.
-            state = exec->getNext(&obj, &rloc);
-            exec.reset();
-            if (PlanExecutor::IS_EOF == state) {
-                break;
+            PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+            while (batch.size() < batchSize) {
+                state = exec->getNext(&obj, &rloc);
+                if (PlanExecutor::ADVANCED != state) {
+                    break;
+                }
+                batch.push_back(std::make_pair(rloc, obj.getOwned()));
             }
 
             if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
@@ -379,10 +424,16 @@ long long Helpers::removeRange(OperationContext* txn,
                 break;
             }
 
-            verify(PlanExecutor::ADVANCED == state);
+            exec.reset();
 
-            WriteUnitOfWork wuow(txn);
+            if (batch.empty()) {
+                break;
+            }
+
+            // A partial batch means the scan reached the end of the range
+            finished = (batch.size() < batchSize);
 
+            std::shared_ptr<CollectionMetadata> metadataNow;
             if (onlyRemoveOrphanedDocs) {
                 // Do a final check in the write lock to make absolutely sure that our
                 // collection hasn't been modified in a way that invalidates our migration
@@ -392,27 +443,9 @@ long long Helpers::removeRange(OperationContext* txn,
                 // in the future we might want to.
                 verify(ShardingState::get(getGlobalServiceContext())->enabled());
 
-                bool docIsOrphan;
-
                 // In write lock, so will be the most up-to-date version
-                std::shared_ptr<CollectionMetadata> metadataNow =
+                metadataNow =
                     ShardingState::get(getGlobalServiceContext())->getCollectionMetadata(ns);
-                if (metadataNow) {
-                    ShardKeyPattern kp(metadataNow->getKeyPattern());
-                    BSONObj key = kp.extractShardKeyFromDoc(obj);
-                    docIsOrphan =
-                        !metadataNow->keyBelongsToMe(key) && !metadataNow->keyIsPending(key);
-                } else {
-                    docIsOrphan = false;
-                }
-
-                if (!docIsOrphan) {
-                    warning(LogComponent::kSharding)
-                        << "aborting migration cleanup for chunk " << min << " to " << max
-                        << (metadataNow ? (string) " at document " + obj.toString() : "")
-                        << ", collection " << ns << " has changed " << endl;
-                    break;
-                }
             }
 
             NamespaceString nss(ns);
@@ -423,13 +456,46 @@ long long Helpers::removeRange(OperationContext* txn,
                 return numDeleted;
             }
 
-            if (callback)
-                callback->goingToDelete(obj);
+            WriteUnitOfWork wuow(txn);
+            long long numDeletedInBatch = 0;
+
+            for (const auto& entry : batch) {
+                const BSONObj& doc = entry.second;
+
+                if (onlyRemoveOrphanedDocs) {
+                    bool docIsOrphan;
+                    if (metadataNow) {
+                        ShardKeyPattern kp(metadataNow->getKeyPattern());
+                        BSONObj key = kp.extractShardKeyFromDoc(doc);
+                        docIsOrphan =
+                            !metadataNow->keyBelongsToMe(key) && !metadataNow->keyIsPending(key);
+                    } else {
+                        docIsOrphan = false;
+                    }
+
+                    if (!docIsOrphan) {
+                        warning(LogComponent::kSharding)
+                            << "aborting migration cleanup for chunk " << min << " to " << max
+                            << (metadataNow ? (string) " at document " + doc.toString() : "")
+                            << ", collection " << ns << " has changed " << endl;
+                        finished = true;
+                        break;
+                    }
+                }
+
+                if (callback)
+                    callback->goingToDelete(doc);
+
+                BSONObj deletedId;
+                collection->deleteDocument(txn, entry.first, false, false, &deletedId);
+                numDeletedInBatch++;
+            }
 
-            BSONObj deletedId;
-            collection->deleteDocument(txn, rloc, false, false, &deletedId);
             wuow.commit();
-            numDeleted++;
+            numDeleted += numDeletedInBatch;
+
+            rangeDeleterDocsDeletedCounter.increment(numDeletedInBatch);
+            rangeDeleterBatchesCounter.increment();
         }
 
         // TODO remove once the yielding below that references this timer has been removed
@@ -449,6 +515,18 @@ long long Helpers::removeRange(OperationContext* txn,
             }
             millisWaitingForReplication += replStatus.duration;
         }
+
+        if (!finished) {
+            const Milliseconds delay = throttle.nextDelay(
+                rangeDeleterLatencyThrottleFactor, Milliseconds(rangeDeleterMaxThrottleMillis));
+            rangeDeleterThrottledMillisCounter.increment(durationCount<Milliseconds>(delay));
+
+            // Pause in short steps, so that killOp and shutdown don't wait for the whole pause
+            for (Milliseconds left = delay; left > Milliseconds(0); left -= kThrottleStep) {
+                txn->checkForInterrupt();
+                sleepFor(std::min(left, kThrottleStep));
+            }
+        }
     }
 
     if (writeConcern.shouldWaitForOtherNodes())
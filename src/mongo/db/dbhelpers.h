@@ -163,7 +163,11 @@ struct Helpers {
      *
      * Returns -1 when no usable index exists
      *
-     * Does oplog the individual document deletions.
+     * Does oplog the individual document deletions. Documents are deleted in index order, in
+     * storage transactions of up to 'rangeDeleterBatchSize' documents each, and the deletion
+     * pauses between batches while foreground operations on the collection are slower than
+     * 'rangeDeleterLatencyThrottleFactor' times usual. Throws if 'txn' is interrupted during a
+     * pause.
      * // TODO: Refactor this mechanism, it is growing too large
      */
     static long long removeRange(OperationContext* txn,
@@ -35,6 +35,7 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -46,6 +47,10 @@ using std::unique_ptr;
 using std::vector;
 using stdx::make_unique;
 
+// Makes the stage read ahead whenever it fetches a record, as if the record had not been in
+// memory, so that readahead can be tested on any storage engine.
+MONGO_FP_DECLARE(fetchStageAlwaysReadAhead);
+
 // static
 const char* FetchStage::kStageType = "FETCH";
 
@@ -58,7 +63,10 @@ FetchStage::FetchStage(OperationContext* txn,
       _collection(collection),
       _ws(ws),
       _filter(filter),
-      _idRetrying(WorkingSet::INVALID_ID) {
+      _idRetrying(WorkingSet::INVALID_ID),
+      _hasStashedChildState(false),
+      _stashedChildState(NEED_TIME),
+      _stashedChildId(WorkingSet::INVALID_ID) {
     _children.emplace_back(child);
 }
 
@@ -71,6 +79,10 @@ bool FetchStage::isEOF() {
         return false;
     }
 
+    if (!_readahead.empty() || _hasStashedChildState) {
+        return false;
+    }
+
     return child()->isEOF();
 }
 
@@ -84,15 +96,25 @@ PlanStage::StageState FetchStage::work(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
-    // Either retry the last WSM we worked on or get a new one from our child.
+    // Either retry the last WSM we worked on, take one we read ahead, or get a new one from our
+    // child.
     WorkingSetID id;
     StageState status;
-    if (_idRetrying == WorkingSet::INVALID_ID) {
-        status = child()->work(&id);
-    } else {
+    if (_idRetrying != WorkingSet::INVALID_ID) {
         status = ADVANCED;
         id = _idRetrying;
         _idRetrying = WorkingSet::INVALID_ID;
+    } else if (!_readahead.empty()) {
+        status = ADVANCED;
+        id = _readahead.front();
+        _readahead.pop_front();
+    } else if (_hasStashedChildState) {
+        status = _stashedChildState;
+        id = _stashedChildId;
+        _hasStashedChildState = false;
+        _stashedChildId = WorkingSet::INVALID_ID;
+    } else {
+        status = child()->work(&id);
     }
 
     if (PlanStage::ADVANCED == status) {
@@ -112,14 +134,20 @@ PlanStage::StageState FetchStage::work(WorkingSetID* out) {
 
                 if (auto fetcher = _cursor->fetcherForId(member->loc)) {
                     // There's something to fetch. Hand the fetcher off to the WSM, and pass up
-                    // a fetch request.
+                    // a fetch request. The records after this one are likely to be cold as well,
+                    // so get them paging in while we yield.
                     _idRetrying = id;
                     member->setFetcher(fetcher.release());
+                    readAhead();
                     *out = id;
                     _commonStats.needYield++;
                     return NEED_YIELD;
                 }
 
+                if (MONGO_FAIL_POINT(fetchStageAlwaysReadAhead)) {
+                    readAhead();
+                }
+
                 // The doc is already in memory, so go ahead and grab it. Now we have a RecordId
                 // as well as an unowned object
                 if (!WorkingSetCommon::fetch(getOpCtx(), _ws, id, _cursor)) {
@@ -158,6 +186,36 @@ PlanStage::StageState FetchStage::work(WorkingSetID* out) {
     return status;
 }
 
+void FetchStage::readAhead() {
+    if (!_readahead.empty() || _hasStashedChildState) {
+        // Still working through the last batch.
+        return;
+    }
+
+    vector<RecordId> locs;
+    for (int i = 0; i < internalQueryExecFetchReadaheadDepth && !child()->isEOF(); ++i) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState status = child()->work(&id);
+
+        if (PlanStage::ADVANCED == status) {
+            _readahead.push_back(id);
+            WorkingSetMember* member = _ws->get(id);
+            if (!member->hasObj() && member->hasLoc()) {
+                locs.push_back(member->loc);
+            }
+        } else if (PlanStage::NEED_TIME != status) {
+            _hasStashedChildState = true;
+            _stashedChildState = status;
+            _stashedChildId = id;
+            break;
+        }
+    }
+
+    if (!locs.empty()) {
+        _cursor->prefetch(locs);
+    }
+}
+
 void FetchStage::doSaveState() {
     if (_cursor)
         _cursor->saveUnpositioned();
@@ -188,6 +246,14 @@ void FetchStage::doInvalidate(OperationContext* txn, const RecordId& dl, Invalid
             WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
         }
     }
+
+    // The same goes for anything we've read ahead but not yet returned.
+    for (WorkingSetID id : _readahead) {
+        WorkingSetMember* member = _ws->get(id);
+        if (member->hasLoc() && (member->loc == dl)) {
+            WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+        }
+    }
 }
 
 PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 
 #include "mongo/db/exec/plan_stage.h"
@@ -83,6 +84,14 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Called when the record we are about to fetch is not in memory. Pulls up to
+     * internalQueryExecFetchReadaheadDepth further results from our child into '_readahead' and
+     * asks the cursor to start paging in their records, so that the I/O for them overlaps with
+     * the yield for the current one.
+     */
+    void readAhead();
+
     // Collection which is used by this stage. Used to resolve record ids retrieved by child
     // stages. The lifetime of the collection must supersede that of the stage.
     const Collection* _collection;
@@ -98,6 +107,16 @@ private:
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // Results pulled from our child by readAhead(). These are worked, in order, before we ask
+    // our child for anything else.
+    std::deque<WorkingSetID> _readahead;
+
+    // If our child returns something other than ADVANCED or NEED_TIME during readAhead(), it
+    // is held here and passed up once '_readahead' has drained.
+    bool _hasStashedChildState;
+    StageState _stashedChildState;
+    WorkingSetID _stashedChildId;
+
     // Stats
     FetchStats _specificStats;
 };
@@ -54,7 +54,7 @@ public:
         // BSONElementIterator does some interesting things with arrays that I don't think
         // SimpleArrayElementIterator does.
         if (_wsm->hasObj()) {
-            return new BSONElementIterator(path, _wsm->obj.value());
+            return new BSONElementIterator(path, _wsm->obj.value(), _fields.get(_wsm->obj.value()));
         }
 
         // NOTE: This (kind of) duplicates code in WorkingSetMember::getFieldDotted.
@@ -94,6 +94,7 @@ public:
 
 private:
     WorkingSetMember* _wsm;
+    mutable MatchableFieldTable _fields;
 };
 
 class IndexKeyMatchableDocument : public MatchableDocument {
@@ -390,18 +390,19 @@ Status ProjectionExec::transform(const BSONObj& in,
             BSONArrayBuilder arrBuilder;
             BSONObjBuilder subBob;
 
-            if (in.getField(elt.fieldName()).eoo()) {
+            BSONElement arrayElt = in.getField(elt.fieldName());
+            if (arrayElt.eoo()) {
                 return Status(ErrorCodes::InternalError,
                               "$elemMatch called on document element with eoo");
             }
 
-            if (in.getField(elt.fieldName()).Obj().getField(arrayDetails.elemMatchKey()).eoo()) {
+            BSONElement matchedElt = arrayElt.Obj().getField(arrayDetails.elemMatchKey());
+            if (matchedElt.eoo()) {
                 return Status(ErrorCodes::InternalError,
                               "$elemMatch called on array element with eoo");
             }
 
-            arrBuilder.append(
-                in.getField(elt.fieldName()).Obj().getField(arrayDetails.elemMatchKey()));
+            arrBuilder.append(matchedElt);
             subBob.appendArray(matcher->first, arrBuilder.arr());
             Status status = append(bob, subBob.done().firstElement(), details, arrayOpType);
             if (!status.isOK()) {
@@ -146,7 +146,7 @@ PlanStage::StageState SortStage::work(WorkingSetID* out) {
             // The data remains in the WorkingSet and we wrap the WSID with the sort key.
             SortableDataItem item;
             Status sortKeyStatus = _sortKeyGen->getSortKey(*member, &item.sortKey);
-            if (!_sortKeyGen->getSortKey(*member, &item.sortKey).isOK()) {
+            if (!sortKeyStatus.isOK()) {
                 *out = WorkingSetCommon::allocateStatusMember(_ws, sortKeyStatus);
                 return PlanStage::FAILURE;
             }
@@ -31,6 +31,7 @@
 #include "mongo/db/global_timestamp.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 
 namespace {
@@ -60,20 +61,29 @@ Timestamp getLastSetTimestamp() {
 }
 
 Timestamp getNextGlobalTimestamp() {
+    return getNextGlobalTimestamps(1);
+}
+
+Timestamp getNextGlobalTimestamps(unsigned count) {
+    invariant(count > 0);
     stdx::lock_guard<stdx::mutex> lk(globalTimestampMutex);
 
     const unsigned now = (unsigned)time(0);
     const unsigned globalSecs = globalTimestamp.getSecs();
+    Timestamp first;
     if (globalSecs == now) {
-        globalTimestamp = Timestamp(globalSecs, globalTimestamp.getInc() + 1);
+        first = Timestamp(globalSecs, globalTimestamp.getInc() + 1);
+        globalTimestamp = Timestamp(globalSecs, globalTimestamp.getInc() + count);
     } else if (now < globalSecs) {
-        globalTimestamp = Timestamp(globalSecs, globalTimestamp.getInc() + 1);
+        first = Timestamp(globalSecs, globalTimestamp.getInc() + 1);
+        globalTimestamp = Timestamp(globalSecs, globalTimestamp.getInc() + count);
         // separate function to keep out of the hot code path
         fassert(17449, !skewed(globalTimestamp));
     } else {
-        globalTimestamp = Timestamp(now, 1);
+        first = Timestamp(now, 1);
+        globalTimestamp = Timestamp(now, count);
     }
 
-    return globalTimestamp;
+    return first;
 }
 }
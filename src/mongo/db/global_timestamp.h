@@ -42,4 +42,10 @@ Timestamp getLastSetTimestamp();
  * Generates a new and unique Timestamp.
  */
 Timestamp getNextGlobalTimestamp();
+
+/**
+ * Generates 'count' new and unique Timestamps with consecutive increments in the same second,
+ * and returns the first of them. 'count' must be positive.
+ */
+Timestamp getNextGlobalTimestamps(unsigned count);
 }
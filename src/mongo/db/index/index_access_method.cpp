@@ -222,6 +222,22 @@ Status IndexAccessMethod::touch(OperationContext* txn, const BSONObj& obj) {
     return Status::OK();
 }
 
+Status IndexAccessMethod::touch(OperationContext* txn, const std::vector<BSONObj>& objs) {
+    BSONObjSet keys(BSONObjCmp(_descriptor->keyPattern()));
+    for (const auto& obj : objs) {
+        BSONObjSet objKeys;
+        getKeys(obj, &objKeys);
+        keys.insert(objKeys.begin(), objKeys.end());
+    }
+
+    std::unique_ptr<SortedDataInterface::Cursor> cursor(_newInterface->newCursor(txn));
+    for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
+        cursor->seekExact(*i, SortedDataInterface::Cursor::kJustExistance);
+    }
+
+    return Status::OK();
+}
+
 
 Status IndexAccessMethod::touch(OperationContext* txn) const {
     return _newInterface->touch(txn);
@@ -142,6 +142,12 @@ public:
      */
     Status touch(OperationContext* txn, const BSONObj& obj);
 
+    /**
+     * Like touch(txn, obj) for each of 'objs'. The keys of all the objects are sorted in index
+     * order first, so a single cursor visits them in one forward sweep.
+     */
+    Status touch(OperationContext* txn, const std::vector<BSONObj>& objs);
+
     /**
      * this pages in the entire index
      */
@@ -51,6 +51,8 @@
 #include "mongo/db/auth/internal_user_auth.h"
 #include "mongo/db/auth/security_key.h"
 #include "mongo/db/server_options.h"
+#include "mongo/logger/async_log_writer.h"
+#include "mongo/logger/async_rotatable_file_appender.h"
 #include "mongo/logger/logger.h"
 #include "mongo/logger/console_appender.h"
 #include "mongo/logger/message_event.h"
@@ -200,6 +202,8 @@ void forkServerOrDie() {
 MONGO_INITIALIZER_GENERAL(ServerLogRedirection,
                           ("GlobalLogManager", "EndStartupOptionHandling", "ForkServer"),
                           ("default"))(InitializerContext*) {
+    using logger::AsyncLogWriter;
+    using logger::AsyncRotatableFileAppender;
     using logger::LogManager;
     using logger::MessageEventEphemeral;
     using logger::MessageEventDetailsEncoder;
@@ -274,13 +278,29 @@ MONGO_INITIALIZER_GENERAL(ServerLogRedirection,
 
         LogManager* manager = logger::globalLogManager();
         manager->getGlobalDomain()->clearAppenders();
-        manager->getGlobalDomain()->attachAppender(
-            MessageLogDomain::AppenderAutoPtr(new RotatableFileAppender<MessageEventEphemeral>(
-                new MessageEventDetailsEncoder, writer.getValue())));
-        manager->getNamedDomain("javascriptOutput")
-            ->attachAppender(
+        if (serverGlobalParams.logAsync) {
+            // Lives for the rest of the process, like the appenders which refer to it.
+            AsyncLogWriter* asyncWriter =
+                new AsyncLogWriter(writer.getValue(),
+                                   serverGlobalParams.logAsyncDropWhenFull
+                                       ? AsyncLogWriter::OverflowPolicy::kDrop
+                                       : AsyncLogWriter::OverflowPolicy::kBlock);
+            manager->getGlobalDomain()->attachAppender(MessageLogDomain::AppenderAutoPtr(
+                new AsyncRotatableFileAppender<MessageEventEphemeral>(
+                    new MessageEventDetailsEncoder, asyncWriter)));
+            manager->getNamedDomain("javascriptOutput")
+                ->attachAppender(MessageLogDomain::AppenderAutoPtr(
+                    new AsyncRotatableFileAppender<MessageEventEphemeral>(
+                        new MessageEventDetailsEncoder, asyncWriter)));
+        } else {
+            manager->getGlobalDomain()->attachAppender(
                 MessageLogDomain::AppenderAutoPtr(new RotatableFileAppender<MessageEventEphemeral>(
                     new MessageEventDetailsEncoder, writer.getValue())));
+            manager->getNamedDomain("javascriptOutput")
+                ->attachAppender(MessageLogDomain::AppenderAutoPtr(
+                    new RotatableFileAppender<MessageEventEphemeral>(new MessageEventDetailsEncoder,
+                                                                     writer.getValue())));
+        }
 
         if (serverGlobalParams.logAppend && exists) {
             log() << "***** SERVER RESTARTED *****" << endl;
@@ -83,6 +83,7 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/rpc/command_reply_builder.h"
@@ -1225,6 +1226,7 @@ NOINLINE_DECL void dbexit(ExitCode rc, const char* why) {
     }
 #endif
 
+    logger::AsyncLogWriter::flushAll();
     quickExit(rc);
 }
 
@@ -187,6 +187,38 @@ TEST(AndOp, MatchesThreeClauses) {
     ASSERT(!andOp.matchesBSON(BSON("a" << 10 << "b" << 6), NULL));
 }
 
+TEST(AndOp, MatchesClausesOnSeveralFields) {
+    // Once several paths are looked up in a document, the top-level fields are found through a
+    // table of their offsets; this checks that dotted paths, arrays and duplicate field names
+    // still resolve as they do without it.
+    BSONObj baseOperand1 = BSON("a" << 1);
+    BSONObj baseOperand2 = BSON("b.c" << 2);
+    BSONObj baseOperand3 = BSON("d" << 3);
+
+    unique_ptr<ComparisonMatchExpression> sub1(new EqualityMatchExpression());
+    ASSERT(sub1->init("a", baseOperand1["a"]).isOK());
+
+    unique_ptr<ComparisonMatchExpression> sub2(new EqualityMatchExpression());
+    ASSERT(sub2->init("b.c", baseOperand2["b.c"]).isOK());
+
+    unique_ptr<ComparisonMatchExpression> sub3(new EqualityMatchExpression());
+    ASSERT(sub3->init("d", baseOperand3["d"]).isOK());
+
+    AndMatchExpression andOp;
+    andOp.add(sub1.release());
+    andOp.add(sub2.release());
+    andOp.add(sub3.release());
+
+    ASSERT(andOp.matchesBSON(BSON("x" << 0 << "d" << 3 << "b" << BSON("c" << 2) << "a" << 1),
+                             NULL));
+    ASSERT(andOp.matchesBSON(
+        BSON("a" << 1 << "b" << BSON_ARRAY(BSON("c" << 1) << BSON("c" << 2)) << "d" << 3), NULL));
+    ASSERT(!andOp.matchesBSON(BSON("a" << 1 << "b" << BSON("c" << 2) << "dd" << 3), NULL));
+    // Only the first of two fields with the same name is looked at.
+    ASSERT(!andOp.matchesBSON(BSON("a" << 1 << "b" << BSON("c" << 2) << "d" << 4 << "d" << 3),
+                              NULL));
+}
+
 TEST(AndOp, ElemMatchKey) {
     BSONObj baseOperand1 = BSON("a" << 1);
     BSONObj baseOperand2 = BSON("b" << 2);
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include "mongo/bson/bson_field_offset_table.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/matcher/path.h"
@@ -74,6 +75,32 @@ public:
     };
 };
 
+/**
+ * Indexes the fields of a document for a MatchableDocument, but only once a second path has been
+ * looked up in it: an expression on a single field finds it with one walk over the document,
+ * which building the table would only add to.
+ */
+class MatchableFieldTable {
+public:
+    /**
+     * Returns the table for 'obj', which must be the same document on every call, or null if
+     * it is not worth building yet.
+     */
+    const BSONFieldOffsetTable* get(const BSONObj& obj) {
+        if (++_lookups < 2) {
+            return nullptr;
+        }
+        if (_lookups == 2) {
+            _table.reset(obj);
+        }
+        return &_table;
+    }
+
+private:
+    int _lookups = 0;
+    BSONFieldOffsetTable _table;
+};
+
 class BSONMatchableDocument : public MatchableDocument {
 public:
     BSONMatchableDocument(const BSONObj& obj);
@@ -84,10 +111,11 @@ public:
     }
 
     virtual ElementIterator* allocateIterator(const ElementPath* path) const {
+        const BSONFieldOffsetTable* fields = _fields.get(_obj);
         if (_iteratorUsed)
-            return new BSONElementIterator(path, _obj);
+            return new BSONElementIterator(path, _obj, fields);
         _iteratorUsed = true;
-        _iterator.reset(path, _obj);
+        _iterator.reset(path, _obj, fields);
         return &_iterator;
     }
 
@@ -103,5 +131,6 @@ private:
     BSONObj _obj;
     mutable BSONElementIterator _iterator;
     mutable bool _iteratorUsed;
+    mutable MatchableFieldTable _fields;
 };
 }
@@ -85,19 +85,25 @@ ElementIterator::Context SimpleArrayElementIterator::next() {
 // ------
 BSONElementIterator::BSONElementIterator() {
     _path = NULL;
+    _contextFields = NULL;
 }
 
-BSONElementIterator::BSONElementIterator(const ElementPath* path, const BSONObj& context)
-    : _path(path), _context(context) {
+BSONElementIterator::BSONElementIterator(const ElementPath* path,
+                                         const BSONObj& context,
+                                         const BSONFieldOffsetTable* contextFields)
+    : _path(path), _context(context), _contextFields(contextFields) {
     _state = BEGIN;
     // log() << "path: " << path.fieldRef().dottedField() << " context: " << context << endl;
 }
 
 BSONElementIterator::~BSONElementIterator() {}
 
-void BSONElementIterator::reset(const ElementPath* path, const BSONObj& context) {
+void BSONElementIterator::reset(const ElementPath* path,
+                                const BSONObj& context,
+                                const BSONFieldOffsetTable* contextFields) {
     _path = path;
     _context = context;
+    _contextFields = contextFields;
     _state = BEGIN;
     _next.reset();
 
@@ -192,7 +198,8 @@ bool BSONElementIterator::more() {
 
     if (_state == BEGIN) {
         size_t idxPath = 0;
-        BSONElement e = getFieldDottedOrArray(_context, _path->fieldRef(), &idxPath);
+        BSONElement e =
+            getFieldDottedOrArray(_context, _path->fieldRef(), &idxPath, _contextFields);
 
         if (e.type() != Array) {
             _next.reset(e, BSONElement(), false);
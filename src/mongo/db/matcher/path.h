@@ -33,6 +33,7 @@
 
 #include "mongo/base/status.h"
 #include "mongo/base/string_data.h"
+#include "mongo/bson/bson_field_offset_table.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/field_ref.h"
 
@@ -137,11 +138,19 @@ private:
 class BSONElementIterator : public ElementIterator {
 public:
     BSONElementIterator();
-    BSONElementIterator(const ElementPath* path, const BSONObj& context);
+    /**
+     * If 'contextFields' is not null, it must index 'context' and outlive the iterator. It is used
+     * to find the first part of the path.
+     */
+    BSONElementIterator(const ElementPath* path,
+                        const BSONObj& context,
+                        const BSONFieldOffsetTable* contextFields = nullptr);
 
     virtual ~BSONElementIterator();
 
-    void reset(const ElementPath* path, const BSONObj& context);
+    void reset(const ElementPath* path,
+               const BSONObj& context,
+               const BSONFieldOffsetTable* contextFields = nullptr);
 
     bool more();
     Context next();
@@ -155,6 +164,7 @@ private:
 
     const ElementPath* _path;
     BSONObj _context;
+    const BSONFieldOffsetTable* _contextFields;
 
     enum State { BEGIN, IN_ARRAY, DONE } _state;
     Context _next;
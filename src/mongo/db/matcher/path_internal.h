@@ -33,6 +33,7 @@
 #include <cstdint>
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/bson_field_offset_table.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/jsobj.h"
 
@@ -42,6 +43,11 @@ bool isAllDigits(StringData str);
 
 // XXX document me
 // Replaces getFieldDottedOrArray without recursion nor std::string manipulation
-BSONElement getFieldDottedOrArray(const BSONObj& doc, const FieldRef& path, size_t* idxPath);
+// If 'docFields' is not null, it must index 'doc', and the first part of the path is looked up in
+// it.
+BSONElement getFieldDottedOrArray(const BSONObj& doc,
+                                  const FieldRef& path,
+                                  size_t* idxPath,
+                                  const BSONFieldOffsetTable* docFields = nullptr);
 
 }  // namespace mongo
@@ -68,6 +68,24 @@ void OpObserver::onInsert(OperationContext* txn,
     }
 }
 
+void OpObserver::onInserts(OperationContext* txn,
+                           const NamespaceString& ns,
+                           std::vector<BSONObj>::const_iterator begin,
+                           std::vector<BSONObj>::const_iterator end,
+                           bool fromMigrate) {
+    repl::_logOps(txn, "i", ns, begin, end, fromMigrate);
+
+    for (auto it = begin; it != end; ++it) {
+        getGlobalAuthorizationManager()->logOp(txn, "i", ns.ns().c_str(), *it, nullptr);
+        logOpForSharding(txn, "i", ns.ns().c_str(), *it, nullptr, fromMigrate);
+    }
+
+    logOpForDbHash(txn, ns.ns().c_str());
+    if (strstr(ns.ns().c_str(), ".system.js")) {
+        Scope::storedFuncMod(txn);
+    }
+}
+
 void OpObserver::onUpdate(OperationContext* txn, oplogUpdateEntryArgs args) {
     repl::_logOp(txn, "u", args.ns.c_str(), args.update, &args.criteria, args.fromMigrate);
 
@@ -34,6 +34,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/field_path.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -42,6 +43,11 @@ using boost::intrusive_ptr;
 using std::string;
 using std::vector;
 
+namespace {
+// Running total of the bytes copied by DocumentStorage::clone() on this thread.
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL size_t clonedBytes;
+}  // namespace
+
 Position DocumentStorage::findField(StringData requested) const {
     int reqSize = requested.size();  // get size calculation out of the way if needed
 
@@ -182,12 +188,22 @@ void DocumentStorage::reserveFields(size_t expectedFields) {
 intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
     intrusive_ptr<DocumentStorage> out(new DocumentStorage());
 
-    // Make a copy of the buffer.
-    // It is very important that the positions of each field are the same after cloning.
-    const size_t bufferBytes = (_bufferEnd + hashTabBytes()) - _buffer;
-    out->_buffer = new char[bufferBytes];
-    out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
-    memcpy(out->_buffer, _buffer, bufferBytes);
+    if (_buffer) {
+        // Make a buffer with the same capacity so the clone can be added to without growing, but
+        // only copy the parts that are in use: the fields and, once we are hashing, the hash
+        // table. The free space between them can be most of the buffer since it grows by doubling.
+        // It is very important that the positions of each field are the same after cloning.
+        const size_t bufferBytes = (_bufferEnd + hashTabBytes()) - _buffer;
+        out->_buffer = new char[bufferBytes];
+        out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
+        memcpy(out->_buffer, _buffer, _usedBytes);
+        clonedBytes += _usedBytes;
+
+        if (_numFields >= HASH_TAB_MIN) {
+            memcpy(out->_hashTab, _hashTab, hashTabBytes());
+            clonedBytes += hashTabBytes();
+        }
+    }
 
     // Copy remaining fields
     out->_usedBytes = _usedBytes;
@@ -205,6 +221,10 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
     return out;
 }
 
+size_t DocumentStorage::clonedBytesOnThisThread() {
+    return clonedBytes;
+}
+
 DocumentStorage::~DocumentStorage() {
     std::unique_ptr<char[]> deleteBufferAtScopeEnd(_buffer);
 
@@ -266,6 +266,13 @@ public:
     /// Shallow copy of this. Caller owns memory.
     boost::intrusive_ptr<DocumentStorage> clone() const;
 
+    /**
+     * Returns the number of bytes clone() has copied on the current thread. This is a running
+     * total, so callers should look at the difference between two calls. Used to measure how much
+     * copying pipeline stages do.
+     */
+    static size_t clonedBytesOnThisThread();
+
     size_t allocatedBytes() const {
         return !_buffer ? 0 : (_bufferEnd - _buffer + hashTabBytes());
     }
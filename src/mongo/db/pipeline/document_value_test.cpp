@@ -301,6 +301,61 @@ public:
     }
 };
 
+/** Clone a Document that is hashing its fields and keep adding fields to both copies. */
+class CloneHashedFields {
+public:
+    void run() {
+        MutableDocument md;
+        for (int i = 0; i < 20; i++) {
+            md.addField("field" + std::to_string(i), Value(i));
+        }
+        const Document document = md.freeze();
+
+        const size_t clonedBefore = DocumentStorage::clonedBytesOnThisThread();
+        MutableDocument cloned(document);
+        cloned.addField("extra", Value(true));
+        const size_t clonedBytes = DocumentStorage::clonedBytesOnThisThread() - clonedBefore;
+
+        // Only the fields and hash table are copied, not the free space after the fields.
+        ASSERT_GREATER_THAN(clonedBytes, 0U);
+        ASSERT_LESS_THAN(clonedBytes, document.getApproximateSize());
+
+        for (int i = 20; i < 40; i++) {
+            cloned.addField("field" + std::to_string(i), Value(i));
+        }
+        const Document clonedDocument = cloned.freeze();
+        for (int i = 0; i < 40; i++) {
+            const string name = "field" + std::to_string(i);
+            ASSERT_EQUALS(Value(i), clonedDocument[name]);
+            ASSERT_EQUALS(i < 20 ? Value(i) : Value(), document[name]);
+        }
+        ASSERT_EQUALS(Value(true), clonedDocument["extra"]);
+        ASSERT(document["extra"].missing());
+    }
+};
+
+/** Setting a nested field only clones the sub documents along its path. */
+class CloneOnlyNestedPath {
+public:
+    void run() {
+        const Document document = fromBson(fromjson("{a:{b:1,c:2},d:{e:3},f:4}"));
+        MutableDocument md(document);
+        md.setNestedField(FieldPath("a.b"), Value(10));
+        const Document changed = md.freeze();
+
+        ASSERT_EQUALS(DOC("a" << DOC("b" << 10 << "c" << 2) << "d" << DOC("e" << 3) << "f" << 4),
+                      changed);
+        ASSERT_EQUALS(DOC("a" << DOC("b" << 1 << "c" << 2) << "d" << DOC("e" << 3) << "f" << 4),
+                      document);
+
+        // The modified path was copied, the untouched sub document is shared.
+        ASSERT_NOT_EQUALS(document.getPtr(), changed.getPtr());
+        ASSERT_NOT_EQUALS(document["a"].getDocument().getPtr(),
+                          changed["a"].getDocument().getPtr());
+        ASSERT_EQUALS(document["d"].getDocument().getPtr(), changed["d"].getDocument().getPtr());
+    }
+};
+
 /** FieldIterator for an empty Document. */
 class FieldIteratorEmpty {
 public:
@@ -1670,6 +1725,8 @@ public:
         add<Document::Compare>();
         add<Document::Clone>();
         add<Document::CloneMultipleFields>();
+        add<Document::CloneHashedFields>();
+        add<Document::CloneOnlyNestedPath>();
         add<Document::FieldIteratorEmpty>();
         add<Document::FieldIteratorSingle>();
         add<Document::FieldIteratorMultiple>();
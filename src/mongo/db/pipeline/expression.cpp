@@ -48,7 +48,6 @@ using Parser = Expression::Parser;
 using namespace mongoutils;
 
 using boost::intrusive_ptr;
-using std::set;
 using std::string;
 using std::vector;
 
@@ -1235,8 +1234,10 @@ void ExpressionObject::addToDocument(MutableDocument& out,
                                      Variables* vars) const {
     FieldMap::const_iterator end = _expressions.end();
 
-    // This is used to mark fields we've done so that we can add the ones we haven't
-    set<string> doneFields;
+    // This is used to tell whether there are any fields we haven't done. It holds the keys
+    // of _expressions, so building it doesn't allocate per field.
+    vector<const string*> doneFields;
+    doneFields.reserve(_expressions.size());
 
     FieldIterator fields(currentDoc);
     while (fields.more()) {
@@ -1257,7 +1258,7 @@ void ExpressionObject::addToDocument(MutableDocument& out,
         }
 
         // make sure we don't add this field again
-        doneFields.insert(exprIter->first);
+        doneFields.push_back(&exprIter->first);
 
         Expression* expr = exprIter->second.get();
 
@@ -1322,16 +1323,21 @@ void ExpressionObject::addToDocument(MutableDocument& out,
         }
     }
 
+    // currentDoc may have repeated a field name, so keep each done field once
+    const std::less<const string*> keyOrder;
+    std::sort(doneFields.begin(), doneFields.end(), keyOrder);
+    doneFields.erase(std::unique(doneFields.begin(), doneFields.end()), doneFields.end());
+
     if (doneFields.size() == _expressions.size())
         return;
 
     /* add any remaining fields we haven't already taken care of */
     for (vector<string>::const_iterator i(_order.begin()); i != _order.end(); ++i) {
         FieldMap::const_iterator it = _expressions.find(*i);
-        string fieldName(it->first);
+        const string& fieldName = it->first;
 
         /* if we've already dealt with this field, above, do nothing */
-        if (doneFields.count(fieldName))
+        if (std::binary_search(doneFields.begin(), doneFields.end(), &fieldName, keyOrder))
             continue;
 
         // this is a missing inclusion field
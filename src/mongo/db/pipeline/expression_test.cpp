@@ -2290,6 +2290,31 @@ public:
     }
 };
 
+/** Project a computed expression after an included field that the source repeats. */
+class ComputedAfterRepeatedField : public ExpectedResultBase {
+public:
+    virtual BSONObj source() {
+        return BSON("_id" << 0 << "a" << 1 << "a" << 2);
+    }
+    void prepareExpression() {
+        expression()->includePath("a");
+        expression()->addField(mongo::FieldPath("b"), ExpressionConstant::create(Value(5)));
+    }
+    BSONObj expected() {
+        return BSON("_id" << 0 << "a" << 1 << "a" << 2 << "b" << 5);
+    }
+    BSONArray expectedDependencies() {
+        return BSON_ARRAY("_id"
+                          << "a");
+    }
+    BSONObj expectedBsonRepresentation() {
+        return BSON("a" << true << "b" << BSON("$const" << 5));
+    }
+    bool expectedIsSimple() {
+        return false;
+    }
+};
+
 /** Project a computed expression replacing an existing field. */
 class ComputedReplacement : public Computed {
     virtual BSONObj source() {
@@ -4446,6 +4471,7 @@ public:
         add<Object::IncludeArrayNested>();
         add<Object::ExcludeNonRootId>();
         add<Object::Computed>();
+        add<Object::ComputedAfterRepeatedField>();
         add<Object::ComputedReplacement>();
         add<Object::ComputedUndefined>();
         add<Object::ComputedUndefinedReplacement>();
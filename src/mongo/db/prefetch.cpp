@@ -32,13 +32,15 @@
 
 #include "mongo/db/prefetch.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/commands/server_status_metric.h"
-#include "mongo/db/dbhelpers.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/bgsync.h"
+#include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
@@ -64,11 +66,11 @@ ServerStatusMetricField<TimerStats> displayPrefetchIndexPages("repl.preload.inde
 TimerStats prefetchDocStats;
 ServerStatusMetricField<TimerStats> displayPrefetchDocPages("repl.preload.docs", &prefetchDocStats);
 
-// page in pages needed for all index lookups on a given object
+// page in pages needed for all index lookups on the given objects
 void prefetchIndexPages(OperationContext* txn,
                         Collection* collection,
                         const BackgroundSync::IndexPrefetchConfig& prefetchConfig,
-                        const BSONObj& obj) {
+                        const std::vector<BSONObj>& objs) {
     // do we want prefetchConfig to be (1) as-is, (2) for update ops only, or (3) configured per op
     // type? One might want PREFETCH_NONE for updates, but it's more rare that it is a bad idea for
     // inserts. #3 (per op), a big issue would be "too many knobs".
@@ -85,7 +87,7 @@ void prefetchIndexPages(OperationContext* txn,
                     return;
                 IndexAccessMethod* iam = collection->getIndexCatalog()->getIndex(desc);
                 invariant(iam);
-                iam->touch(txn, obj);
+                iam->touch(txn, objs);
             } catch (const DBException& e) {
                 LOG(2) << "ignoring exception in prefetchIndexPages(): " << e.what() << endl;
             }
@@ -98,12 +100,12 @@ void prefetchIndexPages(OperationContext* txn,
                 collection->getIndexCatalog()->getIndexIterator(txn, true);
             while (ii.more()) {
                 TimerHolder timer(&prefetchIndexStats);
-                // This will page in all index pages for the given object.
+                // This will page in all index pages for the given objects.
                 try {
                     IndexDescriptor* desc = ii.next();
                     IndexAccessMethod* iam = collection->getIndexCatalog()->getIndex(desc);
                     verify(iam);
-                    iam->touch(txn, obj);
+                    iam->touch(txn, objs);
                 } catch (const DBException& e) {
                     LOG(2) << "ignoring exception in prefetchIndexPages(): " << e.what() << endl;
                 }
@@ -115,55 +117,96 @@ void prefetchIndexPages(OperationContext* txn,
     }
 }
 
-// page in the data pages for a record associated with an object
-void prefetchRecordPages(OperationContext* txn, Database* db, const char* ns, const BSONObj& obj) {
-    BSONElement _id;
-    if (obj.getObjectID(_id)) {
-        TimerHolder timer(&prefetchDocStats);
-        BSONObjBuilder builder;
-        builder.append(_id);
-        BSONObj result;
-        try {
-            if (Helpers::findById(txn, db, ns, builder.done(), result)) {
-                // do we want to use Record::touch() here?  it's pretty similar.
-                volatile char _dummy_char = '\0';
-
-                // Touch the first word on every page in order to fault it into memory
-                for (int i = 0; i < result.objsize(); i += g_minOSPageSizeBytes) {
-                    _dummy_char += *(result.objdata() + i);
-                }
-                // hit the last page, in case we missed it above
-                _dummy_char += *(result.objdata() + result.objsize() - 1);
+// page in the data pages for the records associated with the given objects
+void prefetchRecordPages(OperationContext* txn,
+                         Collection* collection,
+                         const std::vector<BSONObj>& objs) {
+    TimerHolder timer(&prefetchDocStats);
+    try {
+        IndexDescriptor* desc = collection->getIndexCatalog()->findIdIndex(txn);
+        if (!desc)
+            return;
+        IndexAccessMethod* iam = collection->getIndexCatalog()->getIndex(desc);
+        invariant(iam);
+
+        // Look up the _ids in index order, then read the records in RecordId order, so that
+        // both the index and the collection are visited in a single forward sweep.
+        BSONObjSet ids;
+        for (const auto& obj : objs) {
+            BSONElement _id;
+            if (obj.getObjectID(_id)) {
+                ids.insert(_id.wrap(""));
+            }
+        }
+
+        std::vector<RecordId> locs;
+        locs.reserve(ids.size());
+        auto indexCursor = iam->newCursor(txn);
+        for (const auto& id : ids) {
+            if (auto kv = indexCursor->seekExact(id, SortedDataInterface::Cursor::kWantLoc)) {
+                locs.push_back(kv->loc);
             }
-        } catch (const DBException& e) {
-            LOG(2) << "ignoring exception in prefetchRecordPages(): " << e.what() << endl;
         }
+        std::sort(locs.begin(), locs.end());
+
+        auto recordCursor = collection->getRecordStore()->getCursor(txn);
+        for (const auto& loc : locs) {
+            auto record = recordCursor->seekExact(loc);
+            if (!record || record->data.size() <= 0) {
+                continue;
+            }
+
+            volatile char _dummy_char = '\0';
+            const char* data = record->data.data();
+            const int size = record->data.size();
+
+            // Touch the first word on every page in order to fault it into memory
+            for (int i = 0; i < size; i += g_minOSPageSizeBytes) {
+                _dummy_char += *(data + i);
+            }
+            // hit the last page, in case we missed it above
+            _dummy_char += *(data + size - 1);
+        }
+    } catch (const DBException& e) {
+        LOG(2) << "ignoring exception in prefetchRecordPages(): " << e.what() << endl;
     }
 }
 }  // namespace
 
-// prefetch for an oplog operation
-void prefetchPagesForReplicatedOp(OperationContext* txn, Database* db, const BSONObj& op) {
+// prefetch for a batch of oplog operations on one collection
+void prefetchPagesForReplicatedOps(OperationContext* txn,
+                                   Database* db,
+                                   StringData ns,
+                                   const std::vector<BSONObj>& ops) {
     invariant(db);
     const BackgroundSync::IndexPrefetchConfig prefetchConfig =
         BackgroundSync::get()->getIndexPrefetchConfig();
-    const char* opField;
-    const char* opType = op.getStringField("op");
-    switch (*opType) {
-        case 'i':  // insert
-        case 'd':  // delete
-            opField = "o";
-            break;
-        case 'u':  // update
-            opField = "o2";
-            break;
-        default:
-            // prefetch ignores other ops
-            return;
-    }
 
-    BSONObj obj = op.getObjectField(opField);
-    const char* ns = op.getStringField("ns");
+    std::vector<BSONObj> indexObjs;
+    std::vector<BSONObj> updateObjs;
+    indexObjs.reserve(ops.size());
+    for (const auto& op : ops) {
+        dassert(StringData(op.getStringField("ns")) == ns);
+        const char* opType = op.getStringField("op");
+        switch (*opType) {
+            case 'i':  // insert
+                indexObjs.push_back(repl::uncompressOplogPayload(op, op.getObjectField("o")));
+                break;
+            case 'd':  // delete
+                indexObjs.push_back(op.getObjectField("o"));
+                break;
+            case 'u':  // update
+                indexObjs.push_back(op.getObjectField("o2"));
+                updateObjs.push_back(indexObjs.back());
+                break;
+            default:
+                // prefetch ignores other ops
+                break;
+        }
+    }
+    if (indexObjs.empty()) {
+        return;
+    }
 
     // This will have to change for engines other than MMAP V1, because they might not have
     // means for directly prefetching pages from the collection. For this purpose, acquire S
@@ -175,7 +218,7 @@ void prefetchPagesForReplicatedOp(OperationContext* txn, Database* db, const BSO
         return;
     }
 
-    LOG(4) << "index prefetch for op " << *opType << endl;
+    LOG(4) << "index prefetch for " << indexObjs.size() << " ops on " << ns << endl;
 
     // should we prefetch index pages on updates? if the update is in-place and doesn't change
     // indexed values, it is actually slower - a lot slower if there are a dozen indexes or
@@ -192,7 +235,7 @@ void prefetchPagesForReplicatedOp(OperationContext* txn, Database* db, const BSO
     // a way to achieve that would be to prefetch the record first, and then afterwards do
     // this part.
     //
-    prefetchIndexPages(txn, collection, prefetchConfig, obj);
+    prefetchIndexPages(txn, collection, prefetchConfig, indexObjs);
 
     // do not prefetch the data for inserts; it doesn't exist yet
     //
@@ -200,11 +243,11 @@ void prefetchPagesForReplicatedOp(OperationContext* txn, Database* db, const BSO
     // when we delete.  note if done we only want to touch the first page.
     //
     // update: do record prefetch.
-    if ((*opType == 'u') &&
+    if (!updateObjs.empty() &&
         // do not prefetch the data for capped collections because
         // they typically do not have an _id index for findById() to use.
         !collection->isCapped()) {
-        prefetchRecordPages(txn, db, ns, obj);
+        prefetchRecordPages(txn, collection, updateObjs);
     }
 }
 
@@ -27,13 +27,21 @@
 */
 #pragma once
 
+#include <vector>
+
+#include "mongo/base/string_data.h"
+
 namespace mongo {
 class BSONObj;
 class Database;
 class OperationContext;
 namespace repl {
 
-// page in possible index and/or data pages for an op from the oplog
-void prefetchPagesForReplicatedOp(OperationContext* txn, Database* db, const BSONObj& op);
+// page in possible index and/or data pages for a batch of ops from the oplog, all on collection
+// 'ns'. The keys and records are visited in sorted order.
+void prefetchPagesForReplicatedOps(OperationContext* txn,
+                                   Database* db,
+                                   StringData ns,
+                                   const std::vector<BSONObj>& ops);
 }  // namespace repl
 }  // namespace mongo
@@ -365,6 +365,15 @@ QueryResult::View getMore(OperationContext* txn,
         exec->reattachToOperationContext(txn);
         exec->restoreState();
 
+        // If we're tailing a capped collection, retrieve a monotonically increasing insert
+        // counter before generating the batch, so that an insert that becomes visible after the
+        // batch was generated still wakes us up below.
+        uint64_t lastInsertCount = 0;
+        if (isCursorAwaitData(cc)) {
+            invariant(ctx->getCollection()->isCapped());
+            lastInsertCount = ctx->getCollection()->getCappedInsertNotifier()->getCount();
+        }
+
         PlanExecutor::ExecState state;
 
         generateBatch(ntoreturn, cc, &bb, &numResults, &slaveReadTill, &state);
@@ -384,7 +393,6 @@ QueryResult::View getMore(OperationContext* txn,
 
             // Block waiting for data for up to 1 second.
             Seconds timeout(1);
-            uint64_t lastInsertCount = notifier->getCount();
             notifier->waitForInsert(lastInsertCount, timeout);
             notifier.reset();
 
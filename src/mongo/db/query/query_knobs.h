@@ -101,4 +101,9 @@ extern int internalQueryExecYieldIterations;
 // Yield if it's been at least this many milliseconds since we last yielded.
 extern int internalQueryExecYieldPeriodMS;
 
+// When a FETCH stage finds that a record is not in physical memory, how many of the following
+// results does it pull from its child so that their records can be read in ahead of time?
+// Zero disables readahead.
+extern int internalQueryExecFetchReadaheadDepth;
+
 }  // namespace mongo
@@ -0,0 +1,72 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/range_deleter_throttle.h"
+
+#include <algorithm>
+
+namespace mongo {
+
+RangeDeleterThrottle::RangeDeleterThrottle(const Top& top, StringData ns)
+    : _top(top), _ns(ns.toString()), _last(_top.getCollectionData(_ns).total) {}
+
+Milliseconds RangeDeleterThrottle::nextDelay(double latencyFactor, Milliseconds maxDelay) {
+    if (latencyFactor <= 0) {
+        _delay = Milliseconds(0);
+        return _delay;
+    }
+
+    const Top::UsageData now = _top.getCollectionData(_ns).total;
+    const Top::UsageData diff(_last, now);
+    _last = now;
+
+    if (diff.count == 0) {
+        // No foreground activity, so there is nobody to slow down
+        _delay /= 2;
+        return _delay;
+    }
+
+    const double avgMicros = static_cast<double>(diff.time) / diff.count;
+    if (_baselineMicros == 0) {
+        _baselineMicros = avgMicros;
+    }
+
+    if (avgMicros > _baselineMicros * latencyFactor) {
+        _delay = std::min(std::max(_delay * 2, Milliseconds(1)), maxDelay);
+    } else {
+        _delay /= 2;
+        _baselineMicros = 0.8 * _baselineMicros + 0.2 * avgMicros;
+    }
+
+    return _delay;
+}
+
+}  // namespace mongo
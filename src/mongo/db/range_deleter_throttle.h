@@ -0,0 +1,66 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/base/string_data.h"
+#include "mongo/db/stats/top.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * Decides how long a range deletion should pause between two batches, based on the latency which
+ * foreground operations on the same collection observed while the previous batch ran. Keeps an
+ * exponentially weighted baseline of the per-operation latency and doubles the pause every time
+ * the latency is above the given multiple of the baseline, halving it again once latency
+ * recovers.
+ */
+class RangeDeleterThrottle {
+public:
+    RangeDeleterThrottle(const Top& top, StringData ns);
+
+    /**
+     * Returns the time to pause before the next batch, or zero if no throttling is needed. The
+     * pause never exceeds 'maxDelay'. A 'latencyFactor' of zero or less disables the throttle.
+     */
+    Milliseconds nextDelay(double latencyFactor, Milliseconds maxDelay);
+
+private:
+    const Top& _top;
+    const std::string _ns;
+
+    Top::UsageData _last;
+    double _baselineMicros = 0;
+    Milliseconds _delay{0};
+};
+
+}  // namespace mongo
@@ -0,0 +1,113 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/range_deleter_throttle.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+namespace {
+
+const char* const kNs = "test.user";
+
+/**
+ * Records 'count' foreground queries on kNs which took 'micros' each.
+ */
+void recordQueries(Top& top, int count, long long micros) {
+    for (int i = 0; i < count; i++) {
+        top.record(kNs, dbQuery, -1, micros, false);
+    }
+}
+
+TEST(RangeDeleterThrottle, DisabledByNonPositiveFactor) {
+    Top top;
+    RangeDeleterThrottle throttle(top, kNs);
+
+    recordQueries(top, 10, 100);
+    ASSERT_EQUALS(Milliseconds(0), throttle.nextDelay(2, Milliseconds(1000)));
+
+    recordQueries(top, 10, 100000);
+    ASSERT_EQUALS(Milliseconds(0), throttle.nextDelay(0, Milliseconds(1000)));
+    ASSERT_EQUALS(Milliseconds(0), throttle.nextDelay(-1, Milliseconds(1000)));
+}
+
+TEST(RangeDeleterThrottle, NoPauseWithoutForegroundActivity) {
+    Top top;
+    RangeDeleterThrottle throttle(top, kNs);
+
+    ASSERT_EQUALS(Milliseconds(0), throttle.nextDelay(2, Milliseconds(1000)));
+
+    // Another collection's operations don't count
+    top.record("test.other", dbQuery, -1, 100000, false);
+    ASSERT_EQUALS(Milliseconds(0), throttle.nextDelay(2, Milliseconds(1000)));
+}
+
+TEST(RangeDeleterThrottle, BacksOffWhileLatencyIsHighAndRecovers) {
+    Top top;
+    RangeDeleterThrottle throttle(top, kNs);
+    const Milliseconds maxDelay(5);
+
+    // The first sample sets the baseline
+    recordQueries(top, 10, 100);
+    ASSERT_EQUALS(Milliseconds(0), throttle.nextDelay(2, maxDelay));
+
+    // Ten times the baseline doubles the pause every batch, up to the maximum
+    const Milliseconds slowDelays[] = {
+        Milliseconds(1), Milliseconds(2), Milliseconds(4), Milliseconds(5), Milliseconds(5)};
+    for (const Milliseconds& expected : slowDelays) {
+        recordQueries(top, 10, 1000);
+        ASSERT_EQUALS(expected, throttle.nextDelay(2, maxDelay));
+    }
+
+    // Back at the baseline, the pause halves every batch
+    const Milliseconds fastDelays[] = {Milliseconds(2), Milliseconds(1), Milliseconds(0)};
+    for (const Milliseconds& expected : fastDelays) {
+        recordQueries(top, 10, 100);
+        ASSERT_EQUALS(expected, throttle.nextDelay(2, maxDelay));
+    }
+}
+
+TEST(RangeDeleterThrottle, PauseHalvesWhenForegroundGoesIdle) {
+    Top top;
+    RangeDeleterThrottle throttle(top, kNs);
+
+    recordQueries(top, 10, 100);
+    ASSERT_EQUALS(Milliseconds(0), throttle.nextDelay(2, Milliseconds(1000)));
+
+    for (int i = 0; i < 4; i++) {
+        recordQueries(top, 10, 1000);
+        throttle.nextDelay(2, Milliseconds(1000));
+    }
+    ASSERT_EQUALS(Milliseconds(4), throttle.nextDelay(2, Milliseconds(1000)));
+}
+
+}  // namespace
+}  // namespace mongo
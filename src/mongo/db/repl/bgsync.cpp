@@ -134,6 +134,21 @@ static ServerStatusMetricField<Counter64> displayBufferSize("repl.buffer.sizeByt
 static int bufferMaxSizeGauge = 256 * 1024 * 1024;
 static ServerStatusMetricField<int> displayBufferMaxSize("repl.buffer.maxSizeBytes",
                                                          &bufferMaxSizeGauge);
+// The count of fetched batches in the buffer
+static Counter64 bufferBatchesGauge;
+static ServerStatusMetricField<Counter64> displayBufferBatches("repl.buffer.batches",
+                                                               &bufferBatchesGauge);
+// The number and time of waits by the fetcher for room in the buffer
+static TimerStats bufferProducerWaitStats;
+static ServerStatusMetricField<TimerStats> displayBufferProducerWaits(
+    "repl.buffer.producerWaits", &bufferProducerWaitStats);
+// The number and time of waits by the applier for ops to appear in the buffer
+static TimerStats bufferConsumerWaitStats;
+static ServerStatusMetricField<TimerStats> displayBufferConsumerWaits(
+    "repl.buffer.consumerWaits", &bufferConsumerWaitStats);
+
+// The max number of fetched batches in the buffer
+const size_t kBufferMaxBatches = 1024;
 
 
 BackgroundSyncInterface::~BackgroundSyncInterface() {}
@@ -143,10 +158,16 @@ size_t getSize(const BSONObj& o) {
     // SERVER-9808 Avoid Fortify complaint about implicit signed->unsigned conversion
     return static_cast<size_t>(o.objsize());
 }
+
+void decrementBufferGauges(const OplogBatchRing::Size& dropped) {
+    bufferBatchesGauge.decrement(dropped.batches);
+    bufferCountGauge.decrement(dropped.ops);
+    bufferSizeGauge.decrement(dropped.bytes);
+}
 }  // namespace
 
 BackgroundSync::BackgroundSync()
-    : _buffer(bufferMaxSizeGauge, &getSize),
+    : _buffer(bufferMaxSizeGauge, kBufferMaxBatches),
       _lastOpTimeFetched(Timestamp(std::numeric_limits<int>::max(), 0),
                          std::numeric_limits<long long>::max()),
       _lastFetchedHash(0),
@@ -169,7 +190,7 @@ void BackgroundSync::shutdown() {
 
     // Clear the buffer in case the producerThread is waiting in push() due to a full queue.
     invariant(inShutdown());
-    _buffer.clear();
+    decrementBufferGauges(_buffer.clear());
     _pause = true;
 
     // Wake up producerThread so it notices that we're in shutdown
@@ -337,7 +358,10 @@ void BackgroundSync::_produce(OperationContext* txn, executor::TaskExecutor* tas
                     nsToDatabase(rsOplogName),
                     cmdObj,
                     fetcherCallback,
-                    rpc::makeEmptyMetadata());
+                    rpc::makeEmptyMetadata(),
+                    // Each reply is buffered as one batch, so copying its entries out would not
+                    // free the reply's memory any sooner.
+                    Fetcher::DocumentOwnership::kShareReplyBuffer);
     auto scheduleStatus = fetcher.schedule();
     if (!scheduleStatus.isOK()) {
         warning() << "unable to schedule fetcher to read remote oplog on " << source << ": "
@@ -423,7 +447,7 @@ void BackgroundSync::_fetcherCallback(const StatusWith<Fetcher::QueryResponse>&
 
     // process documents
     int currentBatchMessageSize = 0;
-    for (auto documentIter = documentBegin; documentIter != documentEnd; ++documentIter) {
+    if (documentBegin != documentEnd) {
         if (inShutdown()) {
             return;
         }
@@ -435,11 +459,13 @@ void BackgroundSync::_fetcherCallback(const StatusWith<Fetcher::QueryResponse>&
             return;
         }
 
-        // At this point, we are guaranteed to have at least one thing to read out
-        // of the fetcher.
-        const BSONObj& o = *documentIter;
-        currentBatchMessageSize += o.objsize();
-        opsReadStats.increment();
+        // The documents share the buffer of the getMore reply, so handing the batch to the
+        // buffer does not copy any oplog entries.
+        OplogBatchRing::Batch batch(documentBegin, documentEnd);
+        for (const auto& o : batch) {
+            currentBatchMessageSize += o.objsize();
+        }
+        opsReadStats.increment(batch.size());
 
         if (MONGO_FAIL_POINT(stepDownWhileDrainingFailPoint)) {
             sleepsecs(20);
@@ -451,17 +477,22 @@ void BackgroundSync::_fetcherCallback(const StatusWith<Fetcher::QueryResponse>&
         }
 
         OCCASIONALLY {
-            LOG(2) << "bgsync buffer has " << _buffer.size() << " bytes";
+            LOG(2) << "bgsync buffer has " << _buffer.size().bytes << " bytes";
         }
 
-        bufferCountGauge.increment();
-        bufferSizeGauge.increment(getSize(o));
-        _buffer.push(o);
+        const BSONObj lastOp = batch.back();
+        bufferBatchesGauge.increment();
+        bufferCountGauge.increment(batch.size());
+        bufferSizeGauge.increment(currentBatchMessageSize);
+        const Milliseconds waited = _buffer.push(std::move(batch));
+        if (waited > Milliseconds(0)) {
+            bufferProducerWaitStats.recordMillis(durationCount<Milliseconds>(waited));
+        }
 
         {
             stdx::unique_lock<stdx::mutex> lock(_mutex);
-            _lastFetchedHash = o["h"].numberLong();
-            _lastOpTimeFetched = fassertStatusOK(28770, OpTime::parseFromBSON(o));
+            _lastFetchedHash = lastOp["h"].numberLong();
+            _lastOpTimeFetched = fassertStatusOK(28770, OpTime::parseFromBSON(lastOp));
             LOG(3) << "lastOpTimeFetched: " << _lastOpTimeFetched;
         }
     }
@@ -522,22 +553,30 @@ bool BackgroundSync::_shouldChangeSyncSource(const HostAndPort& syncSource) {
 
 
 bool BackgroundSync::peek(BSONObj* op) {
-    return _buffer.peek(*op);
+    return _buffer.peek(op);
 }
 
 void BackgroundSync::waitForMore() {
-    BSONObj op;
-    // Block for one second before timing out.
-    // Ignore the value of the op we peeked at.
-    _buffer.blockingPeek(op, 1);
+    // Block for one second before timing out. Only count the calls which found the buffer empty.
+    Timer timer;
+    bool waited = false;
+    _buffer.waitForData(Seconds(1), &waited);
+    if (waited) {
+        bufferConsumerWaitStats.record(timer);
+    }
 }
 
 void BackgroundSync::consume() {
     // this is just to get the op off the queue, it's been peeked at
     // and queued for application already
-    BSONObj op = _buffer.blockingPop();
+    BSONObj op;
+    const bool havePeeked = _buffer.peek(&op);
+    invariant(havePeeked);
     bufferCountGauge.decrement(1);
     bufferSizeGauge.decrement(getSize(op));
+    if (_buffer.consume()) {
+        bufferBatchesGauge.decrement(1);
+    }
 }
 
 void BackgroundSync::_rollback(OperationContext* txn,
@@ -607,7 +646,7 @@ void BackgroundSync::waitUntilPaused() {
 }
 
 void BackgroundSync::clearBuffer() {
-    _buffer.clear();
+    decrementBufferGauges(_buffer.clear());
 }
 
 long long BackgroundSync::_readLastAppliedHash(OperationContext* txn) {
@@ -654,7 +693,10 @@ void BackgroundSync::setInitialSyncRequestedFlag(bool value) {
 
 void BackgroundSync::pushTestOpToBuffer(const BSONObj& op) {
     stdx::lock_guard<stdx::mutex> lock(_mutex);
-    _buffer.push(op);
+    bufferBatchesGauge.increment();
+    bufferCountGauge.increment();
+    bufferSizeGauge.increment(getSize(op));
+    _buffer.push(OplogBatchRing::Batch{op});
 }
 
 
@@ -31,12 +31,12 @@
 #include "mongo/base/status_with.h"
 #include "mongo/client/fetcher.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_batch_ring.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/net/hostandport.h"
-#include "mongo/util/queue.h"
 
 namespace mongo {
 
@@ -141,8 +141,8 @@ private:
     // protects creation of s_instance
     static stdx::mutex s_mutex;
 
-    // Production thread
-    BlockingQueue<BSONObj> _buffer;
+    // Production thread. Holds whole fetched batches; see OplogBatchRing.
+    OplogBatchRing _buffer;
 
     // _mutex protects all of the class variables except _syncSourceReader and _buffer
     mutable stdx::mutex _mutex;
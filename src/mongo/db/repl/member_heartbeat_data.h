@@ -88,6 +88,12 @@ public:
         return _lastResponse.hasIsElectable() && !_lastResponse.isElectable();
     }
 
+    // Returns true if the last heartbeat data stated that the node can apply compressed oplog
+    // entries.
+    bool appliesCompressedOplog() const {
+        return _lastResponse.appliesCompressedOplog();
+    }
+
     // Was this member up for the last heartbeat?
     bool up() const {
         return _health > 0;
@@ -36,8 +36,11 @@
 
 #include <deque>
 #include <set>
+#include <snappy.h>
 #include <vector>
 
+#include "mongo/base/counter.h"
+#include "mongo/base/data_view.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
@@ -57,6 +60,7 @@
 #include "mongo/db/catalog/rename_collection.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/dbhash.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
@@ -104,6 +108,14 @@ namespace repl {
 std::string rsOplogName = "local.oplog.rs";
 std::string masterSlaveOplogName = "local.oplog.$main";
 int OPLOG_VERSION = 2;
+// Written only when the replica set config enables oplog compression. Versions without support
+// for it fassert (18820) when they apply such an entry, so downgrading a member is unsafe until
+// the compressed entries have rolled off the oplog.
+int OPLOG_VERSION_COMPRESSED = 3;
+
+// Insert and update payloads smaller than this are never compressed, even when the replica set
+// config enables oplog compression.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(oplogCompressionMinBytes, int, 4096);
 
 MONGO_FP_DECLARE(disableSnapshotting);
 
@@ -114,6 +126,16 @@ Collection* _localOplogCollection = nullptr;
 
 PseudoRandom hashGenerator(std::unique_ptr<SecureRandom>(SecureRandom::create())->nextInt64());
 
+// Field holding the snappy compressed original of a compressed "o" or "o2" payload.
+const char kCompressedPayloadFieldName[] = "$z";
+
+Counter64 compressedPayloadsStats;
+ServerStatusMetricField<Counter64> displayCompressedPayloads("repl.oplog.compression.payloads",
+                                                             &compressedPayloadsStats);
+Counter64 compressionBytesSavedStats;
+ServerStatusMetricField<Counter64> displayCompressionBytesSaved(
+    "repl.oplog.compression.bytesSaved", &compressionBytesSavedStats);
+
 // Synchronizes the section where a new Timestamp is generated and when it actually
 // appears in the oplog.
 stdx::mutex newOpMutex;
@@ -122,31 +144,34 @@ stdx::condition_variable newTimestampNotifier;
 static std::string _oplogCollectionName;
 
 // so we can fail the same way
+void checkOplogInsert(Status result) {
+    massert(17322, str::stream() << "write to oplog failed: " << result.toString(), result.isOK());
+}
+
 void checkOplogInsert(StatusWith<RecordId> result) {
-    massert(17322,
-            str::stream() << "write to oplog failed: " << result.getStatus().toString(),
-            result.isOK());
+    checkOplogInsert(result.getStatus());
 }
 
 /**
- * Allocates an optime for a new entry in the oplog, and updates the replication coordinator to
- * reflect that new optime.  Returns the new optime and the correct value of the "h" field for
- * the new oplog entry.
+ * Allocates optimes for 'count' new entries in the oplog, all in one critical section, and
+ * stores them in 'slotsOut' along with the correct values of the "h" field for the new entries.
+ * The optimes have consecutive timestamps. Only the first one is registered with the storage
+ * engine, which keeps the whole batch hidden from readers as long as the entries are written in
+ * the same unit of work.
  *
- * NOTE: From the time this function returns to the time that the new oplog entry is written
+ * NOTE: From the time this function returns to the time that the new oplog entries are written
  * to the storage system, all errors must be considered fatal.  This is because the this
  * function registers the new optime with the storage system and the replication coordinator,
  * and provides no facility to revert those registrations on rollback.
  */
-std::pair<OpTime, long long> getNextOpTime(OperationContext* txn,
-                                           Collection* oplog,
-                                           const char* ns,
-                                           ReplicationCoordinator* replCoord,
-                                           const char* opstr,
-                                           ReplicationCoordinator::Mode replicationMode) {
+void getNextOpTimes(OperationContext* txn,
+                    Collection* oplog,
+                    ReplicationCoordinator* replCoord,
+                    ReplicationCoordinator::Mode replicationMode,
+                    unsigned count,
+                    std::pair<OpTime, long long>* slotsOut) {
     synchronizeOnCappedInFlightResource(txn->lockState());
 
-    long long hashNew = 0;
     long long term = OpTime::kProtocolVersionV0Term;
 
     // Fetch term out of the newOpMutex.
@@ -157,18 +182,21 @@ std::pair<OpTime, long long> getNextOpTime(OperationContext* txn,
     }
 
     stdx::lock_guard<stdx::mutex> lk(newOpMutex);
-    Timestamp ts = getNextGlobalTimestamp();
+    const Timestamp first = getNextGlobalTimestamps(count);
     newTimestampNotifier.notify_all();
 
-    fassert(28560, oplog->getRecordStore()->oplogDiskLocRegister(txn, ts));
+    fassert(28560, oplog->getRecordStore()->oplogDiskLocRegister(txn, first));
 
-    // Set hash if we're in replset mode, otherwise it remains 0 in master/slave.
-    if (replicationMode == ReplicationCoordinator::modeReplSet) {
-        hashNew = hashGenerator.nextInt64();
-    }
+    for (unsigned i = 0; i < count; i++) {
+        // Set hash if we're in replset mode, otherwise it remains 0 in master/slave.
+        long long hashNew = 0;
+        if (replicationMode == ReplicationCoordinator::modeReplSet) {
+            hashNew = hashGenerator.nextInt64();
+        }
 
-    OpTime opTime(ts, term);
-    return std::pair<OpTime, long long>(opTime, hashNew);
+        OpTime opTime(Timestamp(first.getSecs(), first.getInc() + i), term);
+        slotsOut[i] = std::pair<OpTime, long long>(opTime, hashNew);
+    }
 }
 
 /**
@@ -256,46 +284,46 @@ void setOplogCollectionName() {
 
 */
 
-void _logOp(OperationContext* txn,
-            const char* opstr,
-            const char* ns,
-            const BSONObj& obj,
-            BSONObj* o2,
-            bool fromMigrate,
-            const std::string& oplogCollectionName,
-            ReplicationCoordinator::Mode replicationMode,
-            bool updateReplOpTime) {
-    NamespaceString nss(ns);
+namespace {
+
+bool shouldLogOp(OperationContext* txn,
+                 const NamespaceString& nss,
+                 ReplicationCoordinator::Mode replicationMode) {
     if (nss.db() == "local") {
-        return;
+        return false;
     }
 
     if (nss.isSystemDotProfile()) {
-        return;
+        return false;
     }
 
     if (replicationMode == ReplicationCoordinator::modeNone) {
-        return;
+        return false;
     }
 
     if (!txn->writesAreReplicated()) {
-        return;
+        return false;
     }
 
     fassert(28626, txn->recoveryUnit());
+    return true;
+}
 
-    Lock::DBLock lk(txn->lockState(), "local", MODE_IX);
-
-    ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
-
+void checkCanAcceptWritesFor(ReplicationCoordinator* replCoord,
+                             const char* ns,
+                             ReplicationCoordinator::Mode replicationMode) {
     if (ns[0] && replicationMode == ReplicationCoordinator::modeReplSet &&
-        !replCoord->canAcceptWritesFor(nss)) {
+        !replCoord->canAcceptWritesFor(NamespaceString(ns))) {
         severe() << "logOp() but can't accept write to collection " << ns;
         fassertFailed(17405);
     }
-    Lock::CollectionLock lk2(txn->lockState(), oplogCollectionName, MODE_IX);
-
+}
 
+/**
+ * Returns the oplog collection, looking it up the first time. The caller must hold the
+ * collection lock on the oplog.
+ */
+Collection* getLocalOplogCollection(OperationContext* txn, const std::string& oplogCollectionName) {
     if (_localOplogCollection == nullptr) {
         OldClientContext ctx(txn, oplogCollectionName);
         _localDB = ctx.db();
@@ -306,33 +334,113 @@ void _logOp(OperationContext* txn,
                     " missing. did you drop it? if so, restart the server",
                 _localOplogCollection);
     }
+    return _localOplogCollection;
+}
+
+/**
+ * Returns true if large insert and update payloads should be written to the oplog in compressed
+ * form. Only replica sets whose config opts in do this, and only while all of their members have
+ * said in heartbeats that they can apply compressed entries, because members that predate
+ * compressed entries cannot apply them.
+ */
+bool shouldCompressOplogPayloads(ReplicationCoordinator* replCoord,
+                                 ReplicationCoordinator::Mode replicationMode) {
+    return replicationMode == ReplicationCoordinator::modeReplSet &&
+        replCoord->isOplogCompressionEnabled();
+}
+
+/**
+ * The "o" and "o2" fields of an oplog entry, in the form they are written to the oplog.
+ */
+struct OplogEntryPayload {
+    BSONObj o;
+    BSONObj o2;
+    bool hasO2 = false;
+    bool compressed = false;
+};
 
-    std::pair<OpTime, long long> slot =
-        getNextOpTime(txn, _localOplogCollection, ns, replCoord, opstr, replicationMode);
+OplogEntryPayload makeOplogEntryPayload(const char* opstr,
+                                        const BSONObj& obj,
+                                        BSONObj* o2,
+                                        bool compress) {
+    OplogEntryPayload payload;
+    payload.o = obj;
+    if (o2) {
+        payload.o2 = *o2;
+        payload.hasO2 = true;
+    }
 
-    /* we jump through a bunch of hoops here to avoid copying the obj buffer twice --
-       instead we do a single copy to the destination position in the memory mapped file.
-    */
+    // Deletes, commands and no-ops are small, and commands must stay readable by rollback.
+    if (compress && (*opstr == 'i' || *opstr == 'u')) {
+        if (compressOplogPayload(&payload.o)) {
+            payload.compressed = true;
+        }
+        if (payload.hasO2 && compressOplogPayload(&payload.o2)) {
+            payload.compressed = true;
+        }
+    }
+    return payload;
+}
 
+/* we jump through a bunch of hoops here to avoid copying the obj buffer twice --
+   instead we do a single copy to the destination position in the memory mapped file.
+*/
+OplogDocWriter makeOplogEntryWriter(const std::pair<OpTime, long long>& slot,
+                                    const char* opstr,
+                                    const char* ns,
+                                    const OplogEntryPayload& payload,
+                                    bool fromMigrate) {
     BSONObjBuilder b(256);
 
     slot.first.append(&b);
     b.append("h", slot.second);
-    b.append("v", OPLOG_VERSION);
+    b.append("v", payload.compressed ? OPLOG_VERSION_COMPRESSED : OPLOG_VERSION);
     b.append("op", opstr);
     b.append("ns", ns);
     if (fromMigrate) {
         b.appendBool("fromMigrate", true);
     }
 
-    if (o2) {
-        b.append("o2", *o2);
+    if (payload.hasO2) {
+        b.append("o2", payload.o2);
+    }
+
+    return OplogDocWriter(b.obj(), payload.o);
+}
+
+}  // namespace
+
+void _logOp(OperationContext* txn,
+            const char* opstr,
+            const char* ns,
+            const BSONObj& obj,
+            BSONObj* o2,
+            bool fromMigrate,
+            const std::string& oplogCollectionName,
+            ReplicationCoordinator::Mode replicationMode,
+            bool updateReplOpTime) {
+    if (!shouldLogOp(txn, NamespaceString(ns), replicationMode)) {
+        return;
     }
-    BSONObj partial = b.done();
 
-    OplogDocWriter writer(partial, obj);
+    Lock::DBLock lk(txn->lockState(), "local", MODE_IX);
+
+    ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
+    checkCanAcceptWritesFor(replCoord, ns, replicationMode);
+
+    // Compress before reserving the optime, so that the entry is not kept hidden while we do.
+    const OplogEntryPayload payload = makeOplogEntryPayload(
+        opstr, obj, o2, shouldCompressOplogPayloads(replCoord, replicationMode));
+
+    Lock::CollectionLock lk2(txn->lockState(), oplogCollectionName, MODE_IX);
+    Collection* oplog = getLocalOplogCollection(txn, oplogCollectionName);
+
+    std::pair<OpTime, long long> slot;
+    getNextOpTimes(txn, oplog, replCoord, replicationMode, 1, &slot);
+
+    OplogDocWriter writer = makeOplogEntryWriter(slot, opstr, ns, payload, fromMigrate);
     // This transaction might roll back.
-    checkOplogInsert(_localOplogCollection->insertDocument(txn, &writer, false));
+    checkOplogInsert(oplog->insertDocument(txn, &writer, false));
 
     // Set replCoord last optime only after we're sure the WUOW didn't abort and roll back.
     if (updateReplOpTime) {
@@ -342,6 +450,57 @@ void _logOp(OperationContext* txn,
     ReplClientInfo::forClient(txn->getClient()).setLastOp(slot.first);
 }
 
+void _logOps(OperationContext* txn,
+             const char* opstr,
+             const NamespaceString& nss,
+             std::vector<BSONObj>::const_iterator begin,
+             std::vector<BSONObj>::const_iterator end,
+             bool fromMigrate) {
+    ReplicationCoordinator* replCoord = ReplicationCoordinator::get(txn);
+    const ReplicationCoordinator::Mode replicationMode = replCoord->getReplicationMode();
+    const size_t count = end - begin;
+    if (count == 0 || !shouldLogOp(txn, nss, replicationMode)) {
+        return;
+    }
+
+    const char* ns = nss.ns().c_str();
+
+    Lock::DBLock lk(txn->lockState(), "local", MODE_IX);
+    checkCanAcceptWritesFor(replCoord, ns, replicationMode);
+
+    // Compress before reserving the optimes, so that the entries are not kept hidden while we do.
+    const bool compress = shouldCompressOplogPayloads(replCoord, replicationMode);
+    std::vector<OplogEntryPayload> payloads;
+    payloads.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        payloads.push_back(makeOplogEntryPayload(opstr, begin[i], nullptr, compress));
+    }
+
+    Lock::CollectionLock lk2(txn->lockState(), _oplogCollectionName, MODE_IX);
+    Collection* oplog = getLocalOplogCollection(txn, _oplogCollectionName);
+
+    std::vector<std::pair<OpTime, long long>> slots(count);
+    getNextOpTimes(txn, oplog, replCoord, replicationMode, count, slots.data());
+
+    std::vector<OplogDocWriter> writers;
+    std::vector<const DocWriter*> docs;
+    writers.reserve(count);
+    docs.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        writers.push_back(makeOplogEntryWriter(slots[i], opstr, ns, payloads[i], fromMigrate));
+        docs.push_back(&writers.back());
+    }
+
+    // This transaction might roll back.
+    checkOplogInsert(oplog->insertDocumentsForOplog(txn, docs.data(), count));
+
+    // Set replCoord last optime only after we're sure the WUOW didn't abort and roll back.
+    const OpTime& lastOpTime = slots.back().first;
+    txn->recoveryUnit()->registerChange(new UpdateReplOpTimeChange(lastOpTime, replCoord));
+
+    ReplClientInfo::forClient(txn->getClient()).setLastOp(lastOpTime);
+}
+
 void _logOp(OperationContext* txn,
             const char* opstr,
             const char* ns,
@@ -590,6 +749,61 @@ std::map<std::string, ApplyOpMetadata> opsMap = {
 
 }  // namespace
 
+bool compressOplogPayload(BSONObj* obj) {
+    if (obj->objsize() < oplogCompressionMinBytes) {
+        return false;
+    }
+
+    std::string compressed;
+    snappy::Compress(obj->objdata(), obj->objsize(), &compressed);
+
+    BSONObjBuilder b(compressed.size() + 64);
+    BSONElement idElem = obj->getField("_id");
+    if (!idElem.eoo()) {
+        b.append(idElem);
+    }
+    b.appendBinData(kCompressedPayloadFieldName,
+                    static_cast<int>(compressed.size()),
+                    BinDataGeneral,
+                    compressed.data());
+    BSONObj compressedObj = b.obj();
+    if (compressedObj.objsize() >= obj->objsize()) {
+        return false;
+    }
+
+    compressedPayloadsStats.increment();
+    compressionBytesSavedStats.increment(obj->objsize() - compressedObj.objsize());
+    *obj = compressedObj;
+    return true;
+}
+
+BSONObj uncompressOplogPayload(const BSONObj& op, const BSONObj& payload) {
+    if (op["v"].numberInt() != OPLOG_VERSION_COMPRESSED) {
+        return payload;
+    }
+    BSONElement compressedElem = payload[kCompressedPayloadFieldName];
+    if (compressedElem.type() != BinData) {
+        return payload;
+    }
+
+    int compressedLen;
+    const char* compressed = compressedElem.binData(compressedLen);
+    size_t len;
+    uassert(28791,
+            str::stream() << "corrupt compressed payload in oplog entry: " << op.toString(),
+            snappy::GetUncompressedLength(compressed, compressedLen, &len) &&
+                len >= static_cast<size_t>(BSONObj::kMinBSONLength) &&
+                len <= static_cast<size_t>(BSONObjMaxInternalSize));
+
+    SharedBuffer buf = SharedBuffer::allocate(len);
+    uassert(28792,
+            str::stream() << "corrupt compressed payload in oplog entry: " << op.toString(),
+            snappy::RawUncompress(compressed, compressedLen, buf.get()) &&
+                ConstDataView(buf.get()).read<LittleEndian<int>>() == static_cast<int>(len) &&
+                buf.get()[len - 1] == EOO);
+    return BSONObj(std::move(buf));
+}
+
 // @return failure status if an update should have happened and the document DNE.
 // See replset initial sync code.
 Status applyOperation_inlock(OperationContext* txn,
@@ -611,13 +825,13 @@ Status applyOperation_inlock(OperationContext* txn,
 
     BSONObj o;
     if (fieldO.isABSONObj())
-        o = fieldO.embeddedObject();
+        o = uncompressOplogPayload(op, fieldO.embeddedObject());
 
     const char* ns = fieldNs.valuestrsafe();
 
     BSONObj o2;
     if (fieldO2.isABSONObj())
-        o2 = fieldO2.Obj();
+        o2 = uncompressOplogPayload(op, fieldO2.Obj());
 
     bool valueB = fieldB.booleanSafe();
 
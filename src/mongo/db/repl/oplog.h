@@ -31,6 +31,7 @@
 #include <cstddef>
 #include <deque>
 #include <string>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/base/disallow_copying.h"
@@ -77,6 +78,11 @@ extern std::string masterSlaveOplogName;
 
 extern int OPLOG_VERSION;
 
+// Version of the oplog entries whose "o" or "o2" payloads are compressed. These are only written
+// when the replica set config enables oplog compression and every other member that applies the
+// oplog reports in its heartbeats that it can apply them.
+extern int OPLOG_VERSION_COMPRESSED;
+
 /** Log an operation to the local oplog
  *
  * @param opstr
@@ -109,10 +115,41 @@ void _logOp(OperationContext* txn,
             BSONObj* o2,
             bool fromMigrate);
 
+/**
+ * Logs one operation of type 'opstr' on 'nss' for each of the objects in [begin, end). The
+ * optimes for all of the entries are reserved at once and the entries are written to the oplog
+ * with a single insert into its record store. Sets replCoord last optime to that of the last
+ * entry.
+ */
+void _logOps(OperationContext* txn,
+             const char* opstr,
+             const NamespaceString& nss,
+             std::vector<BSONObj>::const_iterator begin,
+             std::vector<BSONObj>::const_iterator end,
+             bool fromMigrate);
+
 // Flush out the cached pointers to the local database and oplog.
 // Used by the closeDatabase command to ensure we don't cache closed things.
 void oplogCheckCloseDatabase(OperationContext* txn, Database* db);
 
+/**
+ * Replaces the "o" or "o2" payload 'obj' with {_id: <obj._id>, $z: <snappy compressed obj>} if
+ * it is at least oplogCompressionMinBytes long and compresses well enough to be worth it. The
+ * _id stays uncompressed so that rollback and the applier's choice of writer thread can read it
+ * without uncompressing the entry. Returns true if 'obj' was replaced, in which case the entry
+ * must be written with version OPLOG_VERSION_COMPRESSED.
+ *
+ * Once such an entry is in the oplog, any member that syncs it without support for that version,
+ * such as a downgraded or older member, stops with fassert 18820.
+ */
+bool compressOplogPayload(BSONObj* obj);
+
+/**
+ * Returns the "o" or "o2" field 'payload' of the oplog entry 'op' in its original form,
+ * uncompressing it if it was written compressed. Throws if a compressed payload is corrupt.
+ */
+BSONObj uncompressOplogPayload(const BSONObj& op, const BSONObj& payload);
+
 /**
  * Take a non-command op and apply it locally
  * Used for applying from an oplog
@@ -0,0 +1,159 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_batch_ring.h"
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace repl {
+
+OplogBatchRing::OplogBatchRing(size_t maxSizeBytes, size_t maxBatches)
+    : _maxSizeBytes(maxSizeBytes), _slots(maxBatches) {
+    invariant(maxBatches > 0);
+}
+
+bool OplogBatchRing::_hasRoomFor_inlock(size_t bytes) const {
+    if (_size.batches == 0) {
+        return true;
+    }
+    return _size.batches < _slots.size() && _size.bytes + bytes <= _maxSizeBytes;
+}
+
+Milliseconds OplogBatchRing::push(Batch batch) {
+    if (batch.empty()) {
+        return Milliseconds(0);
+    }
+
+    size_t bytes = 0;
+    for (const auto& op : batch) {
+        bytes += static_cast<size_t>(op.objsize());
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    Milliseconds waited(0);
+    if (!_hasRoomFor_inlock(bytes)) {
+        Timer timer;
+        _producerWaiting = true;
+        _notFull.wait(lk, [this, bytes] { return _hasRoomFor_inlock(bytes); });
+        _producerWaiting = false;
+        waited = Milliseconds(timer.millis());
+    }
+
+    _size.ops += batch.size();
+    _size.bytes += bytes;
+    _slots[(_head + _size.batches) % _slots.size()] = std::move(batch);
+    _size.batches++;
+
+    if (_consumerWaiting) {
+        _notEmpty.notify_one();
+    }
+    return waited;
+}
+
+bool OplogBatchRing::peek(BSONObj* op) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_size.batches == 0) {
+        return false;
+    }
+    *op = _slots[_head][_headPos];
+    return true;
+}
+
+bool OplogBatchRing::consume() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(_size.batches > 0);
+
+    Batch& batch = _slots[_head];
+    _size.ops--;
+    _size.bytes -= static_cast<size_t>(batch[_headPos].objsize());
+    if (++_headPos < batch.size()) {
+        if (_producerWaiting && _size.bytes <= _maxSizeBytes / 2) {
+            _notFull.notify_one();
+        }
+        return false;
+    }
+
+    // Releasing the BSONObjs lets go of the reply buffer they were fetched in.
+    Batch().swap(batch);
+    _head = (_head + 1) % _slots.size();
+    _headPos = 0;
+    _size.batches--;
+
+    if (_producerWaiting) {
+        _notFull.notify_one();
+    }
+    return true;
+}
+
+bool OplogBatchRing::waitForData(Milliseconds timeout, bool* waited) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (waited) {
+        *waited = _size.batches == 0;
+    }
+    if (_size.batches > 0) {
+        return true;
+    }
+
+    _consumerWaiting = true;
+    const bool hasData =
+        _notEmpty.wait_for(lk, timeout, [this] { return _size.batches > 0; });
+    _consumerWaiting = false;
+    return hasData;
+}
+
+bool OplogBatchRing::empty() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _size.batches == 0;
+}
+
+OplogBatchRing::Size OplogBatchRing::size() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _size;
+}
+
+OplogBatchRing::Size OplogBatchRing::clear() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    const Size dropped = _size;
+    for (auto& batch : _slots) {
+        Batch().swap(batch);
+    }
+    _head = 0;
+    _headPos = 0;
+    _size = Size();
+
+    _notFull.notify_all();
+    return dropped;
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Bounded queue of oplog entries between the BackgroundSync fetcher and the applier. The
+ * fetcher pushes each getMore reply as one batch. The applier peeks at and consumes one entry at
+ * a time. Entries are not copied on the way through: a batch holds BSONObjs which share the
+ * buffer of the reply they arrived in.
+ *
+ * Batches are kept in a fixed number of slots. push() waits while every slot is in use, or while
+ * the batch would take the buffered entries over the byte limit. A batch is always accepted into
+ * an empty ring, so that a batch bigger than the limit cannot block the producer forever.
+ *
+ * Meant for one producer thread and one consumer thread. The producer takes the mutex once per
+ * batch, and the two threads only signal each other when the other one is actually waiting.
+ * clear() may be called from any thread.
+ */
+class OplogBatchRing {
+    MONGO_DISALLOW_COPYING(OplogBatchRing);
+
+public:
+    using Batch = std::vector<BSONObj>;
+
+    struct Size {
+        size_t batches = 0;
+        size_t ops = 0;
+        size_t bytes = 0;
+    };
+
+    OplogBatchRing(size_t maxSizeBytes, size_t maxBatches);
+
+    /**
+     * Appends the entries in 'batch' after waiting for room for them. Returns how long it
+     * waited. Empty batches are ignored.
+     */
+    Milliseconds push(Batch batch);
+
+    /**
+     * Copies the oldest entry into 'op' without removing it. Returns false if the ring is empty.
+     */
+    bool peek(BSONObj* op) const;
+
+    /**
+     * Removes the oldest entry, which must exist. Returns true if that emptied its batch.
+     */
+    bool consume();
+
+    /**
+     * Waits up to 'timeout' for the ring to hold an entry. Returns true if it does. If 'waited'
+     * is not null, sets it to whether the ring was empty and the caller had to block.
+     */
+    bool waitForData(Milliseconds timeout, bool* waited = nullptr);
+
+    bool empty() const;
+
+    Size size() const;
+
+    /**
+     * Drops all entries and wakes up a producer waiting in push(). Returns what was dropped.
+     */
+    Size clear();
+
+private:
+    bool _hasRoomFor_inlock(size_t bytes) const;
+
+    const size_t _maxSizeBytes;
+
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _notEmpty;
+    stdx::condition_variable _notFull;
+    bool _consumerWaiting = false;
+    bool _producerWaiting = false;
+
+    std::vector<Batch> _slots;
+    size_t _head = 0;     // Slot holding the oldest batch.
+    size_t _headPos = 0;  // Index of the oldest entry within that batch.
+    Size _size;
+};
+
+}  // namespace repl
+}  // namespace mongo
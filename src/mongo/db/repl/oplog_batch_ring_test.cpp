@@ -0,0 +1,147 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_batch_ring.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+
+using namespace mongo;
+using namespace mongo::repl;
+
+OplogBatchRing::Batch makeBatch(int first, int count) {
+    OplogBatchRing::Batch batch;
+    for (int i = first; i < first + count; ++i) {
+        batch.push_back(BSON("_id" << i));
+    }
+    return batch;
+}
+
+TEST(OplogBatchRingTest, PeekAndConsumeInOrderAcrossBatches) {
+    OplogBatchRing ring(1024 * 1024, 4);
+    ASSERT_TRUE(ring.empty());
+    ring.push(makeBatch(0, 3));
+    ring.push(makeBatch(3, 2));
+    ring.push(OplogBatchRing::Batch());
+
+    OplogBatchRing::Size size = ring.size();
+    ASSERT_EQUALS(2U, size.batches);
+    ASSERT_EQUALS(5U, size.ops);
+    ASSERT_EQUALS(5U * static_cast<size_t>(BSON("_id" << 0).objsize()), size.bytes);
+
+    for (int i = 0; i < 5; ++i) {
+        BSONObj op;
+        ASSERT_TRUE(ring.peek(&op));
+        ASSERT_EQUALS(i, op["_id"].numberInt());
+        ASSERT_EQUALS(i == 2 || i == 4, ring.consume());
+    }
+
+    BSONObj op;
+    ASSERT_FALSE(ring.peek(&op));
+    ASSERT_TRUE(ring.empty());
+    ASSERT_EQUALS(0U, ring.size().bytes);
+}
+
+TEST(OplogBatchRingTest, WaitForDataTimesOutWhenEmpty) {
+    OplogBatchRing ring(1024, 4);
+    bool waited = false;
+    ASSERT_FALSE(ring.waitForData(Milliseconds(10), &waited));
+    ASSERT_TRUE(waited);
+    ring.push(makeBatch(0, 1));
+    ASSERT_TRUE(ring.waitForData(Milliseconds(10), &waited));
+    ASSERT_FALSE(waited);
+}
+
+TEST(OplogBatchRingTest, AcceptsOversizedBatchWhenEmpty) {
+    OplogBatchRing ring(1, 4);
+    ASSERT_EQUALS(Milliseconds(0), ring.push(makeBatch(0, 10)));
+    ASSERT_EQUALS(10U, ring.size().ops);
+}
+
+TEST(OplogBatchRingTest, PushWaitsForFreeSlot) {
+    OplogBatchRing ring(1024 * 1024, 1);
+    ring.push(makeBatch(0, 2));
+
+    stdx::thread producer([&ring] { ring.push(makeBatch(2, 1)); });
+
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(ring.waitForData(Seconds(10)));
+        BSONObj op;
+        ASSERT_TRUE(ring.peek(&op));
+        ASSERT_EQUALS(i, op["_id"].numberInt());
+        ring.consume();
+    }
+    producer.join();
+    ASSERT_TRUE(ring.empty());
+}
+
+TEST(OplogBatchRingTest, PushWaitsForBytes) {
+    const size_t opSize = static_cast<size_t>(BSON("_id" << 0).objsize());
+    OplogBatchRing ring(4 * opSize, 16);
+    ring.push(makeBatch(0, 4));
+
+    stdx::thread producer([&ring] { ring.push(makeBatch(4, 2)); });
+
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_TRUE(ring.waitForData(Seconds(10)));
+        BSONObj op;
+        ASSERT_TRUE(ring.peek(&op));
+        ASSERT_EQUALS(i, op["_id"].numberInt());
+        ring.consume();
+        ASSERT_LESS_THAN_OR_EQUALS(ring.size().bytes, 4 * opSize);
+    }
+    producer.join();
+}
+
+TEST(OplogBatchRingTest, ClearDropsEverythingAndWakesProducer) {
+    OplogBatchRing ring(1024 * 1024, 1);
+    ring.push(makeBatch(0, 3));
+
+    stdx::thread producer([&ring] { ring.push(makeBatch(3, 1)); });
+
+    // The producer is either still waiting, or already pushed after an earlier clear().
+    size_t droppedOps = 0;
+    while (droppedOps < 4) {
+        droppedOps += ring.clear().ops;
+        sleepmillis(1);
+    }
+    producer.join();
+
+    ASSERT_EQUALS(4U, droppedOps);
+    ASSERT_TRUE(ring.empty());
+    BSONObj op;
+    ASSERT_FALSE(ring.peek(&op));
+}
+
+}  // namespace
@@ -45,6 +45,7 @@ namespace mongo {
 namespace repl {
 namespace {
 
+const std::string kAppliesCompressedOplogFieldName = "compressedOplog";
 const std::string kConfigFieldName = "config";
 const std::string kConfigVersionFieldName = "v";
 const std::string kElectionTimeFieldName = "electionTime";
@@ -95,6 +96,9 @@ void ReplSetHeartbeatResponse::addToBSON(BSONObjBuilder* builder, bool isProtoco
     if (_stateDisagreement) {
         *builder << kHasStateDisagreementFieldName << _stateDisagreement;
     }
+    if (_appliesCompressedOplog) {
+        *builder << kAppliesCompressedOplogFieldName << _appliesCompressedOplog;
+    }
     if (_stateSet) {
         builder->appendIntOrLL(kMemberStateFieldName, _state.s);
     }
@@ -267,6 +271,9 @@ Status ReplSetHeartbeatResponse::initialize(const BSONObj& doc, long long term)
 
     _stateDisagreement = doc[kHasStateDisagreementFieldName].trueValue();
 
+    // Members which predate compressed oplog entries never send this field.
+    _appliesCompressedOplog = doc[kAppliesCompressedOplogFieldName].trueValue();
+
 
     // Not required for the case of uninitialized members -- they have no config
     const BSONElement configVersionElement = doc[kConfigVersionFieldName];
@@ -86,6 +86,9 @@ public:
     bool isStateDisagreement() const {
         return _stateDisagreement;
     }
+    bool appliesCompressedOplog() const {
+        return _appliesCompressedOplog;
+    }
     const std::string& getReplicaSetName() const {
         return _setName;
     }
@@ -151,6 +154,14 @@ public:
         _stateDisagreement = true;
     }
 
+    /**
+     * Sets _appliesCompressedOplog to true, to tell the sender that this member can apply oplog
+     * entries of version OPLOG_VERSION_COMPRESSED.
+     */
+    void noteAppliesCompressedOplog() {
+        _appliesCompressedOplog = true;
+    }
+
     /**
      * Sets _hasData to true, and _hasDataSet to true to indicate _hasData has been modified
      */
@@ -259,6 +270,7 @@ private:
     bool _mismatch = false;
     bool _isReplSet = false;
     bool _stateDisagreement = false;
+    bool _appliesCompressedOplog = false;
 
     bool _stateSet = false;
     MemberState _state;
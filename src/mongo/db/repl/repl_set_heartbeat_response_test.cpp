@@ -722,6 +722,27 @@ TEST(ReplSetHeartbeatResponse, InitializeBothOpTimeTypesSameResult) {
     ASSERT_EQUALS(hbResponseTimestamp.getOpTime(), hbResponseTimestamp.getOpTime());
 }
 
+TEST(ReplSetHeartbeatResponse, AppliesCompressedOplogRoundTrips) {
+    ReplSetHeartbeatResponse hbResponse;
+    hbResponse.setSetName("rs0");
+    ASSERT_FALSE(hbResponse.toBSON(true).hasField("compressedOplog"));
+
+    hbResponse.noteAppliesCompressedOplog();
+    BSONObj hbResponseObj = hbResponse.toBSON(true);
+    ASSERT_EQUALS(true, hbResponseObj["compressedOplog"].trueValue());
+
+    ReplSetHeartbeatResponse hbResponseRoundTrip;
+    ASSERT_OK(hbResponseRoundTrip.initialize(hbResponseObj, 0));
+    ASSERT_TRUE(hbResponseRoundTrip.appliesCompressedOplog());
+
+    // A response from a member which predates compressed oplog entries lacks the field.
+    ReplSetHeartbeatResponse hbResponseOld;
+    ASSERT_OK(hbResponseOld.initialize(BSON("ok" << 1.0 << "set"
+                                                 << "rs0"),
+                                       0));
+    ASSERT_FALSE(hbResponseOld.appliesCompressedOplog());
+}
+
 TEST(ReplSetHeartbeatResponse, NoConfigStillInitializing) {
     ReplSetHeartbeatResponse hbResp;
     std::string msg = "still initializing";
@@ -72,6 +72,7 @@ const std::string kElectionTimeoutFieldName = "electionTimeoutMillis";
 const std::string kHeartbeatIntervalFieldName = "heartbeatIntervalMillis";
 const std::string kHeartbeatTimeoutFieldName = "heartbeatTimeoutSecs";
 const std::string kChainingAllowedFieldName = "chainingAllowed";
+const std::string kOplogCompressionFieldName = "oplogCompression";
 const std::string kGetLastErrorDefaultsFieldName = "getLastErrorDefaults";
 const std::string kGetLastErrorModesFieldName = "getLastErrorModes";
 
@@ -214,6 +215,15 @@ Status ReplicaSetConfig::_parseSettingsSubdocument(const BSONObj& settings) {
     if (!status.isOK())
         return status;
 
+    //
+    // Parse oplogCompression. Members which cannot apply compressed (version 3) entries fassert
+    // when they sync one, see isOplogCompressionEnabled().
+    //
+    status = bsonExtractBooleanFieldWithDefault(
+        settings, kOplogCompressionFieldName, false, &_oplogCompression);
+    if (!status.isOK())
+        return status;
+
     //
     // Parse getLastErrorDefaults
     //
@@ -607,6 +617,10 @@ BSONObj ReplicaSetConfig::toBSON() const {
 
     BSONObjBuilder settingsBuilder(configBuilder.subobjStart(kSettingsFieldName));
     settingsBuilder.append(kChainingAllowedFieldName, _chainingAllowed);
+    if (_oplogCompression) {
+        // Only include "oplogCompression" field if true
+        settingsBuilder.append(kOplogCompressionFieldName, _oplogCompression);
+    }
     settingsBuilder.appendIntOrLL(kHeartbeatIntervalFieldName,
                                   durationCount<Milliseconds>(_heartbeatInterval));
     settingsBuilder.appendIntOrLL(kHeartbeatTimeoutFieldName,
@@ -219,6 +219,19 @@ public:
         return _chainingAllowed;
     }
 
+    /**
+     * Returns true if members may write large insert and update payloads to the oplog in
+     * compressed form. Even when this is set, the primary writes compressed entries only while
+     * every other member, apart from arbiters, is up and reports in its heartbeats that it can
+     * apply them. Entries which were already written stay compressed: a member which is
+     * downgraded, or an older member which is added, fails with fassert 18820 when it syncs one
+     * of these version 3 entries. Disabling the setting does not help until the last of them has
+     * rolled off the oplog of every member it could sync from.
+     */
+    bool isOplogCompressionEnabled() const {
+        return _oplogCompression;
+    }
+
     /**
      * Returns true if this replica set is for use as a config server replica set.
      */
@@ -302,6 +315,7 @@ private:
     Milliseconds _heartbeatInterval = kDefaultHeartbeatInterval;
     Seconds _heartbeatTimeoutPeriod = Seconds(0);
     bool _chainingAllowed;
+    bool _oplogCompression = false;
     int _majorityVoteCount;
     int _writeMajority;
     int _totalVotingMembers;
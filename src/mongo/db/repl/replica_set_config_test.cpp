@@ -692,6 +692,43 @@ TEST(ReplicaSetConfig, ChainingAllowedField) {
     ASSERT_FALSE(config.isChainingAllowed());
 }
 
+TEST(ReplicaSetConfig, ParseFailsWithNonBoolOplogCompressionField) {
+    ReplicaSetConfig config;
+    Status status = config.initialize(BSON("_id"
+                                           << "rs0"
+                                           << "version" << 1 << "members"
+                                           << BSON_ARRAY(BSON("_id" << 0 << "host"
+                                                                    << "localhost:12345"))
+                                           << "settings" << BSON("oplogCompression"
+                                                                 << "yes")));
+    ASSERT_EQUALS(ErrorCodes::TypeMismatch, status);
+}
+
+TEST(ReplicaSetConfig, OplogCompressionField) {
+    ReplicaSetConfig config;
+    ASSERT_OK(config.initialize(BSON("_id"
+                                     << "rs0"
+                                     << "version" << 1 << "members"
+                                     << BSON_ARRAY(BSON("_id" << 0 << "host"
+                                                              << "localhost:12345")))));
+    ASSERT_OK(config.validate());
+    ASSERT_FALSE(config.isOplogCompressionEnabled());
+    ASSERT_FALSE(config.toBSON()["settings"].Obj().hasField("oplogCompression"));
+
+    ASSERT_OK(config.initialize(BSON("_id"
+                                     << "rs0"
+                                     << "version" << 1 << "members"
+                                     << BSON_ARRAY(BSON("_id" << 0 << "host"
+                                                              << "localhost:12345")) << "settings"
+                                     << BSON("oplogCompression" << true))));
+    ASSERT_OK(config.validate());
+    ASSERT_TRUE(config.isOplogCompressionEnabled());
+
+    ReplicaSetConfig roundTripped;
+    ASSERT_OK(roundTripped.initialize(config.toBSON()));
+    ASSERT_TRUE(roundTripped.isOplogCompressionEnabled());
+}
+
 TEST(ReplicaSetConfig, ConfigServerField) {
     ReplicaSetConfig config;
     ASSERT_OK(config.initialize(BSON("_id"
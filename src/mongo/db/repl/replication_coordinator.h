@@ -626,6 +626,13 @@ public:
      */
     virtual bool isV1ElectionProtocol() = 0;
 
+    /**
+     * Returns true if large oplog entry payloads should be written in compressed form: the current
+     * replica set configuration allows it and every other member that applies the oplog reported
+     * in its last heartbeat that it can apply compressed entries.
+     */
+    virtual bool isOplogCompressionEnabled() = 0;
+
     /**
      * Writes into 'output' all the information needed to generate a summary of the current
      * replication state for use by the web interface.
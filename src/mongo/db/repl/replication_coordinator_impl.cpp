@@ -2297,6 +2297,8 @@ ReplicationCoordinatorImpl::_setCurrentRSConfig_inlock(const ReplicaSetConfig& n
     // Must get this before changing our config.
     OpTime myOptime = _getMyLastOptime_inlock();
     _topCoord->updateConfig(newConfig, myIndex, _replExecutor.now(), myOptime);
+    _oplogCompressionEnabled.store(newConfig.isOplogCompressionEnabled() &&
+                                   _topCoord->allMembersApplyCompressedOplog());
     _rsConfig = newConfig;
     log() << "New replica set config in use: " << _rsConfig.toBSON() << rsLog;
     _selfIndex = myIndex;
@@ -2800,6 +2802,10 @@ bool ReplicationCoordinatorImpl::isV1ElectionProtocol() {
     return _isV1ElectionProtocol_inlock();
 }
 
+bool ReplicationCoordinatorImpl::isOplogCompressionEnabled() {
+    return _oplogCompressionEnabled.load();
+}
+
 Status ReplicationCoordinatorImpl::processHeartbeatV1(const ReplSetHeartbeatArgsV1& args,
                                                       ReplSetHeartbeatResponse* response) {
     {
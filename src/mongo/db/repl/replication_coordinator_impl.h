@@ -268,6 +268,8 @@ public:
 
     virtual bool isV1ElectionProtocol() override;
 
+    virtual bool isOplogCompressionEnabled() override;
+
     virtual void summarizeAsHtml(ReplSetHtmlSummary* s) override;
 
     virtual void dropAllSnapshots() override;
@@ -1203,6 +1205,11 @@ private:
     // The cached current term. It's in sync with the term in topology coordinator.
     long long _cachedTerm = OpTime::kProtocolVersionV0Term;  // (M)
 
+    // Whether the current config enables oplog compression and every other member could apply
+    // compressed oplog entries as of the last heartbeat response or config change. It's in sync
+    // with the config and the topology coordinator, and is read without _mutex on every write.
+    AtomicWord<bool> _oplogCompressionEnabled{false};  // (S)
+
     // Callback Handle used to cancel a scheduled LivenessTimeout callback.
     ReplicationExecutor::CallbackHandle _handleLivenessTimeoutCbh;  // (M)
 
@@ -155,6 +155,12 @@ void ReplicationCoordinatorImpl::_handleHeartbeatResponse(
     HeartbeatResponseAction action = _topCoord->processHeartbeatResponse(
         now, networkTime, target, hbStatusResponse, lastApplied);
 
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _oplogCompressionEnabled.store(_rsConfig.isOplogCompressionEnabled() &&
+                                       _topCoord->allMembersApplyCompressedOplog());
+    }
+
     if (action.getAction() == HeartbeatResponseAction::NoAction && hbStatusResponse.isOK() &&
         hbStatusResponse.getValue().hasOpTime() && targetIndex >= 0 &&
         hbStatusResponse.getValue().hasState() &&
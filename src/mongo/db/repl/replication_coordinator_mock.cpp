@@ -350,6 +350,10 @@ bool ReplicationCoordinatorMock::isV1ElectionProtocol() {
     return true;
 }
 
+bool ReplicationCoordinatorMock::isOplogCompressionEnabled() {
+    return false;
+}
+
 void ReplicationCoordinatorMock::summarizeAsHtml(ReplSetHtmlSummary* output) {}
 
 long long ReplicationCoordinatorMock::getTerm() {
@@ -202,6 +202,8 @@ public:
 
     virtual bool isV1ElectionProtocol();
 
+    virtual bool isOplogCompressionEnabled();
+
     virtual void summarizeAsHtml(ReplSetHtmlSummary* output);
 
     virtual long long getTerm();
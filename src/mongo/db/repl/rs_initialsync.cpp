@@ -54,10 +54,12 @@
 #include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace repl {
@@ -69,6 +71,10 @@ using std::string;
 // Failpoint which fails initial sync and leaves on oplog entry in the buffer.
 MONGO_FP_DECLARE(failInitSyncWithBufferedEntriesLeft);
 
+// Number of collections, or _id ranges of large collections, cloned at once and of collections
+// indexed at once during initial sync. 1 clones one collection at a time.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncCloneThreads, int, 1);
+
 /**
  * Truncates the oplog (removes any documents) and resets internal variables that were
  * originally initialized or affected by using values from the oplog at startup time.  These
@@ -188,6 +194,7 @@ bool _initialSyncClone(OperationContext* txn,
         options.mayBeInterrupted = true;
         options.syncData = dataPass;
         options.syncIndexes = !dataPass;
+        options.parallelism = std::max(1, initialSyncCloneThreads);
 
         // Make database stable
         ScopedTransaction transaction(txn, MODE_IX);
@@ -362,10 +369,12 @@ Status _initialSync() {
         }
     }
 
+    Timer phaseTimer;
     Cloner cloner;
     if (!_initialSyncClone(&txn, cloner, r.conn()->getServerAddress(), dbs, true)) {
         return Status(ErrorCodes::InitialSyncFailure, "initial sync failed data cloning");
     }
+    log() << "initial sync data copy took " << phaseTimer.seconds() << " seconds";
 
     log() << "initial sync data copy, starting syncup";
 
@@ -377,28 +386,34 @@ Status _initialSync() {
 
     std::string msg = "oplog sync 1 of 3";
     log() << msg;
+    phaseTimer.reset();
     if (!_initialSyncApplyOplog(&txn, init, &r)) {
         return Status(ErrorCodes::InitialSyncFailure,
                       str::stream() << "initial sync failed: " << msg);
     }
+    log() << "initial sync " << msg << " took " << phaseTimer.seconds() << " seconds";
 
     // Now we sync to the latest op on the sync target _again_, as we may have recloned ops
     // that were "from the future" compared with minValid. During this second application,
     // nothing should need to be recloned.
     msg = "oplog sync 2 of 3";
     log() << msg;
+    phaseTimer.reset();
     if (!_initialSyncApplyOplog(&txn, init, &r)) {
         return Status(ErrorCodes::InitialSyncFailure,
                       str::stream() << "initial sync failed: " << msg);
     }
+    log() << "initial sync " << msg << " took " << phaseTimer.seconds() << " seconds";
     // data should now be consistent
 
     msg = "initial sync building indexes";
     log() << msg;
+    phaseTimer.reset();
     if (!_initialSyncClone(&txn, cloner, r.conn()->getServerAddress(), dbs, false)) {
         return Status(ErrorCodes::InitialSyncFailure,
                       str::stream() << "initial sync failed: " << msg);
     }
+    log() << msg << " took " << phaseTimer.seconds() << " seconds";
 
     // WARNING: If the 3rd oplog sync step is removed we must reset minValid
     // to the last entry on the source server so that we don't come
@@ -408,10 +423,12 @@ Status _initialSync() {
     log() << msg;
 
     SyncTail tail(bgsync, multiSyncApply);
+    phaseTimer.reset();
     if (!_initialSyncApplyOplog(&txn, tail, &r)) {
         return Status(ErrorCodes::InitialSyncFailure,
                       str::stream() << "initial sync failed: " << msg);
     }
+    log() << "initial sync " << msg << " took " << phaseTimer.seconds() << " seconds";
 
     // ---------
 
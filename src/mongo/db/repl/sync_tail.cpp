@@ -34,6 +34,7 @@
 #include "mongo/db/repl/sync_tail.h"
 
 #include <boost/functional/hash.hpp>
+#include <map>
 #include <memory>
 #include "third_party/murmurhash3/MurmurHash3.h"
 
@@ -111,6 +112,15 @@ MONGO_FP_DECLARE(rsSyncApplyStop);
 static TimerStats applyBatchStats;
 static ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches",
                                                                    &applyBatchStats);
+// Number and time of waits for a batch's prefetch to finish before applying it (mmapv1 only)
+static TimerStats prefetchBatchStats;
+static ServerStatusMetricField<TimerStats> displayPrefetchBatches("repl.preload.batches",
+                                                                  &prefetchBatchStats);
+
+// Once this many ops of a batch have been gathered, their prefetch is started so that it runs
+// while the rest of the batch is being gathered.
+const size_t kPrefetchChunkOps = 256;
+
 void initializePrefetchThread() {
     if (!ClientBasic::getCurrent()) {
         Client::initThreadIfNotAlready();
@@ -266,37 +276,53 @@ Status SyncTail::syncApply(OperationContext* txn, const BSONObj& op, bool conver
 
 namespace {
 
-// The pool threads call this to prefetch each op
-void prefetchOp(const BSONObj& op) {
+// Only mmapv1 prefetches replicated ops. It reads pages in from disk on the applier's behalf.
+// Other engines would only gain from a prefetch that overlaps with applying the previous batch,
+// which the applier cannot do yet, since it gathers batch N+1 only after batch N is written.
+bool shouldPrefetchReplicatedOps() {
+    return getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1();
+}
+
+// The pool threads call this to prefetch the ops of one collection
+void prefetchCollectionOps(const std::string& ns, const std::vector<BSONObj>& ops) {
     initializePrefetchThread();
 
-    const char* ns = op.getStringField("ns");
-    if (ns && (ns[0] != '\0')) {
-        try {
-            // one possible tweak here would be to stay in the read lock for this database
-            // for multiple prefetches if they are for the same database.
-            OperationContextImpl txn;
-            AutoGetCollectionForRead ctx(&txn, ns);
-            Database* db = ctx.getDb();
-            if (db) {
-                prefetchPagesForReplicatedOp(&txn, db, op);
-            }
-        } catch (const DBException& e) {
-            LOG(2) << "ignoring exception in prefetchOp(): " << e.what() << endl;
-        } catch (const std::exception& e) {
-            log() << "Unhandled std::exception in prefetchOp(): " << e.what() << endl;
-            fassertFailed(16397);
+    try {
+        OperationContextImpl txn;
+        AutoGetCollectionForRead ctx(&txn, ns);
+        Database* db = ctx.getDb();
+        if (db) {
+            prefetchPagesForReplicatedOps(&txn, db, ns, ops);
         }
+    } catch (const DBException& e) {
+        LOG(2) << "ignoring exception in prefetchCollectionOps(): " << e.what() << endl;
+    } catch (const std::exception& e) {
+        log() << "Unhandled std::exception in prefetchCollectionOps(): " << e.what() << endl;
+        fassertFailed(16397);
     }
 }
 
-// Doles out all the work to the reader pool threads and waits for them to complete
-void prefetchOps(const std::deque<BSONObj>& ops, OldThreadPool* prefetcherPool) {
+// Groups the CRUD ops in [begin, end) by collection and doles out one task per collection to
+// the reader pool threads. Does not wait for them to complete.
+void scheduleOpsPrefetch(std::deque<BSONObj>::const_iterator begin,
+                         std::deque<BSONObj>::const_iterator end,
+                         OldThreadPool* prefetcherPool) {
     invariant(prefetcherPool);
-    for (std::deque<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
-        prefetcherPool->schedule(&prefetchOp, *it);
+    if (BackgroundSync::get()->getIndexPrefetchConfig() == BackgroundSync::PREFETCH_NONE) {
+        return;
+    }
+
+    std::map<std::string, std::vector<BSONObj>> opsByNs;
+    for (auto it = begin; it != end; ++it) {
+        const char* ns = it->getStringField("ns");
+        if (*ns != '\0' && isCrudOpType(it->getStringField("op"))) {
+            opsByNs[ns].push_back(*it);
+        }
+    }
+    for (auto& nsAndOps : opsByNs) {
+        prefetcherPool->schedule(
+            &prefetchCollectionOps, nsAndOps.first, std::move(nsAndOps.second));
     }
-    prefetcherPool->join();
 }
 
 // Doles out all the work to the writer pool threads and waits for them to complete
@@ -364,9 +390,14 @@ OpTime SyncTail::multiApply(OperationContext* txn,
     invariant(func);
     invariant(sync);
 
-    if (getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1()) {
-        // Use a ThreadPool to prefetch all the operations in a batch.
-        prefetchOps(ops.getDeque(), prefetcherPool);
+    if (shouldPrefetchReplicatedOps()) {
+        // Use a ThreadPool to prefetch the rest of the operations in the batch, and wait for
+        // those scheduled while it was being gathered.
+        TimerHolder timer(&prefetchBatchStats);
+        const std::deque<BSONObj>& deque = ops.getDeque();
+        scheduleOpsPrefetch(
+            deque.begin() + ops.getNumPrefetchScheduled(), deque.end(), prefetcherPool);
+        prefetcherPool->join();
     }
 
     std::vector<std::vector<BSONObj>> writerVectors(replWriterThreadCount);
@@ -664,9 +695,10 @@ bool SyncTail::tryPopAndWaitForMore(OperationContext* txn,
     else
         curVersion = elemVersion.Int();
 
-    if (curVersion != OPLOG_VERSION) {
-        severe() << "expected oplog version " << OPLOG_VERSION << " but found version "
-                 << curVersion << " in oplog entry: " << op;
+    if (curVersion != OPLOG_VERSION && curVersion != OPLOG_VERSION_COMPRESSED) {
+        severe() << "expected oplog version " << OPLOG_VERSION << " or "
+                 << OPLOG_VERSION_COMPRESSED << " but found version " << curVersion
+                 << " in oplog entry: " << op;
         fassertFailedNoTrace(18820);
     }
 
@@ -674,6 +706,15 @@ bool SyncTail::tryPopAndWaitForMore(OperationContext* txn,
     ops->push_back(op);
     _networkQueue->consume();
 
+    // Start prefetching the ops gathered so far, while the rest of the batch is gathered.
+    const std::deque<BSONObj>& deque = ops->getDeque();
+    if (deque.size() - ops->getNumPrefetchScheduled() >= kPrefetchChunkOps &&
+        shouldPrefetchReplicatedOps()) {
+        scheduleOpsPrefetch(
+            deque.begin() + ops->getNumPrefetchScheduled(), deque.end(), &_prefetcherPool);
+        ops->setNumPrefetchScheduled(deque.size());
+    }
+
     // Go back for more ops
     return false;
 }
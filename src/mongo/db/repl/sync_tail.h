@@ -102,7 +102,7 @@ public:
 
     class OpQueue {
     public:
-        OpQueue() : _size(0) {}
+        OpQueue() : _size(0), _numPrefetchScheduled(0) {}
         size_t getSize() const {
             return _size;
         }
@@ -122,9 +122,19 @@ public:
             return _deque.back();
         }
 
+        // Number of ops at the front of the queue already handed to the prefetcher pool.
+        size_t getNumPrefetchScheduled() const {
+            return _numPrefetchScheduled;
+        }
+        void setNumPrefetchScheduled(size_t numOps) {
+            invariant(numOps <= _deque.size());
+            _numPrefetchScheduled = numOps;
+        }
+
     private:
         std::deque<BSONObj> _deque;
         size_t _size;
+        size_t _numPrefetchScheduled;
     };
 
     // returns true if we should continue waiting for BSONObjs, false if we should
@@ -166,6 +176,8 @@ protected:
 
     // Prefetch and write a deque of operations, using the supplied function.
     // Initial Sync and Sync Tail each use a different function.
+    // Only mmapv1 prefetches. Ops whose prefetch was already scheduled while the batch was being
+    // gathered are not prefetched again; multiApply waits for those to finish before applying.
     // Returns the last OpTime applied.
     static OpTime multiApply(OperationContext* txn,
                              const OpQueue& ops,
@@ -95,6 +95,12 @@ public:
      */
     virtual std::vector<HostAndPort> getMaybeUpHostAndPorts() const = 0;
 
+    /**
+     * Returns true if every other member of the set, apart from arbiters, is up and reported in
+     * its last heartbeat that it can apply compressed oplog entries.
+     */
+    virtual bool allMembersApplyCompressedOplog() const = 0;
+
     /**
      * Gets the earliest time the current node will stand for election.
      */
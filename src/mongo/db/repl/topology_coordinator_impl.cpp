@@ -673,6 +673,7 @@ Status TopologyCoordinatorImpl::prepareHeartbeatResponse(Date_t now,
 
     // This is a replica set
     response->noteReplSet();
+    response->noteAppliesCompressedOplog();
 
     response->setSetName(ourSetName);
     response->setState(myState.s);
@@ -755,6 +756,7 @@ Status TopologyCoordinatorImpl::prepareHeartbeatResponseV1(Date_t now,
     }
 
     response->setSetName(ourSetName);
+    response->noteAppliesCompressedOplog();
 
     response->setState(myState.s);
 
@@ -1946,6 +1948,21 @@ std::vector<HostAndPort> TopologyCoordinatorImpl::getMaybeUpHostAndPorts() const
     return upHosts;
 }
 
+bool TopologyCoordinatorImpl::allMembersApplyCompressedOplog() const {
+    for (std::vector<MemberHeartbeatData>::const_iterator it = _hbdata.begin(); it != _hbdata.end();
+         ++it) {
+        const int itIndex = indexOfIterator(_hbdata, it);
+        if (itIndex == _selfIndex || _rsConfig.getMemberAt(itIndex).isArbiter()) {
+            continue;
+        }
+        // A member which is down may come back running a version which cannot apply them.
+        if (!it->up() || !it->appliesCompressedOplog()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool TopologyCoordinatorImpl::voteForMyself(Date_t now) {
     if (_role != Role::candidate) {
         return false;
@@ -150,6 +150,7 @@ public:
     virtual MemberState getMemberState() const;
     virtual HostAndPort getSyncSourceAddress() const;
     virtual std::vector<HostAndPort> getMaybeUpHostAndPorts() const;
+    virtual bool allMembersApplyCompressedOplog() const;
     virtual int getMaintenanceCount() const;
     virtual long long getTerm() const;
     virtual bool updateTerm(long long term);
@@ -809,6 +809,51 @@ TEST_F(TopoCoordTest, ReceiveHeartbeatWhileAbsentFromConfig) {
                                          Milliseconds(300)).getAction());
 }
 
+TEST_F(TopoCoordTest, AllMembersApplyCompressedOplogOnlyWhenEveryDataBearingMemberSaysSo) {
+    updateConfig(BSON("_id"
+                      << "rs0"
+                      << "version" << 1 << "members"
+                      << BSON_ARRAY(BSON("_id" << 10 << "host"
+                                               << "hself")
+                                    << BSON("_id" << 20 << "host"
+                                                  << "h2") << BSON("_id" << 30 << "host"
+                                                                         << "h3"
+                                                                         << "arbiterOnly" << true))
+                      << "settings" << BSON("protocolVersion" << 1)),
+                 0);
+    setSelfMemberState(MemberState::RS_SECONDARY);
+
+    // Nothing has been heard from h2 yet.
+    ASSERT_FALSE(getTopoCoord().allMembersApplyCompressedOplog());
+
+    // h2 answers without saying it can apply compressed entries, as older versions do.
+    heartbeatFromMember(
+        HostAndPort("h2"), "rs0", MemberState::RS_SECONDARY, OpTime(Timestamp(1, 0), 0));
+    ASSERT_FALSE(getTopoCoord().allMembersApplyCompressedOplog());
+
+    // Our own heartbeat responses say we can, so use one as h2's. The arbiter never applies
+    // the oplog, so it does not matter what it says.
+    ReplSetHeartbeatArgsV1 args;
+    args.setSetName("rs0");
+    args.setConfigVersion(1);
+    args.setSenderId(20);
+    ReplSetHeartbeatResponse hb;
+    ASSERT_OK(getTopoCoord().prepareHeartbeatResponseV1(
+        now()++, args, "rs0", OpTime(Timestamp(1, 0), 0), &hb));
+    ASSERT_TRUE(hb.appliesCompressedOplog());
+    getTopoCoord().prepareHeartbeatRequestV1(now(), "rs0", HostAndPort("h2"));
+    getTopoCoord().processHeartbeatResponse(now()++,
+                                            Milliseconds(1),
+                                            HostAndPort("h2"),
+                                            StatusWith<ReplSetHeartbeatResponse>(hb),
+                                            OpTime(Timestamp(1, 0), 0));
+    ASSERT_TRUE(getTopoCoord().allMembersApplyCompressedOplog());
+
+    // h2 may come back up running a version which cannot apply them.
+    receiveDownHeartbeat(HostAndPort("h2"), "rs0", OpTime(Timestamp(1, 0), 0));
+    ASSERT_FALSE(getTopoCoord().allMembersApplyCompressedOplog());
+}
+
 TEST_F(TopoCoordTest, PrepareSyncFromResponse) {
     OpTime staleOpTime(Timestamp(1, 1), 0);
     OpTime ourOpTime(Timestamp(staleOpTime.getSecs() + 11, 1), 0);
@@ -57,6 +57,8 @@ struct ServerGlobalParams {
           unixSocketPermissions(DEFAULT_UNIX_PERMS),
           logAppend(false),
           logRenameOnRotate(true),
+          logAsync(false),
+          logAsyncDropWhenFull(false),
           logWithSyslog(false),
           isHttpInterfaceEnabled(false) {
         started = time(0);
@@ -107,11 +109,13 @@ struct ServerGlobalParams {
     std::string keyFile;  // Path to keyfile, or empty if none.
     std::string pidFile;  // Path to pid file, or empty if none.
 
-    std::string logpath;     // Path to log file, if logging to a file; otherwise, empty.
-    bool logAppend;          // True if logging to a file in append mode.
-    bool logRenameOnRotate;  // True if logging should rename log files on rotate
-    bool logWithSyslog;      // True if logging to syslog; must not be set if logpath is set.
-    int syslogFacility;      // Facility used when appending messages to the syslog.
+    std::string logpath;        // Path to log file, if logging to a file; otherwise, empty.
+    bool logAppend;             // True if logging to a file in append mode.
+    bool logRenameOnRotate;     // True if logging should rename log files on rotate
+    bool logAsync;              // True if the log file is written from a background thread.
+    bool logAsyncDropWhenFull;  // True if async logging discards lines when its buffer is full.
+    bool logWithSyslog;         // True if logging to syslog; must not be set if logpath is set.
+    int syslogFacility;         // Facility used when appending messages to the syslog.
 
     bool isHttpInterfaceEnabled;  // True if the dbwebserver should be enabled.
 
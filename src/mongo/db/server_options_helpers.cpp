@@ -256,6 +256,17 @@ Status addGeneralServerOptions(moe::OptionSection* options) {
                                moe::String,
                                "set the log rotation behavior (rename|reopen)");
 
+    options->addOptionChaining("systemLog.logAsync",
+                               "logAsync",
+                               moe::Switch,
+                               "write to logpath from a background thread");
+
+    options->addOptionChaining("systemLog.logAsyncOverflow",
+                               "logAsyncOverflow",
+                               moe::String,
+                               "set what logAsync does when its buffer is full (block|drop)")
+        .requires("systemLog.logAsync");
+
     options->addOptionChaining("systemLog.timeStampFormat",
                                "timeStampFormat",
                                moe::String,
@@ -927,6 +938,22 @@ Status storeServerOptions(const moe::Environment& params, const std::vector<std:
         }
     }
 
+    if (params.count("systemLog.logAsync") && params["systemLog.logAsync"].as<bool>() == true) {
+        serverGlobalParams.logAsync = true;
+    }
+
+    if (params.count("systemLog.logAsyncOverflow")) {
+        std::string logAsyncOverflowParam = params["systemLog.logAsyncOverflow"].as<string>();
+        if (logAsyncOverflowParam == "drop") {
+            serverGlobalParams.logAsyncDropWhenFull = true;
+        } else if (logAsyncOverflowParam == "block") {
+            serverGlobalParams.logAsyncDropWhenFull = false;
+        } else {
+            return Status(ErrorCodes::BadValue,
+                          "unsupported value for logAsyncOverflow " + logAsyncOverflowParam);
+        }
+    }
+
     if (!serverGlobalParams.logpath.empty() && serverGlobalParams.logWithSyslog) {
         return Status(ErrorCodes::BadValue, "Cant use both a logpath and syslog ");
     }
@@ -145,6 +145,15 @@ void Top::cloneMap(Top::UsageMap& out) const {
     out = _usage;
 }
 
+Top::CollectionData Top::getCollectionData(StringData ns) const {
+    stdx::lock_guard<SimpleMutex> lk(_lock);
+    UsageMap::const_iterator it = _usage.find(ns);
+    if (it == _usage.end()) {
+        return CollectionData();
+    }
+    return it->second;
+}
+
 void Top::append(BSONObjBuilder& b) {
     stdx::lock_guard<SimpleMutex> lk(_lock);
     _appendToUsageMap(b, _usage);
@@ -85,6 +85,13 @@ public:
     void record(StringData ns, int op, int lockType, long long micros, bool command);
     void append(BSONObjBuilder& b);
     void cloneMap(UsageMap& out) const;
+
+    /**
+     * Returns the usage recorded so far for a single namespace. The result is empty if nothing
+     * has been recorded for 'ns'.
+     */
+    CollectionData getCollectionData(StringData ns) const;
+
     void collectionDropped(StringData ns);
 
 private:
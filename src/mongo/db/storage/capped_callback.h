@@ -54,5 +54,11 @@ public:
     virtual Status aboutToDeleteCapped(OperationContext* txn,
                                        const RecordId& loc,
                                        RecordData data) = 0;
+
+    /**
+     * Record stores that hide uncommitted inserts call this when more of the collection becomes
+     * visible, so that tailing cursors waiting for new data can be woken up.
+     */
+    virtual void notifyCappedWaitersIfNeeded() {}
 };
 }
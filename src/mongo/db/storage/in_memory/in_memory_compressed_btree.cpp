@@ -0,0 +1,950 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/in_memory/in_memory_compressed_btree.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/base/data_view.h"
+#include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+using std::string;
+
+namespace {
+
+const int TempKeyMaxSize = 1024;  // this goes away with SERVER-3372
+
+bool hasFieldNames(const BSONObj& obj) {
+    BSONForEach(e, obj) {
+        if (e.fieldName()[0])
+            return true;
+    }
+    return false;
+}
+
+BSONObj stripFieldNames(const BSONObj& query) {
+    if (!hasFieldNames(query))
+        return query;
+
+    BSONObjBuilder bb;
+    BSONForEach(e, query) {
+        bb.appendAs(e, StringData());
+    }
+    return bb.obj();
+}
+
+// taken from btree_logic.cpp
+Status dupKeyError(const BSONObj& key) {
+    StringBuilder sb;
+    sb << "E11000 duplicate key error ";
+    sb << "dup key: " << key;
+    return Status(ErrorCodes::DuplicateKey, sb.str());
+}
+
+StringData toStringData(const KeyString& keyString) {
+    return StringData(keyString.getBuffer(), keyString.getSize());
+}
+
+StringData typeBitsToStringData(const KeyString::TypeBits& typeBits) {
+    // AllZeros TypeBits can be encoded as an empty buffer.
+    if (typeBits.isAllZeros())
+        return StringData();
+    return StringData(reinterpret_cast<const char*>(typeBits.getBuffer()), typeBits.getSize());
+}
+
+/**
+ * Returns the number of bytes of an entry that encode the key, leaving out the RecordId that
+ * every entry ends with.
+ */
+size_t keySizeWithoutRecordId(StringData entry) {
+    invariant(entry.size() >= 2);  // smallest possible encoding of a RecordId.
+    const size_t ridSize = 2 + (static_cast<unsigned char>(entry[entry.size() - 1]) & 0x7);
+    return entry.size() - ridSize;
+}
+
+/**
+ * An index entry in its uncompressed form: the KeyString of (key, RecordId) and the encoded
+ * TypeBits needed to turn it back into BSON.
+ */
+struct Entry {
+    Entry(StringData key, StringData typeBits)
+        : key(key.toString()), typeBits(typeBits.toString()) {}
+
+    std::string key;
+    std::string typeBits;
+};
+
+/**
+ * A leaf stores a run of adjacent entries. The bytes shared by every key in the leaf are stored
+ * once as the prefix. The entries are packed back to back in a single buffer, each as a 16-bit
+ * suffix length, the key suffix and the TypeBits, and an offset table allows binary searching
+ * them without unpacking anything.
+ */
+class PackedLeaf {
+public:
+    // Leaves are split once their entries take more than this many bytes.
+    static const size_t kMaxBytes = 4096;
+
+    /**
+     * Packs the sorted entries [begin, end) into a new leaf.
+     */
+    PackedLeaf(const std::vector<Entry>& entries, size_t begin, size_t end);
+
+    /**
+     * Returns how many bytes the entries [begin, end) take when packed into a single leaf.
+     */
+    static size_t packedSize(const std::vector<Entry>& entries, size_t begin, size_t end);
+
+    size_t size() const {
+        return _offsets.size();
+    }
+
+    size_t dataSize() const {
+        return _data.size();
+    }
+
+    StringData suffix(size_t slot) const {
+        const char* entry = _data.data() + _offsets[slot];
+        const uint16_t len = ConstDataView(entry).read<uint16_t>();
+        return StringData(entry + sizeof(uint16_t), len);
+    }
+
+    StringData typeBits(size_t slot) const {
+        const StringData keySuffix = suffix(slot);
+        const char* begin = keySuffix.rawData() + keySuffix.size();
+        const char* end = _data.data() + _entryEnd(slot);
+        return StringData(begin, end - begin);
+    }
+
+    void getKey(size_t slot, std::string* out) const {
+        const StringData keySuffix = suffix(slot);
+        out->assign(_prefix);
+        out->append(keySuffix.rawData(), keySuffix.size());
+    }
+
+    /**
+     * Compares the key in 'slot' with 'key' without reassembling it.
+     */
+    int compare(size_t slot, StringData key) const {
+        const int cmp = StringData(_prefix).compare(key.substr(0, _prefix.size()));
+        if (cmp != 0)
+            return cmp;
+        return suffix(slot).compare(key.substr(_prefix.size()));
+    }
+
+    /**
+     * Returns the first slot whose key is >= 'key', or size() if there is none.
+     */
+    size_t lowerBound(StringData key) const;
+
+    /**
+     * Inserts an entry at 'slot' by shifting the entries after it. Returns false, leaving the
+     * leaf unchanged, if 'key' doesn't start with the prefix or the leaf would grow past
+     * kMaxBytes. The leaf must then be repacked.
+     */
+    bool insertInPlace(size_t slot, StringData key, StringData typeBits);
+
+    /**
+     * Removes the entry at 'slot'. The prefix stays valid for the remaining entries.
+     */
+    void erase(size_t slot);
+
+    void unpack(std::vector<Entry>* out) const;
+
+    size_t memoryUsage() const {
+        return sizeof(PackedLeaf) + _prefix.capacity() + _data.capacity() +
+            _offsets.capacity() * sizeof(uint16_t);
+    }
+
+private:
+    size_t _entryEnd(size_t slot) const {
+        return slot + 1 < _offsets.size() ? _offsets[slot + 1] : _data.size();
+    }
+
+    std::string _prefix;
+    std::string _data;
+    std::vector<uint16_t> _offsets;
+};
+
+PackedLeaf::PackedLeaf(const std::vector<Entry>& entries, size_t begin, size_t end) {
+    invariant(begin < end);
+
+    // The entries are sorted, so the prefix shared by the first and last key is shared by all.
+    const StringData first = entries[begin].key;
+    const StringData last = entries[end - 1].key;
+    const size_t mismatch =
+        std::mismatch(first.rawData(),
+                      first.rawData() + std::min(first.size(), last.size()),
+                      last.rawData()).first -
+        first.rawData();
+    _prefix = first.substr(0, mismatch).toString();
+
+    const size_t size = packedSize(entries, begin, end) - _prefix.size();
+    invariant(size <= std::numeric_limits<uint16_t>::max());
+    _data.reserve(size);
+    _offsets.reserve(end - begin);
+
+    for (size_t i = begin; i < end; i++) {
+        const StringData keySuffix = StringData(entries[i].key).substr(_prefix.size());
+        _offsets.push_back(_data.size());
+
+        char len[sizeof(uint16_t)];
+        DataView(len).write<uint16_t>(keySuffix.size());
+        _data.append(len, sizeof(len));
+        _data.append(keySuffix.rawData(), keySuffix.size());
+        _data.append(entries[i].typeBits);
+    }
+}
+
+size_t PackedLeaf::packedSize(const std::vector<Entry>& entries, size_t begin, size_t end) {
+    const std::string& first = entries[begin].key;
+    const std::string& last = entries[end - 1].key;
+    const size_t prefixSize =
+        std::mismatch(first.begin(),
+                      first.begin() + std::min(first.size(), last.size()),
+                      last.begin()).first -
+        first.begin();
+
+    size_t size = prefixSize;
+    for (size_t i = begin; i < end; i++) {
+        size += sizeof(uint16_t) + entries[i].key.size() - prefixSize + entries[i].typeBits.size();
+    }
+    return size;
+}
+
+size_t PackedLeaf::lowerBound(StringData key) const {
+    // Every key in the leaf starts with the prefix, so unless 'key' does too it sorts before or
+    // after all of them.
+    const int cmp = StringData(_prefix).compare(key.substr(0, _prefix.size()));
+    if (cmp != 0)
+        return cmp > 0 ? 0 : size();
+
+    const StringData keySuffix = key.substr(_prefix.size());
+    size_t low = 0;
+    size_t high = size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (suffix(mid).compare(keySuffix) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+bool PackedLeaf::insertInPlace(size_t slot, StringData key, StringData typeBits) {
+    if (!key.startsWith(_prefix))
+        return false;
+
+    const StringData keySuffix = key.substr(_prefix.size());
+    const size_t entrySize = sizeof(uint16_t) + keySuffix.size() + typeBits.size();
+    if (_data.size() + entrySize > kMaxBytes)
+        return false;
+
+    std::string entry;
+    entry.reserve(entrySize);
+    char len[sizeof(uint16_t)];
+    DataView(len).write<uint16_t>(keySuffix.size());
+    entry.append(len, sizeof(len));
+    entry.append(keySuffix.rawData(), keySuffix.size());
+    entry.append(typeBits.rawData(), typeBits.size());
+
+    const size_t offset = slot < size() ? _offsets[slot] : _data.size();
+    _data.insert(offset, entry);
+    _offsets.insert(_offsets.begin() + slot, offset);
+    for (size_t i = slot + 1; i < _offsets.size(); i++) {
+        _offsets[i] += entrySize;
+    }
+    return true;
+}
+
+void PackedLeaf::erase(size_t slot) {
+    const size_t offset = _offsets[slot];
+    const size_t entrySize = _entryEnd(slot) - offset;
+
+    _data.erase(offset, entrySize);
+    _offsets.erase(_offsets.begin() + slot);
+    for (size_t i = slot; i < _offsets.size(); i++) {
+        _offsets[i] -= entrySize;
+    }
+}
+
+void PackedLeaf::unpack(std::vector<Entry>* out) const {
+    std::string key;
+    for (size_t slot = 0; slot < size(); slot++) {
+        getKey(slot, &key);
+        out->emplace_back(key, typeBits(slot));
+    }
+}
+
+/**
+ * The entries of an index, in KeyString order, in a list of PackedLeaf. Lookups binary search
+ * the leaves by their first key and then the entries of a single leaf.
+ */
+class CompressedIndexData {
+public:
+    struct Position {
+        size_t leaf = 0;
+        size_t slot = 0;
+    };
+
+    /**
+     * Returns false if 'key' is already in the index.
+     */
+    bool insert(StringData key, StringData typeBits);
+
+    /**
+     * Returns false if 'key' is not in the index.
+     */
+    bool erase(StringData key);
+
+    /**
+     * Positions 'pos' on the first entry >= 'key' when 'forward' or on the last entry <= 'key'
+     * otherwise. Returns false if there is no such entry.
+     */
+    bool seek(StringData key, bool forward, Position* pos) const;
+
+    /**
+     * Moves 'pos' to the next entry in the given direction. Returns false at the end.
+     */
+    bool advance(bool forward, Position* pos) const;
+
+    void getKey(const Position& pos, std::string* out) const {
+        _leaves[pos.leaf]->getKey(pos.slot, out);
+    }
+
+    StringData typeBits(const Position& pos) const {
+        return _leaves[pos.leaf]->typeBits(pos.slot);
+    }
+
+    bool empty() const {
+        return _leaves.empty();
+    }
+
+    long long numEntries() const {
+        return _numEntries;
+    }
+
+    /**
+     * Changes on every modification. A Position is only valid for the version it was found in.
+     */
+    uint64_t version() const {
+        return _version;
+    }
+
+    long long memoryUsage() const;
+
+private:
+    /**
+     * Returns the leaf that 'key' belongs in: the last one whose first key is <= 'key', or the
+     * first leaf if there is none.
+     */
+    size_t _findLeaf(StringData key) const;
+
+    /**
+     * Replaces the leaf at 'leafIndex' with as many leaves as it takes to hold 'entries'.
+     */
+    void _repack(size_t leafIndex, const std::vector<Entry>& entries);
+
+    static void _pack(const std::vector<Entry>& entries,
+                      size_t begin,
+                      size_t end,
+                      std::vector<std::unique_ptr<PackedLeaf>>* out);
+
+    std::vector<std::unique_ptr<PackedLeaf>> _leaves;
+    long long _numEntries = 0;
+    uint64_t _version = 0;
+};
+
+bool CompressedIndexData::insert(StringData key, StringData typeBits) {
+    if (_leaves.empty()) {
+        _repack(0, {Entry(key, typeBits)});
+        _numEntries++;
+        _version++;
+        return true;
+    }
+
+    const size_t leafIndex = _findLeaf(key);
+    PackedLeaf* leaf = _leaves[leafIndex].get();
+    const size_t slot = leaf->lowerBound(key);
+    if (slot < leaf->size() && leaf->compare(slot, key) == 0)
+        return false;
+
+    if (leaf->insertInPlace(slot, key, typeBits)) {
+        // Nothing else to do.
+    } else if (slot == leaf->size() && leafIndex + 1 == _leaves.size() &&
+               leaf->dataSize() >= PackedLeaf::kMaxBytes / 2) {
+        // Appending after the last entry is the common case of ascending inserts. Starting a new
+        // leaf, rather than splitting this one in half, keeps the leaves behind it full.
+        _repack(_leaves.size(), {Entry(key, typeBits)});
+    } else {
+        std::vector<Entry> entries;
+        entries.reserve(leaf->size() + 1);
+        leaf->unpack(&entries);
+        entries.insert(entries.begin() + slot, Entry(key, typeBits));
+        _repack(leafIndex, entries);
+    }
+
+    _numEntries++;
+    _version++;
+    return true;
+}
+
+bool CompressedIndexData::erase(StringData key) {
+    if (_leaves.empty())
+        return false;
+
+    const size_t leafIndex = _findLeaf(key);
+    PackedLeaf* leaf = _leaves[leafIndex].get();
+    const size_t slot = leaf->lowerBound(key);
+    if (slot == leaf->size() || leaf->compare(slot, key) != 0)
+        return false;
+
+    leaf->erase(slot);
+    if (leaf->size() == 0) {
+        _leaves.erase(_leaves.begin() + leafIndex);
+    } else if (leaf->dataSize() < PackedLeaf::kMaxBytes / 4 && leafIndex + 1 < _leaves.size()) {
+        // Merge an underfull leaf into its right neighbor if the result is no more than half
+        // full, so that deletes don't leave the index spread over mostly empty leaves.
+        std::vector<Entry> entries;
+        leaf->unpack(&entries);
+        _leaves[leafIndex + 1]->unpack(&entries);
+        if (PackedLeaf::packedSize(entries, 0, entries.size()) <= PackedLeaf::kMaxBytes / 2) {
+            _leaves.erase(_leaves.begin() + leafIndex + 1);
+            _repack(leafIndex, entries);
+        }
+    }
+
+    _numEntries--;
+    _version++;
+    return true;
+}
+
+bool CompressedIndexData::seek(StringData key, bool forward, Position* pos) const {
+    if (_leaves.empty())
+        return false;
+
+    pos->leaf = _findLeaf(key);
+    const PackedLeaf* leaf = _leaves[pos->leaf].get();
+    pos->slot = leaf->lowerBound(key);
+
+    if (forward) {
+        if (pos->slot < leaf->size())
+            return true;
+        // Everything in this leaf is before 'key', so the next entry is the answer.
+        pos->slot = leaf->size() - 1;
+        return advance(true, pos);
+    }
+
+    if (pos->slot < leaf->size() && leaf->compare(pos->slot, key) == 0)
+        return true;
+    // pos is on the first entry after 'key', so the previous one is the answer.
+    return advance(false, pos);
+}
+
+bool CompressedIndexData::advance(bool forward, Position* pos) const {
+    if (forward) {
+        if (++pos->slot < _leaves[pos->leaf]->size())
+            return true;
+        if (pos->leaf + 1 == _leaves.size())
+            return false;
+        pos->leaf++;
+        pos->slot = 0;
+        return true;
+    }
+
+    if (pos->slot > 0) {
+        pos->slot--;
+        return true;
+    }
+    if (pos->leaf == 0)
+        return false;
+    pos->leaf--;
+    pos->slot = _leaves[pos->leaf]->size() - 1;
+    return true;
+}
+
+long long CompressedIndexData::memoryUsage() const {
+    long long bytes = _leaves.capacity() * sizeof(std::unique_ptr<PackedLeaf>);
+    for (auto&& leaf : _leaves) {
+        bytes += leaf->memoryUsage();
+    }
+    return bytes;
+}
+
+size_t CompressedIndexData::_findLeaf(StringData key) const {
+    // Find the first leaf whose first key is > 'key'. 'key' belongs in the one before it.
+    size_t low = 0;
+    size_t high = _leaves.size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (_leaves[mid]->compare(0, key) <= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low == 0 ? 0 : low - 1;
+}
+
+void CompressedIndexData::_repack(size_t leafIndex, const std::vector<Entry>& entries) {
+    std::vector<std::unique_ptr<PackedLeaf>> packed;
+    _pack(entries, 0, entries.size(), &packed);
+
+    if (leafIndex < _leaves.size())
+        _leaves.erase(_leaves.begin() + leafIndex);
+    _leaves.insert(_leaves.begin() + leafIndex,
+                   std::make_move_iterator(packed.begin()),
+                   std::make_move_iterator(packed.end()));
+}
+
+void CompressedIndexData::_pack(const std::vector<Entry>& entries,
+                                size_t begin,
+                                size_t end,
+                                std::vector<std::unique_ptr<PackedLeaf>>* out) {
+    // Splitting in the middle leaves room on both sides for the inserts that will follow.
+    if (end - begin == 1 ||
+        PackedLeaf::packedSize(entries, begin, end) <= PackedLeaf::kMaxBytes) {
+        out->push_back(stdx::make_unique<PackedLeaf>(entries, begin, end));
+        return;
+    }
+
+    const size_t mid = begin + (end - begin) / 2;
+    _pack(entries, begin, mid, out);
+    _pack(entries, mid, end, out);
+}
+
+class InMemoryCompressedBtreeBuilderImpl;
+
+class InMemoryCompressedBtreeImpl : public SortedDataInterface {
+public:
+    InMemoryCompressedBtreeImpl(CompressedIndexData* data, const Ordering& ordering)
+        : _data(data), _ordering(ordering) {}
+
+    virtual SortedDataBuilderInterface* getBulkBuilder(OperationContext* txn, bool dupsAllowed);
+
+    virtual Status insert(OperationContext* txn,
+                          const BSONObj& key,
+                          const RecordId& loc,
+                          bool dupsAllowed) {
+        invariant(loc.isNormal());
+        invariant(!hasFieldNames(key));
+
+        if (key.objsize() >= TempKeyMaxSize) {
+            string msg = mongoutils::str::stream()
+                << "InMemoryCompressedBtree::insert: key too large to index, failing " << ' '
+                << key.objsize() << ' ' << key;
+            return Status(ErrorCodes::KeyTooLong, msg);
+        }
+
+        if (!dupsAllowed && isDup(key, loc))
+            return dupKeyError(key);
+
+        const KeyString data(key, _ordering, loc);
+        const StringData typeBits = typeBitsToStringData(data.getTypeBits());
+        if (_data->insert(toStringData(data), typeBits)) {
+            txn->recoveryUnit()->registerChange(
+                new IndexChange(_data, toStringData(data), typeBits, true));
+        }
+        return Status::OK();
+    }
+
+    virtual void unindex(OperationContext* txn,
+                         const BSONObj& key,
+                         const RecordId& loc,
+                         bool dupsAllowed) {
+        invariant(loc.isNormal());
+        invariant(!hasFieldNames(key));
+
+        const KeyString data(key, _ordering, loc);
+        if (_data->erase(toStringData(data))) {
+            txn->recoveryUnit()->registerChange(new IndexChange(
+                _data, toStringData(data), typeBitsToStringData(data.getTypeBits()), false));
+        }
+    }
+
+    virtual void fullValidate(OperationContext* txn,
+                              bool full,
+                              long long* numKeysOut,
+                              BSONObjBuilder* output) const {
+        *numKeysOut = _data->numEntries();
+    }
+
+    virtual bool appendCustomStats(OperationContext* txn,
+                                   BSONObjBuilder* output,
+                                   double scale) const {
+        return false;
+    }
+
+    virtual long long getSpaceUsedBytes(OperationContext* txn) const {
+        return _data->memoryUsage();
+    }
+
+    virtual Status dupKeyCheck(OperationContext* txn, const BSONObj& key, const RecordId& loc) {
+        invariant(!hasFieldNames(key));
+        if (isDup(key, loc))
+            return dupKeyError(key);
+        return Status::OK();
+    }
+
+    virtual bool isEmpty(OperationContext* txn) {
+        return _data->empty();
+    }
+
+    virtual Status touch(OperationContext* txn) const {
+        // already in memory...
+        return Status::OK();
+    }
+
+    virtual std::unique_ptr<SortedDataInterface::Cursor> newCursor(OperationContext* txn,
+                                                                   bool isForward) const {
+        return stdx::make_unique<Cursor>(*_data, _ordering, isForward);
+    }
+
+    virtual Status initAsEmpty(OperationContext* txn) {
+        // No-op
+        return Status::OK();
+    }
+
+    CompressedIndexData* data() const {
+        return _data;
+    }
+
+    const Ordering& ordering() const {
+        return _ordering;
+    }
+
+private:
+    class Cursor final : public SortedDataInterface::Cursor {
+    public:
+        Cursor(const CompressedIndexData& data, const Ordering& ordering, bool forward)
+            : _data(data), _ordering(ordering), _forward(forward) {}
+
+        boost::optional<IndexKeyEntry> next(RequestedInfo parts) override {
+            // Advance on a cursor at the end is a no-op
+            if (_eof)
+                return {};
+
+            if (!_lastMoveWasRestore)
+                advanceCursor();
+            updatePosition();
+            return curr(parts);
+        }
+
+        void setEndPosition(const BSONObj& key, bool inclusive) override {
+            if (key.isEmpty()) {
+                // This means scan to end of index.
+                _endPosition.reset();
+                return;
+            }
+
+            // NOTE: this uses the opposite rules as a normal seek because a forward scan should
+            // end after the key if inclusive and before if exclusive.
+            const auto discriminator =
+                _forward == inclusive ? KeyString::kExclusiveAfter : KeyString::kExclusiveBefore;
+            _endPosition = stdx::make_unique<KeyString>();
+            _endPosition->resetToKey(stripFieldNames(key), _ordering, discriminator);
+        }
+
+        boost::optional<IndexKeyEntry> seek(const BSONObj& key,
+                                            bool inclusive,
+                                            RequestedInfo parts) override {
+            const auto discriminator =
+                _forward == inclusive ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
+            _query.resetToKey(stripFieldNames(key), _ordering, discriminator);
+            seekCursor(_query);
+            updatePosition();
+            return curr(parts);
+        }
+
+        boost::optional<IndexKeyEntry> seek(const IndexSeekPoint& seekPoint,
+                                            RequestedInfo parts) override {
+            // makeQueryObject handles the discriminator in the real exclusive cases.
+            const BSONObj key = IndexEntryComparison::makeQueryObject(seekPoint, _forward);
+            const auto discriminator =
+                _forward ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
+            _query.resetToKey(key, _ordering, discriminator);
+            seekCursor(_query);
+            updatePosition();
+            return curr(parts);
+        }
+
+        void savePositioned() override {
+            // Our saved position is wherever we were when we last called updatePosition().
+            // Any partially completed repositions should not effect our saved position.
+        }
+
+        void saveUnpositioned() override {
+            savePositioned();
+            _eof = true;
+        }
+
+        void restore() override {
+            if (!_eof) {
+                _lastMoveWasRestore = !seekCursor(_key);
+            }
+        }
+
+        void detachFromOperationContext() final {}
+
+        void reattachToOperationContext(OperationContext* txn) final {}
+
+    private:
+        boost::optional<IndexKeyEntry> curr(RequestedInfo parts) const {
+            if (_eof)
+                return {};
+
+            BSONObj bson;
+            if (parts & kWantKey) {
+                bson = KeyString::toBson(_key.getBuffer(), _key.getSize(), _ordering, _typeBits);
+            }
+
+            return {{std::move(bson), _loc}};
+        }
+
+        bool atOrPastEndPointAfterSeeking() const {
+            if (_eof)
+                return true;
+            if (!_endPosition)
+                return false;
+
+            const int cmp = _key.compare(*_endPosition);
+
+            // We set up _endPosition to be in between the last in-range value and the first
+            // out-of-range value. In particular, it is constructed to never equal any legal
+            // index key.
+            dassert(cmp != 0);
+
+            if (_forward) {
+                // We may have landed after the end point.
+                return cmp > 0;
+            } else {
+                // We may have landed before the end point.
+                return cmp < 0;
+            }
+        }
+
+        void advanceCursor() {
+            if (_positionVersion != _data.version()) {
+                // The index changed since we were positioned, so find our place again from the
+                // key we are on. If it is gone, seeking lands on the entry after it.
+                if (!seekCursor(_key))
+                    return;
+            }
+            _cursorAtEof = !_data.advance(_forward, &_position);
+        }
+
+        // Seeks to query. Returns true on exact match.
+        bool seekCursor(const KeyString& query) {
+            _positionVersion = _data.version();
+            _cursorAtEof = !_data.seek(toStringData(query), _forward, &_position);
+            if (_cursorAtEof)
+                return false;
+            _data.getKey(_position, &_buffer);
+            return StringData(_buffer) == toStringData(query);
+        }
+
+        /**
+         * This must be called after moving the cursor to update our cached position. It should
+         * not be called after a restore that did not restore to original state since that does
+         * not logically move the cursor until the following call to next().
+         */
+        void updatePosition() {
+            _lastMoveWasRestore = false;
+            if (_cursorAtEof) {
+                _eof = true;
+                _loc = RecordId();
+                return;
+            }
+
+            _eof = false;
+
+            _data.getKey(_position, &_buffer);
+            _key.resetFromBuffer(_buffer.data(), _buffer.size());
+
+            if (atOrPastEndPointAfterSeeking()) {
+                _eof = true;
+                return;
+            }
+
+            _loc = KeyString::decodeRecordIdAtEnd(_key.getBuffer(), _key.getSize());
+
+            const StringData typeBits = _data.typeBits(_position);
+            BufReader br(typeBits.rawData(), typeBits.size());
+            _typeBits.resetFromBuffer(&br);
+        }
+
+        const CompressedIndexData& _data;  // not owned
+        const Ordering _ordering;
+        const bool _forward;
+
+        // Where the underlying index cursor is, and the index version it is valid for.
+        CompressedIndexData::Position _position;
+        uint64_t _positionVersion = 0;
+        std::string _buffer;
+
+        // These are where this cursor instance is. They are not changed in the face of a failing
+        // next().
+        KeyString _key;
+        KeyString::TypeBits _typeBits;
+        RecordId _loc;
+        bool _eof = false;
+
+        // This differs from _eof in that it always reflects the result of the most recent call
+        // to reposition the underlying index cursor.
+        bool _cursorAtEof = false;
+
+        // Used by next to decide to return current position rather than moving. Should be reset
+        // to false by any operation that moves the cursor, other than subsequent save/restore
+        // pairs.
+        bool _lastMoveWasRestore = false;
+
+        KeyString _query;
+
+        std::unique_ptr<KeyString> _endPosition;
+    };
+
+    class IndexChange : public RecoveryUnit::Change {
+    public:
+        IndexChange(CompressedIndexData* data, StringData key, StringData typeBits, bool insert)
+            : _data(data), _key(key.toString()), _typeBits(typeBits.toString()), _insert(insert) {}
+
+        virtual void commit() {}
+        virtual void rollback() {
+            if (_insert)
+                _data->erase(_key);
+            else
+                _data->insert(_key, _typeBits);
+        }
+
+    private:
+        CompressedIndexData* _data;
+        const std::string _key;
+        const std::string _typeBits;
+        const bool _insert;
+    };
+
+    /**
+     * Returns true if 'key' is indexed for a RecordId other than 'loc'.
+     */
+    bool isDup(const BSONObj& key, const RecordId& loc) const {
+        // Without a RecordId, the KeyString of 'key' sorts before all of its entries.
+        const KeyString prefix(key, _ordering);
+        const StringData prefixData = toStringData(prefix);
+
+        CompressedIndexData::Position pos;
+        if (!_data->seek(prefixData, true, &pos))
+            return false;
+
+        std::string entry;
+        do {
+            _data->getKey(pos, &entry);
+            if (StringData(entry).substr(0, keySizeWithoutRecordId(entry)) != prefixData)
+                return false;
+            if (KeyString::decodeRecordIdAtEnd(entry.data(), entry.size()) != loc)
+                return true;
+        } while (_data->advance(true, &pos));
+        return false;
+    }
+
+    CompressedIndexData* const _data;
+    const Ordering _ordering;
+};
+
+class InMemoryCompressedBtreeBuilderImpl : public SortedDataBuilderInterface {
+public:
+    InMemoryCompressedBtreeBuilderImpl(InMemoryCompressedBtreeImpl* index, bool dupsAllowed)
+        : _index(index), _dupsAllowed(dupsAllowed) {
+        invariant(_index->data()->empty());
+    }
+
+    Status addKey(const BSONObj& key, const RecordId& loc) {
+        // inserts should be in ascending (key, RecordId) order.
+
+        if (key.objsize() >= TempKeyMaxSize) {
+            return Status(ErrorCodes::KeyTooLong, "key too big");
+        }
+
+        invariant(loc.isNormal());
+        invariant(!hasFieldNames(key));
+
+        const KeyString data(key, _index->ordering(), loc);
+        if (!_last.empty()) {
+            // Compare the keys, ignoring their RecordIds.
+            const StringData keyData = toStringData(data);
+            const StringData lastData = _last;
+            const int cmp = keyData.substr(0, keySizeWithoutRecordId(keyData))
+                                .compare(lastData.substr(0, keySizeWithoutRecordId(lastData)));
+            if (cmp < 0 || (_dupsAllowed && cmp == 0 && keyData < lastData)) {
+                return Status(ErrorCodes::InternalError,
+                              "expected ascending (key, RecordId) order in bulk builder");
+            } else if (!_dupsAllowed && cmp == 0 && keyData != lastData) {
+                return dupKeyError(key);
+            }
+        }
+
+        _index->data()->insert(toStringData(data), typeBitsToStringData(data.getTypeBits()));
+        _last = toStringData(data).toString();
+
+        return Status::OK();
+    }
+
+private:
+    InMemoryCompressedBtreeImpl* const _index;
+    const bool _dupsAllowed;
+    std::string _last;  // used to detect duplicate keys or (key, RecordId) ordering violations
+};
+
+SortedDataBuilderInterface* InMemoryCompressedBtreeImpl::getBulkBuilder(OperationContext* txn,
+                                                                        bool dupsAllowed) {
+    return new InMemoryCompressedBtreeBuilderImpl(this, dupsAllowed);
+}
+
+}  // namespace
+
+SortedDataInterface* getInMemoryCompressedBtreeImpl(const Ordering& ordering,
+                                                    std::shared_ptr<void>* dataInOut) {
+    invariant(dataInOut);
+    if (!*dataInOut) {
+        *dataInOut = std::make_shared<CompressedIndexData>();
+    }
+    return new InMemoryCompressedBtreeImpl(static_cast<CompressedIndexData*>(dataInOut->get()),
+                                           ordering);
+}
+
+}  // namespace mongo
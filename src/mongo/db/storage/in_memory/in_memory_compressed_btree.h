@@ -0,0 +1,49 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/storage/sorted_data_interface.h"
+
+namespace mongo {
+
+/**
+ * Returns an index that stores its entries as KeyStrings in packed leaves of a few KB each.
+ * Within a leaf, the bytes shared by all keys are stored once and the remaining suffixes are
+ * laid out back to back, so indexes on keys with long common prefixes (URLs, paths) take a
+ * fraction of the memory of getInMemoryBtreeImpl(), and lookups binary search a contiguous
+ * buffer instead of chasing tree nodes.
+ *
+ * Caller takes ownership.
+ * All permanent data will be stored and fetch from dataInOut.
+ */
+SortedDataInterface* getInMemoryCompressedBtreeImpl(const Ordering& ordering,
+                                                    std::shared_ptr<void>* dataInOut);
+
+}  // namespace mongo
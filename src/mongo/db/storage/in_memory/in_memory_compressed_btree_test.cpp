@@ -0,0 +1,158 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/in_memory/in_memory_compressed_btree.h"
+
+#include <set>
+
+#include "mongo/db/storage/in_memory/in_memory_btree_impl.h"
+#include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
+#include "mongo/db/storage/sorted_data_interface_test_harness.h"
+#include "mongo/platform/random.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+
+class InMemoryCompressedHarnessHelper final : public HarnessHelper {
+public:
+    InMemoryCompressedHarnessHelper() : _order(Ordering::make(BSONObj())) {}
+
+    std::unique_ptr<SortedDataInterface> newSortedDataInterface(bool unique) final {
+        return std::unique_ptr<SortedDataInterface>(
+            getInMemoryCompressedBtreeImpl(_order, &_data));
+    }
+
+    std::unique_ptr<RecoveryUnit> newRecoveryUnit() final {
+        return stdx::make_unique<InMemoryRecoveryUnit>();
+    }
+
+private:
+    std::shared_ptr<void> _data;  // used by InMemoryCompressedBtreeImpl
+    Ordering _order;
+};
+
+std::unique_ptr<HarnessHelper> newHarnessHelper() {
+    return stdx::make_unique<InMemoryCompressedHarnessHelper>();
+}
+
+namespace {
+
+BSONObj urlKey(int i) {
+    return BSON("" << ("https://www.example.com/catalog/products/category/" +
+                       std::to_string(i % 10) + "/item/" + std::to_string(i)));
+}
+
+// Keys that share long prefixes take much less space than in the uncompressed btree.
+TEST(InMemoryCompressedBtree, PrefixCompressionSavesSpace) {
+    const Ordering order = Ordering::make(BSONObj());
+    std::shared_ptr<void> compressedData;
+    std::shared_ptr<void> btreeData;
+    std::unique_ptr<SortedDataInterface> compressed(
+        getInMemoryCompressedBtreeImpl(order, &compressedData));
+    std::unique_ptr<SortedDataInterface> btree(getInMemoryBtreeImpl(order, &btreeData));
+
+    const std::unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+    {
+        WriteUnitOfWork uow(opCtx.get());
+        for (int i = 0; i < 10000; i++) {
+            ASSERT_OK(compressed->insert(opCtx.get(), urlKey(i), RecordId(1, i), true));
+            ASSERT_OK(btree->insert(opCtx.get(), urlKey(i), RecordId(1, i), true));
+        }
+        uow.commit();
+    }
+
+    ASSERT_EQUALS(10000, compressed->numEntries(opCtx.get()));
+    ASSERT_LESS_THAN(compressed->getSpaceUsedBytes(opCtx.get()) * 2,
+                     btree->getSpaceUsedBytes(opCtx.get()));
+}
+
+// Random inserts and removes split and merge leaves. The index must always scan in order in
+// both directions.
+TEST(InMemoryCompressedBtree, RandomInsertsAndRemoves) {
+    const std::unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(
+        harnessHelper->newSortedDataInterface(false));
+    const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+
+    PseudoRandom random(42);
+    std::set<int> expected;
+    for (int round = 0; round < 20000; round++) {
+        const int i = static_cast<uint32_t>(random.nextInt32()) % 5000;
+        WriteUnitOfWork uow(opCtx.get());
+        if (static_cast<uint32_t>(random.nextInt32()) % 3 == 0) {
+            sorted->unindex(opCtx.get(), urlKey(i), RecordId(1, i), true);
+            expected.erase(i);
+        } else {
+            ASSERT_OK(sorted->insert(opCtx.get(), urlKey(i), RecordId(1, i), true));
+            expected.insert(i);
+        }
+        uow.commit();
+    }
+
+    ASSERT_EQUALS(static_cast<long long>(expected.size()), sorted->numEntries(opCtx.get()));
+
+    for (bool forward : {true, false}) {
+        std::vector<IndexKeyEntry> entries;
+        auto cursor = sorted->newCursor(opCtx.get(), forward);
+        for (auto entry = cursor->seek(forward ? minKey : maxKey, true); entry;
+             entry = cursor->next()) {
+            entries.push_back(*entry);
+        }
+        ASSERT_EQUALS(expected.size(), entries.size());
+        for (size_t j = 1; j < entries.size(); j++) {
+            const int cmp = entries[j - 1].key.woCompare(entries[j].key);
+            ASSERT(forward ? cmp < 0 : cmp > 0);
+        }
+    }
+}
+
+// A cursor repositions itself when the index changes under it between calls to next().
+TEST(InMemoryCompressedBtree, CursorSeesConcurrentChanges) {
+    const std::unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(harnessHelper->newSortedDataInterface(
+        false, {{BSON("" << 1), loc1}, {BSON("" << 3), loc1}, {BSON("" << 5), loc1}}));
+    const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+
+    auto cursor = sorted->newCursor(opCtx.get());
+    ASSERT_EQ(cursor->seek(BSON("" << 1), true), IndexKeyEntry(BSON("" << 1), loc1));
+
+    insertToIndex(opCtx, sorted, {{BSON("" << 2), loc1}});
+    removeFromIndex(opCtx, sorted, {{BSON("" << 3), loc1}});
+
+    ASSERT_EQ(cursor->next(), IndexKeyEntry(BSON("" << 2), loc1));
+    ASSERT_EQ(cursor->next(), IndexKeyEntry(BSON("" << 5), loc1));
+    ASSERT_EQ(cursor->next(), boost::none);
+}
+
+}  // namespace
+}  // namespace mongo
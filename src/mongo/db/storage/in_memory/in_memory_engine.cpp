@@ -32,6 +32,7 @@
 
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/storage/in_memory/in_memory_btree_impl.h"
+#include "mongo/db/storage/in_memory/in_memory_compressed_btree.h"
 #include "mongo/db/storage/in_memory/in_memory_record_store.h"
 #include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
 
@@ -76,6 +77,10 @@ SortedDataInterface* InMemoryEngine::getSortedDataInterface(OperationContext* op
                                                             StringData ident,
                                                             const IndexDescriptor* desc) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_prefixCompressIndexes) {
+        return getInMemoryCompressedBtreeImpl(Ordering::make(desc->keyPattern()),
+                                              &_dataMap[ident]);
+    }
     return getInMemoryBtreeImpl(Ordering::make(desc->keyPattern()), &_dataMap[ident]);
 }
 
@@ -38,6 +38,13 @@ namespace mongo {
 
 class InMemoryEngine : public KVEngine {
 public:
+    /**
+     * If 'prefixCompressIndexes' is true, indexes keep their entries in prefix compressed
+     * leaves, see getInMemoryCompressedBtreeImpl().
+     */
+    explicit InMemoryEngine(bool prefixCompressIndexes = false)
+        : _prefixCompressIndexes(prefixCompressIndexes) {}
+
     virtual RecoveryUnit* newRecoveryUnit();
 
     virtual Status createRecordStore(OperationContext* opCtx,
@@ -93,6 +100,8 @@ public:
 private:
     typedef StringMap<std::shared_ptr<void>> DataMap;
 
+    const bool _prefixCompressIndexes;
+
     mutable stdx::mutex _mutex;
     DataMap _dataMap;  // All actual data is owned in here
 };
@@ -30,6 +30,7 @@
  */
 
 #include "mongo/base/init.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/in_memory/in_memory_engine.h"
 #include "mongo/db/storage/kv/kv_storage_engine.h"
@@ -39,6 +40,15 @@ namespace mongo {
 
 namespace {
 
+// Keep index entries in prefix compressed leaves rather than as individual BSON keys.
+bool inMemoryPrefixCompressIndexes = false;
+ExportedServerParameter<bool> inMemoryPrefixCompressIndexesParameter(
+    ServerParameterSet::getGlobal(),
+    "inMemoryPrefixCompressIndexes",
+    &inMemoryPrefixCompressIndexes,
+    true,    // allowedAtStartup
+    false);  // allowedAtRuntime
+
 class InMemoryFactory : public StorageEngine::Factory {
 public:
     virtual ~InMemoryFactory() {}
@@ -47,7 +57,7 @@ public:
         KVStorageEngineOptions options;
         options.directoryPerDB = params.directoryperdb;
         options.forRepair = params.repair;
-        return new KVStorageEngine(new InMemoryEngine(), options);
+        return new KVStorageEngine(new InMemoryEngine(inMemoryPrefixCompressIndexes), options);
     }
 
     virtual StringData getCanonicalName() const {
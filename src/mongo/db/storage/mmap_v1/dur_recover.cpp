@@ -40,6 +40,7 @@
 #include <sys/stat.h>
 
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/compress.h"
 #include "mongo/db/storage/mmap_v1/dur_commitjob.h"
 #include "mongo/db/storage/mmap_v1/dur_journal.h"
@@ -50,11 +51,14 @@
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/checksum.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/startup_test.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -83,6 +87,16 @@ namespace dur {
 // The singleton recovery job object
 RecoveryJob& RecoveryJob::_instance = *(new RecoveryJob());
 
+// Number of threads used to apply journaled writes to the data files during recovery. Writes to
+// different data files are independent, so they may be applied concurrently, at the cost of
+// queueing up to kMaxPendingWriteBytes of them. It only helps when the journal writes to many data
+// files, so the default of 1 keeps applying each section as soon as it is read, without queueing.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(journalRecoveryThreads, int, 1);
+
+// How many bytes of basic writes to queue up before applying them during recovery. Bounds the
+// memory used for uncompressed journal sections.
+const size_t kMaxPendingWriteBytes = 256 * 1024 * 1024;
+
 
 void removeJournalFiles();
 boost::filesystem::path getJournalDir();
@@ -252,7 +266,12 @@ static string fileName(const char* dbName, int fileNo) {
 
 
 RecoveryJob::RecoveryJob()
-    : _recovering(false), _lastDataSyncedFromLastRun(0), _lastSeqMentionedInConsoleLog(1) {}
+    : _recovering(false),
+      _lastDataSyncedFromLastRun(0),
+      _lastSeqMentionedInConsoleLog(1),
+      _pendingBytes(0),
+      _applyMicros(0),
+      _writesApplied(0) {}
 
 RecoveryJob::~RecoveryJob() {
     DESTRUCTOR_GUARD(if (!_mmfs.empty()) {} close();)
@@ -264,6 +283,15 @@ void RecoveryJob::close() {
 }
 
 void RecoveryJob::_close() {
+    if (_recoveryPool && _mmfs.size() > 1) {
+        // Sync the files we opened concurrently; flushAll() below then finds them clean.
+        for (const auto& mmf : _mmfs) {
+            DurableMappedFile* file = mmf.get();
+            fassert(28785, _recoveryPool->schedule([file] { file->flush(true); }));
+        }
+        _recoveryPool->waitForIdle();
+    }
+
     MongoFile::flushAll(true);
     _mmfs.clear();
 }
@@ -312,17 +340,94 @@ void RecoveryJob::write(Last& last, const ParsedJournalEntry& entry) {
     verify(entry.dbName);
 
     DurableMappedFile* mmf = last.newEntry(entry, *this);
+    stats.curr()->_writeToDataFilesBytes += _writeToFile(mmf, entry);
+}
 
+size_t RecoveryJob::_writeToFile(DurableMappedFile* mmf, const ParsedJournalEntry& entry) {
     if ((entry.e->ofs + entry.e->len) <= mmf->length()) {
         verify(mmf->view_write());
         verify(entry.e->srcData());
 
         void* dest = (char*)mmf->view_write() + entry.e->ofs;
         memcpy(dest, entry.e->srcData(), entry.e->len);
-        stats.curr()->_writeToDataFilesBytes += entry.e->len;
+        return entry.e->len;
     } else {
         massert(13622, "Trying to write past end of file in WRITETODATAFILES", _recovering);
+        return 0;
+    }
+}
+
+void RecoveryJob::_applyPendingWrites() {
+    if (_pendingWrites.empty()) {
+        _pendingSections.clear();
+        return;
+    }
+
+    Timer t;
+
+    // Resolve the file of every write on this thread, as opening files isn't thread safe, and
+    // bucket the writes by file. Within a file they stay in journal order. Writes to different
+    // files never overlap, so the buckets can be applied in any order.
+    map<DurableMappedFile*, vector<const ParsedJournalEntry*>> byFile;
+    {
+        Last last;
+        for (const ParsedJournalEntry& entry : _pendingWrites) {
+            verify(entry.e);
+            verify(entry.dbName);
+            byFile[last.newEntry(entry, *this)].push_back(&entry);
+        }
+    }
+
+    vector<size_t> bytes(byFile.size(), 0);
+    if (_recoveryPool && byFile.size() > 1) {
+        // An exception escaping a pool task would terminate the process, so each task keeps its
+        // error and the first one is rethrown here, as it would have been by a serial recovery.
+        vector<Status> statuses(byFile.size(), Status::OK());
+        size_t n = 0;
+        for (const auto& file : byFile) {
+            DurableMappedFile* mmf = file.first;
+            const vector<const ParsedJournalEntry*>* writes = &file.second;
+            size_t* written = &bytes[n];
+            Status* status = &statuses[n];
+            n++;
+            fassert(28786,
+                    _recoveryPool->schedule([this, mmf, writes, written, status] {
+                        try {
+                            for (const ParsedJournalEntry* entry : *writes) {
+                                *written += _writeToFile(mmf, *entry);
+                            }
+                        } catch (const DBException& ex) {
+                            *status = ex.toStatus();
+                        }
+                    }));
+        }
+        _recoveryPool->waitForIdle();
+
+        for (const Status& status : statuses) {
+            if (!status.isOK()) {
+                msgasserted(status.code(), status.reason());
+            }
+        }
+    } else {
+        size_t n = 0;
+        for (const auto& file : byFile) {
+            for (const ParsedJournalEntry* entry : file.second) {
+                bytes[n] += _writeToFile(file.first, *entry);
+            }
+            n++;
+        }
+    }
+
+    for (size_t written : bytes) {
+        stats.curr()->_writeToDataFilesBytes += written;
     }
+
+    _writesApplied += _pendingWrites.size();
+    _applyMicros += t.micros();
+
+    _pendingWrites.clear();
+    _pendingSections.clear();
+    _pendingBytes = 0;
 }
 
 void RecoveryJob::applyEntry(Last& last, const ParsedJournalEntry& entry, bool apply, bool dump) {
@@ -364,10 +469,31 @@ void RecoveryJob::applyEntries(const vector<ParsedJournalEntry>& entries) {
         log() << "BEGIN section" << endl;
     }
 
+    if (_recovering && apply && !dump && _recoveryPool) {
+        // Queue basic writes so that they can be applied per data file. DurOps may create or
+        // remove files, so everything queued before one is applied first.
+        for (const ParsedJournalEntry& entry : entries) {
+            if (entry.e) {
+                _pendingWrites.push_back(entry);
+                _pendingBytes += entry.e->len;
+            } else if (entry.op) {
+                _applyPendingWrites();
+                Last last;
+                applyEntry(last, entry, apply, dump);
+            }
+        }
+        return;
+    }
+
+    Timer t;
     Last last;
     for (vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
         applyEntry(last, *i, apply, dump);
+        if (apply && i->e) {
+            _writesApplied++;
+        }
     }
+    _applyMicros += t.micros();
 
     if (dump) {
         log() << "END section" << endl;
@@ -433,7 +559,16 @@ void RecoveryJob::processSection(const JSectHeader* h,
     }
 
     // got all the entries for one group commit.  apply them:
+    const size_t pendingBefore = _pendingWrites.size();
     applyEntries(entries);
+
+    if (_pendingWrites.size() > pendingBefore) {
+        // Some of this section's writes were queued and point into its uncompressed buffer.
+        _pendingSections.push_back(std::move(i));
+        if (_pendingBytes >= kMaxPendingWriteBytes) {
+            _applyPendingWrites();
+        }
+    }
 }
 
 /** apply a specific journal file, that is already mmap'd
@@ -527,7 +662,15 @@ bool RecoveryJob::processFile(boost::filesystem::path journalfile) {
     void* p =
         f.mapWithOptions(journalfile.string().c_str(), MongoFile::READONLY | MongoFile::SEQUENTIAL);
     massert(13544, str::stream() << "recover error couldn't open " << journalfile.string(), p);
-    return processFileBuffer(p, (unsigned)f.length());
+    const bool abruptEnd = processFileBuffer(p, (unsigned)f.length());
+
+    // Everything which was fully read from this file is valid, even if it ended abruptly.
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mx);
+        _applyPendingWrites();
+    }
+
+    return abruptEnd;
 }
 
 /** @param files all the j._0 style files we need to apply for recovery */
@@ -540,6 +683,25 @@ void RecoveryJob::go(vector<boost::filesystem::path>& files) {
     _lastDataSyncedFromLastRun = journalReadLSN();
     log() << "recover lsn: " << _lastDataSyncedFromLastRun << endl;
 
+    if (journalRecoveryThreads > 1) {
+        ThreadPool::Options options;
+        options.poolName = "journalRecovery";
+        options.minThreads = options.maxThreads = journalRecoveryThreads;
+        _recoveryPool.reset(new ThreadPool(options));
+        _recoveryPool->startup();
+    }
+    ON_BLOCK_EXIT([this] {
+        if (_recoveryPool) {
+            _recoveryPool->shutdown();
+            _recoveryPool->join();
+            _recoveryPool.reset();
+        }
+    });
+
+    _applyMicros = 0;
+    _writesApplied = 0;
+    Timer t;
+
     for (unsigned i = 0; i != files.size(); ++i) {
         bool abruptEnd = processFile(files[i]);
         if (abruptEnd && i + 1 < files.size()) {
@@ -550,7 +712,15 @@ void RecoveryJob::go(vector<boost::filesystem::path>& files) {
         }
     }
 
+    const long long replayMicros = t.micros();
+    t.reset();
     close();
+    const long long flushMicros = t.micros();
+
+    log() << "recover replayed journal in " << replayMicros / 1000 << "ms (read "
+          << (replayMicros - _applyMicros) / 1000 << "ms, applied " << _writesApplied
+          << " writes in " << _applyMicros / 1000 << "ms), flushed data files in "
+          << flushMicros / 1000 << "ms" << endl;
 
     if (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalScanOnly) {
         uasserted(13545,
@@ -32,6 +32,8 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <list>
+#include <memory>
+#include <vector>
 
 #include "mongo/db/storage/mmap_v1/dur_journalformat.h"
 #include "mongo/util/concurrency/mutex.h"
@@ -39,9 +41,11 @@
 namespace mongo {
 
 class DurableMappedFile;
+class ThreadPool;
 
 namespace dur {
 
+class JournalSectionIterator;
 struct ParsedJournalEntry;
 
 /** call go() to execute a recovery from existing journal files.
@@ -79,12 +83,17 @@ private:
 
 
     void write(Last& last, const ParsedJournalEntry& entry);  // actually writes to the file
+    // copies a basic write into an already resolved file, returns the number of bytes written
+    size_t _writeToFile(DurableMappedFile* mmf, const ParsedJournalEntry& entry);
     void applyEntry(Last& last, const ParsedJournalEntry& entry, bool apply, bool dump);
     void applyEntries(const std::vector<ParsedJournalEntry>& entries);
     bool processFileBuffer(const void*, unsigned len);
     bool processFile(boost::filesystem::path journalfile);
     void _close();  // doesn't lock
 
+    // Applies everything in _pendingWrites, one task per data file. Doesn't lock.
+    void _applyPendingWrites();
+
 
     // Set of memory mapped files and a mutex to protect them
     stdx::mutex _mx;
@@ -96,6 +105,21 @@ private:
     unsigned long long _lastDataSyncedFromLastRun;
     unsigned long long _lastSeqMentionedInConsoleLog;
 
+    // While recovering with a _recoveryPool, basic writes are queued here across sections and
+    // applied in parallel, per data file, at the next DurOp, once enough have built up, or at the
+    // end of each journal file. The writes point into the uncompressed buffers of
+    // _pendingSections, which are kept alive until then.
+    std::vector<ParsedJournalEntry> _pendingWrites;
+    std::vector<std::unique_ptr<JournalSectionIterator>> _pendingSections;
+    size_t _pendingBytes;
+
+    // Applies and flushes data files during recovery. Only set while go() runs.
+    std::unique_ptr<ThreadPool> _recoveryPool;
+
+    // Recovery phase timings, reported at the end of go().
+    long long _applyMicros;
+    unsigned long long _writesApplied;
+
 
     static RecoveryJob& _instance;
 };
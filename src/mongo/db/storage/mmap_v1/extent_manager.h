@@ -120,6 +120,12 @@ public:
      */
     virtual std::unique_ptr<RecordFetcher> recordNeedsFetch(const DiskLoc& loc) const = 0;
 
+    /**
+     * Asks the OS to start paging in the records at the provided DiskLocs without waiting for
+     * the I/O to complete. Extent managers which are not backed by mapped files ignore this.
+     */
+    virtual void prefetchRecords(const std::vector<DiskLoc>& locs) const {}
+
     /**
      * @param loc - has to be for a specific MmapV1RecordHeader (not an Extent)
      * Note(erh) see comment on recordFor
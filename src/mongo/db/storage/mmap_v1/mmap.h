@@ -59,6 +59,12 @@ private:
     unsigned _len;
 };
 
+/**
+ * Tells the OS that the pages spanning [p, p + len) will be needed soon, so that it can start
+ * reading them in asynchronously. Advisory only; errors are ignored.
+ */
+void adviseWillNeed(const void* p, size_t len);
+
 // lock order: lock dbMutex before this if you lock both
 class LockMongoFilesShared {
     friend class LockMongoFilesExclusive;
@@ -30,6 +30,7 @@
 
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
 
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
 
 #include "mongo/db/storage/mmap_v1/mmap_v1_extent_manager.h"
@@ -311,6 +312,31 @@ std::unique_ptr<RecordFetcher> MmapV1ExtentManager::recordNeedsFetch(const DiskL
     return {};
 }
 
+void MmapV1ExtentManager::prefetchRecords(const std::vector<DiskLoc>& locs) const {
+    // We can't read a record's length without faulting on its header, so advise a fixed window
+    // starting at each record. This covers the header and most small documents.
+    const size_t kWindowBytes = 4096;
+
+    std::vector<const char*> starts;
+    starts.reserve(locs.size());
+    for (const DiskLoc& loc : locs) {
+        if (!loc.isNull())
+            starts.push_back(reinterpret_cast<const char*>(_recordForV1(loc)));
+    }
+    std::sort(starts.begin(), starts.end());
+
+    // Coalesce overlapping windows so that records clustered on disk cost a single madvise.
+    size_t i = 0;
+    while (i < starts.size()) {
+        const char* begin = starts[i];
+        const char* end = begin + kWindowBytes;
+        for (++i; i < starts.size() && starts[i] <= end; ++i) {
+            end = starts[i] + kWindowBytes;
+        }
+        adviseWillNeed(begin, end - begin);
+    }
+}
+
 DiskLoc MmapV1ExtentManager::extentLocForV1(const DiskLoc& loc) const {
     MmapV1RecordHeader* record = recordForV1(loc);
     return DiskLoc(loc.a(), record->extentOfs());
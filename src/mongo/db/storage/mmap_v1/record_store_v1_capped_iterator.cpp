@@ -210,4 +210,13 @@ std::unique_ptr<RecordFetcher> CappedRecordStoreV1Iterator::fetcherForId(const R
     return _recordStore->_extentManager->recordNeedsFetch(DiskLoc::fromRecordId(id));
 }
 
+void CappedRecordStoreV1Iterator::prefetch(const std::vector<RecordId>& ids) const {
+    std::vector<DiskLoc> locs;
+    locs.reserve(ids.size());
+    for (const RecordId& id : ids) {
+        locs.push_back(DiskLoc::fromRecordId(id));
+    }
+    _recordStore->_extentManager->prefetchRecords(locs);
+}
+
 }  // namespace mongo
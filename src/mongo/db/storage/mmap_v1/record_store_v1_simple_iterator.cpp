@@ -122,4 +122,13 @@ std::unique_ptr<RecordFetcher> SimpleRecordStoreV1Iterator::fetcherForNext() con
 std::unique_ptr<RecordFetcher> SimpleRecordStoreV1Iterator::fetcherForId(const RecordId& id) const {
     return _recordStore->_extentManager->recordNeedsFetch(DiskLoc::fromRecordId(id));
 }
+
+void SimpleRecordStoreV1Iterator::prefetch(const std::vector<RecordId>& ids) const {
+    std::vector<DiskLoc> locs;
+    locs.reserve(ids.size());
+    for (const RecordId& id : ids) {
+        locs.push_back(DiskLoc::fromRecordId(id));
+    }
+    _recordStore->_extentManager->prefetchRecords(locs);
+}
 }
@@ -60,6 +60,7 @@ public:
     void invalidate(const RecordId& dl) final;
     std::unique_ptr<RecordFetcher> fetcherForNext() const final;
     std::unique_ptr<RecordFetcher> fetcherForId(const RecordId& id) const final;
+    void prefetch(const std::vector<RecordId>& ids) const final;
 
 private:
     void advance();
@@ -251,6 +251,13 @@ public:
     virtual std::unique_ptr<RecordFetcher> fetcherForId(const RecordId& id) const {
         return {};
     }
+
+    /**
+     * Hints that the provided Records are about to be fetched, in order, so that the storage
+     * engine can start reading them into memory in the background. This must not block on I/O
+     * and is purely advisory: callers must still honor fetcherForId() for each Record.
+     */
+    virtual void prefetch(const std::vector<RecordId>& ids) const {}
 };
 
 /**
@@ -359,6 +366,26 @@ public:
                                               const DocWriter* doc,
                                               bool enforceQuota) = 0;
 
+    /**
+     * Inserts 'nDocs' documents in order. Record stores which can amortize the per insert work
+     * over a whole batch should override this. If 'idsOut' is not NULL, it must have room for
+     * 'nDocs' RecordIds, which are filled in as the documents are inserted.
+     */
+    virtual Status insertRecordsWithDocWriter(OperationContext* txn,
+                                              const DocWriter* const* docs,
+                                              size_t nDocs,
+                                              bool enforceQuota,
+                                              RecordId* idsOut) {
+        for (size_t i = 0; i < nDocs; i++) {
+            StatusWith<RecordId> res = insertRecord(txn, docs[i], enforceQuota);
+            if (!res.isOK())
+                return res.getStatus();
+            if (idsOut)
+                idsOut[i] = res.getValue();
+        }
+        return Status::OK();
+    }
+
     /**
      * @param notifier - Only used by record stores which do not support doc-locking.
      *                   In the case of a document move, this is called after the document
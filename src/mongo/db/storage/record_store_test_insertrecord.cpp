@@ -174,4 +174,42 @@ TEST(RecordStoreTestHarness, InsertMultipleRecordsUsingDocWriter) {
     }
 }
 
+// Insert a batch of records with one call and verify that each can be read back
+// by the RecordId it was given.
+TEST(RecordStoreTestHarness, InsertRecordsWithDocWriter) {
+    unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 10;
+    std::vector<std::unique_ptr<StringDocWriter>> writers;
+    std::vector<const DocWriter*> docs;
+    for (int i = 0; i < nToInsert; i++) {
+        stringstream ss;
+        ss << "record " << i;
+        writers.emplace_back(new StringDocWriter(ss.str(), false));
+        docs.push_back(writers.back().get());
+    }
+
+    RecordId locs[nToInsert];
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_OK(
+                rs->insertRecordsWithDocWriter(opCtx.get(), &docs[0], nToInsert, false, locs));
+            uow.commit();
+        }
+    }
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(nToInsert, rs->numRecords(opCtx.get()));
+        for (int i = 0; i < nToInsert; i++) {
+            stringstream ss;
+            ss << "record " << i;
+            ASSERT_EQUALS(ss.str(), string(rs->dataFor(opCtx.get(), locs[i]).data()));
+        }
+    }
+}
+
 }  // namespace mongo
@@ -0,0 +1,574 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/skiplist/skiplist.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/storage/skiplist/skiplist_recovery_unit.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+using Transaction = SkipListTransactionManager::Transaction;
+
+/**
+ * A key and its tower of next pointers, followed in the same allocation by the key bytes. The
+ * low bit of a next pointer marks the Node as removed on that level.
+ */
+class SkipList::Node {
+public:
+    static Node* create(StringData key, int height) {
+        void* memory = mongoMalloc(allocationSize(key.size(), height));
+        Node* node = new (memory) Node(key.size(), height);
+        for (int level = 0; level < height; level++) {
+            new (&node->next(level)) std::atomic<uintptr_t>(0);
+        }
+        key.copyTo(node->_keyData(), false);
+        return node;
+    }
+
+    static void destroy(void* node) {
+        static_cast<Node*>(node)->~Node();
+        std::free(node);
+    }
+
+    StringData key() const {
+        return StringData(const_cast<Node*>(this)->_keyData(), _keySize);
+    }
+
+    int height() const {
+        return _height;
+    }
+
+    std::atomic<uintptr_t>& next(int level) {
+        dassert(level < _height);
+        return reinterpret_cast<std::atomic<uintptr_t>*>(this + 1)[level];
+    }
+
+    int64_t allocationSize() const {
+        return allocationSize(_keySize, _height);
+    }
+
+    std::atomic<Version*> head{nullptr};
+
+private:
+    static int64_t allocationSize(size_t keySize, int height) {
+        return sizeof(Node) + height * sizeof(std::atomic<uintptr_t>) + keySize;
+    }
+
+    Node(size_t keySize, int height) : _keySize(keySize), _height(height) {}
+
+    char* _keyData() {
+        return reinterpret_cast<char*>(&next(0) + _height);
+    }
+
+    const uint32_t _keySize;
+    const uint8_t _height;
+};
+
+namespace {
+
+bool isMarked(uintptr_t word) {
+    return word & 1;
+}
+
+uintptr_t marked(uintptr_t word) {
+    return word | 1;
+}
+
+SkipList::Node* toNode(uintptr_t word) {
+    return reinterpret_cast<SkipList::Node*>(word & ~uintptr_t(1));
+}
+
+uintptr_t toWord(SkipList::Node* node) {
+    return reinterpret_cast<uintptr_t>(node);
+}
+
+/**
+ * Returns the newest Version in the chain starting at 'version' that a snapshot at
+ * 'readTimestamp' of transaction 'txn' can see, or nullptr.
+ */
+const SkipList::Version* visibleVersion(const SkipList::Version* version,
+                                        uint64_t readTimestamp,
+                                        const Transaction* txn) {
+    for (; version; version = version->older.load()) {
+        uint64_t timestamp = version->timestamp.load();
+        if (timestamp == SkipListTransactionManager::kUncommittedTimestamp) {
+            if (version->txn == txn)
+                return version;
+
+            // The transaction may have committed without having stamped this version yet.
+            timestamp = version->txn->commitTimestamp.load();
+            if (timestamp == 0)
+                continue;
+        }
+
+        if (timestamp <= readTimestamp)
+            return version;
+    }
+    return nullptr;
+}
+
+bool isVisibleValue(const SkipList::Version* version) {
+    return version && !version->isDeletion;
+}
+
+/**
+ * A transaction may only write a key whose newest Version is its own or was visible to it.
+ */
+bool isWriteConflict(const SkipList::Version* head,
+                     uint64_t readTimestamp,
+                     const Transaction* txn) {
+    if (!head)
+        return false;
+
+    uint64_t timestamp = head->timestamp.load();
+    if (timestamp == SkipListTransactionManager::kUncommittedTimestamp) {
+        if (head->txn == txn)
+            return false;
+
+        timestamp = head->txn->commitTimestamp.load();
+        if (timestamp == 0)
+            return true;
+    }
+    return timestamp > readTimestamp;
+}
+
+}  // namespace
+
+// Visible to every snapshot as a deletion.
+SkipList::Version SkipList::_removed(nullptr, 0, true, 0);
+
+SkipList::Version* SkipList::Version::create(StringData value,
+                                             bool isDeletion,
+                                             Transaction* txn) {
+    void* memory = mongoMalloc(sizeof(Version) + value.size());
+    Version* version = new (memory)
+        Version(txn, value.size(), isDeletion, SkipListTransactionManager::kUncommittedTimestamp);
+    value.copyTo(static_cast<char*>(memory) + sizeof(Version), false);
+    return version;
+}
+
+void SkipList::Version::destroy(void* version) {
+    static_cast<Version*>(version)->~Version();
+    std::free(version);
+}
+
+SkipList::SkipList(SkipListTransactionManager* txnManager)
+    : _txnManager(txnManager),
+      _head(Node::create(StringData(), kMaxHeight)),
+      _randomState(reinterpret_cast<uintptr_t>(this)) {
+    _memoryUsed.store(_head->allocationSize());
+    _txnManager->trackAllocation(_head->allocationSize());
+}
+
+SkipList::~SkipList() {
+    int64_t bytes = 0;
+    Node* node = _head;
+    while (node) {
+        Node* next = toNode(node->next(0).load());
+
+        Version* version = node->head.load();
+        if (version == &_removed)
+            version = nullptr;
+        while (version) {
+            Version* older = version->older.load();
+            bytes += version->allocationSize();
+            Version::destroy(version);
+            version = older;
+        }
+
+        bytes += node->allocationSize();
+        Node::destroy(node);
+        node = next;
+    }
+    _txnManager->trackDeallocation(bytes);
+}
+
+bool SkipList::find(SkipListRecoveryUnit* ru, StringData key, StringData* value) {
+    const uint64_t readTimestamp = ru->getReadTimestamp();
+
+    Node* preds[kMaxHeight];
+    Node* succs[kMaxHeight];
+    Node* node = _find(&key, preds, succs);
+    if (!node)
+        return false;
+
+    const Version* version = visibleVersion(node->head.load(), readTimestamp, ru->getTransaction());
+    if (!isVisibleValue(version))
+        return false;
+
+    *value = version->value();
+    return true;
+}
+
+bool SkipList::insert(SkipListRecoveryUnit* ru, StringData key, StringData value) {
+    return _write(ru, key, value, WriteMode::kInsert);
+}
+
+bool SkipList::update(SkipListRecoveryUnit* ru, StringData key, StringData value) {
+    return _write(ru, key, value, WriteMode::kUpdate);
+}
+
+bool SkipList::remove(SkipListRecoveryUnit* ru, StringData key) {
+    return _write(ru, key, StringData(), WriteMode::kRemove);
+}
+
+bool SkipList::_write(SkipListRecoveryUnit* ru, StringData key, StringData value, WriteMode mode) {
+    const uint64_t readTimestamp = ru->getReadTimestamp();
+    Transaction* txn = ru->getWriteTransaction();
+
+    Node* preds[kMaxHeight];
+    Node* succs[kMaxHeight];
+    while (true) {
+        Node* node = _find(&key, preds, succs);
+        if (!node) {
+            if (mode != WriteMode::kInsert)
+                return false;
+
+            Version* version = Version::create(value, false, txn);
+            node = _link(key, version, preds, succs);
+            if (!node) {
+                // Another writer linked a Node for the same key or a neighbor first.
+                Version::destroy(version);
+                continue;
+            }
+
+            _memoryUsed.fetchAndAdd(version->allocationSize());
+            _txnManager->trackAllocation(version->allocationSize());
+            ru->registerWrite(this, node, version);
+            return true;
+        }
+
+        Version* head = node->head.load();
+        if (head == &_removed) {
+            _unlink(node);
+            continue;
+        }
+
+        if (isWriteConflict(head, readTimestamp, txn))
+            throw WriteConflictException();
+
+        const bool exists = isVisibleValue(visibleVersion(head, readTimestamp, txn));
+        if (exists == (mode == WriteMode::kInsert))
+            return false;
+
+        Version* version = Version::create(value, mode == WriteMode::kRemove, txn);
+        version->older.store(head);
+        if (!node->head.compare_exchange_strong(head, version)) {
+            // Only the garbage collector can have replaced a Version we were allowed to write
+            // over, so this Node is being removed.
+            Version::destroy(version);
+            continue;
+        }
+
+        _memoryUsed.fetchAndAdd(version->allocationSize());
+        _txnManager->trackAllocation(version->allocationSize());
+        ru->registerWrite(this, node, version);
+        return true;
+    }
+}
+
+void SkipList::rollbackVersion(Node* node, Version* version) {
+    Version* expected = version;
+    invariant(node->head.compare_exchange_strong(expected, version->older.load()));
+    _retireVersion(version);
+}
+
+SkipList::Node* SkipList::_find(const StringData* key, Node** preds, Node** succs) {
+retry:
+    Node* pred = _head;
+    for (int level = kMaxHeight - 1; level >= 0; level--) {
+        Node* curr = toNode(pred->next(level).load());
+        while (curr) {
+            uintptr_t succ = curr->next(level).load();
+            while (isMarked(succ)) {
+                uintptr_t expected = toWord(curr);
+                if (!pred->next(level).compare_exchange_strong(expected, toWord(toNode(succ)))) {
+                    // 'pred' was removed or gained a new successor.
+                    goto retry;
+                }
+
+                curr = toNode(succ);
+                if (!curr)
+                    break;
+                succ = curr->next(level).load();
+            }
+
+            if (!curr || (key && curr->key().compare(*key) >= 0))
+                break;
+
+            pred = curr;
+            curr = toNode(succ);
+        }
+
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+
+    Node* node = succs[0];
+    return (node && key && node->key() == *key) ? node : nullptr;
+}
+
+SkipList::Node* SkipList::_next(Node* node) {
+    const uintptr_t next = node->next(0).load();
+    if (!isMarked(next))
+        return toNode(next);
+
+    // 'node' is being removed and Nodes linked after it may be missing from its tower. A new Node
+    // for the same key can only have been linked after 'node' was removed, so it comes next.
+    const StringData key = node->key();
+    Node* preds[kMaxHeight];
+    Node* succs[kMaxHeight];
+    _find(&key, preds, succs);
+    return succs[0];
+}
+
+SkipList::Node* SkipList::_lastBefore(const StringData* key) {
+    Node* preds[kMaxHeight];
+    Node* succs[kMaxHeight];
+    _find(key, preds, succs);
+    return preds[0] == _head ? nullptr : preds[0];
+}
+
+SkipList::Node* SkipList::_link(StringData key, Version* version, Node** preds, Node** succs) {
+    const int height = _randomHeight();
+    Node* node = Node::create(key, height);
+    node->head.store(version);
+    for (int level = 0; level < height; level++) {
+        node->next(level).store(toWord(succs[level]));
+    }
+
+    uintptr_t expected = toWord(succs[0]);
+    if (!preds[0]->next(0).compare_exchange_strong(expected, toWord(node))) {
+        Node::destroy(node);
+        return nullptr;
+    }
+
+    _memoryUsed.fetchAndAdd(node->allocationSize());
+    _txnManager->trackAllocation(node->allocationSize());
+
+    // The Node is in the list once it is linked on level 0. The upper levels only speed up
+    // searches, and are linked one at a time, searching again whenever a neighbor changed.
+    for (int level = 1; level < height; level++) {
+        while (true) {
+            uintptr_t next = node->next(level).load();
+            if (next != toWord(succs[level]) &&
+                !node->next(level).compare_exchange_strong(next, toWord(succs[level]))) {
+                break;
+            }
+
+            expected = toWord(succs[level]);
+            if (preds[level]->next(level).compare_exchange_strong(expected, toWord(node)))
+                break;
+
+            _find(&key, preds, succs);
+        }
+    }
+    return node;
+}
+
+void SkipList::_unlink(Node* node) {
+    // Marking from the top down keeps the Node reachable on level 0 until it is unreachable
+    // everywhere else.
+    for (int level = node->height() - 1; level >= 0; level--) {
+        node->next(level).fetch_or(1);
+    }
+
+    const StringData key = node->key();
+    Node* preds[kMaxHeight];
+    Node* succs[kMaxHeight];
+    _find(&key, preds, succs);
+}
+
+void SkipList::collectGarbage(SkipListTransactionManager::Slot* slot) {
+    _txnManager->enterEpoch(slot);
+    const uint64_t oldestReadTimestamp = _txnManager->getOldestReadTimestamp();
+
+    Node* node = toNode(_head->next(0).load());
+    while (node) {
+        Node* next = toNode(node->next(0).load());
+        _collectNodeGarbage(node, oldestReadTimestamp);
+        node = next;
+    }
+
+    _txnManager->exitEpoch(slot);
+}
+
+void SkipList::_collectNodeGarbage(Node* node, uint64_t oldestReadTimestamp) {
+    Version* head = node->head.load();
+    if (head == &_removed)
+        return;
+
+    // Find the newest Version that every snapshot can see. Anything older is unreachable.
+    Version* version = head;
+    while (version) {
+        const uint64_t timestamp = version->timestamp.load();
+        if (timestamp != SkipListTransactionManager::kUncommittedTimestamp &&
+            timestamp <= oldestReadTimestamp) {
+            break;
+        }
+        version = version->older.load();
+    }
+
+    if (!version) {
+        // A Node without Versions was left behind by an aborted insert.
+        if (!head && node->head.compare_exchange_strong(head, &_removed)) {
+            _unlink(node);
+            _retireNode(node);
+        }
+        return;
+    }
+
+    Version* garbage = version->older.exchange(nullptr);
+    while (garbage) {
+        Version* older = garbage->older.load();
+        _retireVersion(garbage);
+        garbage = older;
+    }
+
+    if (version == head && version->isDeletion &&
+        node->head.compare_exchange_strong(head, &_removed)) {
+        _unlink(node);
+        _retireVersion(version);
+        _retireNode(node);
+    }
+}
+
+int SkipList::_randomHeight() {
+    // splitmix64 over a shared counter, so that concurrent writers never need a lock.
+    uint64_t bits = _randomState.addAndFetch(0x9E3779B97F4A7C15ULL);
+    bits = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBULL;
+    bits ^= bits >> 31;
+
+    // Each level holds a quarter of the Nodes of the level below it.
+    int height = 1;
+    while (height < kMaxHeight && (bits & 3) == 0) {
+        height++;
+        bits >>= 2;
+    }
+    return height;
+}
+
+void SkipList::_retireVersion(Version* version) {
+    _memoryUsed.fetchAndSubtract(version->allocationSize());
+    _txnManager->retire(version, &Version::destroy, version->allocationSize());
+}
+
+void SkipList::_retireNode(Node* node) {
+    _memoryUsed.fetchAndSubtract(node->allocationSize());
+    _txnManager->retire(node, &Node::destroy, node->allocationSize());
+}
+
+SkipList::Cursor::Cursor(SkipList* list, SkipListRecoveryUnit* ru, bool forward)
+    : _list(list), _ru(ru), _forward(forward) {}
+
+bool SkipList::Cursor::seek(StringData key) {
+    _ru->getReadTimestamp();
+
+    Node* preds[kMaxHeight];
+    Node* succs[kMaxHeight];
+    Node* node = _list->_find(&key, preds, succs);
+    if (!_forward && !node)
+        node = preds[0] == _list->_head ? nullptr : preds[0];
+    else if (_forward)
+        node = succs[0];
+    return _settle(node);
+}
+
+bool SkipList::Cursor::seekToStart() {
+    _ru->getReadTimestamp();
+    return _settle(_forward ? _list->_next(_list->_head) : _list->_lastBefore(nullptr));
+}
+
+bool SkipList::Cursor::next() {
+    if (!_node)
+        return false;
+
+    _ru->getReadTimestamp();
+    if (_ru->getSnapshotId() != _snapshotId) {
+        // '_node' may have been freed since the snapshot it was found in was closed.
+        const StringData key(_key);
+        if (!_forward)
+            return _settle(_list->_lastBefore(&key));
+
+        Node* preds[kMaxHeight];
+        Node* succs[kMaxHeight];
+        Node* node = _list->_find(&key, preds, succs);
+        return _settle(node ? _list->_next(node) : succs[0]);
+    }
+
+    if (_forward)
+        return _settle(_list->_next(_node));
+
+    const StringData key(_key);
+    return _settle(_list->_lastBefore(&key));
+}
+
+void SkipList::Cursor::reset() {
+    _node = nullptr;
+    _version = nullptr;
+    _key.clear();
+}
+
+bool SkipList::Cursor::_settle(Node* node) {
+    const uint64_t readTimestamp = _ru->getReadTimestamp();
+    const Transaction* txn = _ru->getTransaction();
+    _snapshotId = _ru->getSnapshotId();
+
+    while (node) {
+        const Version* version = visibleVersion(node->head.load(), readTimestamp, txn);
+        if (isVisibleValue(version)) {
+            _node = node;
+            _version = version;
+            const StringData key = node->key();
+            _key.assign(key.rawData(), key.size());
+            return true;
+        }
+
+        if (_forward) {
+            node = _list->_next(node);
+        } else {
+            const StringData key = node->key();
+            node = _list->_lastBefore(&key);
+        }
+    }
+
+    reset();
+    return false;
+}
+
+}  // namespace mongo
@@ -0,0 +1,241 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/storage/skiplist/skiplist_transaction_manager.h"
+#include "mongo/db/storage/snapshot.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+class SkipListRecoveryUnit;
+
+/**
+ * An ordered map from byte strings to multi-versioned values that readers and writers access
+ * without taking locks.
+ *
+ * Each key is a Node in a skiplist whose towers are linked with compare-and-swap, after Fraser's
+ * design. A Node holds a chain of Versions, newest first. A write pushes a new Version onto the
+ * chain and stays invisible to other snapshots until its transaction commits. Two transactions
+ * that write the same key conflict, and the one that finds the other's Version throws
+ * WriteConflictException.
+ *
+ * Versions that no snapshot can see anymore, and the Nodes of keys that were deleted before the
+ * oldest snapshot, are only removed by collectGarbage(). Their memory is handed to the
+ * SkipListTransactionManager, which frees it once no reader can still be looking at it.
+ */
+class SkipList {
+    MONGO_DISALLOW_COPYING(SkipList);
+
+public:
+    class Node;
+    class Cursor;
+
+    /**
+     * One value of a key. The value bytes follow the struct in the same allocation.
+     */
+    struct Version {
+        static Version* create(StringData value,
+                               bool isDeletion,
+                               SkipListTransactionManager::Transaction* txn);
+        static void destroy(void* version);
+
+        StringData value() const {
+            return StringData(reinterpret_cast<const char*>(this + 1), size);
+        }
+
+        int64_t allocationSize() const {
+            return sizeof(Version) + size;
+        }
+
+        // The commit timestamp, or kUncommittedTimestamp until the writer has stamped it.
+        std::atomic<uint64_t> timestamp;
+        std::atomic<Version*> older{nullptr};
+        SkipListTransactionManager::Transaction* const txn;  // Only valid while not stamped.
+        const uint32_t size;
+        const bool isDeletion;
+
+    private:
+        friend class SkipList;
+
+        Version(SkipListTransactionManager::Transaction* txn,
+                uint32_t size,
+                bool isDeletion,
+                uint64_t timestamp)
+            : timestamp(timestamp), txn(txn), size(size), isDeletion(isDeletion) {}
+    };
+
+    /**
+     * Iterates over the values of a SkipList visible to a SkipListRecoveryUnit, in key order or
+     * in reverse. The key and value are valid until the cursor moves or the snapshot is closed.
+     * A cursor used in a new snapshot picks up where it left off.
+     */
+    class Cursor {
+    public:
+        Cursor(SkipList* list, SkipListRecoveryUnit* ru, bool forward);
+
+        /**
+         * Positions the cursor on the first key >= 'key' when iterating forward, or on the last
+         * key <= 'key' in reverse. Returns false if there is no such key.
+         */
+        bool seek(StringData key);
+
+        /**
+         * Positions the cursor on the first key in the direction of iteration.
+         */
+        bool seekToStart();
+
+        /**
+         * Moves to the next key in the direction of iteration. Returns false at the end.
+         */
+        bool next();
+
+        bool isEOF() const {
+            return !_node;
+        }
+
+        StringData key() const {
+            return StringData(_key);
+        }
+
+        StringData value() const {
+            return _version->value();
+        }
+
+        /**
+         * Forgets the position.
+         */
+        void reset();
+
+        void setRecoveryUnit(SkipListRecoveryUnit* ru) {
+            _ru = ru;
+        }
+
+    private:
+        bool _settle(Node* node);
+
+        SkipList* const _list;
+        SkipListRecoveryUnit* _ru;
+        const bool _forward;
+        Node* _node = nullptr;
+        const Version* _version = nullptr;
+        SnapshotId _snapshotId;
+        std::string _key;  // Copied so that the position survives the end of the snapshot.
+    };
+
+    static const int kMaxHeight = 12;
+
+    explicit SkipList(SkipListTransactionManager* txnManager);
+    ~SkipList();
+
+    /**
+     * Finds the value of 'key' visible to 'ru'. Returns false if there is none. The value is
+     * valid until the snapshot is closed.
+     */
+    bool find(SkipListRecoveryUnit* ru, StringData key, StringData* value);
+
+    /**
+     * Writes 'key' in the transaction of 'ru'. These throw WriteConflictException if another
+     * transaction wrote 'key' and has not committed, or committed after the snapshot of 'ru'
+     * was opened.
+     *
+     * insert() does nothing and returns false if 'key' has a visible value. update() and
+     * remove() do nothing and return false if it does not.
+     */
+    bool insert(SkipListRecoveryUnit* ru, StringData key, StringData value);
+    bool update(SkipListRecoveryUnit* ru, StringData key, StringData value);
+    bool remove(SkipListRecoveryUnit* ru, StringData key);
+
+    /**
+     * Removes 'version', the newest Version of 'node', when its transaction aborts.
+     */
+    void rollbackVersion(Node* node, Version* version);
+
+    /**
+     * Removes Versions and Nodes that no snapshot can see anymore. Only one thread may collect
+     * garbage in a SkipList at a time.
+     */
+    void collectGarbage(SkipListTransactionManager::Slot* slot);
+
+    /**
+     * Returns the bytes held by this SkipList, including garbage that has not been collected.
+     */
+    int64_t getMemoryUsed() const {
+        return _memoryUsed.load();
+    }
+
+    SkipListTransactionManager* getTransactionManager() const {
+        return _txnManager;
+    }
+
+private:
+    enum class WriteMode { kInsert, kUpdate, kRemove };
+
+    bool _write(SkipListRecoveryUnit* ru, StringData key, StringData value, WriteMode mode);
+
+    /**
+     * Fills 'preds' and 'succs' with the last node before 'key' and the first node at or after
+     * it on every level, unlinking removed nodes on the way. A null 'key' sorts after every
+     * other key. Returns the node for 'key' if there is one.
+     */
+    Node* _find(const StringData* key, Node** preds, Node** succs);
+
+    /**
+     * Returns the Node after 'node' on level 0, or the last Node before 'key', or nullptr.
+     */
+    Node* _next(Node* node);
+    Node* _lastBefore(const StringData* key);
+
+    Node* _link(StringData key, Version* version, Node** preds, Node** succs);
+    void _unlink(Node* node);
+
+    void _collectNodeGarbage(Node* node, uint64_t oldestReadTimestamp);
+
+    int _randomHeight();
+
+    void _retireVersion(Version* version);
+    void _retireNode(Node* node);
+
+    SkipListTransactionManager* const _txnManager;
+    Node* const _head;
+    AtomicInt64 _memoryUsed;
+    AtomicUInt64 _randomState;
+
+    // Replaces the Versions of a removed Node so that writers know to retry elsewhere.
+    static Version _removed;
+};
+
+}  // namespace mongo
@@ -0,0 +1,199 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/skiplist/skiplist_engine.h"
+
+#include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/storage/skiplist/skiplist_index.h"
+#include "mongo/db/storage/skiplist/skiplist_record_store.h"
+#include "mongo/db/storage/skiplist/skiplist_recovery_unit.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+namespace {
+
+// How often the background thread collects garbage.
+const Milliseconds kGarbageCollectionInterval(100);
+
+}  // namespace
+
+SkipListEngine::SkipListEngine(int64_t memoryLimitBytes)
+    : _txnManager(memoryLimitBytes),
+      _snapshotManager(stdx::make_unique<SkipListSnapshotManager>(&_txnManager)) {
+    _gcThread = stdx::thread(stdx::bind(&SkipListEngine::_garbageCollectorThread, this));
+}
+
+SkipListEngine::~SkipListEngine() {
+    cleanShutdown();
+}
+
+RecoveryUnit* SkipListEngine::newRecoveryUnit() {
+    return new SkipListRecoveryUnit(&_txnManager, _snapshotManager.get());
+}
+
+Status SkipListEngine::createRecordStore(OperationContext* opCtx,
+                                         StringData ns,
+                                         StringData ident,
+                                         const CollectionOptions& options) {
+    // All work done in getRecordStore
+    return Status::OK();
+}
+
+RecordStore* SkipListEngine::getRecordStore(OperationContext* opCtx,
+                                            StringData ns,
+                                            StringData ident,
+                                            const CollectionOptions& options) {
+    std::shared_ptr<SkipList> list = _getList(ident);
+    if (options.capped) {
+        return new SkipListRecordStore(ns,
+                                       std::move(list),
+                                       true,
+                                       options.cappedSize ? options.cappedSize : 4096,
+                                       options.cappedMaxDocs ? options.cappedMaxDocs : -1);
+    } else {
+        return new SkipListRecordStore(ns, std::move(list));
+    }
+}
+
+Status SkipListEngine::createSortedDataInterface(OperationContext* opCtx,
+                                                 StringData ident,
+                                                 const IndexDescriptor* desc) {
+    // All work done in getSortedDataInterface
+    return Status::OK();
+}
+
+SortedDataInterface* SkipListEngine::getSortedDataInterface(OperationContext* opCtx,
+                                                            StringData ident,
+                                                            const IndexDescriptor* desc) {
+    std::shared_ptr<SkipList> list = _getList(ident);
+    const Ordering ordering = Ordering::make(desc->keyPattern());
+    if (desc->unique()) {
+        return new SkipListIndexUnique(
+            std::move(list), ordering, desc->parentNS(), desc->indexName());
+    }
+    return new SkipListIndexStandard(
+        std::move(list), ordering, desc->parentNS(), desc->indexName());
+}
+
+Status SkipListEngine::dropIdent(OperationContext* opCtx, StringData ident) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _lists.erase(ident);
+    return Status::OK();
+}
+
+int64_t SkipListEngine::getIdentSize(OperationContext* opCtx, StringData ident) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _lists.find(ident);
+    return it == _lists.end() ? 0 : it->second->getMemoryUsed();
+}
+
+bool SkipListEngine::hasIdent(OperationContext* opCtx, StringData ident) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _lists.find(ident) != _lists.end();
+}
+
+std::vector<std::string> SkipListEngine::getAllIdents(OperationContext* opCtx) const {
+    std::vector<std::string> all;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (auto it = _lists.begin(); it != _lists.end(); ++it) {
+            all.push_back(it->first);
+        }
+    }
+    return all;
+}
+
+void SkipListEngine::cleanShutdown() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_gcMutex);
+        if (_shuttingDown)
+            return;
+        _shuttingDown = true;
+        _shutdownCV.notify_one();
+    }
+    _gcThread.join();
+}
+
+std::shared_ptr<SkipList> SkipListEngine::_getList(StringData ident) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    std::shared_ptr<SkipList>& list = _lists[ident];
+    if (!list)
+        list = std::make_shared<SkipList>(&_txnManager);
+    return list;
+}
+
+void SkipListEngine::collectGarbage() {
+    stdx::lock_guard<stdx::mutex> collectLk(_collectMutex);
+
+    std::vector<std::shared_ptr<SkipList>> lists;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (auto it = _lists.begin(); it != _lists.end(); ++it) {
+            lists.push_back(it->second);
+        }
+    }
+
+    SkipListTransactionManager::Slot* slot = _txnManager.acquireSlot();
+    for (auto&& list : lists) {
+        list->collectGarbage(slot);
+    }
+    _txnManager.releaseSlot(slot);
+
+    _txnManager.reclaim();
+}
+
+void SkipListEngine::_garbageCollectorThread() {
+    setThreadName("SkipListGC");
+    LOG(1) << "starting skiplist garbage collector thread";
+
+    while (true) {
+        collectGarbage();
+
+        stdx::unique_lock<stdx::mutex> lk(_gcMutex);
+        if (_shuttingDown)
+            break;
+        _shutdownCV.wait_for(lk, kGarbageCollectionInterval);
+        if (_shuttingDown)
+            break;
+    }
+
+    LOG(1) << "stopping skiplist garbage collector thread";
+}
+
+}  // namespace mongo
@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/db/storage/kv/kv_engine.h"
+#include "mongo/db/storage/skiplist/skiplist.h"
+#include "mongo/db/storage/skiplist/skiplist_snapshot_manager.h"
+#include "mongo/db/storage/skiplist/skiplist_transaction_manager.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+/**
+ * An in-memory KVEngine that supports document-level concurrency. Every ident is a SkipList
+ * that readers and writers access without locks, see SkipList and SkipListTransactionManager.
+ *
+ * A background thread removes versions that no snapshot can see anymore and frees the memory
+ * that readers can no longer reach.
+ */
+class SkipListEngine final : public KVEngine {
+public:
+    /**
+     * A 'memoryLimitBytes' of 0 means unlimited.
+     */
+    explicit SkipListEngine(int64_t memoryLimitBytes = 0);
+    ~SkipListEngine() final;
+
+    RecoveryUnit* newRecoveryUnit() final;
+
+    Status createRecordStore(OperationContext* opCtx,
+                             StringData ns,
+                             StringData ident,
+                             const CollectionOptions& options) final;
+
+    RecordStore* getRecordStore(OperationContext* opCtx,
+                                StringData ns,
+                                StringData ident,
+                                const CollectionOptions& options) final;
+
+    Status createSortedDataInterface(OperationContext* opCtx,
+                                     StringData ident,
+                                     const IndexDescriptor* desc) final;
+
+    SortedDataInterface* getSortedDataInterface(OperationContext* opCtx,
+                                                StringData ident,
+                                                const IndexDescriptor* desc) final;
+
+    Status dropIdent(OperationContext* opCtx, StringData ident) final;
+
+    bool supportsDocLocking() const final {
+        return true;
+    }
+
+    bool supportsDirectoryPerDB() const final {
+        return false;
+    }
+
+    /**
+     * This is sort of strange since "durable" has no meaning...
+     */
+    bool isDurable() const final {
+        return true;
+    }
+
+    int64_t getIdentSize(OperationContext* opCtx, StringData ident) final;
+
+    Status repairIdent(OperationContext* opCtx, StringData ident) final {
+        return Status::OK();
+    }
+
+    void cleanShutdown() final;
+
+    bool hasIdent(OperationContext* opCtx, StringData ident) const final;
+
+    std::vector<std::string> getAllIdents(OperationContext* opCtx) const final;
+
+    SnapshotManager* getSnapshotManager() const final {
+        return _snapshotManager.get();
+    }
+
+    // ---- skiplist specific
+
+    /**
+     * Removes what no snapshot can see anymore from every ident and frees the memory that no
+     * reader can reach. The background thread calls this periodically.
+     */
+    void collectGarbage();
+
+    SkipListTransactionManager* getTransactionManager() {
+        return &_txnManager;
+    }
+
+private:
+    void _garbageCollectorThread();
+
+    std::shared_ptr<SkipList> _getList(StringData ident);
+
+    // Declared first so that it outlives the lists whose memory it tracks.
+    SkipListTransactionManager _txnManager;
+    const std::unique_ptr<SkipListSnapshotManager> _snapshotManager;
+
+    mutable stdx::mutex _mutex;  // Guards _lists.
+    StringMap<std::shared_ptr<SkipList>> _lists;
+
+    stdx::mutex _collectMutex;  // Serializes collectGarbage().
+
+    stdx::mutex _gcMutex;  // Guards _shuttingDown.
+    stdx::condition_variable _shutdownCV;
+    bool _shuttingDown = false;
+    stdx::thread _gcThread;
+};
+
+}  // namespace mongo
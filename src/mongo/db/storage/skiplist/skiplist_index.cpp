@@ -0,0 +1,751 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/skiplist/skiplist_index.h"
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/db/storage/skiplist/skiplist_recovery_unit.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+static const int TempKeyMaxSize = 1024;  // this goes away with SERVER-3372
+
+bool hasFieldNames(const BSONObj& obj) {
+    BSONForEach(e, obj) {
+        if (e.fieldName()[0])
+            return true;
+    }
+    return false;
+}
+
+BSONObj stripFieldNames(const BSONObj& query) {
+    if (!hasFieldNames(query))
+        return query;
+
+    BSONObjBuilder bb;
+    BSONForEach(e, query) {
+        bb.appendAs(e, StringData());
+    }
+    return bb.obj();
+}
+
+Status checkKeySize(const BSONObj& key) {
+    if (key.objsize() >= TempKeyMaxSize) {
+        std::string msg = mongoutils::str::stream()
+            << "SkipListIndex::insert: key too large to index, failing " << ' ' << key.objsize()
+            << ' ' << key;
+        return Status(ErrorCodes::KeyTooLong, msg);
+    }
+    return Status::OK();
+}
+
+StringData toStringData(const KeyString& keyString) {
+    return StringData(keyString.getBuffer(), keyString.getSize());
+}
+
+StringData typeBitsToStringData(const KeyString::TypeBits& typeBits) {
+    if (typeBits.isAllZeros())
+        return StringData();
+    return StringData(reinterpret_cast<const char*>(typeBits.getBuffer()), typeBits.getSize());
+}
+
+/**
+ * Builds the value of a unique index entry from the RecordIds and TypeBits of its records.
+ */
+void makeUniqueValue(const std::vector<std::pair<RecordId, KeyString::TypeBits>>& records,
+                     KeyString* value) {
+    for (size_t i = 0; i < records.size(); i++) {
+        value->appendRecordId(records[i].first);
+        // When there is only one record, we can omit AllZeros TypeBits. Otherwise they need
+        // to be included.
+        if (!(records[i].second.isAllZeros() && records.size() == 1)) {
+            value->appendTypeBits(records[i].second);
+        }
+    }
+}
+
+}  // namespace
+
+SkipListIndex::SkipListIndex(std::shared_ptr<SkipList> list,
+                             const Ordering& ordering,
+                             StringData collectionNamespace,
+                             StringData indexName)
+    : _list(std::move(list)),
+      _ordering(ordering),
+      _collectionNamespace(collectionNamespace.toString()),
+      _indexName(indexName.toString()) {}
+
+Status SkipListIndex::dupKeyError(const BSONObj& key) {
+    StringBuilder sb;
+    sb << "E11000 duplicate key error";
+    sb << " collection: " << _collectionNamespace;
+    sb << " index: " << _indexName;
+    sb << " dup key: " << key;
+    return Status(ErrorCodes::DuplicateKey, sb.str());
+}
+
+Status SkipListIndex::insert(OperationContext* txn,
+                             const BSONObj& key,
+                             const RecordId& loc,
+                             bool dupsAllowed) {
+    invariant(loc.isNormal());
+    dassert(!hasFieldNames(key));
+
+    Status s = checkKeySize(key);
+    if (!s.isOK())
+        return s;
+
+    s = _list->getTransactionManager()->checkMemoryLimit();
+    if (!s.isOK())
+        return s;
+
+    return _insert(SkipListRecoveryUnit::get(txn), key, loc, dupsAllowed);
+}
+
+void SkipListIndex::unindex(OperationContext* txn,
+                            const BSONObj& key,
+                            const RecordId& loc,
+                            bool dupsAllowed) {
+    invariant(loc.isNormal());
+    dassert(!hasFieldNames(key));
+
+    _unindex(SkipListRecoveryUnit::get(txn), key, loc, dupsAllowed);
+}
+
+void SkipListIndex::fullValidate(OperationContext* txn,
+                                 bool full,
+                                 long long* numKeysOut,
+                                 BSONObjBuilder* output) const {
+    if (output)
+        *output << "valid" << true;
+
+    auto cursor = newCursor(txn);
+    long long count = 0;
+    for (auto kv = cursor->seek(BSONObj(), true, Cursor::kJustExistance); kv;
+         kv = cursor->next(Cursor::kJustExistance)) {
+        count++;
+    }
+
+    if (numKeysOut) {
+        *numKeysOut = count;
+    }
+}
+
+bool SkipListIndex::appendCustomStats(OperationContext* txn,
+                                      BSONObjBuilder* output,
+                                      double scale) const {
+    return false;
+}
+
+Status SkipListIndex::dupKeyCheck(OperationContext* txn,
+                                  const BSONObj& key,
+                                  const RecordId& loc) {
+    invariant(!hasFieldNames(key));
+    invariant(unique());
+
+    // First check whether the key exists.
+    const KeyString data(key, _ordering);
+    StringData value;
+    if (!_list->find(SkipListRecoveryUnit::get(txn), toStringData(data), &value))
+        return Status::OK();
+
+    // If the key exists, check if we already have this loc at this key. If so, we don't
+    // consider that to be a dup.
+    BufReader br(value.rawData(), value.size());
+    while (br.remaining()) {
+        if (KeyString::decodeRecordId(&br) == loc)
+            return Status::OK();
+
+        KeyString::TypeBits::fromBuffer(&br);  // Just calling this to advance reader.
+    }
+    return dupKeyError(key);
+}
+
+bool SkipListIndex::isEmpty(OperationContext* txn) {
+    SkipList::Cursor cursor(_list.get(), SkipListRecoveryUnit::get(txn), true);
+    return !cursor.seekToStart();
+}
+
+long long SkipListIndex::getSpaceUsedBytes(OperationContext* txn) const {
+    return _list->getMemoryUsed();
+}
+
+Status SkipListIndex::initAsEmpty(OperationContext* txn) {
+    // No-op
+    return Status::OK();
+}
+
+/**
+ * Bulk builds a non-unique index.
+ *
+ * There is no faster way to load a SkipList than inserting into it, so this only defers
+ * committing the inserts to commit().
+ */
+class SkipListIndex::StandardBulkBuilder : public SortedDataBuilderInterface {
+public:
+    StandardBulkBuilder(SkipListIndex* idx, OperationContext* txn) : _idx(idx), _txn(txn) {}
+
+    Status addKey(const BSONObj& key, const RecordId& loc) {
+        return _idx->insert(_txn, key, loc, true);
+    }
+
+    void commit(bool mayInterrupt) {
+        // this is bizarre, but required as part of the contract
+        WriteUnitOfWork uow(_txn);
+        uow.commit();
+    }
+
+private:
+    SkipListIndex* const _idx;
+    OperationContext* const _txn;
+};
+
+/**
+ * Bulk builds a unique index.
+ *
+ * In order to support unique indexes in dupsAllowed mode this class only does an actual insert
+ * after it sees a key after the one we are trying to insert. This allows us to gather up all
+ * duplicate locs and insert them all together.
+ */
+class SkipListIndex::UniqueBulkBuilder : public SortedDataBuilderInterface {
+public:
+    UniqueBulkBuilder(SkipListIndex* idx, OperationContext* txn, bool dupsAllowed)
+        : _idx(idx), _txn(txn), _dupsAllowed(dupsAllowed) {}
+
+    Status addKey(const BSONObj& newKey, const RecordId& loc) {
+        {
+            const Status s = checkKeySize(newKey);
+            if (!s.isOK())
+                return s;
+        }
+
+        const int cmp = newKey.woCompare(_key, _idx->ordering());
+        if (cmp != 0) {
+            if (!_key.isEmpty()) {   // _key.isEmpty() is only true on the first call to addKey().
+                invariant(cmp > 0);  // newKey must be > the last key
+                // We are done with dups of the last key so we can insert it now.
+                doInsert();
+            }
+            invariant(_records.empty());
+        } else {
+            // Dup found!
+            if (!_dupsAllowed) {
+                return _idx->dupKeyError(newKey);
+            }
+
+            // If we get here, we are in the weird mode where dups are allowed on a unique
+            // index, so add ourselves to the list of duplicate locs. This also replaces the
+            // _key which is correct since any dups seen later are likely to be newer.
+        }
+
+        _key = newKey.getOwned();
+        _keyString.resetToKey(_key, _idx->ordering());
+        _records.push_back(std::make_pair(loc, _keyString.getTypeBits()));
+
+        return Status::OK();
+    }
+
+    void commit(bool mayInterrupt) {
+        WriteUnitOfWork uow(_txn);
+        if (!_records.empty()) {
+            // This handles inserting the last unique key.
+            doInsert();
+        }
+        uow.commit();
+    }
+
+private:
+    void doInsert() {
+        invariant(!_records.empty());
+
+        KeyString value;
+        makeUniqueValue(_records, &value);
+        invariant(_idx->list()->insert(
+            SkipListRecoveryUnit::get(_txn), toStringData(_keyString), toStringData(value)));
+
+        _records.clear();
+    }
+
+    SkipListIndex* const _idx;
+    OperationContext* const _txn;
+    const bool _dupsAllowed;
+    BSONObj _key;
+    KeyString _keyString;
+    std::vector<std::pair<RecordId, KeyString::TypeBits>> _records;
+};
+
+namespace {
+
+/**
+ * Implements the basic cursor functionality used by both unique and standard indexes.
+ */
+class SkipListIndexCursorBase : public SortedDataInterface::Cursor {
+public:
+    SkipListIndexCursorBase(const SkipListIndex& idx, OperationContext* txn, bool forward)
+        : _txn(txn),
+          _cursor(idx.list(), SkipListRecoveryUnit::get(txn), forward),
+          _idx(idx),
+          _forward(forward) {}
+
+    boost::optional<IndexKeyEntry> next(RequestedInfo parts) override {
+        // Advance on a cursor at the end is a no-op
+        if (_eof)
+            return {};
+
+        if (!_lastMoveWasRestore)
+            advanceCursor();
+        updatePosition();
+        return curr(parts);
+    }
+
+    void setEndPosition(const BSONObj& key, bool inclusive) override {
+        if (key.isEmpty()) {
+            // This means scan to end of index.
+            _endPosition.reset();
+            return;
+        }
+
+        // NOTE: this uses the opposite rules as a normal seek because a forward scan should
+        // end after the key if inclusive and before if exclusive.
+        const auto discriminator =
+            _forward == inclusive ? KeyString::kExclusiveAfter : KeyString::kExclusiveBefore;
+        _endPosition = stdx::make_unique<KeyString>();
+        _endPosition->resetToKey(stripFieldNames(key), _idx.ordering(), discriminator);
+    }
+
+    boost::optional<IndexKeyEntry> seek(const BSONObj& key,
+                                        bool inclusive,
+                                        RequestedInfo parts) override {
+        const BSONObj finalKey = stripFieldNames(key);
+        const auto discriminator =
+            _forward == inclusive ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
+
+        // By using a discriminator other than kInclusive, there is no need to distinguish
+        // unique vs non-unique key formats since both start with the key.
+        _query.resetToKey(finalKey, _idx.ordering(), discriminator);
+        seekCursor(_query);
+        updatePosition();
+        return curr(parts);
+    }
+
+    boost::optional<IndexKeyEntry> seek(const IndexSeekPoint& seekPoint,
+                                        RequestedInfo parts) override {
+        // TODO: don't go to a bson obj then to a KeyString, go straight
+        BSONObj key = IndexEntryComparison::makeQueryObject(seekPoint, _forward);
+
+        // makeQueryObject handles the discriminator in the real exclusive cases.
+        const auto discriminator =
+            _forward ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
+        _query.resetToKey(key, _idx.ordering(), discriminator);
+        seekCursor(_query);
+        updatePosition();
+        return curr(parts);
+    }
+
+    void savePositioned() override {
+        // Our saved position is wherever we were when we last called updatePosition().
+        // Any partially completed repositions should not effect our saved position.
+    }
+
+    void saveUnpositioned() override {
+        savePositioned();
+        _eof = true;
+    }
+
+    void restore() override {
+        _cursor.setRecoveryUnit(SkipListRecoveryUnit::get(_txn));
+
+        if (!_eof) {
+            _lastMoveWasRestore = !seekCursor(_key);
+        }
+    }
+
+    void detachFromOperationContext() final {
+        _txn = nullptr;
+    }
+
+    void reattachToOperationContext(OperationContext* txn) final {
+        _txn = txn;
+        // The RecoveryUnit is picked up in restore().
+    }
+
+protected:
+    // Called after _key has been filled in.
+    virtual void updateLocAndTypeBits() = 0;
+
+    boost::optional<IndexKeyEntry> curr(RequestedInfo parts) const {
+        if (_eof)
+            return {};
+
+        dassert(!atOrPastEndPointAfterSeeking());
+        dassert(!_loc.isNull());
+
+        BSONObj bson;
+        if (parts & kWantKey) {
+            bson = KeyString::toBson(_key.getBuffer(), _key.getSize(), _idx.ordering(), _typeBits);
+        }
+
+        return {{std::move(bson), _loc}};
+    }
+
+    bool atOrPastEndPointAfterSeeking() const {
+        if (_eof)
+            return true;
+        if (!_endPosition)
+            return false;
+
+        const int cmp = _key.compare(*_endPosition);
+
+        // We set up _endPosition to be in between the last in-range value and the first
+        // out-of-range value. In particular, it is constructed to never equal any legal index
+        // key.
+        dassert(cmp != 0);
+
+        if (_forward) {
+            // We may have landed after the end point.
+            return cmp > 0;
+        } else {
+            // We may have landed before the end point.
+            return cmp < 0;
+        }
+    }
+
+    void advanceCursor() {
+        _cursorAtEof = !_cursor.next();
+    }
+
+    // Seeks to query. Returns true on exact match.
+    bool seekCursor(const KeyString& query) {
+        _cursorAtEof = !_cursor.seek(toStringData(query));
+        return !_cursorAtEof && _cursor.key() == toStringData(query);
+    }
+
+    /**
+     * This must be called after moving the cursor to update our cached position. It should not
+     * be called after a restore that did not restore to original state since that does not
+     * logically move the cursor until the following call to next().
+     */
+    void updatePosition() {
+        _lastMoveWasRestore = false;
+        if (_cursorAtEof) {
+            _eof = true;
+            _loc = RecordId();
+            return;
+        }
+
+        _eof = false;
+
+        const StringData key = _cursor.key();
+        _key.resetFromBuffer(key.rawData(), key.size());
+
+        if (atOrPastEndPointAfterSeeking()) {
+            _eof = true;
+            return;
+        }
+
+        updateLocAndTypeBits();
+    }
+
+    OperationContext* _txn;
+    SkipList::Cursor _cursor;
+    const SkipListIndex& _idx;  // not owned
+    const bool _forward;
+
+    // These are where this cursor instance is. They are not changed in the face of a failing
+    // next().
+    KeyString _key;
+    KeyString::TypeBits _typeBits;
+    RecordId _loc;
+    bool _eof = false;
+
+    // This differs from _eof in that it always reflects the result of the most recent call to
+    // reposition _cursor.
+    bool _cursorAtEof = false;
+
+    // Used by next to decide to return current position rather than moving. Should be reset to
+    // false by any operation that moves the cursor, other than subsequent save/restore pairs.
+    bool _lastMoveWasRestore = false;
+
+    KeyString _query;
+
+    std::unique_ptr<KeyString> _endPosition;
+};
+
+class SkipListIndexStandardCursor final : public SkipListIndexCursorBase {
+public:
+    SkipListIndexStandardCursor(const SkipListIndex& idx, OperationContext* txn, bool forward)
+        : SkipListIndexCursorBase(idx, txn, forward) {}
+
+    void updateLocAndTypeBits() override {
+        _loc = KeyString::decodeRecordIdAtEnd(_key.getBuffer(), _key.getSize());
+
+        const StringData value = _cursor.value();
+        BufReader br(value.rawData(), value.size());
+        _typeBits.resetFromBuffer(&br);
+    }
+};
+
+class SkipListIndexUniqueCursor final : public SkipListIndexCursorBase {
+public:
+    SkipListIndexUniqueCursor(const SkipListIndex& idx, OperationContext* txn, bool forward)
+        : SkipListIndexCursorBase(idx, txn, forward) {}
+
+    void restore() override {
+        SkipListIndexCursorBase::restore();
+
+        // In addition to seeking to the correct key, we also need to make sure that the loc is
+        // on the correct side of _loc.
+        if (_lastMoveWasRestore)
+            return;  // We are on a different key so no need to check loc.
+        if (_eof)
+            return;
+
+        // If we get here we need to look at the actual RecordId for this key and make sure we
+        // are supposed to see it.
+        const StringData value = _cursor.value();
+        BufReader br(value.rawData(), value.size());
+        RecordId locInIndex = KeyString::decodeRecordId(&br);
+
+        if (locInIndex == _loc)
+            return;
+
+        _lastMoveWasRestore = true;
+        if (_forward && (locInIndex < _loc))
+            advanceCursor();
+        if (!_forward && (locInIndex > _loc))
+            advanceCursor();
+    }
+
+    void updateLocAndTypeBits() override {
+        // We assume that cursors can only ever see unique indexes in their "pristine" state,
+        // where no duplicates are possible. The cases where dups are allowed should hold
+        // sufficient locks to ensure that no cursor ever sees them.
+        const StringData value = _cursor.value();
+        BufReader br(value.rawData(), value.size());
+        _loc = KeyString::decodeRecordId(&br);
+        _typeBits.resetFromBuffer(&br);
+
+        if (!br.atEof()) {
+            severe() << "Unique index cursor seeing multiple records for key "
+                     << curr(kWantKey)->key;
+            fassertFailed(28784);
+        }
+    }
+
+    boost::optional<IndexKeyEntry> seekExact(const BSONObj& key, RequestedInfo parts) override {
+        _query.resetToKey(stripFieldNames(key), _idx.ordering());
+        if (!seekCursor(_query))
+            _cursorAtEof = true;
+        updatePosition();
+        dassert(_eof || _key.compare(_query) == 0);
+        return curr(parts);
+    }
+};
+
+}  // namespace
+
+SkipListIndexUnique::SkipListIndexUnique(std::shared_ptr<SkipList> list,
+                                         const Ordering& ordering,
+                                         StringData collectionNamespace,
+                                         StringData indexName)
+    : SkipListIndex(std::move(list), ordering, collectionNamespace, indexName) {}
+
+std::unique_ptr<SortedDataInterface::Cursor> SkipListIndexUnique::newCursor(OperationContext* txn,
+                                                                            bool forward) const {
+    return stdx::make_unique<SkipListIndexUniqueCursor>(*this, txn, forward);
+}
+
+SortedDataBuilderInterface* SkipListIndexUnique::getBulkBuilder(OperationContext* txn,
+                                                                bool dupsAllowed) {
+    return new UniqueBulkBuilder(this, txn, dupsAllowed);
+}
+
+Status SkipListIndexUnique::_insert(SkipListRecoveryUnit* ru,
+                                    const BSONObj& key,
+                                    const RecordId& loc,
+                                    bool dupsAllowed) {
+    const KeyString data(key, _ordering);
+
+    KeyString value(loc);
+    if (!data.getTypeBits().isAllZeros())
+        value.appendTypeBits(data.getTypeBits());
+
+    if (_list->insert(ru, toStringData(data), toStringData(value)))
+        return Status::OK();
+
+    // we might be in weird mode where there might be multiple values
+    // we put them all in the "list"
+    // Note that we can't omit AllZeros when there are multiple locs for a value. When we remove
+    // down to a single value, it will be cleaned up.
+    StringData old;
+    invariant(_list->find(ru, toStringData(data), &old));
+
+    bool insertedLoc = false;
+
+    value.resetToEmpty();
+    BufReader br(old.rawData(), old.size());
+    while (br.remaining()) {
+        RecordId locInIndex = KeyString::decodeRecordId(&br);
+        if (loc == locInIndex)
+            return Status::OK();  // already in index
+
+        if (!insertedLoc && loc < locInIndex) {
+            value.appendRecordId(loc);
+            value.appendTypeBits(data.getTypeBits());
+            insertedLoc = true;
+        }
+
+        // Copy from old to new value
+        value.appendRecordId(locInIndex);
+        value.appendTypeBits(KeyString::TypeBits::fromBuffer(&br));
+    }
+
+    if (!dupsAllowed)
+        return dupKeyError(key);
+
+    if (!insertedLoc) {
+        // This loc is higher than all currently in the index for this key
+        value.appendRecordId(loc);
+        value.appendTypeBits(data.getTypeBits());
+    }
+
+    invariant(_list->update(ru, toStringData(data), toStringData(value)));
+    return Status::OK();
+}
+
+void SkipListIndexUnique::_unindex(SkipListRecoveryUnit* ru,
+                                   const BSONObj& key,
+                                   const RecordId& loc,
+                                   bool dupsAllowed) {
+    const KeyString data(key, _ordering);
+
+    if (!dupsAllowed) {
+        // nice and clear
+        _list->remove(ru, toStringData(data));
+        return;
+    }
+
+    // dups are allowed, so we have to deal with a vector of RecordIds.
+
+    StringData old;
+    if (!_list->find(ru, toStringData(data), &old))
+        return;
+
+    bool foundLoc = false;
+    std::vector<std::pair<RecordId, KeyString::TypeBits>> records;
+
+    BufReader br(old.rawData(), old.size());
+    while (br.remaining()) {
+        RecordId locInIndex = KeyString::decodeRecordId(&br);
+        KeyString::TypeBits typeBits = KeyString::TypeBits::fromBuffer(&br);
+
+        if (loc == locInIndex) {
+            if (records.empty() && !br.remaining()) {
+                // This is the common case: we are removing the only loc for this key.
+                // Remove the whole entry.
+                invariant(_list->remove(ru, toStringData(data)));
+                return;
+            }
+
+            foundLoc = true;
+            continue;
+        }
+
+        records.push_back(std::make_pair(locInIndex, typeBits));
+    }
+
+    if (!foundLoc) {
+        warning().stream() << loc << " not found in the index for key " << key;
+        return;  // nothing to do
+    }
+
+    // Put other locs for this key back in the index.
+    invariant(!records.empty());
+    KeyString value;
+    makeUniqueValue(records, &value);
+    invariant(_list->update(ru, toStringData(data), toStringData(value)));
+}
+
+// ------------------------------
+
+SkipListIndexStandard::SkipListIndexStandard(std::shared_ptr<SkipList> list,
+                                             const Ordering& ordering,
+                                             StringData collectionNamespace,
+                                             StringData indexName)
+    : SkipListIndex(std::move(list), ordering, collectionNamespace, indexName) {}
+
+std::unique_ptr<SortedDataInterface::Cursor> SkipListIndexStandard::newCursor(
+    OperationContext* txn, bool forward) const {
+    return stdx::make_unique<SkipListIndexStandardCursor>(*this, txn, forward);
+}
+
+SortedDataBuilderInterface* SkipListIndexStandard::getBulkBuilder(OperationContext* txn,
+                                                                  bool dupsAllowed) {
+    // We aren't unique so dups better be allowed.
+    invariant(dupsAllowed);
+    return new StandardBulkBuilder(this, txn);
+}
+
+Status SkipListIndexStandard::_insert(SkipListRecoveryUnit* ru,
+                                      const BSONObj& keyBson,
+                                      const RecordId& loc,
+                                      bool dupsAllowed) {
+    invariant(dupsAllowed);
+
+    const KeyString key(keyBson, _ordering, loc);
+
+    // If the record was already in the index, we just return OK.
+    // This can happen, for example, when building a background index while documents are being
+    // written and reindexed.
+    _list->insert(ru, toStringData(key), typeBitsToStringData(key.getTypeBits()));
+    return Status::OK();
+}
+
+void SkipListIndexStandard::_unindex(SkipListRecoveryUnit* ru,
+                                     const BSONObj& key,
+                                     const RecordId& loc,
+                                     bool dupsAllowed) {
+    invariant(dupsAllowed);
+    const KeyString data(key, _ordering, loc);
+    _list->remove(ru, toStringData(data));
+}
+
+}  // namespace mongo
@@ -0,0 +1,169 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "mongo/bson/ordering.h"
+#include "mongo/db/storage/skiplist/skiplist.h"
+#include "mongo/db/storage/sorted_data_interface.h"
+
+namespace mongo {
+
+class SkipListRecoveryUnit;
+
+/**
+ * A SortedDataInterface that keeps its entries in a SkipList, in the same formats as the
+ * WiredTiger indexes use.
+ */
+class SkipListIndex : public SortedDataInterface {
+public:
+    SkipListIndex(std::shared_ptr<SkipList> list,
+                  const Ordering& ordering,
+                  StringData collectionNamespace,
+                  StringData indexName);
+
+    Status insert(OperationContext* txn,
+                  const BSONObj& key,
+                  const RecordId& loc,
+                  bool dupsAllowed) override;
+
+    void unindex(OperationContext* txn,
+                 const BSONObj& key,
+                 const RecordId& loc,
+                 bool dupsAllowed) override;
+
+    void fullValidate(OperationContext* txn,
+                      bool full,
+                      long long* numKeysOut,
+                      BSONObjBuilder* output) const override;
+
+    bool appendCustomStats(OperationContext* txn,
+                           BSONObjBuilder* output,
+                           double scale) const override;
+
+    Status dupKeyCheck(OperationContext* txn, const BSONObj& key, const RecordId& loc) override;
+
+    bool isEmpty(OperationContext* txn) override;
+
+    long long getSpaceUsedBytes(OperationContext* txn) const override;
+
+    Status initAsEmpty(OperationContext* txn) override;
+
+    SkipList* list() const {
+        return _list.get();
+    }
+
+    Ordering ordering() const {
+        return _ordering;
+    }
+
+    virtual bool unique() const = 0;
+
+    Status dupKeyError(const BSONObj& key);
+
+protected:
+    virtual Status _insert(SkipListRecoveryUnit* ru,
+                           const BSONObj& key,
+                           const RecordId& loc,
+                           bool dupsAllowed) = 0;
+
+    virtual void _unindex(SkipListRecoveryUnit* ru,
+                          const BSONObj& key,
+                          const RecordId& loc,
+                          bool dupsAllowed) = 0;
+
+    class StandardBulkBuilder;
+    class UniqueBulkBuilder;
+
+    const std::shared_ptr<SkipList> _list;
+    const Ordering _ordering;
+    const std::string _collectionNamespace;
+    const std::string _indexName;
+};
+
+class SkipListIndexUnique final : public SkipListIndex {
+public:
+    SkipListIndexUnique(std::shared_ptr<SkipList> list,
+                        const Ordering& ordering,
+                        StringData collectionNamespace,
+                        StringData indexName);
+
+    std::unique_ptr<SortedDataInterface::Cursor> newCursor(OperationContext* txn,
+                                                           bool forward) const override;
+
+    SortedDataBuilderInterface* getBulkBuilder(OperationContext* txn, bool dupsAllowed) override;
+
+    bool unique() const override {
+        return true;
+    }
+
+protected:
+    Status _insert(SkipListRecoveryUnit* ru,
+                   const BSONObj& key,
+                   const RecordId& loc,
+                   bool dupsAllowed) override;
+
+    void _unindex(SkipListRecoveryUnit* ru,
+                  const BSONObj& key,
+                  const RecordId& loc,
+                  bool dupsAllowed) override;
+};
+
+class SkipListIndexStandard final : public SkipListIndex {
+public:
+    SkipListIndexStandard(std::shared_ptr<SkipList> list,
+                          const Ordering& ordering,
+                          StringData collectionNamespace,
+                          StringData indexName);
+
+    std::unique_ptr<SortedDataInterface::Cursor> newCursor(OperationContext* txn,
+                                                           bool forward) const override;
+
+    SortedDataBuilderInterface* getBulkBuilder(OperationContext* txn, bool dupsAllowed) override;
+
+    bool unique() const override {
+        return false;
+    }
+
+protected:
+    Status _insert(SkipListRecoveryUnit* ru,
+                   const BSONObj& key,
+                   const RecordId& loc,
+                   bool dupsAllowed) override;
+
+    void _unindex(SkipListRecoveryUnit* ru,
+                  const BSONObj& key,
+                  const RecordId& loc,
+                  bool dupsAllowed) override;
+};
+
+}  // namespace mongo
@@ -0,0 +1,71 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/skiplist/skiplist_index.h"
+
+#include "mongo/db/storage/skiplist/skiplist.h"
+#include "mongo/db/storage/skiplist/skiplist_recovery_unit.h"
+#include "mongo/db/storage/skiplist/skiplist_snapshot_manager.h"
+#include "mongo/db/storage/skiplist/skiplist_transaction_manager.h"
+#include "mongo/db/storage/sorted_data_interface_test_harness.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+
+class SkipListHarnessHelper final : public HarnessHelper {
+public:
+    SkipListHarnessHelper() : _snapshotManager(&_txnManager), _order(Ordering::make(BSONObj())) {}
+
+    std::unique_ptr<SortedDataInterface> newSortedDataInterface(bool unique) final {
+        auto list = std::make_shared<SkipList>(&_txnManager);
+        if (unique) {
+            return stdx::make_unique<SkipListIndexUnique>(
+                std::move(list), _order, "test.skiplist", "testIndex");
+        }
+        return stdx::make_unique<SkipListIndexStandard>(
+            std::move(list), _order, "test.skiplist", "testIndex");
+    }
+
+    std::unique_ptr<RecoveryUnit> newRecoveryUnit() final {
+        return stdx::make_unique<SkipListRecoveryUnit>(&_txnManager, &_snapshotManager);
+    }
+
+private:
+    SkipListTransactionManager _txnManager;
+    SkipListSnapshotManager _snapshotManager;
+    Ordering _order;
+};
+
+std::unique_ptr<HarnessHelper> newHarnessHelper() {
+    return stdx::make_unique<SkipListHarnessHelper>();
+}
+}  // namespace mongo
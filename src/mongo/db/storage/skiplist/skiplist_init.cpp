@@ -0,0 +1,100 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/base/init.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/kv/kv_storage_engine.h"
+#include "mongo/db/storage/skiplist/skiplist_engine.h"
+#include "mongo/db/storage_options.h"
+
+namespace mongo {
+
+namespace {
+
+// The most memory, in megabytes, that the engine may use before writes fail with
+// ExceededMemoryLimit. 0 means unlimited.
+int skipListMemoryLimitMB = 0;
+
+class SkipListMemoryLimitMBParameter : public ExportedServerParameter<int> {
+public:
+    SkipListMemoryLimitMBParameter()
+        : ExportedServerParameter<int>(ServerParameterSet::getGlobal(),
+                                       "skipListMemoryLimitMB",
+                                       &skipListMemoryLimitMB,
+                                       true,   // allowedToChangeAtStartup
+                                       false)  // allowedToChangeAtRuntime
+    {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 0) {
+            return Status(ErrorCodes::BadValue, "skipListMemoryLimitMB must not be negative");
+        }
+        return Status::OK();
+    }
+
+} skipListMemoryLimitMBParameter;
+
+class SkipListFactory : public StorageEngine::Factory {
+public:
+    virtual ~SkipListFactory() {}
+    virtual StorageEngine* create(const StorageGlobalParams& params,
+                                  const StorageEngineLockFile& lockFile) const {
+        KVStorageEngineOptions options;
+        options.directoryPerDB = params.directoryperdb;
+        options.forRepair = params.repair;
+        const int64_t memoryLimitBytes = static_cast<int64_t>(skipListMemoryLimitMB) << 20;
+        return new KVStorageEngine(new SkipListEngine(memoryLimitBytes), options);
+    }
+
+    virtual StringData getCanonicalName() const {
+        return "inMemorySkipList";
+    }
+
+    virtual Status validateMetadata(const StorageEngineMetadata& metadata,
+                                    const StorageGlobalParams& params) const {
+        return Status::OK();
+    }
+
+    virtual BSONObj createMetadataOptions(const StorageGlobalParams& params) const {
+        return BSONObj();
+    }
+};
+
+}  // namespace
+
+MONGO_INITIALIZER_WITH_PREREQUISITES(SkipListEngineInit, ("SetGlobalEnvironment"))
+(InitializerContext* context) {
+    getGlobalServiceContext()->registerStorageEngine("inMemorySkipList", new SkipListFactory());
+    return Status::OK();
+}
+
+}  // namespace mongo
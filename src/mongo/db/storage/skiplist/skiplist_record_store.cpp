@@ -0,0 +1,624 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/skiplist/skiplist_record_store.h"
+
+#include "mongo/base/checked_cast.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/db/storage/oplog_hack.h"
+#include "mongo/db/storage/skiplist/skiplist_recovery_unit.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+StringData toStringData(const KeyString& key) {
+    return StringData(key.getBuffer(), key.getSize());
+}
+
+RecordId fromKey(StringData key) {
+    return KeyString::decodeRecordIdAtEnd(key.rawData(), key.size());
+}
+
+}  // namespace
+
+class SkipListRecordStore::Cursor final : public RecordCursor {
+public:
+    Cursor(OperationContext* txn, const SkipListRecordStore& rs, bool forward)
+        : _rs(rs),
+          _txn(txn),
+          _forward(forward),
+          _cursor(rs._list.get(), _getRecoveryUnit(txn), forward) {
+        _updateCappedVisibility();
+    }
+
+    boost::optional<Record> next() final {
+        if (_eof)
+            return {};
+
+        bool positioned;
+        if (_lastReturnedId.isNull()) {
+            if (!_forward && !_lowestHiddenId.isNull()) {
+                // Start from the highest visible record.
+                const KeyString key(_lowestHiddenId);
+                positioned = _cursor.seek(toStringData(key)) &&
+                    (fromKey(_cursor.key()) < _lowestHiddenId || _cursor.next());
+            } else {
+                positioned = _cursor.seekToStart();
+            }
+        } else {
+            positioned = _cursor.next();
+        }
+
+        if (!positioned) {
+            _eof = true;
+            return {};
+        }
+
+        const RecordId id = fromKey(_cursor.key());
+        if (_forward && !_lowestHiddenId.isNull() && id >= _lowestHiddenId) {
+            _eof = true;
+            return {};
+        }
+
+        _lastReturnedId = id;
+        return {{id, _currentData()}};
+    }
+
+    boost::optional<Record> seekExact(const RecordId& id) final {
+        const KeyString key(id);
+        if (!_cursor.seek(toStringData(key)) || fromKey(_cursor.key()) != id) {
+            _cursor.reset();
+            _eof = true;
+            return {};
+        }
+
+        _lastReturnedId = id;
+        _eof = false;
+        return {{id, _currentData()}};
+    }
+
+    void savePositioned() final {}
+
+    void saveUnpositioned() final {
+        _cursor.reset();
+        _lastReturnedId = RecordId();
+    }
+
+    bool restore() final {
+        // Capped visibility must be decided before the snapshot that this cursor reads from next
+        // is opened.
+        _updateCappedVisibility();
+        _cursor.setRecoveryUnit(_getRecoveryUnit(_txn));
+
+        // If we've hit EOF, then this iterator is done and need not be restored.
+        if (_eof)
+            return true;
+
+        if (_lastReturnedId.isNull() || !_rs._isCapped)
+            return true;
+
+        // Doc was deleted either by _cappedDeleteAsNeeded() or temp_cappedTruncateAfter().
+        // It is important that we error out in this case so that consumers don't silently get
+        // 'holes' when scanning capped collections. We don't make this guarantee for normal
+        // collections so it is ok to skip ahead in that case.
+        RecordData unused;
+        if (!_rs.findRecord(_txn, _lastReturnedId, &unused)) {
+            _eof = true;
+            return false;
+        }
+        return true;
+    }
+
+    void detachFromOperationContext() final {
+        _txn = nullptr;
+    }
+
+    void reattachToOperationContext(OperationContext* txn) final {
+        _txn = txn;
+        // The RecoveryUnit is picked up in restore().
+    }
+
+private:
+    RecordData _currentData() const {
+        const StringData value = _cursor.value();
+        RecordData data(value.rawData(), value.size());
+        data.makeOwned();  // The value is only valid until the snapshot is closed.
+        return data;
+    }
+
+    void _updateCappedVisibility() {
+        if (_rs._isCapped)
+            _lowestHiddenId = _rs._lowestCappedHiddenRecord();
+    }
+
+    const SkipListRecordStore& _rs;
+    OperationContext* _txn;
+    const bool _forward;
+    SkipList::Cursor _cursor;
+    bool _eof = false;
+    RecordId _lastReturnedId;  // If null, need to seek to first/last record.
+    RecordId _lowestHiddenId;  // If not null, capped records from here on are not visible.
+};
+
+class SkipListRecordStore::NumRecordsChange : public RecoveryUnit::Change {
+public:
+    NumRecordsChange(SkipListRecordStore* rs, int64_t diff) : _rs(rs), _diff(diff) {}
+    virtual void commit() {}
+    virtual void rollback() {
+        _rs->_numRecords.fetchAndAdd(-_diff);
+    }
+
+private:
+    SkipListRecordStore* _rs;
+    int64_t _diff;
+};
+
+class SkipListRecordStore::DataSizeChange : public RecoveryUnit::Change {
+public:
+    DataSizeChange(SkipListRecordStore* rs, int64_t amount) : _rs(rs), _amount(amount) {}
+    virtual void commit() {}
+    virtual void rollback() {
+        _rs->_dataSize.fetchAndAdd(-_amount);
+    }
+
+private:
+    SkipListRecordStore* _rs;
+    int64_t _amount;
+};
+
+class SkipListRecordStore::CappedInsertChange : public RecoveryUnit::Change {
+public:
+    CappedInsertChange(SkipListRecordStore* rs, const RecordId& id) : _rs(rs), _id(id) {}
+    virtual void commit() {
+        _rs->_dealtWithCappedId(_id);
+    }
+    virtual void rollback() {
+        _rs->_dealtWithCappedId(_id);
+    }
+
+private:
+    SkipListRecordStore* _rs;
+    const RecordId _id;
+};
+
+SkipListRecordStore::SkipListRecordStore(StringData ns,
+                                         std::shared_ptr<SkipList> list,
+                                         bool isCapped,
+                                         int64_t cappedMaxSize,
+                                         int64_t cappedMaxDocs,
+                                         CappedDocumentDeleteCallback* cappedDeleteCallback)
+    : RecordStore(ns),
+      _list(std::move(list)),
+      _isCapped(isCapped),
+      _isOplog(NamespaceString::oplog(ns)),
+      _cappedMaxSize(cappedMaxSize),
+      _cappedMaxDocs(cappedMaxDocs),
+      _cappedDeleteCallback(cappedDeleteCallback) {
+    if (_isCapped) {
+        invariant(_cappedMaxSize > 0);
+        invariant(_cappedMaxDocs == -1 || _cappedMaxDocs > 0);
+    } else {
+        invariant(_cappedMaxSize == -1);
+        invariant(_cappedMaxDocs == -1);
+    }
+
+    // The SkipList may already hold records if this ident was opened before.
+    SkipListRecoveryUnit ru(_list->getTransactionManager(), nullptr);
+    SkipList::Cursor cursor(_list.get(), &ru, true);
+    int64_t numRecords = 0;
+    int64_t dataSize = 0;
+    RecordId lastId;
+    for (bool more = cursor.seekToStart(); more; more = cursor.next()) {
+        numRecords++;
+        dataSize += cursor.value().size();
+        lastId = fromKey(cursor.key());
+    }
+    ru.abandonSnapshot();
+
+    _numRecords.store(numRecords);
+    _dataSize.store(dataSize);
+    _nextIdNum.store(lastId.isNormal() ? lastId.repr() + 1 : 1);
+}
+
+const char* SkipListRecordStore::name() const {
+    return "skiplist";
+}
+
+SkipListRecoveryUnit* SkipListRecordStore::_getRecoveryUnit(OperationContext* txn) {
+    return SkipListRecoveryUnit::get(txn);
+}
+
+RecordData SkipListRecordStore::dataFor(OperationContext* txn, const RecordId& loc) const {
+    RecordData data;
+    invariant(findRecord(txn, loc, &data));
+    return data;
+}
+
+bool SkipListRecordStore::findRecord(OperationContext* txn,
+                                     const RecordId& loc,
+                                     RecordData* rd) const {
+    const KeyString key(loc);
+    StringData value;
+    if (!_list->find(_getRecoveryUnit(txn), toStringData(key), &value))
+        return false;
+
+    *rd = RecordData(value.rawData(), value.size());
+    rd->makeOwned();  // The value is only valid until the snapshot is closed.
+    return true;
+}
+
+void SkipListRecordStore::deleteRecord(OperationContext* txn, const RecordId& loc) {
+    const KeyString key(loc);
+    SkipListRecoveryUnit* ru = _getRecoveryUnit(txn);
+
+    StringData oldValue;
+    invariant(_list->find(ru, toStringData(key), &oldValue));
+    const int oldLength = oldValue.size();
+    invariant(_list->remove(ru, toStringData(key)));
+
+    _changeNumRecords(txn, -1);
+    _increaseDataSize(txn, -oldLength);
+}
+
+bool SkipListRecordStore::_cappedAndNeedDelete() const {
+    if (!_isCapped)
+        return false;
+
+    if (_dataSize.load() > _cappedMaxSize)
+        return true;
+
+    if ((_cappedMaxDocs != -1) && (_numRecords.load() > _cappedMaxDocs))
+        return true;
+
+    return false;
+}
+
+void SkipListRecordStore::_cappedDeleteAsNeeded(OperationContext* txn,
+                                                const RecordId& justInserted) {
+    if (!_cappedAndNeedDelete())
+        return;
+
+    // ensure only one thread at a time can do deletes, otherwise they'll conflict.
+    stdx::unique_lock<stdx::mutex> lock(_cappedDeleterMutex, stdx::defer_lock);
+    if (_cappedMaxDocs != -1) {
+        lock.lock();  // Max docs has to be exact, so have to check every time.
+    } else if (!lock.try_lock()) {
+        return;  // Someone else is deleting old records.
+    }
+
+    // we do this in a side transaction in case it aborts
+    SkipListRecoveryUnit* realRecoveryUnit =
+        checked_cast<SkipListRecoveryUnit*>(txn->releaseRecoveryUnit());
+    invariant(realRecoveryUnit);
+    OperationContext::RecoveryUnitState const realRUstate = txn->setRecoveryUnit(
+        new SkipListRecoveryUnit(realRecoveryUnit->getTransactionManager(),
+                                 realRecoveryUnit->getSnapshotManager()),
+        OperationContext::kNotInUnitOfWork);
+
+    try {
+        WriteUnitOfWork wuow(txn);
+
+        int64_t sizeOverCap = _dataSize.load() - _cappedMaxSize;
+        int64_t docsOverCap = 0;
+        if (_cappedMaxDocs != -1)
+            docsOverCap = _numRecords.load() - _cappedMaxDocs;
+
+        SkipList::Cursor cursor(_list.get(), _getRecoveryUnit(txn), true);
+        int64_t sizeSaved = 0;
+        int64_t docsRemoved = 0;
+        for (bool more = cursor.seekToStart();
+             more && (sizeSaved < sizeOverCap || docsRemoved < docsOverCap) &&
+             docsRemoved < 20000;
+             more = cursor.next()) {
+            // don't go past the record we just inserted
+            const RecordId id = fromKey(cursor.key());
+            if (id >= justInserted)
+                break;
+
+            const StringData value = cursor.value();
+            if (_cappedDeleteCallback) {
+                uassertStatusOK(_cappedDeleteCallback->aboutToDeleteCapped(
+                    txn, id, RecordData(value.rawData(), value.size())));
+            }
+
+            ++docsRemoved;
+            sizeSaved += value.size();
+            invariant(_list->remove(_getRecoveryUnit(txn), cursor.key()));
+        }
+
+        _changeNumRecords(txn, -docsRemoved);
+        _increaseDataSize(txn, -sizeSaved);
+        wuow.commit();
+    } catch (const WriteConflictException& wce) {
+        delete txn->releaseRecoveryUnit();
+        txn->setRecoveryUnit(realRecoveryUnit, realRUstate);
+        log() << "got conflict truncating capped, ignoring";
+        return;
+    } catch (...) {
+        delete txn->releaseRecoveryUnit();
+        txn->setRecoveryUnit(realRecoveryUnit, realRUstate);
+        throw;
+    }
+
+    delete txn->releaseRecoveryUnit();
+    txn->setRecoveryUnit(realRecoveryUnit, realRUstate);
+}
+
+StatusWith<RecordId> SkipListRecordStore::insertRecord(OperationContext* txn,
+                                                       const char* data,
+                                                       int len,
+                                                       bool enforceQuota) {
+    if (_isCapped && len > _cappedMaxSize) {
+        return StatusWith<RecordId>(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
+    }
+
+    Status memoryStatus = _list->getTransactionManager()->checkMemoryLimit();
+    if (!memoryStatus.isOK())
+        return memoryStatus;
+
+    RecordId loc;
+    if (_isOplog) {
+        StatusWith<RecordId> status = oploghack::extractKey(data, len);
+        if (!status.isOK())
+            return status;
+        loc = status.getValue();
+
+        stdx::lock_guard<stdx::mutex> lk(_uncommittedIdsMutex);
+        _addUncommittedId_inlock(txn, loc);
+    } else if (_isCapped) {
+        // Allocating the id and hiding it must be atomic, or a cursor could see a later record
+        // before this one is hidden.
+        stdx::lock_guard<stdx::mutex> lk(_uncommittedIdsMutex);
+        loc = _nextId();
+        _addUncommittedId_inlock(txn, loc);
+    } else {
+        loc = _nextId();
+    }
+
+    const KeyString key(loc);
+    if (!_list->insert(_getRecoveryUnit(txn), toStringData(key), StringData(data, len))) {
+        return StatusWith<RecordId>(ErrorCodes::DuplicateKey,
+                                    str::stream() << "record " << loc << " already exists");
+    }
+
+    _changeNumRecords(txn, 1);
+    _increaseDataSize(txn, len);
+
+    _cappedDeleteAsNeeded(txn, loc);
+
+    return StatusWith<RecordId>(loc);
+}
+
+StatusWith<RecordId> SkipListRecordStore::insertRecord(OperationContext* txn,
+                                                       const DocWriter* doc,
+                                                       bool enforceQuota) {
+    const int len = doc->documentSize();
+
+    std::unique_ptr<char[]> buf(new char[len]);
+    doc->writeDocument(buf.get());
+
+    return insertRecord(txn, buf.get(), len, enforceQuota);
+}
+
+StatusWith<RecordId> SkipListRecordStore::updateRecord(OperationContext* txn,
+                                                       const RecordId& loc,
+                                                       const char* data,
+                                                       int len,
+                                                       bool enforceQuota,
+                                                       UpdateNotifier* notifier) {
+    const KeyString key(loc);
+    SkipListRecoveryUnit* ru = _getRecoveryUnit(txn);
+
+    StringData oldValue;
+    invariant(_list->find(ru, toStringData(key), &oldValue));
+    const int oldLength = oldValue.size();
+
+    if (_isCapped && len > oldLength) {
+        return StatusWith<RecordId>(
+            ErrorCodes::InternalError, "failing update: objects in a capped ns cannot grow", 10003);
+    }
+
+    if (len > oldLength) {
+        Status memoryStatus = _list->getTransactionManager()->checkMemoryLimit();
+        if (!memoryStatus.isOK())
+            return memoryStatus;
+    }
+
+    invariant(_list->update(ru, toStringData(key), StringData(data, len)));
+
+    _increaseDataSize(txn, len - oldLength);
+
+    _cappedDeleteAsNeeded(txn, loc);
+
+    return StatusWith<RecordId>(loc);
+}
+
+bool SkipListRecordStore::updateWithDamagesSupported() const {
+    return false;
+}
+
+Status SkipListRecordStore::updateWithDamages(OperationContext* txn,
+                                              const RecordId& loc,
+                                              const RecordData& oldRec,
+                                              const char* damageSource,
+                                              const mutablebson::DamageVector& damages) {
+    invariant(false);
+}
+
+std::unique_ptr<RecordCursor> SkipListRecordStore::getCursor(OperationContext* txn,
+                                                             bool forward) const {
+    return stdx::make_unique<Cursor>(txn, *this, forward);
+}
+
+Status SkipListRecordStore::truncate(OperationContext* txn) {
+    SkipListRecoveryUnit* ru = _getRecoveryUnit(txn);
+    SkipList::Cursor cursor(_list.get(), ru, true);
+    int64_t recordsRemoved = 0;
+    int64_t bytesRemoved = 0;
+    for (bool more = cursor.seekToStart(); more; more = cursor.next()) {
+        recordsRemoved++;
+        bytesRemoved += cursor.value().size();
+        invariant(_list->remove(ru, cursor.key()));
+    }
+
+    _changeNumRecords(txn, -recordsRemoved);
+    _increaseDataSize(txn, -bytesRemoved);
+    return Status::OK();
+}
+
+void SkipListRecordStore::temp_cappedTruncateAfter(OperationContext* txn,
+                                                   RecordId end,
+                                                   bool inclusive) {
+    WriteUnitOfWork wuow(txn);
+    Cursor cursor(txn, *this, true);
+    while (auto record = cursor.next()) {
+        RecordId loc = record->id;
+        if (end < loc || (inclusive && end == loc)) {
+            if (_cappedDeleteCallback)
+                uassertStatusOK(_cappedDeleteCallback->aboutToDeleteCapped(txn, loc, record->data));
+            deleteRecord(txn, loc);
+        }
+    }
+    wuow.commit();
+}
+
+Status SkipListRecordStore::validate(OperationContext* txn,
+                                     bool full,
+                                     bool scanData,
+                                     ValidateAdaptor* adaptor,
+                                     ValidateResults* results,
+                                     BSONObjBuilder* output) {
+    results->valid = true;
+    long long nrecords = 0;
+    SkipList::Cursor cursor(_list.get(), _getRecoveryUnit(txn), true);
+    for (bool more = cursor.seekToStart(); more; more = cursor.next()) {
+        nrecords++;
+        if (scanData && full) {
+            const StringData value = cursor.value();
+            size_t dataSize;
+            const Status status =
+                adaptor->validate(RecordData(value.rawData(), value.size()), &dataSize);
+            if (!status.isOK()) {
+                results->valid = false;
+                results->errors.push_back("invalid object detected (see logs)");
+                log() << "Invalid object detected in " << _ns << ": " << status.reason();
+            }
+        }
+    }
+
+    output->appendNumber("nrecords", nrecords);
+
+    return Status::OK();
+}
+
+void SkipListRecordStore::appendCustomStats(OperationContext* txn,
+                                            BSONObjBuilder* result,
+                                            double scale) const {
+    result->appendBool("capped", _isCapped);
+    if (_isCapped) {
+        result->appendIntOrLL("max", _cappedMaxDocs);
+        result->appendIntOrLL("maxSize", _cappedMaxSize / scale);
+    }
+    result->appendNumber("memoryUsed", static_cast<long long>(_list->getMemoryUsed() / scale));
+}
+
+int64_t SkipListRecordStore::storageSize(OperationContext* txn,
+                                         BSONObjBuilder* extraInfo,
+                                         int infoLevel) const {
+    // Includes the versions of deleted and overwritten records that are not collected yet.
+    return _list->getMemoryUsed();
+}
+
+boost::optional<RecordId> SkipListRecordStore::oplogStartHack(
+    OperationContext* txn, const RecordId& startingPosition) const {
+    if (!_isOplog)
+        return boost::none;
+
+    SkipList::Cursor cursor(_list.get(), _getRecoveryUnit(txn), false);
+    const KeyString key(startingPosition);
+    if (!cursor.seek(toStringData(key)))
+        return RecordId();
+
+    return fromKey(cursor.key());
+}
+
+Status SkipListRecordStore::oplogDiskLocRegister(OperationContext* txn, const Timestamp& opTime) {
+    StatusWith<RecordId> loc = oploghack::keyForOptime(opTime);
+    if (!loc.isOK())
+        return loc.getStatus();
+
+    stdx::lock_guard<stdx::mutex> lk(_uncommittedIdsMutex);
+    _addUncommittedId_inlock(txn, loc.getValue());
+    return Status::OK();
+}
+
+RecordId SkipListRecordStore::_nextId() {
+    invariant(!_isOplog);
+    return RecordId(_nextIdNum.fetchAndAdd(1));
+}
+
+void SkipListRecordStore::_addUncommittedId_inlock(OperationContext* txn, const RecordId& id) {
+    // The oplog registers ids ahead of inserting them.
+    if (_uncommittedIds.insert(id).second)
+        txn->recoveryUnit()->registerChange(new CappedInsertChange(this, id));
+}
+
+void SkipListRecordStore::_dealtWithCappedId(const RecordId& id) {
+    stdx::lock_guard<stdx::mutex> lk(_uncommittedIdsMutex);
+    _uncommittedIds.erase(id);
+}
+
+RecordId SkipListRecordStore::_lowestCappedHiddenRecord() const {
+    stdx::lock_guard<stdx::mutex> lk(_uncommittedIdsMutex);
+    return _uncommittedIds.empty() ? RecordId() : *_uncommittedIds.begin();
+}
+
+void SkipListRecordStore::_changeNumRecords(OperationContext* txn, int64_t diff) {
+    txn->recoveryUnit()->registerChange(new NumRecordsChange(this, diff));
+    _numRecords.fetchAndAdd(diff);
+}
+
+void SkipListRecordStore::_increaseDataSize(OperationContext* txn, int64_t amount) {
+    txn->recoveryUnit()->registerChange(new DataSizeChange(this, amount));
+    _dataSize.fetchAndAdd(amount);
+}
+
+}  // namespace mongo
@@ -0,0 +1,182 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <set>
+
+#include "mongo/db/storage/capped_callback.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/skiplist/skiplist.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class SkipListRecoveryUnit;
+
+/**
+ * A RecordStore that keeps its records in a SkipList, keyed by the KeyString of their RecordId.
+ *
+ * Capped collections hide every record at or after the lowest one whose insert has not committed
+ * yet, like the WiredTiger RecordStore does, so that a cursor never skips a record that becomes
+ * visible later.
+ *
+ * @param cappedMaxSize - required if isCapped. limit uses dataSize() in this impl.
+ */
+class SkipListRecordStore final : public RecordStore {
+public:
+    SkipListRecordStore(StringData ns,
+                        std::shared_ptr<SkipList> list,
+                        bool isCapped = false,
+                        int64_t cappedMaxSize = -1,
+                        int64_t cappedMaxDocs = -1,
+                        CappedDocumentDeleteCallback* cappedDeleteCallback = nullptr);
+
+    const char* name() const final;
+
+    RecordData dataFor(OperationContext* txn, const RecordId& loc) const final;
+
+    bool findRecord(OperationContext* txn, const RecordId& loc, RecordData* rd) const final;
+
+    void deleteRecord(OperationContext* txn, const RecordId& dl) final;
+
+    StatusWith<RecordId> insertRecord(OperationContext* txn,
+                                      const char* data,
+                                      int len,
+                                      bool enforceQuota) final;
+
+    StatusWith<RecordId> insertRecord(OperationContext* txn,
+                                      const DocWriter* doc,
+                                      bool enforceQuota) final;
+
+    StatusWith<RecordId> updateRecord(OperationContext* txn,
+                                      const RecordId& oldLocation,
+                                      const char* data,
+                                      int len,
+                                      bool enforceQuota,
+                                      UpdateNotifier* notifier) final;
+
+    bool updateWithDamagesSupported() const final;
+
+    Status updateWithDamages(OperationContext* txn,
+                             const RecordId& loc,
+                             const RecordData& oldRec,
+                             const char* damageSource,
+                             const mutablebson::DamageVector& damages) final;
+
+    std::unique_ptr<RecordCursor> getCursor(OperationContext* txn, bool forward) const final;
+
+    Status truncate(OperationContext* txn) final;
+
+    void temp_cappedTruncateAfter(OperationContext* txn, RecordId end, bool inclusive) final;
+
+    Status validate(OperationContext* txn,
+                    bool full,
+                    bool scanData,
+                    ValidateAdaptor* adaptor,
+                    ValidateResults* results,
+                    BSONObjBuilder* output) final;
+
+    void appendCustomStats(OperationContext* txn, BSONObjBuilder* result, double scale) const final;
+
+    int64_t storageSize(OperationContext* txn,
+                        BSONObjBuilder* extraInfo = NULL,
+                        int infoLevel = 0) const final;
+
+    long long dataSize(OperationContext* txn) const final {
+        return _dataSize.load();
+    }
+
+    long long numRecords(OperationContext* txn) const final {
+        return _numRecords.load();
+    }
+
+    bool isCapped() const final {
+        return _isCapped;
+    }
+
+    void setCappedDeleteCallback(CappedDocumentDeleteCallback* cb) final {
+        _cappedDeleteCallback = cb;
+    }
+
+    boost::optional<RecordId> oplogStartHack(OperationContext* txn,
+                                             const RecordId& startingPosition) const final;
+
+    Status oplogDiskLocRegister(OperationContext* txn, const Timestamp& opTime) final;
+
+    void updateStatsAfterRepair(OperationContext* txn,
+                                long long numRecords,
+                                long long dataSize) final {
+        _numRecords.store(numRecords);
+        _dataSize.store(dataSize);
+    }
+
+private:
+    class Cursor;
+    class NumRecordsChange;
+    class DataSizeChange;
+    class CappedInsertChange;
+
+    static SkipListRecoveryUnit* _getRecoveryUnit(OperationContext* txn);
+
+    RecordId _nextId();
+    void _addUncommittedId_inlock(OperationContext* txn, const RecordId& id);
+    void _dealtWithCappedId(const RecordId& id);
+
+    /**
+     * Returns the lowest RecordId that capped cursors must hide, or a null RecordId.
+     */
+    RecordId _lowestCappedHiddenRecord() const;
+
+    bool _cappedAndNeedDelete() const;
+    void _cappedDeleteAsNeeded(OperationContext* txn, const RecordId& justInserted);
+
+    void _changeNumRecords(OperationContext* txn, int64_t diff);
+    void _increaseDataSize(OperationContext* txn, int64_t amount);
+
+    const std::shared_ptr<SkipList> _list;
+
+    const bool _isCapped;
+    const bool _isOplog;
+    const int64_t _cappedMaxSize;
+    const int64_t _cappedMaxDocs;
+    CappedDocumentDeleteCallback* _cappedDeleteCallback;
+    stdx::mutex _cappedDeleterMutex;  // Held while deleting to stay under the cap.
+
+    mutable stdx::mutex _uncommittedIdsMutex;  // Guards _uncommittedIds.
+    std::set<RecordId> _uncommittedIds;
+
+    AtomicInt64 _nextIdNum;
+    AtomicInt64 _numRecords;
+    AtomicInt64 _dataSize;
+};
+
+}  // namespace mongo
@@ -0,0 +1,209 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/skiplist/skiplist_recovery_unit.h"
+
+#include "mongo/base/checked_cast.h"
+#include "mongo/db/storage/skiplist/skiplist_snapshot_manager.h"
+#include "mongo/util/log.h"
+#include "mongo/util/stacktrace.h"
+
+namespace mongo {
+
+SkipListRecoveryUnit::SkipListRecoveryUnit(SkipListTransactionManager* txnManager,
+                                           SkipListSnapshotManager* snapshotManager)
+    : _txnManager(txnManager),
+      _snapshotManager(snapshotManager),
+      _slot(txnManager->acquireSlot()) {}
+
+SkipListRecoveryUnit::~SkipListRecoveryUnit() {
+    invariant(!_inUnitOfWork);
+    _abort();
+    _txnManager->releaseSlot(_slot);
+}
+
+void SkipListRecoveryUnit::_commit() {
+    try {
+        if (_active) {
+            _txnClose(true);
+        }
+
+        for (Changes::const_iterator it = _changes.begin(), end = _changes.end(); it != end; ++it) {
+            (*it)->commit();
+        }
+        _changes.clear();
+
+        invariant(!_active);
+    } catch (...) {
+        std::terminate();
+    }
+}
+
+void SkipListRecoveryUnit::_abort() {
+    try {
+        if (_active) {
+            _txnClose(false);
+        }
+
+        for (Changes::const_reverse_iterator it = _changes.rbegin(), end = _changes.rend();
+             it != end;
+             ++it) {
+            Change* change = *it;
+            LOG(2) << "CUSTOM ROLLBACK " << demangleName(typeid(*change));
+            change->rollback();
+        }
+        _changes.clear();
+
+        invariant(!_active);
+    } catch (...) {
+        std::terminate();
+    }
+}
+
+void SkipListRecoveryUnit::beginUnitOfWork(OperationContext* opCtx) {
+    invariant(!_areWriteUnitOfWorksBanned);
+    invariant(!_inUnitOfWork);
+    _inUnitOfWork = true;
+}
+
+void SkipListRecoveryUnit::commitUnitOfWork() {
+    invariant(_inUnitOfWork);
+    _inUnitOfWork = false;
+    _commit();
+}
+
+void SkipListRecoveryUnit::abortUnitOfWork() {
+    invariant(_inUnitOfWork);
+    _inUnitOfWork = false;
+    _abort();
+}
+
+void SkipListRecoveryUnit::abandonSnapshot() {
+    invariant(!_inUnitOfWork);
+    if (_active) {
+        // Can't be in a WriteUnitOfWork, so safe to rollback
+        _txnClose(false);
+    }
+    _areWriteUnitOfWorksBanned = false;
+}
+
+void SkipListRecoveryUnit::registerChange(Change* change) {
+    invariant(_inUnitOfWork);
+    _changes.push_back(change);
+}
+
+SkipListRecoveryUnit* SkipListRecoveryUnit::get(OperationContext* txn) {
+    invariant(txn);
+    return checked_cast<SkipListRecoveryUnit*>(txn->recoveryUnit());
+}
+
+SkipListTransactionManager::Transaction* SkipListRecoveryUnit::getWriteTransaction() {
+    invariant(!_readFromMajorityCommittedSnapshot);
+    if (!_active)
+        _txnOpen();
+    if (!_txn)
+        _txn = new SkipListTransactionManager::Transaction();
+    return _txn;
+}
+
+void SkipListRecoveryUnit::prepareForCreateSnapshot() {
+    invariant(!_active);  // Can't already have a snapshot open.
+    invariant(!_inUnitOfWork);
+    invariant(!_readFromMajorityCommittedSnapshot);
+
+    _txnOpen();
+    _areWriteUnitOfWorksBanned = true;
+}
+
+void SkipListRecoveryUnit::_txnClose(bool commit) {
+    invariant(_active);
+
+    if (_txn) {
+        if (commit) {
+            const uint64_t timestamp = _txnManager->commit(_txn);
+            for (auto&& write : _writes) {
+                write.version->timestamp.store(timestamp);
+            }
+        } else {
+            // Each key's Versions from this transaction are the newest ones, so removing them
+            // newest first always removes the head of a chain.
+            for (auto it = _writes.rbegin(); it != _writes.rend(); ++it) {
+                it->list->rollbackVersion(it->node, it->version);
+            }
+        }
+
+        _txnManager->retireTransaction(_txn);
+        _txn = nullptr;
+        _writes.clear();
+    }
+
+    _txnManager->closeSnapshot(_slot);
+    _active = false;
+    _myTransactionCount++;
+}
+
+void SkipListRecoveryUnit::_txnOpen() {
+    invariant(!_active);
+
+    if (_readFromMajorityCommittedSnapshot) {
+        _majorityCommittedSnapshot =
+            _snapshotManager->openSnapshotOnCommittedSnapshot(_slot, &_readTimestamp);
+    } else {
+        _readTimestamp = _txnManager->openSnapshot(_slot);
+    }
+    _active = true;
+}
+
+SnapshotId SkipListRecoveryUnit::getSnapshotId() const {
+    return SnapshotId(_myTransactionCount);
+}
+
+Status SkipListRecoveryUnit::setReadFromMajorityCommittedSnapshot() {
+    auto snapshotName = _snapshotManager->getMinSnapshotForNextCommittedRead();
+    if (!snapshotName) {
+        return {ErrorCodes::ReadConcernMajorityNotAvailableYet,
+                "Read concern majority reads are currently not possible."};
+    }
+
+    _majorityCommittedSnapshot = *snapshotName;
+    _readFromMajorityCommittedSnapshot = true;
+    return Status::OK();
+}
+
+boost::optional<SnapshotName> SkipListRecoveryUnit::getMajorityCommittedSnapshot() const {
+    if (!_readFromMajorityCommittedSnapshot)
+        return {};
+    return _majorityCommittedSnapshot;
+}
+
+}  // namespace mongo
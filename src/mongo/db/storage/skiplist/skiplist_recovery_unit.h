@@ -0,0 +1,171 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/db/storage/skiplist/skiplist.h"
+#include "mongo/db/storage/skiplist/skiplist_transaction_manager.h"
+#include "mongo/db/storage/snapshot_name.h"
+
+namespace mongo {
+
+class SkipListSnapshotManager;
+
+/**
+ * A snapshot and, once something is written, a transaction of the skiplist storage engine.
+ *
+ * Like WiredTiger's, the snapshot opens with the first read or write and closes when the unit of
+ * work commits or aborts, or the snapshot is abandoned. Writes made outside of a unit of work
+ * are committed by the next one.
+ */
+class SkipListRecoveryUnit final : public RecoveryUnit {
+public:
+    SkipListRecoveryUnit(SkipListTransactionManager* txnManager,
+                         SkipListSnapshotManager* snapshotManager);
+    ~SkipListRecoveryUnit() final;
+
+    void beginUnitOfWork(OperationContext* opCtx) final;
+    void commitUnitOfWork() final;
+    void abortUnitOfWork() final;
+
+    bool waitUntilDurable() final {
+        return true;
+    }
+
+    void abandonSnapshot() final;
+
+    Status setReadFromMajorityCommittedSnapshot() final;
+    bool isReadingFromMajorityCommittedSnapshot() const final {
+        return _readFromMajorityCommittedSnapshot;
+    }
+
+    boost::optional<SnapshotName> getMajorityCommittedSnapshot() const final;
+
+    SnapshotId getSnapshotId() const final;
+
+    void registerChange(Change* change) final;
+
+    void* writingPtr(void* data, size_t len) final {
+        invariant(!"don't call writingPtr");
+    }
+
+    void setRollbackWritesDisabled() final {}
+
+    // ---- skiplist specific
+
+    static SkipListRecoveryUnit* get(OperationContext* txn);
+
+    /**
+     * Returns the timestamp of the snapshot, opening it if needed.
+     */
+    uint64_t getReadTimestamp() {
+        if (!_active)
+            _txnOpen();
+        return _readTimestamp;
+    }
+
+    bool inActiveTxn() const {
+        return _active;
+    }
+
+    /**
+     * Returns the transaction this RecoveryUnit has written in, or nullptr if it has not
+     * written anything since the snapshot opened.
+     */
+    const SkipListTransactionManager::Transaction* getTransaction() const {
+        return _txn;
+    }
+
+    /**
+     * Returns the transaction to write in, starting it if needed.
+     */
+    SkipListTransactionManager::Transaction* getWriteTransaction();
+
+    /**
+     * Remembers a Version written by this transaction, to stamp it with the commit timestamp or
+     * remove it on abort.
+     */
+    void registerWrite(SkipList* list, SkipList::Node* node, SkipList::Version* version) {
+        _writes.push_back({list, node, version});
+    }
+
+    SkipListTransactionManager* getTransactionManager() const {
+        return _txnManager;
+    }
+
+    SkipListSnapshotManager* getSnapshotManager() const {
+        return _snapshotManager;
+    }
+
+    /**
+     * Prepares this RU to be the basis for a named snapshot.
+     *
+     * Opens a snapshot, and invariants if one is already open. Bans being in a WriteUnitOfWork
+     * until the snapshot is abandoned.
+     */
+    void prepareForCreateSnapshot();
+
+private:
+    struct Write {
+        SkipList* list;
+        SkipList::Node* node;
+        SkipList::Version* version;
+    };
+
+    void _abort();
+    void _commit();
+
+    void _txnClose(bool commit);
+    void _txnOpen();
+
+    SkipListTransactionManager* const _txnManager;     // not owned
+    SkipListSnapshotManager* const _snapshotManager;  // not owned
+    SkipListTransactionManager::Slot* const _slot;
+
+    bool _areWriteUnitOfWorksBanned = false;
+    bool _inUnitOfWork = false;
+    bool _active = false;
+    uint64_t _myTransactionCount = 1;
+    uint64_t _readTimestamp = 0;
+    bool _readFromMajorityCommittedSnapshot = false;
+    SnapshotName _majorityCommittedSnapshot = SnapshotName::min();
+
+    SkipListTransactionManager::Transaction* _txn = nullptr;
+    std::vector<Write> _writes;
+
+    typedef OwnedPointerVector<Change> Changes;
+    Changes _changes;
+};
+
+}  // namespace mongo
@@ -0,0 +1,104 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/skiplist/skiplist_snapshot_manager.h"
+
+#include "mongo/db/storage/skiplist/skiplist_recovery_unit.h"
+
+namespace mongo {
+
+Status SkipListSnapshotManager::prepareForCreateSnapshot(OperationContext* txn) {
+    SkipListRecoveryUnit::get(txn)->prepareForCreateSnapshot();
+    return Status::OK();
+}
+
+Status SkipListSnapshotManager::createSnapshot(OperationContext* txn, const SnapshotName& name) {
+    // The open snapshot of the RecoveryUnit keeps its timestamp from being garbage collected
+    // until it is pinned below.
+    const uint64_t timestamp = SkipListRecoveryUnit::get(txn)->getReadTimestamp();
+
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    invariant(_snapshots.empty() || _snapshots.rbegin()->first < name);
+    _snapshots[name] = timestamp;
+    _updatePinnedTimestamp_inlock();
+    return Status::OK();
+}
+
+void SkipListSnapshotManager::setCommittedSnapshot(const SnapshotName& name) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+
+    invariant(!_committedSnapshot || *_committedSnapshot <= name);
+    invariant(_snapshots.count(name));
+    _committedSnapshot = name;
+}
+
+void SkipListSnapshotManager::cleanupUnneededSnapshots() {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+
+    if (!_committedSnapshot)
+        return;
+
+    _snapshots.erase(_snapshots.begin(), _snapshots.lower_bound(*_committedSnapshot));
+    _updatePinnedTimestamp_inlock();
+}
+
+void SkipListSnapshotManager::dropAllSnapshots() {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _committedSnapshot = {};
+    _snapshots.clear();
+    _updatePinnedTimestamp_inlock();
+}
+
+boost::optional<SnapshotName> SkipListSnapshotManager::getMinSnapshotForNextCommittedRead() const {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    return _committedSnapshot;
+}
+
+SnapshotName SkipListSnapshotManager::openSnapshotOnCommittedSnapshot(
+    SkipListTransactionManager::Slot* slot, uint64_t* readTimestamp) const {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+
+    uassert(ErrorCodes::ReadConcernMajorityNotAvailableYet,
+            "Committed view disappeared while running operation",
+            _committedSnapshot);
+
+    // Holding the mutex keeps the pinned timestamp from moving past the committed snapshot until
+    // the slot announces it.
+    *readTimestamp = _snapshots.find(*_committedSnapshot)->second;
+    _txnManager->openSnapshotAt(slot, *readTimestamp);
+    return *_committedSnapshot;
+}
+
+void SkipListSnapshotManager::_updatePinnedTimestamp_inlock() {
+    _txnManager->setPinnedTimestamp(_snapshots.empty() ? 0 : _snapshots.begin()->second);
+}
+
+}  // namespace mongo
@@ -0,0 +1,90 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <map>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/storage/skiplist/skiplist_transaction_manager.h"
+#include "mongo/db/storage/snapshot_manager.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+/**
+ * Named snapshots of the skiplist storage engine are commit timestamps. The timestamp of the
+ * oldest snapshot that has not been cleaned up is pinned in the SkipListTransactionManager, so
+ * that garbage collection keeps every version that a read from a named snapshot can see.
+ */
+class SkipListSnapshotManager final : public SnapshotManager {
+    MONGO_DISALLOW_COPYING(SkipListSnapshotManager);
+
+public:
+    explicit SkipListSnapshotManager(SkipListTransactionManager* txnManager)
+        : _txnManager(txnManager) {}
+
+    Status prepareForCreateSnapshot(OperationContext* txn) final;
+    Status createSnapshot(OperationContext* txn, const SnapshotName& name) final;
+    void setCommittedSnapshot(const SnapshotName& name) final;
+    void cleanupUnneededSnapshots() final;
+    void dropAllSnapshots() final;
+
+    //
+    // Skiplist-specific methods
+    //
+
+    /**
+     * Opens a snapshot in 'slot' at the committed snapshot, stores its timestamp in
+     * 'readTimestamp' and returns the SnapshotName used.
+     *
+     * Throws if there is currently no committed snapshot.
+     */
+    SnapshotName openSnapshotOnCommittedSnapshot(SkipListTransactionManager::Slot* slot,
+                                                 uint64_t* readTimestamp) const;
+
+    /**
+     * Returns lowest SnapshotName that could possibly be used by a future call to
+     * openSnapshotOnCommittedSnapshot, or boost::none if there is currently no committed
+     * snapshot.
+     */
+    boost::optional<SnapshotName> getMinSnapshotForNextCommittedRead() const;
+
+private:
+    void _updatePinnedTimestamp_inlock();
+
+    SkipListTransactionManager* const _txnManager;  // not owned
+
+    mutable stdx::mutex _mutex;  // Guards all members below.
+    std::map<SnapshotName, uint64_t> _snapshots;
+    boost::optional<SnapshotName> _committedSnapshot;
+};
+
+}  // namespace mongo
@@ -0,0 +1,308 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/skiplist/skiplist.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/storage/skiplist/skiplist_recovery_unit.h"
+#include "mongo/db/storage/skiplist/skiplist_snapshot_manager.h"
+#include "mongo/db/storage/skiplist/skiplist_transaction_manager.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class SkipListTest : public unittest::Test {
+protected:
+    SkipListTest() : _snapshotManager(&_txnManager), _list(&_txnManager) {}
+
+    std::unique_ptr<SkipListRecoveryUnit> newRecoveryUnit() {
+        return stdx::make_unique<SkipListRecoveryUnit>(&_txnManager, &_snapshotManager);
+    }
+
+    void insert(StringData key, StringData value) {
+        auto ru = newRecoveryUnit();
+        ru->beginUnitOfWork(nullptr);
+        ASSERT_TRUE(_list.insert(ru.get(), key, value));
+        ru->commitUnitOfWork();
+    }
+
+    std::vector<std::string> scan(bool forward) {
+        auto ru = newRecoveryUnit();
+        std::vector<std::string> keys;
+        SkipList::Cursor cursor(&_list, ru.get(), forward);
+        for (bool more = cursor.seekToStart(); more; more = cursor.next()) {
+            keys.push_back(cursor.key().toString());
+        }
+        return keys;
+    }
+
+    SkipListTransactionManager _txnManager;
+    SkipListSnapshotManager _snapshotManager;
+    SkipList _list;
+};
+
+TEST_F(SkipListTest, InsertFindUpdateRemove) {
+    auto ru = newRecoveryUnit();
+    StringData value;
+
+    ru->beginUnitOfWork(nullptr);
+    ASSERT_TRUE(_list.insert(ru.get(), "a", "1"));
+    ASSERT_FALSE(_list.insert(ru.get(), "a", "2"));
+    ASSERT_TRUE(_list.find(ru.get(), "a", &value));
+    ASSERT_EQUALS("1", value);
+    ru->commitUnitOfWork();
+    ru->abandonSnapshot();
+
+    ru->beginUnitOfWork(nullptr);
+    ASSERT_TRUE(_list.update(ru.get(), "a", "3"));
+    ASSERT_FALSE(_list.update(ru.get(), "b", "3"));
+    ru->commitUnitOfWork();
+    ru->abandonSnapshot();
+
+    ASSERT_TRUE(_list.find(ru.get(), "a", &value));
+    ASSERT_EQUALS("3", value);
+    ru->abandonSnapshot();
+
+    ru->beginUnitOfWork(nullptr);
+    ASSERT_TRUE(_list.remove(ru.get(), "a"));
+    ASSERT_FALSE(_list.remove(ru.get(), "a"));
+    ru->commitUnitOfWork();
+    ru->abandonSnapshot();
+
+    ASSERT_FALSE(_list.find(ru.get(), "a", &value));
+
+    // A removed key can be inserted again.
+    ru->abandonSnapshot();
+    ru->beginUnitOfWork(nullptr);
+    ASSERT_TRUE(_list.insert(ru.get(), "a", "4"));
+    ru->commitUnitOfWork();
+    ru->abandonSnapshot();
+    ASSERT_TRUE(_list.find(ru.get(), "a", &value));
+    ASSERT_EQUALS("4", value);
+}
+
+TEST_F(SkipListTest, AbortRollsBack) {
+    insert("a", "1");
+
+    auto ru = newRecoveryUnit();
+    ru->beginUnitOfWork(nullptr);
+    ASSERT_TRUE(_list.insert(ru.get(), "b", "2"));
+    ASSERT_TRUE(_list.update(ru.get(), "a", "3"));
+    ru->abortUnitOfWork();
+
+    StringData value;
+    ASSERT_FALSE(_list.find(ru.get(), "b", &value));
+    ASSERT_TRUE(_list.find(ru.get(), "a", &value));
+    ASSERT_EQUALS("1", value);
+}
+
+TEST_F(SkipListTest, SnapshotIsolation) {
+    insert("a", "1");
+
+    auto reader = newRecoveryUnit();
+    StringData value;
+    ASSERT_TRUE(_list.find(reader.get(), "a", &value));
+
+    auto writer = newRecoveryUnit();
+    writer->beginUnitOfWork(nullptr);
+    ASSERT_TRUE(_list.update(writer.get(), "a", "2"));
+    ASSERT_TRUE(_list.insert(writer.get(), "b", "3"));
+
+    // Uncommitted writes are only visible to their own transaction.
+    ASSERT_TRUE(_list.find(reader.get(), "a", &value));
+    ASSERT_EQUALS("1", value);
+    ASSERT_FALSE(_list.find(reader.get(), "b", &value));
+    writer->commitUnitOfWork();
+
+    // The open snapshot still doesn't see the commit.
+    ASSERT_TRUE(_list.find(reader.get(), "a", &value));
+    ASSERT_EQUALS("1", value);
+    ASSERT_FALSE(_list.find(reader.get(), "b", &value));
+
+    reader->abandonSnapshot();
+    ASSERT_TRUE(_list.find(reader.get(), "a", &value));
+    ASSERT_EQUALS("2", value);
+    ASSERT_TRUE(_list.find(reader.get(), "b", &value));
+}
+
+TEST_F(SkipListTest, WriteConflict) {
+    insert("a", "1");
+
+    auto first = newRecoveryUnit();
+    auto second = newRecoveryUnit();
+
+    first->beginUnitOfWork(nullptr);
+    second->beginUnitOfWork(nullptr);
+    ASSERT_TRUE(_list.update(first.get(), "a", "2"));
+    ASSERT_THROWS(_list.update(second.get(), "a", "3"), WriteConflictException);
+    ASSERT_TRUE(_list.insert(first.get(), "b", "4"));
+    ASSERT_THROWS(_list.insert(second.get(), "b", "5"), WriteConflictException);
+    second->abortUnitOfWork();
+    first->commitUnitOfWork();
+
+    // A snapshot older than a committed write conflicts with it too.
+    auto stale = newRecoveryUnit();
+    StringData value;
+    ASSERT_TRUE(_list.find(stale.get(), "a", &value));
+    insert("c", "6");
+    stale->beginUnitOfWork(nullptr);
+    ASSERT_THROWS(_list.update(stale.get(), "c", "7"), WriteConflictException);
+    stale->abortUnitOfWork();
+}
+
+TEST_F(SkipListTest, CursorOrder) {
+    insert("b", "");
+    insert("d", "");
+    insert("a", "");
+    insert("c", "");
+
+    std::vector<std::string> forward = {"a", "b", "c", "d"};
+    std::vector<std::string> reverse = {"d", "c", "b", "a"};
+    ASSERT(scan(true) == forward);
+    ASSERT(scan(false) == reverse);
+
+    auto ru = newRecoveryUnit();
+    SkipList::Cursor cursor(&_list, ru.get(), true);
+    ASSERT_TRUE(cursor.seek("bb"));
+    ASSERT_EQUALS("c", cursor.key());
+
+    SkipList::Cursor reverseCursor(&_list, ru.get(), false);
+    ASSERT_TRUE(reverseCursor.seek("bb"));
+    ASSERT_EQUALS("b", reverseCursor.key());
+    ASSERT_FALSE(reverseCursor.seek("0"));
+}
+
+TEST_F(SkipListTest, CursorSurvivesNewSnapshot) {
+    insert("a", "");
+    insert("c", "");
+
+    auto ru = newRecoveryUnit();
+    SkipList::Cursor cursor(&_list, ru.get(), true);
+    ASSERT_TRUE(cursor.seekToStart());
+    ASSERT_EQUALS("a", cursor.key());
+
+    insert("b", "");
+    ru->abandonSnapshot();
+
+    ASSERT_TRUE(cursor.next());
+    ASSERT_EQUALS("b", cursor.key());
+    ASSERT_TRUE(cursor.next());
+    ASSERT_EQUALS("c", cursor.key());
+    ASSERT_FALSE(cursor.next());
+}
+
+TEST_F(SkipListTest, GarbageCollection) {
+    const int64_t emptySize = _list.getMemoryUsed();
+    for (int i = 0; i < 100; i++) {
+        insert(std::to_string(i), std::string(100, 'x'));
+    }
+    const int64_t fullSize = _list.getMemoryUsed();
+    ASSERT_GREATER_THAN(fullSize, emptySize);
+
+    // An open snapshot keeps the removed values alive.
+    auto reader = newRecoveryUnit();
+    StringData value;
+    ASSERT_TRUE(_list.find(reader.get(), "0", &value));
+
+    for (int i = 0; i < 100; i++) {
+        auto ru = newRecoveryUnit();
+        ru->beginUnitOfWork(nullptr);
+        ASSERT_TRUE(_list.remove(ru.get(), std::to_string(i)));
+        ru->commitUnitOfWork();
+    }
+
+    SkipListTransactionManager::Slot* slot = _txnManager.acquireSlot();
+    _list.collectGarbage(slot);
+    _txnManager.reclaim();
+    ASSERT_TRUE(_list.find(reader.get(), "99", &value));
+    ASSERT_GREATER_THAN_OR_EQUALS(_list.getMemoryUsed(), fullSize);
+
+    reader->abandonSnapshot();
+    _list.collectGarbage(slot);
+    _txnManager.reclaim();
+    _txnManager.releaseSlot(slot);
+
+    ASSERT_EQUALS(emptySize, _list.getMemoryUsed());
+    ASSERT(scan(true).empty());
+}
+
+TEST_F(SkipListTest, ConcurrentInserts) {
+    const int kThreads = 4;
+    const int kPerThread = 1000;
+
+    std::vector<stdx::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([this, t] {
+            for (int i = 0; i < kPerThread; i++) {
+                std::string key = std::to_string(i * kThreads + t);
+                insert(key, key);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQUALS(static_cast<size_t>(kThreads * kPerThread), scan(true).size());
+}
+
+TEST(SkipListTransactionManagerTest, MemoryLimit) {
+    SkipListTransactionManager txnManager(1024);
+    ASSERT_OK(txnManager.checkMemoryLimit());
+    txnManager.trackAllocation(2048);
+    ASSERT_EQUALS(ErrorCodes::ExceededMemoryLimit, txnManager.checkMemoryLimit());
+    txnManager.trackDeallocation(2048);
+    ASSERT_OK(txnManager.checkMemoryLimit());
+}
+
+TEST(SkipListTransactionManagerTest, CommitTimestampsIncrease) {
+    SkipListTransactionManager txnManager;
+    SkipListSnapshotManager snapshotManager(&txnManager);
+
+    uint64_t last = txnManager.getLastCommittedTimestamp();
+    for (int i = 0; i < 10; i++) {
+        SkipListRecoveryUnit ru(&txnManager, &snapshotManager);
+        ru.beginUnitOfWork(nullptr);
+        ru.getWriteTransaction();
+        ru.commitUnitOfWork();
+        ASSERT_GREATER_THAN(txnManager.getLastCommittedTimestamp(), last);
+        last = txnManager.getLastCommittedTimestamp();
+    }
+}
+
+}  // namespace
+}  // namespace mongo
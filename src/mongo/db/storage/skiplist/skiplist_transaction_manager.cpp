@@ -0,0 +1,204 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/skiplist/skiplist_transaction_manager.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+SkipListTransactionManager::SkipListTransactionManager(int64_t memoryLimitBytes)
+    : _memoryLimitBytes(memoryLimitBytes) {
+    invariant(_memoryLimitBytes >= 0);
+}
+
+SkipListTransactionManager::~SkipListTransactionManager() {
+    for (auto&& retired : _retired) {
+        retired.deleter(retired.ptr);
+    }
+
+    Slot* slot = _slots.load();
+    while (slot) {
+        invariant(!slot->inUse.load());
+        Slot* next = slot->next;
+        delete slot;
+        slot = next;
+    }
+}
+
+SkipListTransactionManager::Slot* SkipListTransactionManager::acquireSlot() {
+    for (Slot* slot = _slots.load(); slot; slot = slot->next) {
+        bool inUse = false;
+        if (!slot->inUse.load() && slot->inUse.compare_exchange_strong(inUse, true))
+            return slot;
+    }
+
+    Slot* slot = new Slot();
+    slot->inUse.store(true);
+    Slot* head = _slots.load();
+    do {
+        slot->next = head;
+    } while (!_slots.compare_exchange_weak(head, slot));
+    return slot;
+}
+
+void SkipListTransactionManager::releaseSlot(Slot* slot) {
+    invariant(slot->readTimestamp.load() == 0);
+    invariant(slot->epoch.load() == 0);
+    slot->inUse.store(false);
+}
+
+uint64_t SkipListTransactionManager::openSnapshot(Slot* slot) {
+    enterEpoch(slot);
+
+    // Announce the oldest possible timestamp before reading the real one. A concurrent call to
+    // getOldestReadTimestamp() that misses both stores read _lastCommitted before we do below,
+    // so it cannot have decided that anything we are about to read is unreachable.
+    slot->readTimestamp.store(1);
+    const uint64_t timestamp = _lastCommitted.load();
+    slot->readTimestamp.store(timestamp);
+    return timestamp;
+}
+
+void SkipListTransactionManager::openSnapshotAt(Slot* slot, uint64_t timestamp) {
+    invariant(timestamp > 0 && timestamp <= _lastCommitted.load());
+    enterEpoch(slot);
+    slot->readTimestamp.store(timestamp);
+}
+
+void SkipListTransactionManager::closeSnapshot(Slot* slot) {
+    slot->readTimestamp.store(0);
+    exitEpoch(slot);
+}
+
+void SkipListTransactionManager::enterEpoch(Slot* slot) {
+    // If the epoch moved on before the announcement became visible, a concurrent reclaim() may
+    // have missed it after deciding that memory retired in our epoch was unreachable.
+    uint64_t epoch;
+    do {
+        epoch = _epoch.load();
+        slot->epoch.store(epoch);
+    } while (_epoch.load() != epoch);
+}
+
+void SkipListTransactionManager::exitEpoch(Slot* slot) {
+    slot->epoch.store(0);
+}
+
+uint64_t SkipListTransactionManager::commit(Transaction* txn) {
+    stdx::lock_guard<SpinLock> lk(_commitLock);
+    const uint64_t timestamp = _lastCommitted.load() + 1;
+    txn->commitTimestamp.store(timestamp);
+    _lastCommitted.store(timestamp);
+    return timestamp;
+}
+
+void SkipListTransactionManager::retireTransaction(Transaction* txn) {
+    retire(txn, &_deleteTransaction, 0);
+}
+
+void SkipListTransactionManager::_deleteTransaction(void* txn) {
+    delete static_cast<Transaction*>(txn);
+}
+
+void SkipListTransactionManager::setPinnedTimestamp(uint64_t timestamp) {
+    dassert(timestamp == 0 || _pinnedTimestamp.load() <= timestamp);
+    _pinnedTimestamp.store(timestamp);
+}
+
+uint64_t SkipListTransactionManager::getOldestReadTimestamp() const {
+    // Both of these must be read before scanning the slots. See openSnapshot() and
+    // openSnapshotAt() for why.
+    const uint64_t pinned = _pinnedTimestamp.load();
+    uint64_t oldest = _lastCommitted.load();
+    if (pinned != 0)
+        oldest = std::min(oldest, pinned);
+
+    for (Slot* slot = _slots.load(); slot; slot = slot->next) {
+        const uint64_t timestamp = slot->readTimestamp.load();
+        if (timestamp != 0)
+            oldest = std::min(oldest, timestamp);
+    }
+    return oldest;
+}
+
+void SkipListTransactionManager::retire(void* ptr, void (*deleter)(void*), int64_t bytes) {
+    stdx::lock_guard<stdx::mutex> lk(_retiredMutex);
+    _retired.push_back({ptr, deleter, bytes, _epoch.fetchAndAdd(1)});
+}
+
+int64_t SkipListTransactionManager::reclaim() {
+    // Anything retired before this point was unlinked before any reader that announces itself
+    // after the slot scan started looking, so only the readers seen by the scan can reach it.
+    uint64_t oldestEpoch = _epoch.load();
+    for (Slot* slot = _slots.load(); slot; slot = slot->next) {
+        const uint64_t epoch = slot->epoch.load();
+        if (epoch != 0)
+            oldestEpoch = std::min(oldestEpoch, epoch);
+    }
+
+    std::vector<RetiredMemory> unreachable;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_retiredMutex);
+        auto firstReachable = std::partition(_retired.begin(),
+                                             _retired.end(),
+                                             [oldestEpoch](const RetiredMemory& retired) {
+                                                 return retired.epoch < oldestEpoch;
+                                             });
+        unreachable.assign(_retired.begin(), firstReachable);
+        _retired.erase(_retired.begin(), firstReachable);
+    }
+
+    int64_t bytesFreed = 0;
+    for (auto&& retired : unreachable) {
+        retired.deleter(retired.ptr);
+        bytesFreed += retired.bytes;
+    }
+    trackDeallocation(bytesFreed);
+    return bytesFreed;
+}
+
+Status SkipListTransactionManager::checkMemoryLimit() const {
+    const int64_t used = _memoryUsed.load();
+    if (_memoryLimitBytes == 0 || used <= _memoryLimitBytes)
+        return Status::OK();
+
+    return Status(ErrorCodes::ExceededMemoryLimit,
+                  str::stream() << "skiplist storage engine is using " << used
+                                << " bytes of memory which exceeds its limit of "
+                                << _memoryLimitBytes << " bytes");
+}
+
+}  // namespace mongo
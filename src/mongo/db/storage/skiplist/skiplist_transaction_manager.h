@@ -0,0 +1,196 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/spin_lock.h"
+
+namespace mongo {
+
+/**
+ * Coordinates transactions and memory reclamation for the skiplist storage engine.
+ *
+ * Writers install new versions of keys that point at their Transaction until it commits.
+ * Committing assigns the Transaction a timestamp and publishes it as the latest committed
+ * timestamp in one step, so a reader sees all of a transaction's writes or none of them. A
+ * snapshot reads the newest version of each key committed at or before the timestamp that was
+ * published when it opened. Neither readers nor writers take locks; only the assignment of
+ * commit timestamps is serialized.
+ *
+ * Memory unlinked from a SkipList may still be in use by readers that found it earlier, so it
+ * is retired here rather than freed. Readers announce themselves in a Slot while they hold
+ * pointers into a SkipList, and reclaim() only frees what no announced reader can reach.
+ */
+class SkipListTransactionManager {
+    MONGO_DISALLOW_COPYING(SkipListTransactionManager);
+
+public:
+    /**
+     * The write side of a transaction. Versions written by a transaction carry
+     * kUncommittedTimestamp and point here until the writer stamps them with commitTimestamp.
+     */
+    struct Transaction {
+        std::atomic<uint64_t> commitTimestamp{0};  // 0 until committed, forever 0 if aborted.
+    };
+
+    static const uint64_t kUncommittedTimestamp = ~0ULL;
+
+    /**
+     * Announces the reads of one RecoveryUnit or of the garbage collector. Slots are owned by the
+     * manager and reused once released.
+     */
+    struct Slot {
+        std::atomic<bool> inUse{false};
+        std::atomic<uint64_t> readTimestamp{0};  // 0 when no snapshot is open.
+        std::atomic<uint64_t> epoch{0};          // 0 when not holding pointers into a SkipList.
+        Slot* next = nullptr;
+    };
+
+    /**
+     * A 'memoryLimitBytes' of 0 means unlimited.
+     */
+    explicit SkipListTransactionManager(int64_t memoryLimitBytes = 0);
+    ~SkipListTransactionManager();
+
+    Slot* acquireSlot();
+    void releaseSlot(Slot* slot);
+
+    /**
+     * Opens a snapshot of everything committed so far in 'slot' and returns its timestamp.
+     */
+    uint64_t openSnapshot(Slot* slot);
+
+    /**
+     * Opens a snapshot as of an older 'timestamp'. The caller must ensure that 'timestamp' is
+     * not older than the pinned timestamp for as long as this call runs.
+     */
+    void openSnapshotAt(Slot* slot, uint64_t timestamp);
+
+    void closeSnapshot(Slot* slot);
+
+    /**
+     * Brackets accesses to a SkipList that are not made within a snapshot.
+     */
+    void enterEpoch(Slot* slot);
+    void exitEpoch(Slot* slot);
+
+    /**
+     * Commits 'txn' by assigning it the next commit timestamp, which is returned.
+     */
+    uint64_t commit(Transaction* txn);
+
+    /**
+     * Retires a committed or aborted transaction once none of its versions point at it anymore.
+     */
+    void retireTransaction(Transaction* txn);
+
+    uint64_t getLastCommittedTimestamp() const {
+        return _lastCommitted.load();
+    }
+
+    /**
+     * Keeps every version visible at 'timestamp' from being reclaimed, for reads from named
+     * snapshots. Pinned timestamps may only increase. 0 removes the pin.
+     */
+    void setPinnedTimestamp(uint64_t timestamp);
+
+    /**
+     * Returns the oldest timestamp that an open or future snapshot can read at. A version that is
+     * followed by a newer version committed at or before this timestamp is unreachable.
+     */
+    uint64_t getOldestReadTimestamp() const;
+
+    /**
+     * Takes ownership of memory that was unlinked from a SkipList. 'deleter' is called on 'ptr'
+     * once no reader can still reach it and 'bytes' is then subtracted from the memory in use.
+     */
+    void retire(void* ptr, void (*deleter)(void*), int64_t bytes);
+
+    /**
+     * Frees everything retired that has become unreachable. Returns the number of bytes freed.
+     */
+    int64_t reclaim();
+
+    void trackAllocation(int64_t bytes) {
+        _memoryUsed.fetchAndAdd(bytes);
+    }
+
+    void trackDeallocation(int64_t bytes) {
+        _memoryUsed.fetchAndSubtract(bytes);
+    }
+
+    /**
+     * Returns ExceededMemoryLimit if the engine holds more memory than it was configured with.
+     * Only operations that add data check this, so that deletes can always make progress.
+     */
+    Status checkMemoryLimit() const;
+
+    int64_t getMemoryUsed() const {
+        return _memoryUsed.load();
+    }
+
+    int64_t getMemoryLimit() const {
+        return _memoryLimitBytes;
+    }
+
+private:
+    struct RetiredMemory {
+        void* ptr;
+        void (*deleter)(void*);
+        int64_t bytes;
+        uint64_t epoch;
+    };
+
+    static void _deleteTransaction(void* txn);
+
+    const int64_t _memoryLimitBytes;
+    AtomicInt64 _memoryUsed;
+
+    // Commit timestamps start at 2 so that a snapshot can always be told apart from the absence
+    // of one, and 1 can stand for "older than everything" while a snapshot is being opened.
+    SpinLock _commitLock;  // Serializes assigning and publishing commit timestamps.
+    AtomicUInt64 _lastCommitted{1};
+    AtomicUInt64 _pinnedTimestamp;
+
+    AtomicUInt64 _epoch{1};
+    std::atomic<Slot*> _slots{nullptr};
+
+    stdx::mutex _retiredMutex;  // Guards _retired.
+    std::vector<RetiredMemory> _retired;
+};
+
+}  // namespace mongo
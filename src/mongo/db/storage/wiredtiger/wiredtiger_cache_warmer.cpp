@@ -0,0 +1,354 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_cache_warmer.h"
+
+#include <algorithm>
+#include <set>
+
+#include "mongo/base/string_data.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_journal_flusher.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+namespace {
+
+// Upper bound on the number of tables saved in the manifest.
+const size_t kMaxManifestEntries = 1000;
+
+// Cursor statistics which count accesses to a table.
+const int kAccessStatistics[] = {WT_STAT_DSRC_CURSOR_SEARCH,
+                                 WT_STAT_DSRC_CURSOR_SEARCH_NEAR,
+                                 WT_STAT_DSRC_CURSOR_NEXT,
+                                 WT_STAT_DSRC_CURSOR_PREV};
+
+/**
+ * Sets 'ops' to the number of cursor operations on 'uri' since WiredTiger opened it. Returns
+ * false if the statistics are not available, for example because the table is being dropped.
+ */
+bool getAccessCount(WT_SESSION* session, const std::string& uri, uint64_t* ops) {
+    const std::string statsUri = "statistics:" + uri;
+    WT_CURSOR* cursor;
+    if (session->open_cursor(session, statsUri.c_str(), NULL, "statistics=(fast)", &cursor) != 0)
+        return false;
+    ON_BLOCK_EXIT(cursor->close, cursor);
+
+    *ops = 0;
+    for (int key : kAccessStatistics) {
+        cursor->set_key(cursor, key);
+        if (cursor->search(cursor) != 0)
+            return false;
+        uint64_t value;
+        if (cursor->get_value(cursor, NULL, NULL, &value) != 0)
+            return false;
+        *ops += value;
+    }
+    return true;
+}
+
+bool hotterThan(const WiredTigerCacheWarmer::ManifestEntry& lhs,
+                const WiredTigerCacheWarmer::ManifestEntry& rhs) {
+    return lhs.score > rhs.score;
+}
+
+/**
+ * Replaces the saved manifest with 'manifest' in one transaction, which is rolled back if any
+ * step fails.
+ */
+Status saveManifest(WT_SESSION* session,
+                    const std::vector<WiredTigerCacheWarmer::ManifestEntry>& manifest) {
+    int ret = session->begin_transaction(session, NULL);
+    if (ret != 0)
+        return wtRCToStatus(ret);
+
+    WT_CURSOR* cursor = NULL;
+    ret = session->open_cursor(session, WiredTigerCacheWarmer::kTableUri, NULL, NULL, &cursor);
+    while (ret == 0 && (ret = cursor->next(cursor)) == 0) {
+        ret = cursor->remove(cursor);
+    }
+    if (ret == WT_NOTFOUND)
+        ret = 0;
+    for (size_t i = 0; ret == 0 && i < manifest.size(); i++) {
+        cursor->set_key(cursor, manifest[i].uri.c_str());
+        cursor->set_value(cursor, manifest[i].score);
+        ret = cursor->insert(cursor);
+    }
+    if (cursor) {
+        const int closeRet = cursor->close(cursor);
+        if (ret == 0)
+            ret = closeRet;
+    }
+
+    if (ret != 0) {
+        session->rollback_transaction(session, NULL);
+        return wtRCToStatus(ret);
+    }
+    return wtRCToStatus(session->commit_transaction(session, NULL));
+}
+
+// Set while a WiredTigerCacheWarmer exists, so that noteCursorOpened() costs nothing otherwise.
+AtomicWord<bool> trackOpenedTables(false);
+
+// Tables on which cursors were opened since the last recordManifest().
+stdx::mutex openedTablesMutex;
+std::set<std::string> openedTables;
+
+}  // namespace
+
+const char* const WiredTigerCacheWarmer::kTableUri = "table:cacheManifest";
+
+WiredTigerCacheWarmer::WiredTigerCacheWarmer(WT_CONNECTION* conn) : _conn(conn) {
+    WT_SESSION* session;
+    invariantWTOK(_conn->open_session(_conn, NULL, NULL, &session));
+    invariantWTOK(session->create(session, kTableUri, "key_format=S,value_format=q"));
+    invariantWTOK(session->close(session, NULL));
+    trackOpenedTables.store(true);
+}
+
+WiredTigerCacheWarmer::~WiredTigerCacheWarmer() {
+    shutdown();
+    trackOpenedTables.store(false);
+    stdx::lock_guard<stdx::mutex> lk(openedTablesMutex);
+    openedTables.clear();
+}
+
+void WiredTigerCacheWarmer::noteCursorOpened(const std::string& uri) {
+    if (!trackOpenedTables.load() || !StringData(uri).startsWith("table:"))
+        return;
+    stdx::lock_guard<stdx::mutex> lk(openedTablesMutex);
+    openedTables.insert(uri);
+}
+
+void WiredTigerCacheWarmer::startup(int warmupThreads,
+                                    int64_t warmupBudgetBytes,
+                                    Milliseconds recordInterval) {
+    invariant(!_thread.joinable());
+    _thread = stdx::thread(stdx::bind(&WiredTigerCacheWarmer::_backgroundThread,
+                                      this,
+                                      warmupThreads,
+                                      warmupBudgetBytes,
+                                      recordInterval));
+}
+
+void WiredTigerCacheWarmer::shutdown() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_shuttingDown)
+            return;
+        _shuttingDown = true;
+        _interrupted.store(1);
+        _shutdownCV.notify_one();
+    }
+
+    if (_thread.joinable()) {
+        _thread.join();
+        recordManifest();
+    }
+}
+
+void WiredTigerCacheWarmer::_backgroundThread(int warmupThreads,
+                                              int64_t warmupBudgetBytes,
+                                              Milliseconds interval) {
+    setThreadName("WTCacheWarmer");
+
+    {
+        // Start from the saved scores so that tables which are hot but stay cached, and so see
+        // little I/O, keep their place in the manifest.
+        stdx::lock_guard<stdx::mutex> lk(_recordMutex);
+        for (const ManifestEntry& entry : loadManifest()) {
+            _usage[entry.uri].score = entry.score;
+        }
+    }
+
+    if (warmupThreads > 0 && warmupBudgetBytes > 0) {
+        Timer t;
+        const int64_t bytes = warmFromManifest(warmupThreads, warmupBudgetBytes);
+        log() << "WiredTiger cache warm-up read " << bytes / (1024 * 1024) << "MB in "
+              << t.millis() << "ms";
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (true) {
+        if (_shutdownCV.wait_for(lk, interval, [this] { return _shuttingDown; }))
+            break;
+
+        lk.unlock();
+        recordManifest();
+        lk.lock();
+    }
+}
+
+void WiredTigerCacheWarmer::recordManifest() {
+    stdx::lock_guard<stdx::mutex> lk(_recordMutex);
+
+    WT_SESSION* session;
+    int ret = _conn->open_session(_conn, NULL, NULL, &session);
+    if (ret != 0) {
+        warning() << "unable to record the WiredTiger cache manifest: " << wtRCToStatus(ret);
+        return;
+    }
+    ON_BLOCK_EXIT(session->close, session, static_cast<const char*>(NULL));
+
+    // A statistics cursor makes WiredTiger open the table, and an idle table stays open for a
+    // long time, so only the tables opened since the last sample and those still scored are
+    // sampled rather than every table.
+    std::set<std::string> uris;
+    {
+        stdx::lock_guard<stdx::mutex> openedLk(openedTablesMutex);
+        uris.swap(openedTables);
+    }
+    for (const auto& table : _usage) {
+        if (table.second.score > 0)
+            uris.insert(table.first);
+    }
+    uris.erase(kTableUri);
+    uris.erase(WiredTigerJournalFlusher::kTableUri);
+
+    // Rebuilding the map drops tables which no longer exist or are no longer used.
+    std::map<std::string, TableUsage> usage;
+    for (const std::string& uri : uris) {
+        uint64_t ops;
+        if (!getAccessCount(session, uri, &ops))
+            continue;
+
+        const TableUsage previous = _usage[uri];
+        // The statistics start from zero whenever WiredTiger reopens the table.
+        const uint64_t delta = ops >= previous.lastOps ? ops - previous.lastOps : ops;
+
+        TableUsage& current = usage[uri];
+        current.lastOps = ops;
+        current.score = previous.score / 2 + static_cast<int64_t>(delta);
+    }
+    _usage.swap(usage);
+
+    std::vector<ManifestEntry> manifest;
+    for (const auto& table : _usage) {
+        if (table.second.score > 0)
+            manifest.push_back(ManifestEntry{table.first, table.second.score});
+    }
+    std::sort(manifest.begin(), manifest.end(), hotterThan);
+    if (manifest.size() > kMaxManifestEntries)
+        manifest.resize(kMaxManifestEntries);
+
+    // The scores are kept, so a failed save is retried with fresher ones at the next interval.
+    Status status = saveManifest(session, manifest);
+    if (!status.isOK()) {
+        warning() << "unable to save the WiredTiger cache manifest: " << status;
+    }
+}
+
+std::vector<WiredTigerCacheWarmer::ManifestEntry> WiredTigerCacheWarmer::loadManifest() const {
+    WT_SESSION* session;
+    invariantWTOK(_conn->open_session(_conn, NULL, NULL, &session));
+    ON_BLOCK_EXIT(session->close, session, static_cast<const char*>(NULL));
+
+    std::vector<ManifestEntry> manifest;
+    WT_CURSOR* cursor;
+    invariantWTOK(session->open_cursor(session, kTableUri, NULL, NULL, &cursor));
+    while (cursor->next(cursor) == 0) {
+        const char* uri;
+        int64_t score;
+        invariantWTOK(cursor->get_key(cursor, &uri));
+        invariantWTOK(cursor->get_value(cursor, &score));
+        manifest.push_back(ManifestEntry{uri, score});
+    }
+    invariantWTOK(cursor->close(cursor));
+
+    std::sort(manifest.begin(), manifest.end(), hotterThan);
+    return manifest;
+}
+
+int64_t WiredTigerCacheWarmer::warmFromManifest(int numThreads, int64_t budgetBytes) {
+    const std::vector<ManifestEntry> manifest = loadManifest();
+
+    AtomicInt64 budget(budgetBytes);
+    AtomicUInt32 nextTable;
+    AtomicInt64 bytesRead;
+
+    auto reader = [&] {
+        WT_SESSION* session;
+        invariantWTOK(_conn->open_session(_conn, NULL, NULL, &session));
+        while (budget.load() > 0 && !_interrupted.load()) {
+            const size_t i = nextTable.fetchAndAdd(1);
+            if (i >= manifest.size())
+                break;
+            bytesRead.fetchAndAdd(_warmTable(session, manifest[i].uri, &budget));
+        }
+        invariantWTOK(session->close(session, NULL));
+    };
+
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < numThreads; i++) {
+        threads.emplace_back(reader);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return bytesRead.load();
+}
+
+int64_t WiredTigerCacheWarmer::_warmTable(WT_SESSION* session,
+                                          const std::string& uri,
+                                          AtomicInt64* budget) {
+    // Raw cursors return keys and values as WT_ITEMs whatever the format of the table. The table
+    // may have been dropped since the manifest was saved.
+    WT_CURSOR* cursor;
+    if (session->open_cursor(session, uri.c_str(), NULL, "raw", &cursor) != 0)
+        return 0;
+    ON_BLOCK_EXIT(cursor->close, cursor);
+
+    int64_t bytes = 0;
+    for (int n = 1; cursor->next(cursor) == 0; n++) {
+        WT_ITEM key;
+        WT_ITEM value;
+        invariantWTOK(cursor->get_key(cursor, &key));
+        invariantWTOK(cursor->get_value(cursor, &value));
+
+        const int64_t size = static_cast<int64_t>(key.size + value.size);
+        bytes += size;
+        if (budget->subtractAndFetch(size) <= 0)
+            break;
+        if (n % 1024 == 0 && _interrupted.load())
+            break;
+    }
+    return bytes;
+}
+
+}
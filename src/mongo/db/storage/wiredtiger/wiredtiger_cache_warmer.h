@@ -0,0 +1,151 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <wiredtiger.h>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * Repopulates the WiredTiger cache after a restart so that the working set does not have to be
+ * faulted back in by user operations one page at a time.
+ *
+ * While the server runs, the warmer periodically samples the per-table cursor statistics to
+ * find which tables are being accessed, keeps a decaying hotness score for each of them, and
+ * persists the hottest tables to a manifest table. On the next startup it reads those tables
+ * sequentially, hottest first and with several threads, until a byte budget is used up.
+ *
+ * WiredTiger only keeps access statistics per table, so the manifest records whole tables rather
+ * than key ranges. Reading them opens the table, so only tables which cursors were opened on are
+ * sampled, until their score decays to zero.
+ */
+class WiredTigerCacheWarmer {
+    MONGO_DISALLOW_COPYING(WiredTigerCacheWarmer);
+
+public:
+    /**
+     * URI of the manifest table. It is not a user ident and must be skipped when enumerating
+     * idents.
+     */
+    static const char* const kTableUri;
+
+    struct ManifestEntry {
+        std::string uri;
+        int64_t score;
+    };
+
+    /**
+     * Creates the manifest table if needed. The connection must have statistics enabled.
+     */
+    explicit WiredTigerCacheWarmer(WT_CONNECTION* conn);
+    ~WiredTigerCacheWarmer();
+
+    /**
+     * Starts a background thread which warms the cache from the saved manifest, reading at most
+     * 'warmupBudgetBytes' with 'warmupThreads' threads, and then records a new manifest every
+     * 'recordInterval'. Warm-up is skipped if 'warmupThreads' is 0.
+     */
+    void startup(int warmupThreads, int64_t warmupBudgetBytes, Milliseconds recordInterval);
+
+    /**
+     * Interrupts any warm-up in progress, stops the background thread and records the manifest
+     * one last time. Must be called before the connection is closed. Calling it more than once
+     * is allowed.
+     */
+    void shutdown();
+
+    /**
+     * Samples the cursor statistics of the tables which were opened since the previous sample or
+     * still have a score, folds the operations since the previous sample into the hotness scores
+     * and saves the hottest tables as the manifest. If saving fails, the manifest is left as it
+     * was and the next call saves it again.
+     */
+    void recordManifest();
+
+    /**
+     * Notes that a cursor was opened on 'uri', so that the next recordManifest() samples it.
+     * Does nothing unless a cache warmer exists. Thread safe.
+     */
+    static void noteCursorOpened(const std::string& uri);
+
+    /**
+     * Returns the saved manifest, hottest table first.
+     */
+    std::vector<ManifestEntry> loadManifest() const;
+
+    /**
+     * Reads the tables in the saved manifest from start to end, hottest first, using
+     * 'numThreads' threads. Stops once 'budgetBytes' of keys and values have been read or
+     * shutdown() is called. Returns the number of bytes read.
+     */
+    int64_t warmFromManifest(int numThreads, int64_t budgetBytes);
+
+private:
+    struct TableUsage {
+        uint64_t lastOps = 0;
+        int64_t score = 0;
+    };
+
+    void _backgroundThread(int warmupThreads, int64_t warmupBudgetBytes, Milliseconds interval);
+
+    /**
+     * Reads 'uri' sequentially, charging what is read against 'budget'. Returns the number of
+     * bytes read.
+     */
+    int64_t _warmTable(WT_SESSION* session, const std::string& uri, AtomicInt64* budget);
+
+    WT_CONNECTION* const _conn;  // not owned
+
+    // Set by shutdown(). Checked by the warm-up readers without holding _mutex.
+    AtomicUInt32 _interrupted;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _shutdownCV;
+    bool _shuttingDown = false;
+    stdx::thread _thread;
+
+    // Serializes recordManifest() and protects _usage.
+    stdx::mutex _recordMutex;
+    std::map<std::string, TableUsage> _usage;
+};
+
+}
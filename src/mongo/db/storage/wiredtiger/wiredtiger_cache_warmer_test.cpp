@@ -0,0 +1,236 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_cache_warmer.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const int kNumRecords = 1000;
+const int kValueSize = 100;
+
+class WiredTigerCacheWarmerTest : public unittest::Test {
+public:
+    WiredTigerCacheWarmerTest() : _dbpath("wt_cache_warmer_test") {
+        open();
+    }
+
+    ~WiredTigerCacheWarmerTest() {
+        close();
+    }
+
+    void open() {
+        int ret = wiredtiger_open(_dbpath.path().c_str(), NULL, "create,statistics=(fast)", &_conn);
+        ASSERT_OK(wtRCToStatus(ret));
+    }
+
+    void close() {
+        if (_conn) {
+            _conn->close(_conn, NULL);
+            _conn = NULL;
+        }
+    }
+
+    void createTable(const std::string& uri) {
+        WT_SESSION* session;
+        invariantWTOK(_conn->open_session(_conn, NULL, NULL, &session));
+        invariantWTOK(session->create(session, uri.c_str(), "key_format=q,value_format=S"));
+        WT_CURSOR* cursor;
+        invariantWTOK(session->open_cursor(session, uri.c_str(), NULL, NULL, &cursor));
+        const std::string value(kValueSize - 1, 'x');
+        for (int64_t i = 0; i < kNumRecords; i++) {
+            cursor->set_key(cursor, i);
+            cursor->set_value(cursor, value.c_str());
+            invariantWTOK(cursor->insert(cursor));
+        }
+        invariantWTOK(session->close(session, NULL));
+    }
+
+    /**
+     * Searches 'uri' through a WiredTigerSession, as record stores and indexes do, so that the
+     * cache warmer learns that the table is in use.
+     */
+    void readTable(const std::string& uri, int numSearches) {
+        WiredTigerSession session(_conn);
+        const uint64_t tableId = WiredTigerSession::genTableId();
+        WT_CURSOR* cursor = session.getCursor(uri, tableId, true);
+        ASSERT(cursor);
+        for (int i = 0; i < numSearches; i++) {
+            cursor->set_key(cursor, static_cast<int64_t>(i % kNumRecords));
+            invariantWTOK(cursor->search(cursor));
+        }
+        session.releaseCursor(tableId, cursor);
+    }
+
+    uint64_t getOpenFiles() {
+        WT_SESSION* session;
+        invariantWTOK(_conn->open_session(_conn, NULL, NULL, &session));
+        StatusWith<uint64_t> openFiles = WiredTigerUtil::getStatisticsValue(
+            session, "statistics:", "statistics=(fast)", WT_STAT_CONN_FILE_OPEN);
+        invariantWTOK(session->close(session, NULL));
+        ASSERT_OK(openFiles.getStatus());
+        return openFiles.getValue();
+    }
+
+protected:
+    unittest::TempDir _dbpath;
+    WT_CONNECTION* _conn = NULL;
+};
+
+TEST_F(WiredTigerCacheWarmerTest, ManifestStartsEmpty) {
+    WiredTigerCacheWarmer warmer(_conn);
+    ASSERT_EQUALS(0U, warmer.loadManifest().size());
+    ASSERT_EQUALS(0, warmer.warmFromManifest(2, 1024 * 1024));
+}
+
+TEST_F(WiredTigerCacheWarmerTest, ManifestOrdersTablesByAccesses) {
+    createTable("table:cold");
+    createTable("table:warm");
+    createTable("table:hot");
+    WiredTigerCacheWarmer warmer(_conn);
+    readTable("table:warm", 10);
+    readTable("table:hot", 100);
+
+    warmer.recordManifest();
+
+    std::vector<WiredTigerCacheWarmer::ManifestEntry> manifest = warmer.loadManifest();
+    ASSERT_EQUALS(2U, manifest.size());
+    ASSERT_EQUALS("table:hot", manifest[0].uri);
+    ASSERT_EQUALS("table:warm", manifest[1].uri);
+    ASSERT_GREATER_THAN(manifest[0].score, manifest[1].score);
+}
+
+TEST_F(WiredTigerCacheWarmerTest, SamplingDoesNotOpenUnusedTables) {
+    createTable("table:cold");
+    createTable("table:hot");
+
+    // Reopen so that no table is open.
+    close();
+    open();
+
+    WiredTigerCacheWarmer warmer(_conn);
+    readTable("table:hot", 100);
+    const uint64_t openFiles = getOpenFiles();
+    warmer.recordManifest();
+    warmer.recordManifest();
+    ASSERT_EQUALS(openFiles, getOpenFiles());
+
+    std::vector<WiredTigerCacheWarmer::ManifestEntry> manifest = warmer.loadManifest();
+    ASSERT_EQUALS(1U, manifest.size());
+    ASSERT_EQUALS("table:hot", manifest[0].uri);
+}
+
+TEST_F(WiredTigerCacheWarmerTest, TablesNoLongerUsedAreNoLongerSampled) {
+    createTable("table:hot");
+    WiredTigerCacheWarmer warmer(_conn);
+    readTable("table:hot", 4);
+
+    // The score halves at every sample without accesses, and the table is dropped from the
+    // manifest once it reaches zero.
+    for (int i = 0; i < 10; i++) {
+        warmer.recordManifest();
+    }
+    ASSERT_EQUALS(0U, warmer.loadManifest().size());
+
+    // Opening a cursor on it again brings it back.
+    readTable("table:hot", 4);
+    warmer.recordManifest();
+    ASSERT_EQUALS(1U, warmer.loadManifest().size());
+}
+
+TEST_F(WiredTigerCacheWarmerTest, ScoresDecayWithoutAccesses) {
+    createTable("table:hot");
+    WiredTigerCacheWarmer warmer(_conn);
+    readTable("table:hot", 100);
+
+    warmer.recordManifest();
+    const int64_t firstScore = warmer.loadManifest()[0].score;
+
+    // No new accesses, so the score should only decay.
+    warmer.recordManifest();
+    std::vector<WiredTigerCacheWarmer::ManifestEntry> manifest = warmer.loadManifest();
+    ASSERT_EQUALS(1U, manifest.size());
+    ASSERT_EQUALS(firstScore / 2, manifest[0].score);
+}
+
+TEST_F(WiredTigerCacheWarmerTest, WarmReadsManifestAfterRestart) {
+    createTable("table:hot");
+    {
+        WiredTigerCacheWarmer warmer(_conn);
+        readTable("table:hot", 100);
+        warmer.recordManifest();
+    }
+
+    close();
+    open();
+
+    WiredTigerCacheWarmer warmer(_conn);
+    ASSERT_EQUALS(1U, warmer.loadManifest().size());
+    ASSERT_GREATER_THAN_OR_EQUALS(warmer.warmFromManifest(2, 1024 * 1024),
+                                  kNumRecords * kValueSize);
+}
+
+TEST_F(WiredTigerCacheWarmerTest, WarmStopsAtBudget) {
+    createTable("table:a");
+    createTable("table:b");
+    WiredTigerCacheWarmer warmer(_conn);
+    readTable("table:a", 100);
+    readTable("table:b", 100);
+
+    warmer.recordManifest();
+
+    // Each reader may overshoot the budget by at most one record.
+    const int64_t budget = kValueSize * 10;
+    const int64_t bytes = warmer.warmFromManifest(2, budget);
+    ASSERT_GREATER_THAN_OR_EQUALS(bytes, budget);
+    ASSERT_LESS_THAN(bytes, budget + 2 * (kValueSize + 16));
+}
+
+TEST_F(WiredTigerCacheWarmerTest, ShutdownRecordsManifest) {
+    createTable("table:hot");
+    WiredTigerCacheWarmer warmer(_conn);
+    readTable("table:hot", 100);
+
+    warmer.startup(1, 1024 * 1024, Seconds(3600));
+    warmer.shutdown();
+    warmer.shutdown();
+
+    ASSERT_EQUALS(1U, warmer.loadManifest().size());
+}
+
+}  // namespace
+}  // namespace mongo
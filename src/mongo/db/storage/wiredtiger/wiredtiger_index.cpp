@@ -137,6 +137,12 @@ StatusWith<std::string> WiredTigerIndex::parseIndexOptions(const BSONObj& option
                 return status;
             }
             ss << elem.valueStringData() << ',';
+        } else if (elem.fieldNameStringData() == "cachePriority") {
+            StatusWith<std::string> priority = WiredTigerUtil::parseCachePriority(elem);
+            if (!priority.isOK()) {
+                return priority;
+            }
+            ss << priority.getValue();
         } else {
             // Return error on first unrecognized field.
             return StatusWith<std::string>(ErrorCodes::InvalidOptions,
@@ -139,4 +139,14 @@ TEST(WiredTigerIndexTest, GenerateCreateStringValidConfigStringOption) {
     ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), std::string("prefix_compression=true,"));
 }
 
+TEST(WiredTigerIndexTest, GenerateCreateStringResidentCachePriority) {
+    BSONObj spec = fromjson("{cachePriority: 'resident'}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), std::string("cache_resident=true,"));
+}
+
+TEST(WiredTigerIndexTest, GenerateCreateStringInvalidCachePriority) {
+    BSONObj spec = fromjson("{cachePriority: 'high'}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), ErrorCodes::BadValue);
+}
+
 }  // namespace mongo
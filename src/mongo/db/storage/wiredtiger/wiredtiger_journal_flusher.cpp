@@ -0,0 +1,128 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_journal_flusher.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+const char* const WiredTigerJournalFlusher::kTableUri = "table:journalFlusher";
+
+WiredTigerJournalFlusher::WiredTigerJournalFlusher(WT_CONNECTION* conn) : _conn(conn) {
+    WT_SESSION* session;
+    invariantWTOK(_conn->open_session(_conn, NULL, NULL, &session));
+    invariantWTOK(session->create(session, kTableUri, "key_format=q,value_format=q"));
+    invariantWTOK(session->close(session, NULL));
+
+    _thread = stdx::thread(stdx::bind(&WiredTigerJournalFlusher::_flusherThread, this));
+}
+
+WiredTigerJournalFlusher::~WiredTigerJournalFlusher() {
+    shutdown();
+}
+
+void WiredTigerJournalFlusher::waitUntilDurable() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (_shuttingDown)
+        return;
+
+    // Any sync that has already started may have been issued before our caller's commit, so only
+    // the next one is guaranteed to cover it.
+    const uint64_t neededFlush = _flushesStarted + 1;
+    if (!_flushRequested) {
+        _flushRequested = true;
+        _flushRequestedCV.notify_one();
+    }
+    _flushCompletedCV.wait(lk, [this, neededFlush] { return _flushesCompleted >= neededFlush; });
+}
+
+void WiredTigerJournalFlusher::shutdown() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_shuttingDown)
+            return;
+        _shuttingDown = true;
+        _flushRequestedCV.notify_one();
+    }
+    _thread.join();
+}
+
+uint64_t WiredTigerJournalFlusher::getNumFlushes() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _flushesCompleted;
+}
+
+void WiredTigerJournalFlusher::_flusherThread() {
+    setThreadName("WTJournalFlusher");
+    LOG(1) << "starting WiredTiger journal flusher thread";
+
+    WT_SESSION* session;
+    invariantWTOK(_conn->open_session(_conn, NULL, NULL, &session));
+    WT_CURSOR* cursor;
+    invariantWTOK(session->open_cursor(session, kTableUri, NULL, NULL, &cursor));
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (true) {
+        _flushRequestedCV.wait(lk, [this] { return _flushRequested || _shuttingDown; });
+
+        // Requests made before shutdown are still honored, so nobody is left waiting.
+        if (!_flushRequested)
+            break;
+
+        _flushRequested = false;
+        const uint64_t flushNumber = ++_flushesStarted;
+        lk.unlock();
+
+        // Committing with sync=true flushes the log up to this commit, which includes every
+        // commit that finished before the sync was started.
+        invariantWTOK(session->begin_transaction(session, "sync=true"));
+        cursor->set_key(cursor, static_cast<int64_t>(1));
+        cursor->set_value(cursor, static_cast<int64_t>(flushNumber));
+        invariantWTOK(cursor->insert(cursor));
+        invariantWTOK(session->commit_transaction(session, NULL));
+
+        lk.lock();
+        _flushesCompleted = flushNumber;
+        _flushCompletedCV.notify_all();
+    }
+    lk.unlock();
+
+    // Closing the session also closes the cursor.
+    invariantWTOK(session->close(session, NULL));
+    LOG(1) << "stopping WiredTiger journal flusher thread";
+}
+}
@@ -0,0 +1,108 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <wiredtiger.h>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+/**
+ * Group commit for the WiredTiger journal. Threads that need their already committed writes to
+ * be durable call waitUntilDurable(), which blocks until a log sync that started after the call
+ * has completed. A single background thread performs the syncs, so every waiter that arrives
+ * while a sync is in progress is covered by the next one. Under light load a waiter pays for
+ * about one fsync, and under heavy load the number of waiters covered by each fsync grows with
+ * the time the fsync takes.
+ *
+ * This version of WiredTiger has no way to flush the log directly, so each sync is done by
+ * committing a one record update to a private table with sync=true, which forces the log to be
+ * flushed up to and including that commit.
+ */
+class WiredTigerJournalFlusher {
+    MONGO_DISALLOW_COPYING(WiredTigerJournalFlusher);
+
+public:
+    /**
+     * URI of the table written by the flusher. It is not a user ident and must be skipped when
+     * enumerating idents.
+     */
+    static const char* const kTableUri;
+
+    /**
+     * Creates the flusher table if needed and starts the flusher thread. The connection must
+     * have logging enabled.
+     */
+    explicit WiredTigerJournalFlusher(WT_CONNECTION* conn);
+    ~WiredTigerJournalFlusher();
+
+    /**
+     * Blocks until all writes committed before this call are in the journal. Returns
+     * immediately once shutdown() has been called.
+     */
+    void waitUntilDurable();
+
+    /**
+     * Performs any sync that was requested before this call and stops the flusher thread. Must
+     * be called before the connection is closed. Calling it more than once is allowed.
+     */
+    void shutdown();
+
+    /**
+     * Returns the number of log syncs performed so far.
+     */
+    uint64_t getNumFlushes() const;
+
+private:
+    void _flusherThread();
+
+    WT_CONNECTION* const _conn;  // not owned
+
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _flushRequestedCV;
+    stdx::condition_variable _flushCompletedCV;
+
+    // Number of syncs started and completed. A waiter is covered by the sync whose number is one
+    // more than _flushesStarted at the time it started waiting.
+    uint64_t _flushesStarted = 0;
+    uint64_t _flushesCompleted = 0;
+
+    bool _flushRequested = false;
+    bool _shuttingDown = false;
+
+    stdx::thread _thread;
+};
+
+}
@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_journal_flusher.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class WiredTigerJournalFlusherTest : public unittest::Test {
+public:
+    WiredTigerJournalFlusherTest() : _dbpath("wt_journal_flusher_test") {
+        int ret = wiredtiger_open(
+            _dbpath.path().c_str(), NULL, "create,log=(enabled=true,path=journal)", &_conn);
+        ASSERT_OK(wtRCToStatus(ret));
+    }
+
+    ~WiredTigerJournalFlusherTest() {
+        _conn->close(_conn, NULL);
+    }
+
+    int64_t readFlusherRecord() {
+        WT_SESSION* session;
+        invariantWTOK(_conn->open_session(_conn, NULL, NULL, &session));
+        WT_CURSOR* cursor;
+        invariantWTOK(session->open_cursor(
+            session, WiredTigerJournalFlusher::kTableUri, NULL, NULL, &cursor));
+        cursor->set_key(cursor, static_cast<int64_t>(1));
+        invariantWTOK(cursor->search(cursor));
+        int64_t value;
+        invariantWTOK(cursor->get_value(cursor, &value));
+        invariantWTOK(session->close(session, NULL));
+        return value;
+    }
+
+protected:
+    unittest::TempDir _dbpath;
+    WT_CONNECTION* _conn = NULL;
+};
+
+TEST_F(WiredTigerJournalFlusherTest, NoSyncWithoutWaiters) {
+    WiredTigerJournalFlusher flusher(_conn);
+    flusher.shutdown();
+    ASSERT_EQUALS(0U, flusher.getNumFlushes());
+}
+
+TEST_F(WiredTigerJournalFlusherTest, EachSequentialWaitSyncs) {
+    WiredTigerJournalFlusher flusher(_conn);
+    flusher.waitUntilDurable();
+    ASSERT_EQUALS(1U, flusher.getNumFlushes());
+    flusher.waitUntilDurable();
+    ASSERT_EQUALS(2U, flusher.getNumFlushes());
+    flusher.shutdown();
+
+    ASSERT_EQUALS(2, readFlusherRecord());
+}
+
+TEST_F(WiredTigerJournalFlusherTest, ConcurrentWaitersShareSyncs) {
+    const int kThreads = 16;
+    const int kWaitsPerThread = 50;
+
+    WiredTigerJournalFlusher flusher(_conn);
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kThreads; i++) {
+        threads.emplace_back([&flusher] {
+            for (int j = 0; j < kWaitsPerThread; j++) {
+                flusher.waitUntilDurable();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    flusher.shutdown();
+
+    // Every thread waited for at least kWaitsPerThread distinct syncs, but no wait should need
+    // more than one sync of its own.
+    ASSERT_GREATER_THAN_OR_EQUALS(flusher.getNumFlushes(), uint64_t(kWaitsPerThread));
+    ASSERT_LESS_THAN_OR_EQUALS(flusher.getNumFlushes(), uint64_t(kThreads * kWaitsPerThread));
+}
+
+TEST_F(WiredTigerJournalFlusherTest, WaitAfterShutdownReturnsImmediately) {
+    WiredTigerJournalFlusher flusher(_conn);
+    flusher.shutdown();
+    flusher.shutdown();
+    flusher.waitUntilDurable();
+    ASSERT_EQUALS(0U, flusher.getNumFlushes());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -39,15 +39,19 @@
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_cache_warmer.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_index.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_journal_flusher.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
@@ -62,6 +66,31 @@ namespace mongo {
 using std::set;
 using std::string;
 
+namespace {
+
+// How often the cache warmer records which tables are hot. 0, the default, disables the cache
+// warmer.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerCacheManifestIntervalSecs, int, 0);
+
+// Number of threads which read the hot tables back into the cache at startup. 0 skips warm-up.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerCacheWarmupThreads, int, 4);
+
+// Percentage of the cache which warm-up may fill.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerCacheWarmupPercent, int, 50);
+
+// Percentage of the cache which tables created with cachePriority "resident" may take before
+// creating another one fails.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerMaxResidentCachePercent, int, 25);
+
+// How often negative record counts and data sizes are raised back to zero. Writers no longer do
+// it themselves, so this bounds how long a count that started out too low hides inserts.
+const Milliseconds kCounterResetInterval(1000);
+
+// How often the size storer's cache is written to its table, as often as before the writes moved
+// to their own thread.
+const Milliseconds kSizeStorerSyncInterval(60 * 1000);
+
+}  // namespace
 
 WiredTigerKVEngine::WiredTigerKVEngine(const std::string& path,
                                        const std::string& extraOpenOptions,
@@ -69,8 +98,7 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& path,
                                        bool repair)
     : _eventHandler(WiredTigerUtil::defaultEventHandlers()),
       _path(path),
-      _durable(durable),
-      _sizeStorerSyncTracker(100000, 60 * 1000) {
+      _durable(durable) {
     size_t cacheSizeGB = wiredTigerGlobalOptions.cacheSizeGB;
     if (cacheSizeGB == 0) {
         // Since the user didn't provide a cache size, choose a reasonable default value.
@@ -162,6 +190,18 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& path,
         _sizeStorer.reset(new WiredTigerSizeStorer(_conn, _sizeStorerUri));
         _sizeStorer->fillCache();
     }
+    _sizeStorerSyncer =
+        stdx::thread(stdx::bind(&WiredTigerKVEngine::_sizeStorerSyncThread, this));
+
+    if (wiredTigerCacheManifestIntervalSecs > 0) {
+        const int64_t warmupBudgetBytes =
+            static_cast<int64_t>(cacheSizeGB) * 1024 * 1024 * 1024 / 100 *
+            std::max(0, std::min(wiredTigerCacheWarmupPercent, 100));
+        _cacheWarmer.reset(new WiredTigerCacheWarmer(_conn));
+        _cacheWarmer->startup(std::max(0, wiredTigerCacheWarmupThreads),
+                              warmupBudgetBytes,
+                              Seconds(wiredTigerCacheManifestIntervalSecs));
+    }
 }
 
 
@@ -175,6 +215,18 @@ WiredTigerKVEngine::~WiredTigerKVEngine() {
 
 void WiredTigerKVEngine::cleanShutdown() {
     log() << "WiredTigerKVEngine shutting down";
+    if (_cacheWarmer) {
+        _cacheWarmer->shutdown();
+        _cacheWarmer.reset();
+    }
+    if (_sizeStorerSyncer.joinable()) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_sizeStorerSyncMutex);
+            _sizeStorerSyncShutdown = true;
+        }
+        _sizeStorerSyncCV.notify_one();
+        _sizeStorerSyncer.join();
+    }
     syncSizeInfo(true);
     if (_conn) {
         // these must be the last things we do before _conn->close();
@@ -260,6 +312,28 @@ void WiredTigerKVEngine::syncSizeInfo(bool sync) const {
     }
 }
 
+void WiredTigerKVEngine::_sizeStorerSyncThread() {
+    setThreadName("WTSizeStorerSync");
+    Date_t lastSync = Date_t::now();
+    stdx::unique_lock<stdx::mutex> lk(_sizeStorerSyncMutex);
+    while (!_sizeStorerSyncShutdown) {
+        _sizeStorerSyncCV.wait_for(lk, kCounterResetInterval);
+        if (_sizeStorerSyncShutdown)
+            break;
+
+        lk.unlock();
+        if (_sizeStorer) {
+            _sizeStorer->resetNegativeCounters();
+        }
+        const Date_t now = Date_t::now();
+        if (now - lastSync >= kSizeStorerSyncInterval) {
+            syncSizeInfo(false);
+            lastSync = now;
+        }
+        lk.lock();
+    }
+}
+
 RecoveryUnit* WiredTigerKVEngine::newRecoveryUnit() {
     return new WiredTigerRecoveryUnit(_sessionCache.get());
 }
@@ -288,6 +362,11 @@ Status WiredTigerKVEngine::createRecordStore(OperationContext* opCtx,
 
     string uri = _uri(ident);
     WT_SESSION* s = session.getSession();
+    Status status =
+        WiredTigerUtil::checkResidentCacheLimit(s, config, wiredTigerMaxResidentCachePercent);
+    if (!status.isOK()) {
+        return status;
+    }
     LOG(2) << "WiredTigerKVEngine::createRecordStore uri: " << uri << " config: " << config;
     return wtRCToStatus(s->create(s, uri.c_str(), config.c_str()));
 }
@@ -344,6 +423,14 @@ Status WiredTigerKVEngine::createSortedDataInterface(OperationContext* opCtx,
 
     std::string config = result.getValue();
 
+    Status status = WiredTigerUtil::checkResidentCacheLimit(
+        WiredTigerRecoveryUnit::get(opCtx)->getSession(opCtx)->getSession(),
+        config,
+        wiredTigerMaxResidentCachePercent);
+    if (!status.isOK()) {
+        return status;
+    }
+
     LOG(2) << "WiredTigerKVEngine::createSortedDataInterface ident: " << ident
            << " config: " << config;
     return wtRCToStatus(WiredTigerIndex::Create(opCtx, _uri(ident), config));
@@ -393,11 +480,6 @@ bool WiredTigerKVEngine::haveDropsQueued() const {
     Date_t now = Date_t::now();
     Milliseconds delta = now - _previousCheckedDropsQueued;
 
-    if (_sizeStorerSyncTracker.intervalHasElapsed()) {
-        _sizeStorerSyncTracker.resetLastTime();
-        syncSizeInfo(false);
-    }
-
     // We only want to check the queue max once per second or we'll thrash
     // This is done in haveDropsQueued, not dropAllQueued so we skip the mutex
     if (delta < Milliseconds(1000))
@@ -490,6 +572,9 @@ std::vector<std::string> WiredTigerKVEngine::getAllIdents(OperationContext* opCt
         if (type != "table")
             continue;
 
+        if (key == WiredTigerJournalFlusher::kTableUri || key == WiredTigerCacheWarmer::kTableUri)
+            continue;
+
         StringData ident = key.substr(idx + 1);
         if (ident == "sizeStorer")
             continue;
@@ -39,11 +39,13 @@
 #include "mongo/bson/ordering.h"
 #include "mongo/db/storage/kv/kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
-#include "mongo/util/elapsed_tracker.h"
+#include "mongo/stdx/thread.h"
 
 namespace mongo {
 
+class WiredTigerCacheWarmer;
 class WiredTigerSessionCache;
 class WiredTigerSizeStorer;
 
@@ -140,6 +142,12 @@ private:
     std::string _uri(StringData ident) const;
     bool _drop(StringData ident);
 
+    /**
+     * Body of the thread which periodically resets negative record counts and writes the size
+     * storer's cache out to its table, so that operations never have to do either themselves.
+     */
+    void _sizeStorerSyncThread();
+
     WT_CONNECTION* _conn;
     WT_EVENT_HANDLER _eventHandler;
     std::unique_ptr<WiredTigerSessionCache> _sessionCache;
@@ -154,7 +162,13 @@ private:
 
     std::unique_ptr<WiredTigerSizeStorer> _sizeStorer;
     std::string _sizeStorerUri;
-    mutable ElapsedTracker _sizeStorerSyncTracker;
+
+    stdx::mutex _sizeStorerSyncMutex;
+    stdx::condition_variable _sizeStorerSyncCV;
+    bool _sizeStorerSyncShutdown = false;
+    stdx::thread _sizeStorerSyncer;
+
+    std::unique_ptr<WiredTigerCacheWarmer> _cacheWarmer;
 
     mutable Date_t _previousCheckedDropsQueued;
 };
@@ -35,9 +35,13 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 
+#include <algorithm>
+#include <cmath>
 #include <wiredtiger.h>
 
 #include "mongo/base/checked_cast.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/db/concurrency/locker.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
@@ -46,6 +50,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
@@ -91,6 +96,17 @@ MONGO_FP_DECLARE(WTWriteConflictException);
 
 const std::string kWiredTigerEngineName = "wiredTiger";
 
+/**
+ * A capped insert that is hidden from readers until it commits or rolls back.
+ */
+struct WiredTigerRecordStore::UncommittedLoc {
+    explicit UncommittedLoc(const RecordId& loc, bool done = false) : loc(loc), done(done) {}
+
+    const RecordId loc;
+    std::atomic<bool> done;
+    std::atomic<UncommittedLoc*> next{nullptr};
+};
+
 class WiredTigerRecordStore::Cursor final : public RecordCursor {
 public:
     Cursor(OperationContext* txn, const WiredTigerRecordStore& rs, bool forward = true)
@@ -295,6 +311,12 @@ StatusWith<std::string> WiredTigerRecordStore::parseOptionsField(const BSONObj o
                 return status;
             }
             ss << elem.valueStringData() << ',';
+        } else if (elem.fieldNameStringData() == "cachePriority") {
+            StatusWith<std::string> priority = WiredTigerUtil::parseCachePriority(elem);
+            if (!priority.isOK()) {
+                return priority;
+            }
+            ss << priority.getValue();
         } else {
             // Return error on first unrecognized field.
             return StatusWith<std::string>(ErrorCodes::InvalidOptions,
@@ -432,6 +454,338 @@ StatusWith<std::string> WiredTigerRecordStore::generateCreateString(
     return StatusWith<std::string>(ss);
 }
 
+class WiredTigerRecordStore::OplogStones::InsertChange final : public RecoveryUnit::Change {
+public:
+    InsertChange(OplogStones* oplogStones,
+                 int64_t bytesInserted,
+                 const RecordId& highestInserted,
+                 int64_t countInserted)
+        : _oplogStones(oplogStones),
+          _bytesInserted(bytesInserted),
+          _highestInserted(highestInserted),
+          _countInserted(countInserted) {}
+
+    void commit() final {
+        invariant(_bytesInserted >= 0);
+        invariant(_highestInserted.isNormal());
+
+        _oplogStones->_currentRecords.fetchAndAdd(_countInserted);
+        int64_t newCurrentBytes = _oplogStones->_currentBytes.addAndFetch(_bytesInserted);
+        if (newCurrentBytes >= _oplogStones->_minBytesPerStone) {
+            _oplogStones->createNewStoneIfNeeded(_highestInserted);
+        }
+    }
+
+    void rollback() final {}
+
+private:
+    OplogStones* _oplogStones;
+    int64_t _bytesInserted;
+    RecordId _highestInserted;
+    int64_t _countInserted;
+};
+
+class WiredTigerRecordStore::OplogStones::TruncateChange final : public RecoveryUnit::Change {
+public:
+    TruncateChange(OplogStones* oplogStones) : _oplogStones(oplogStones) {}
+
+    void commit() final {
+        _oplogStones->_currentRecords.store(0);
+        _oplogStones->_currentBytes.store(0);
+
+        stdx::lock_guard<stdx::mutex> lk(_oplogStones->_mutex);
+        _oplogStones->_stones.clear();
+    }
+
+    void rollback() final {}
+
+private:
+    OplogStones* _oplogStones;
+};
+
+WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* txn, WiredTigerRecordStore* rs)
+    : _rs(rs), _currentRecords(0), _currentBytes(0) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    invariant(rs->isCapped());
+    invariant(rs->cappedMaxSize() > 0);
+    const int64_t maxSize = rs->cappedMaxSize();
+
+    // Keep enough stones that truncating one only removes a small part of the oplog, but make
+    // each of them at least as large as the largest possible oplog entry.
+    const int64_t kMinStonesToKeep = 10;
+    const int64_t kMaxStonesToKeep = 100;
+
+    const int64_t numStones = maxSize / BSONObjMaxInternalSize;
+    _numStonesToKeep = std::min(kMaxStonesToKeep, std::max(kMinStonesToKeep, numStones));
+    _minBytesPerStone = maxSize / _numStonesToKeep;
+    invariant(_minBytesPerStone > 0);
+
+    _calculateStones(txn);
+    _pokeReclaimThreadIfNeeded_inlock();  // Reclaim stones if over the limit.
+}
+
+bool WiredTigerRecordStore::OplogStones::isDead() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _isDead;
+}
+
+void WiredTigerRecordStore::OplogStones::kill() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _isDead = true;
+    _oplogReclaimCv.notify_one();
+}
+
+bool WiredTigerRecordStore::OplogStones::hasExcessStones() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _hasExcessStones_inlock();
+}
+
+void WiredTigerRecordStore::OplogStones::awaitHasExcessStonesOrDead() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (!_isDead && !_hasExcessStones_inlock()) {
+        _oplogReclaimCv.wait(lk);
+    }
+}
+
+boost::optional<WiredTigerRecordStore::OplogStones::Stone>
+WiredTigerRecordStore::OplogStones::peekOldestStoneIfNeeded() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    if (!_hasExcessStones_inlock()) {
+        return {};
+    }
+
+    return _stones.front();
+}
+
+void WiredTigerRecordStore::OplogStones::popOldestStone() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _stones.pop_front();
+}
+
+void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(const RecordId& lastRecord) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex, stdx::try_to_lock);
+    if (!lk) {
+        // Someone else is either creating a new stone or popping the oldest one. Either way the
+        // next insert to commit will create the stone if it is still needed.
+        return;
+    }
+
+    if (_currentBytes.load() < _minBytesPerStone) {
+        // Someone else created a new stone first.
+        return;
+    }
+
+    if (!_stones.empty() && lastRecord < _stones.back().lastRecord) {
+        // Inserts can commit out of order. Stones must stay ordered by their last record, so
+        // leave this one to an insert with a higher RecordId.
+        return;
+    }
+
+    OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), lastRecord};
+    _stones.push_back(stone);
+
+    _pokeReclaimThreadIfNeeded_inlock();
+}
+
+void WiredTigerRecordStore::OplogStones::updateCurrentStoneAfterInsertOnCommit(
+    OperationContext* txn,
+    int64_t bytesInserted,
+    const RecordId& highestInserted,
+    int64_t countInserted) {
+    txn->recoveryUnit()->registerChange(
+        new InsertChange(this, bytesInserted, highestInserted, countInserted));
+}
+
+void WiredTigerRecordStore::OplogStones::clearStonesOnCommit(OperationContext* txn) {
+    txn->recoveryUnit()->registerChange(new TruncateChange(this));
+}
+
+void WiredTigerRecordStore::OplogStones::updateStonesAfterCappedTruncateAfter(
+    int64_t numRecordsRemoved, int64_t dataSizeRemoved, const RecordId& firstRemovedId) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    int64_t numStonesToRemove = 0;
+    int64_t recordsInStonesToRemove = 0;
+    int64_t dataSizeInStonesToRemove = 0;
+
+    // Find the stones that were either fully or partially truncated.
+    for (auto it = _stones.rbegin(); it != _stones.rend(); ++it) {
+        if (it->lastRecord < firstRemovedId) {
+            break;
+        }
+        numStonesToRemove++;
+        recordsInStonesToRemove += it->records;
+        dataSizeInStonesToRemove += it->bytes;
+    }
+
+    _stones.erase(_stones.end() - numStonesToRemove, _stones.end());
+
+    // Whatever is left of a partially truncated stone now belongs to the chunk being filled.
+    _currentRecords.fetchAndAdd(recordsInStonesToRemove - numRecordsRemoved);
+    _currentBytes.fetchAndAdd(dataSizeInStonesToRemove - dataSizeRemoved);
+}
+
+size_t WiredTigerRecordStore::OplogStones::numStones() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _stones.size();
+}
+
+void WiredTigerRecordStore::OplogStones::setMinBytesPerStone(int64_t size) {
+    invariant(size > 0);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    // Only allow changing the minimum bytes per stone if no data has been inserted.
+    invariant(_stones.empty() && _currentRecords.load() == 0);
+    _minBytesPerStone = size;
+}
+
+void WiredTigerRecordStore::OplogStones::setNumStonesToKeep(size_t numStones) {
+    invariant(numStones > 0);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    // Only allow changing the number of stones to keep if no data has been inserted.
+    invariant(_stones.empty() && _currentRecords.load() == 0);
+    _numStonesToKeep = numStones;
+}
+
+void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* txn) {
+    const int64_t numRecords = _rs->numRecords(txn);
+    const int64_t dataSize = _rs->dataSize(txn);
+
+    log() << "The size storer reports that the oplog contains " << numRecords
+          << " records totaling to " << dataSize << " bytes";
+
+    // Only sample if the number of samples drawn is less than 5% of the oplog.
+    const uint64_t kMinSampleRatioForRandCursor = 20;
+
+    // If the oplog doesn't contain enough records to make sampling more efficient, then scan the
+    // oplog to determine where to put down stones.
+    if (numRecords <= 0 || dataSize <= 0 ||
+        uint64_t(numRecords) <
+            kMinSampleRatioForRandCursor * kRandomSamplesPerStone * _numStonesToKeep) {
+        _calculateStonesByScanning(txn);
+        return;
+    }
+
+    // Use the average record size to estimate how many records fit in a stone, and how large
+    // they are together.
+    const double avgRecordSize = double(dataSize) / double(numRecords);
+    const double estRecordsPerStone = std::ceil(_minBytesPerStone / avgRecordSize);
+    const double estBytesPerStone = estRecordsPerStone * avgRecordSize;
+
+    _calculateStonesBySampling(txn, int64_t(estRecordsPerStone), int64_t(estBytesPerStone));
+}
+
+void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationContext* txn) {
+    log() << "Scanning the oplog to determine where to place markers for truncation";
+
+    long long numRecords = 0;
+    long long dataSize = 0;
+
+    auto cursor = _rs->getCursor(txn, true);
+    while (auto record = cursor->next()) {
+        _currentRecords.fetchAndAdd(1);
+        int64_t newCurrentBytes = _currentBytes.addAndFetch(record->data.size());
+        if (newCurrentBytes >= _minBytesPerStone) {
+            LOG(1) << "Placing a marker at optime "
+                   << Timestamp(record->id.repr()).toStringPretty();
+
+            OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), record->id};
+            _stones.push_back(stone);
+        }
+
+        numRecords++;
+        dataSize += record->data.size();
+    }
+
+    if (_rs->_sizeStorer) {
+        _rs->updateStatsAfterRepair(txn, numRecords, dataSize);
+    }
+}
+
+void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationContext* txn,
+                                                                    int64_t estRecordsPerStone,
+                                                                    int64_t estBytesPerStone) {
+    Timestamp earliestOpTime;
+    Timestamp latestOpTime;
+
+    {
+        auto cursor = _rs->getCursor(txn, true);
+        auto record = cursor->next();
+        if (!record) {
+            // This shouldn't really happen unless the size storer values are far off from
+            // reality. The oplog is probably empty, but fall back to scanning it just in case.
+            log() << "Failed to determine the earliest optime, falling back to scanning the oplog";
+            _calculateStonesByScanning(txn);
+            return;
+        }
+        earliestOpTime = Timestamp(record->id.repr());
+    }
+
+    {
+        auto cursor = _rs->getCursor(txn, false);
+        auto record = cursor->next();
+        if (!record) {
+            log() << "Failed to determine the latest optime, falling back to scanning the oplog";
+            _calculateStonesByScanning(txn);
+            return;
+        }
+        latestOpTime = Timestamp(record->id.repr());
+    }
+
+    log() << "Sampling from the oplog between " << earliestOpTime.toStringPretty() << " and "
+          << latestOpTime.toStringPretty() << " to determine where to place markers for truncation";
+
+    const int64_t wholeStones = _rs->numRecords(txn) / estRecordsPerStone;
+    const int64_t numSamples = kRandomSamplesPerStone * _rs->numRecords(txn) / estRecordsPerStone;
+
+    log() << "Taking " << numSamples << " samples and assuming that each section of oplog contains"
+          << " approximately " << estRecordsPerStone << " records totaling to " << estBytesPerStone
+          << " bytes";
+
+    // Take the samples up front and sort them so every kRandomSamplesPerStone-th one can be used
+    // as the last record of a stone.
+    std::vector<RecordId> oplogEstimates;
+    oplogEstimates.reserve(numSamples);
+    auto cursor = _rs->getRandomCursor(txn);
+    for (int64_t i = 0; i < numSamples; ++i) {
+        auto record = cursor->next();
+        if (!record) {
+            log() << "Failed to get enough random samples, falling back to scanning the oplog";
+            _calculateStonesByScanning(txn);
+            return;
+        }
+        oplogEstimates.push_back(record->id);
+    }
+    std::sort(oplogEstimates.begin(), oplogEstimates.end());
+
+    for (int64_t i = 1; i <= wholeStones; ++i) {
+        const RecordId& lastRecord = oplogEstimates[kRandomSamplesPerStone * i - 1];
+
+        LOG(1) << "Placing a marker at optime " << Timestamp(lastRecord.repr()).toStringPretty();
+        OplogStones::Stone stone = {estRecordsPerStone, estBytesPerStone, lastRecord};
+        _stones.push_back(stone);
+    }
+
+    // Account for the partially filled chunk.
+    _currentRecords.store(_rs->numRecords(txn) - estRecordsPerStone * wholeStones);
+    _currentBytes.store(_rs->dataSize(txn) - estBytesPerStone * wholeStones);
+}
+
+bool WiredTigerRecordStore::OplogStones::_hasExcessStones_inlock() const {
+    return _stones.size() > _numStonesToKeep;
+}
+
+void WiredTigerRecordStore::OplogStones::_pokeReclaimThreadIfNeeded_inlock() {
+    if (_hasExcessStones_inlock()) {
+        _oplogReclaimCv.notify_one();
+    }
+}
+
 WiredTigerRecordStore::WiredTigerRecordStore(OperationContext* ctx,
                                              StringData ns,
                                              StringData uri,
@@ -453,8 +807,13 @@ WiredTigerRecordStore::WiredTigerRecordStore(OperationContext* ctx,
       _cappedDeleteCallback(cappedDeleteCallback),
       _cappedDeleteCheckCount(0),
       _useOplogHack(shouldUseOplogHack(ctx, _uri)),
+      _uncommittedHead(new UncommittedLoc(RecordId(), true)),
+      _uncommittedTail(_uncommittedHead),
+      _updatingCappedVisibility(0),
+      _cappedVisibilityEvents(0),
+      _lowestHiddenRecord(0),
+      _oplogHighestSeen(0),
       _sizeStorer(sizeStorer),
-      _sizeStorerCounter(0),
       _shuttingDown(false) {
     Status versionStatus = WiredTigerUtil::checkApplicationMetadataFormatVersion(
         ctx, uri, kMinimumRecordStoreVersion, kMaximumRecordStoreVersion);
@@ -474,7 +833,7 @@ WiredTigerRecordStore::WiredTigerRecordStore(OperationContext* ctx,
     Cursor cursor(ctx, *this, /*forward=*/false);
     if (auto record = cursor.next()) {
         int64_t max = _makeKey(record->id);
-        _oplog_highestSeen = record->id;
+        _oplogHighestSeen.store(record->id.repr());
         _nextIdNum.store(1 + max);
 
         if (_sizeStorer) {
@@ -491,8 +850,8 @@ WiredTigerRecordStore::WiredTigerRecordStore(OperationContext* ctx,
             _dataSize.store(0);
 
             do {
-                _numRecords.fetchAndAdd(1);
-                _dataSize.fetchAndAdd(record->data.size());
+                _numRecords.add(1);
+                _dataSize.add(record->data.size());
             } while ((record = cursor.next()));
         }
     } else {
@@ -505,6 +864,10 @@ WiredTigerRecordStore::WiredTigerRecordStore(OperationContext* ctx,
     }
 
     _hasBackgroundThread = WiredTigerKVEngine::initRsOplogBackgroundThread(ns);
+
+    if (_isOplog && _isCapped) {
+        _oplogStones = std::make_shared<OplogStones>(ctx, this);
+    }
 }
 
 WiredTigerRecordStore::~WiredTigerRecordStore() {
@@ -517,6 +880,16 @@ WiredTigerRecordStore::~WiredTigerRecordStore() {
     if (_sizeStorer) {
         _sizeStorer->onDestroy(this);
     }
+
+    if (_oplogStones) {
+        _oplogStones->kill();
+    }
+
+    while (_uncommittedHead) {
+        UncommittedLoc* entry = _uncommittedHead;
+        _uncommittedHead = entry->next.load();
+        delete entry;
+    }
 }
 
 const char* WiredTigerRecordStore::name() const {
@@ -529,11 +902,17 @@ bool WiredTigerRecordStore::inShutdown() const {
 }
 
 long long WiredTigerRecordStore::dataSize(OperationContext* txn) const {
-    return _dataSize.load();
+    // The counters can dip below zero until resetNegativeCounters() next runs.
+    return std::max(_dataSize.load(), int64_t(0));
 }
 
 long long WiredTigerRecordStore::numRecords(OperationContext* txn) const {
-    return _numRecords.load();
+    return std::max(_numRecords.load(), int64_t(0));
+}
+
+void WiredTigerRecordStore::resetNegativeCounters() {
+    _numRecords.resetIfNegative();
+    _dataSize.resetIfNegative();
 }
 
 bool WiredTigerRecordStore::isCapped() const {
@@ -649,6 +1028,10 @@ int64_t WiredTigerRecordStore::cappedDeleteAsNeeded(OperationContext* txn,
     // This variable isn't thread safe, but has loose semantics anyway.
     dassert(!_isOplog || _cappedMaxDocs == -1);
 
+    // The oplog is truncated a stone at a time by reclaimOplog(), never by the inserting thread.
+    if (_oplogStones)
+        return 0;
+
     if (!cappedAndNeedDelete())
         return 0;
 
@@ -657,27 +1040,6 @@ int64_t WiredTigerRecordStore::cappedDeleteAsNeeded(OperationContext* txn,
 
     if (_cappedMaxDocs != -1) {
         lock.lock();  // Max docs has to be exact, so have to check every time.
-    } else if (_hasBackgroundThread) {
-        // We are foreground, and there is a background thread,
-
-        // Check if we need some back pressure.
-        if ((_dataSize.load() - _cappedMaxSize) < _cappedMaxSizeSlack) {
-            return 0;
-        }
-
-        // Back pressure needed!
-        // We're not actually going to delete anything, but we're going to syncronize
-        // on the deleter thread.
-        // Don't wait forever: we're in a transaction, we could block eviction.
-        if (!lock.try_lock()) {
-            Date_t before = Date_t::now();
-            (void)lock.try_lock_for(boost::chrono::milliseconds(200));  // NOLINT
-            auto delay = boost::chrono::milliseconds(                   // NOLINT
-                durationCount<Milliseconds>(Date_t::now() - before));
-            _cappedSleep.fetchAndAdd(1);
-            _cappedSleepMS.fetchAndAdd(delay.count());
-        }
-        return 0;
     } else {
         if (!lock.try_lock()) {
             // Someone else is deleting old records. Apply back-pressure if too far behind,
@@ -806,6 +1168,73 @@ int64_t WiredTigerRecordStore::cappedDeleteAsNeeded_inlock(OperationContext* txn
     return docsRemoved;
 }
 
+bool WiredTigerRecordStore::yieldAndAwaitOplogDeletionRequest(OperationContext* txn) {
+    // Take another reference to the stones while the collection lock still keeps this record
+    // store alive.
+    std::shared_ptr<OplogStones> oplogStones = _oplogStones;
+    invariant(oplogStones);
+
+    Locker* locker = txn->lockState();
+    Locker::LockSnapshot snapshot;
+
+    // Nothing may touch this record store after the locks are released, since it could be
+    // destroyed while we wait.
+    bool releasedAnyLocks = locker->saveLockStateAndUnlock(&snapshot);
+    invariant(releasedAnyLocks);
+
+    // Don't hold on to a WiredTiger snapshot while waiting either.
+    txn->recoveryUnit()->abandonSnapshot();
+
+    oplogStones->awaitHasExcessStonesOrDead();
+
+    locker->restoreLockState(snapshot);
+
+    return !oplogStones->isDead();
+}
+
+void WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
+    invariant(_oplogStones);
+
+    while (auto stone = _oplogStones->peekOldestStoneIfNeeded()) {
+        invariant(stone->lastRecord.isNormal());
+
+        LOG(1) << "Truncating the oplog between " << _oplogStones->firstRecord << " and "
+               << stone->lastRecord << " to remove approximately " << stone->records
+               << " records totaling to " << stone->bytes << " bytes";
+
+        WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(txn);
+        WT_SESSION* session = ru->getSession(txn)->getSession();
+
+        try {
+            WriteUnitOfWork wuow(txn);
+
+            // The truncate range only needs its end points as keys, there don't have to be
+            // records at either of them.
+            WiredTigerCursor startWrap(_uri, _tableId, true, txn);
+            WT_CURSOR* start = startWrap.get();
+            start->set_key(start, _makeKey(_oplogStones->firstRecord));
+
+            WiredTigerCursor endWrap(_uri, _tableId, true, txn);
+            WT_CURSOR* end = endWrap.get();
+            end->set_key(end, _makeKey(stone->lastRecord));
+
+            invariantWTOK(WT_OP_CHECK(session->truncate(session, NULL, start, end, NULL)));
+            _changeNumRecords(txn, -stone->records);
+            _increaseDataSize(txn, -stone->bytes);
+
+            wuow.commit();
+
+            _oplogStones->popOldestStone();
+            _oplogStones->firstRecord = stone->lastRecord;
+        } catch (const WriteConflictException& wce) {
+            LOG(1) << "Caught WriteConflictException while truncating oplog entries, retrying";
+        }
+    }
+
+    LOG(1) << "Finished truncating the oplog, it now contains approximately "
+           << _numRecords.load() << " records totaling to " << _dataSize.load() << " bytes";
+}
+
 StatusWith<RecordId> WiredTigerRecordStore::extractAndCheckLocForOplog(const char* data, int len) {
     return oploghack::extractKey(data, len);
 }
@@ -814,28 +1243,45 @@ StatusWith<RecordId> WiredTigerRecordStore::insertRecord(OperationContext* txn,
                                                          const char* data,
                                                          int len,
                                                          bool enforceQuota) {
-    if (_isCapped && len > _cappedMaxSize) {
-        return StatusWith<RecordId>(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
+    Record record = {RecordId(), RecordData(data, len)};
+    Status status = _insertRecords(txn, &record, 1);
+    if (!status.isOK())
+        return StatusWith<RecordId>(status);
+    return StatusWith<RecordId>(record.id);
+}
+
+Status WiredTigerRecordStore::_insertRecords(OperationContext* txn,
+                                             Record* records,
+                                             size_t nRecords) {
+    int64_t totalLength = 0;
+    for (size_t i = 0; i < nRecords; i++) {
+        const int len = records[i].data.size();
+        if (_isCapped && len > _cappedMaxSize) {
+            return Status(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
+        }
+        totalLength += len;
     }
 
-    RecordId loc;
     if (_useOplogHack) {
-        StatusWith<RecordId> status = extractAndCheckLocForOplog(data, len);
-        if (!status.isOK())
-            return status;
-        loc = status.getValue();
-        if (loc > _oplog_highestSeen) {
-            stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-            if (loc > _oplog_highestSeen) {
-                _oplog_highestSeen = loc;
-            }
+        for (size_t i = 0; i < nRecords; i++) {
+            Record& record = records[i];
+            StatusWith<RecordId> status =
+                extractAndCheckLocForOplog(record.data.data(), record.data.size());
+            if (!status.isOK())
+                return status.getStatus();
+            record.id = status.getValue();
+            _noteOplogHighestSeen(record.id);
         }
     } else if (_isCapped) {
-        stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-        loc = _nextId();
-        _addUncommitedDiskLoc_inlock(txn, loc);
+        stdx::lock_guard<SpinLock> lk(_uncommittedLocsAppendLock);
+        for (size_t i = 0; i < nRecords; i++) {
+            records[i].id = _nextId();
+            _addUncommittedLoc_inlock(txn, records[i].id);
+        }
     } else {
-        loc = _nextId();
+        for (size_t i = 0; i < nRecords; i++) {
+            records[i].id = _nextId();
+        }
     }
 
     WiredTigerCursor curwrap(_uri, _tableId, true, txn);
@@ -843,41 +1289,39 @@ StatusWith<RecordId> WiredTigerRecordStore::insertRecord(OperationContext* txn,
     WT_CURSOR* c = curwrap.get();
     invariant(c);
 
-    c->set_key(c, _makeKey(loc));
-    WiredTigerItem value(data, len);
-    c->set_value(c, value.Get());
-    int ret = WT_OP_CHECK(c->insert(c));
-    if (ret) {
-        return StatusWith<RecordId>(wtRCToStatus(ret, "WiredTigerRecordStore::insertRecord"));
+    RecordId highestId;
+    for (size_t i = 0; i < nRecords; i++) {
+        const Record& record = records[i];
+        c->set_key(c, _makeKey(record.id));
+        WiredTigerItem value(record.data.data(), record.data.size());
+        c->set_value(c, value.Get());
+        int ret = WT_OP_CHECK(c->insert(c));
+        if (ret) {
+            return wtRCToStatus(ret, "WiredTigerRecordStore::insertRecord");
+        }
+        highestId = std::max(highestId, record.id);
     }
 
-    _changeNumRecords(txn, 1);
-    _increaseDataSize(txn, len);
-
-    cappedDeleteAsNeeded(txn, loc);
+    _changeNumRecords(txn, nRecords);
+    _increaseDataSize(txn, totalLength);
 
-    return StatusWith<RecordId>(loc);
-}
+    if (_oplogStones) {
+        _oplogStones->updateCurrentStoneAfterInsertOnCommit(
+            txn, totalLength, highestId, nRecords);
+    } else {
+        cappedDeleteAsNeeded(txn, highestId);
+    }
 
-void WiredTigerRecordStore::dealtWithCappedLoc(const RecordId& loc) {
-    stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-    SortedDiskLocs::iterator it =
-        std::find(_uncommittedDiskLocs.begin(), _uncommittedDiskLocs.end(), loc);
-    invariant(it != _uncommittedDiskLocs.end());
-    _uncommittedDiskLocs.erase(it);
+    return Status::OK();
 }
 
 bool WiredTigerRecordStore::isCappedHidden(const RecordId& loc) const {
-    stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-    if (_uncommittedDiskLocs.empty()) {
-        return false;
-    }
-    return _uncommittedDiskLocs.front() <= loc;
+    const RecordId lowestHidden = lowestCappedHiddenRecord();
+    return !lowestHidden.isNull() && lowestHidden <= loc;
 }
 
 RecordId WiredTigerRecordStore::lowestCappedHiddenRecord() const {
-    stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-    return _uncommittedDiskLocs.empty() ? RecordId() : _uncommittedDiskLocs.front();
+    return RecordId(_lowestHiddenRecord.load());
 }
 
 StatusWith<RecordId> WiredTigerRecordStore::insertRecord(OperationContext* txn,
@@ -891,6 +1335,43 @@ StatusWith<RecordId> WiredTigerRecordStore::insertRecord(OperationContext* txn,
     return insertRecord(txn, buf.get(), len, enforceQuota);
 }
 
+Status WiredTigerRecordStore::insertRecordsWithDocWriter(OperationContext* txn,
+                                                         const DocWriter* const* docs,
+                                                         size_t nDocs,
+                                                         bool enforceQuota,
+                                                         RecordId* idsOut) {
+    if (nDocs == 0)
+        return Status::OK();
+
+    // Write all of the documents into one buffer, so the batch can be inserted with one cursor.
+    size_t totalSize = 0;
+    for (size_t i = 0; i < nDocs; i++) {
+        totalSize += docs[i]->documentSize();
+    }
+
+    std::unique_ptr<char[]> buffer(new char[totalSize]);
+    std::unique_ptr<Record[]> records(new Record[nDocs]);
+    char* pos = buffer.get();
+    for (size_t i = 0; i < nDocs; i++) {
+        const size_t len = docs[i]->documentSize();
+        docs[i]->writeDocument(pos);
+        records[i].data = RecordData(pos, len);
+        pos += len;
+    }
+    invariant(pos == buffer.get() + totalSize);
+
+    Status status = _insertRecords(txn, records.get(), nDocs);
+    if (!status.isOK())
+        return status;
+
+    if (idsOut) {
+        for (size_t i = 0; i < nDocs; i++) {
+            idsOut[i] = records[i].id;
+        }
+    }
+    return Status::OK();
+}
+
 StatusWith<RecordId> WiredTigerRecordStore::updateRecord(OperationContext* txn,
                                                          const RecordId& loc,
                                                          const char* data,
@@ -937,11 +1418,13 @@ Status WiredTigerRecordStore::updateWithDamages(OperationContext* txn,
 }
 
 void WiredTigerRecordStore::_oplogSetStartHack(WiredTigerRecoveryUnit* wru) const {
-    stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-    if (_uncommittedDiskLocs.empty()) {
-        wru->setOplogReadTill(_oplog_highestSeen);
+    // If nothing is hidden, anything registered after the first load is above the highest seen
+    // record at the time of the second, or is that record and is rechecked by the cursor.
+    const RecordId lowestHidden = lowestCappedHiddenRecord();
+    if (lowestHidden.isNull()) {
+        wru->setOplogReadTill(RecordId(_oplogHighestSeen.load()));
     } else {
-        wru->setOplogReadTill(_uncommittedDiskLocs.front());
+        wru->setOplogReadTill(lowestHidden);
     }
 }
 
@@ -984,6 +1467,10 @@ Status WiredTigerRecordStore::truncate(OperationContext* txn) {
     _changeNumRecords(txn, -numRecords(txn));
     _increaseDataSize(txn, -dataSize(txn));
 
+    if (_oplogStones) {
+        _oplogStones->clearStonesOnCommit(txn);
+    }
+
     return Status::OK();
 }
 
@@ -1123,35 +1610,127 @@ Status WiredTigerRecordStore::oplogDiskLocRegister(OperationContext* txn, const
     if (!loc.isOK())
         return loc.getStatus();
 
-    stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-    _addUncommitedDiskLoc_inlock(txn, loc.getValue());
+    stdx::lock_guard<SpinLock> lk(_uncommittedLocsAppendLock);
+    _addUncommittedLoc_inlock(txn, loc.getValue());
     return Status::OK();
 }
 
 class WiredTigerRecordStore::CappedInsertChange : public RecoveryUnit::Change {
 public:
-    CappedInsertChange(WiredTigerRecordStore* rs, const RecordId& loc) : _rs(rs), _loc(loc) {}
+    CappedInsertChange(WiredTigerRecordStore* rs, UncommittedLoc* entry)
+        : _rs(rs), _entry(entry) {}
 
     virtual void commit() {
-        _rs->dealtWithCappedLoc(_loc);
+        _rs->_dealtWithCappedLoc(_entry);
     }
 
     virtual void rollback() {
-        _rs->dealtWithCappedLoc(_loc);
+        _rs->_dealtWithCappedLoc(_entry);
     }
 
 private:
     WiredTigerRecordStore* _rs;
-    RecordId _loc;
+    UncommittedLoc* _entry;
 };
 
-void WiredTigerRecordStore::_addUncommitedDiskLoc_inlock(OperationContext* txn,
-                                                         const RecordId& loc) {
+void WiredTigerRecordStore::_addUncommittedLoc_inlock(OperationContext* txn,
+                                                      const RecordId& loc) {
     // todo: make this a dassert at some point
-    invariant(_uncommittedDiskLocs.empty() || _uncommittedDiskLocs.back() < loc);
-    _uncommittedDiskLocs.push_back(loc);
-    txn->recoveryUnit()->registerChange(new CappedInsertChange(this, loc));
-    _oplog_highestSeen = loc;
+    invariant(_uncommittedTail->loc < loc);
+
+    UncommittedLoc* entry = new UncommittedLoc(loc);
+    txn->recoveryUnit()->registerChange(new CappedInsertChange(this, entry));
+    _uncommittedTail->next.store(entry);
+    _uncommittedTail = entry;
+
+    // Publishing under the append lock means _updateCappedVisibility() cannot overwrite this
+    // with a value computed before the entry was appended.
+    if (_lowestHiddenRecord.load() == 0) {
+        _lowestHiddenRecord.store(loc.repr());
+    }
+    _noteOplogHighestSeen(loc);
+}
+
+void WiredTigerRecordStore::_dealtWithCappedLoc(UncommittedLoc* entry) {
+    entry->done.store(true);
+    _cappedVisibilityEvents.fetchAndAdd(1);
+    _updateCappedVisibility();
+}
+
+void WiredTigerRecordStore::_updateCappedVisibility() {
+    while (true) {
+        if (_updatingCappedVisibility.swap(1) != 0) {
+            // The thread doing the update will see our event when it rechecks below.
+            return;
+        }
+
+        const uint64_t eventsSeen = _cappedVisibilityEvents.load();
+
+        // Everything before the first entry that is not done is committed, so it can be freed
+        // without holding the append lock. The last entry is never freed.
+        UncommittedLoc* next;
+        while (_uncommittedHead->done.load() && (next = _uncommittedHead->next.load())) {
+            delete _uncommittedHead;
+            _uncommittedHead = next;
+        }
+
+        bool changed;
+        {
+            stdx::lock_guard<SpinLock> lk(_uncommittedLocsAppendLock);
+            while (_uncommittedHead->done.load() && (next = _uncommittedHead->next.load())) {
+                delete _uncommittedHead;
+                _uncommittedHead = next;
+            }
+
+            const int64_t lowestHidden =
+                _uncommittedHead->done.load() ? 0 : _uncommittedHead->loc.repr();
+            changed = _lowestHiddenRecord.swap(lowestHidden) != lowestHidden;
+        }
+
+        _updatingCappedVisibility.store(0);
+
+        if (changed && _cappedDeleteCallback) {
+            _cappedDeleteCallback->notifyCappedWaitersIfNeeded();
+        }
+
+        if (_cappedVisibilityEvents.load() == eventsSeen) {
+            return;
+        }
+    }
+}
+
+void WiredTigerRecordStore::_truncateUncommittedLocsAfter(const RecordId& lastKept) {
+    {
+        stdx::lock_guard<SpinLock> lk(_uncommittedLocsAppendLock);
+        if (lastKept < _uncommittedTail->loc) {
+            // Callers hold the collection exclusively, so nothing above 'lastKept' can still be
+            // uncommitted. Appending a finished entry at 'lastKept' lets RecordIds above it be
+            // registered again, as they are when a rolled back oplog is reapplied.
+            invariant(_uncommittedTail->done.load());
+            UncommittedLoc* entry = new UncommittedLoc(lastKept, true);
+            _uncommittedTail->next.store(entry);
+            _uncommittedTail = entry;
+        }
+    }
+
+    // Nothing past the end of the oplog may be read.
+    if (lastKept.repr() < _oplogHighestSeen.load()) {
+        _oplogHighestSeen.store(lastKept.repr());
+    }
+
+    // Frees the entries which now sit before the new tail.
+    _updateCappedVisibility();
+}
+
+void WiredTigerRecordStore::_noteOplogHighestSeen(const RecordId& loc) {
+    int64_t highestSeen = _oplogHighestSeen.load();
+    while (loc.repr() > highestSeen) {
+        const int64_t actual = _oplogHighestSeen.compareAndSwap(highestSeen, loc.repr());
+        if (actual == highestSeen) {
+            return;
+        }
+        highestSeen = actual;
+    }
 }
 
 boost::optional<RecordId> WiredTigerRecordStore::oplogStartHack(
@@ -1206,7 +1785,7 @@ public:
     NumRecordsChange(WiredTigerRecordStore* rs, int64_t diff) : _rs(rs), _diff(diff) {}
     virtual void commit() {}
     virtual void rollback() {
-        _rs->_numRecords.fetchAndAdd(-_diff);
+        _rs->_numRecords.add(-_diff);
     }
 
 private:
@@ -1216,12 +1795,7 @@ private:
 
 void WiredTigerRecordStore::_changeNumRecords(OperationContext* txn, int64_t diff) {
     txn->recoveryUnit()->registerChange(new NumRecordsChange(this, diff));
-    if (diff > 0) {
-        if (_numRecords.fetchAndAdd(diff) < diff)
-            _numRecords.store(diff);
-    } else if (_numRecords.fetchAndAdd(diff) < 0) {
-        _numRecords.store(0);
-    }
+    _numRecords.add(diff);
 }
 
 class WiredTigerRecordStore::DataSizeChange : public RecoveryUnit::Change {
@@ -1241,17 +1815,7 @@ void WiredTigerRecordStore::_increaseDataSize(OperationContext* txn, int64_t amo
     if (txn)
         txn->recoveryUnit()->registerChange(new DataSizeChange(this, amount));
 
-    if (_dataSize.fetchAndAdd(amount) < 0) {
-        if (amount > 0) {
-            _dataSize.store(amount);
-        } else {
-            _dataSize.store(0);
-        }
-    }
-
-    if (_sizeStorer && _sizeStorerCounter++ % 1000 == 0) {
-        _sizeStorer->storeToCache(_uri, _numRecords.load(), _dataSize.load());
-    }
+    _dataSize.add(amount);
 }
 
 int64_t WiredTigerRecordStore::_makeKey(const RecordId& loc) {
@@ -1266,14 +1830,31 @@ void WiredTigerRecordStore::temp_cappedTruncateAfter(OperationContext* txn,
                                                      bool inclusive) {
     WriteUnitOfWork wuow(txn);
     Cursor cursor(txn, *this);
+    RecordId lastKeptId;
+    RecordId firstRemovedId;
+    int64_t recordsRemoved = 0;
+    int64_t bytesRemoved = 0;
     while (auto record = cursor.next()) {
         RecordId loc = record->id;
         if (end < loc || (inclusive && end == loc)) {
             if (_cappedDeleteCallback)
                 uassertStatusOK(_cappedDeleteCallback->aboutToDeleteCapped(txn, loc, record->data));
+            if (firstRemovedId.isNull())
+                firstRemovedId = loc;
+            recordsRemoved++;
+            bytesRemoved += record->data.size();
             deleteRecord(txn, loc);
+        } else {
+            lastKeptId = loc;
         }
     }
     wuow.commit();
+
+    _truncateUncommittedLocsAfter(lastKeptId);
+
+    if (_oplogStones && recordsRemoved > 0) {
+        _oplogStones->updateStonesAfterCappedTruncateAfter(
+            recordsRemoved, bytesRemoved, firstRemovedId);
+    }
 }
 }
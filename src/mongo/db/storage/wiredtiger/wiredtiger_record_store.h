@@ -32,6 +32,7 @@
 #pragma once
 
 #include <boost/thread/mutex.hpp>
+#include <memory>
 #include <set>
 #include <string>
 
@@ -40,6 +41,8 @@
 #include "mongo/db/storage/record_store.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/concurrency/striped_counter.h"
 #include "mongo/util/fail_point_service.h"
 
 /**
@@ -122,6 +125,12 @@ public:
                                               const DocWriter* doc,
                                               bool enforceQuota);
 
+    virtual Status insertRecordsWithDocWriter(OperationContext* txn,
+                                              const DocWriter* const* docs,
+                                              size_t nDocs,
+                                              bool enforceQuota,
+                                              RecordId* idsOut);
+
     virtual StatusWith<RecordId> updateRecord(OperationContext* txn,
                                               const RecordId& oldLocation,
                                               const char* data,
@@ -202,7 +211,17 @@ public:
         _sizeStorer = ss;
     }
 
-    void dealtWithCappedLoc(const RecordId& loc);
+    /**
+     * Raises the record count and data size to zero if they went negative, which they do when
+     * they were stale when loaded from the size storer. Called periodically in the background
+     * rather than on every update, so that writers never have to sum the counters.
+     */
+    void resetNegativeCounters();
+
+    /**
+     * Visibility checks for capped collections. These never block, so tailing cursors do not
+     * contend with inserts.
+     */
     bool isCappedHidden(const RecordId& loc) const;
     RecordId lowestCappedHiddenRecord() const;
 
@@ -211,8 +230,24 @@ public:
 
     int64_t cappedDeleteAsNeeded_inlock(OperationContext* txn, const RecordId& justInserted);
 
-    boost::timed_mutex& cappedDeleterMutex() {  // NOLINT
-        return _cappedDeleterMutex;
+    class OplogStones;
+
+    /**
+     * Releases the locks held by 'txn' and waits until the oplog has more stones than it should
+     * keep, then reacquires the locks. Returns false if the record store was destroyed while
+     * waiting, in which case it must not be used again.
+     */
+    bool yieldAndAwaitOplogDeletionRequest(OperationContext* txn);
+
+    /**
+     * Truncates whole chunks from the start of the oplog until it holds no more stones than it
+     * should keep.
+     */
+    void reclaimOplog(OperationContext* txn);
+
+    // Exposed only for testing.
+    OplogStones* oplogStones() {
+        return _oplogStones.get();
     }
 
 private:
@@ -220,6 +255,7 @@ private:
     class RandomCursor;
 
     class CappedInsertChange;
+    struct UncommittedLoc;
     class NumRecordsChange;
     class DataSizeChange;
 
@@ -228,7 +264,31 @@ private:
     static int64_t _makeKey(const RecordId& loc);
     static RecordId _fromKey(int64_t k);
 
-    void _addUncommitedDiskLoc_inlock(OperationContext* txn, const RecordId& loc);
+    /**
+     * Hides 'loc' from readers until the current unit of work commits or rolls back. Must be
+     * called with _uncommittedLocsAppendLock held, in increasing RecordId order.
+     */
+    void _addUncommittedLoc_inlock(OperationContext* txn, const RecordId& loc);
+
+    /**
+     * Called when the insert of 'entry' commits or rolls back.
+     */
+    void _dealtWithCappedLoc(UncommittedLoc* entry);
+
+    /**
+     * Drops finished entries from the front of the uncommitted list and publishes the new lowest
+     * hidden RecordId. Only one thread does this at a time. A thread that finds another one
+     * already doing it returns right away, and the other thread picks up its change.
+     */
+    void _updateCappedVisibility();
+
+    /**
+     * Called after temp_cappedTruncateAfter() removed every record after 'lastKept', so that
+     * RecordIds above 'lastKept' may be registered and seen again.
+     */
+    void _truncateUncommittedLocsAfter(const RecordId& lastKept);
+
+    void _noteOplogHighestSeen(const RecordId& loc);
 
     RecordId _nextId();
     void _setId(RecordId loc);
@@ -237,6 +297,12 @@ private:
     void _increaseDataSize(OperationContext* txn, int64_t amount);
     RecordData _getData(const WiredTigerCursor& cursor) const;
     StatusWith<RecordId> extractAndCheckLocForOplog(const char* data, int len);
+
+    /**
+     * Inserts 'records' using one cursor and fills in their ids. The counters, oplog stones and
+     * capped deletion are updated once for the whole batch.
+     */
+    Status _insertRecords(OperationContext* txn, Record* records, size_t nRecords);
     void _oplogSetStartHack(WiredTigerRecoveryUnit* wru) const;
 
     const std::string _uri;
@@ -258,21 +324,41 @@ private:
 
     const bool _useOplogHack;
 
-    typedef std::vector<RecordId> SortedDiskLocs;
-    SortedDiskLocs _uncommittedDiskLocs;
-    RecordId _oplog_visibleTo;
-    RecordId _oplog_highestSeen;
-    mutable stdx::mutex _uncommittedDiskLocsMutex;
+    // Capped inserts that have not committed or rolled back yet, as a singly linked list in
+    // RecordId order. Only _updateCappedVisibility() advances and frees _uncommittedHead, and
+    // only while holding _updatingCappedVisibility. The list always keeps its last entry, so
+    // appending at _uncommittedTail never races with freeing. It starts with a sentinel entry
+    // that is already done, so the first real insert is freed like any other once resolved.
+    UncommittedLoc* _uncommittedHead;
+    UncommittedLoc* _uncommittedTail;  // guarded by _uncommittedLocsAppendLock
+
+    // Serializes assigning capped RecordIds with appending them to the uncommitted list, and
+    // publishing a new _lowestHiddenRecord with appending, so an insert can never be published
+    // as visible before it commits.
+    SpinLock _uncommittedLocsAppendLock;
+
+    AtomicUInt32 _updatingCappedVisibility;
+    AtomicUInt64 _cappedVisibilityEvents;
+
+    // RecordId::repr() of the lowest uncommitted capped insert, or 0 if every insert is visible.
+    AtomicInt64 _lowestHiddenRecord;
+
+    AtomicInt64 _oplogHighestSeen;  // RecordId::repr()
 
     AtomicInt64 _nextIdNum;
-    AtomicInt64 _dataSize;
-    AtomicInt64 _numRecords;
+    // Updated by every write, so they are striped to keep writers from contending on them.
+    // WiredTigerSizeStorer reads them when it syncs, rather than being pushed new values.
+    StripedInt64 _dataSize;
+    StripedInt64 _numRecords;
 
     WiredTigerSizeStorer* _sizeStorer;  // not owned, can be NULL
-    int _sizeStorerCounter;
 
     bool _shuttingDown;
     bool _hasBackgroundThread;
+
+    // Non-null only for the oplog. Shared with the reclaim thread so it can wait on it while
+    // holding no locks.
+    std::shared_ptr<OplogStones> _oplogStones;
 };
 
 // WT failpoint to throw write conflict exceptions randomly
@@ -69,12 +69,14 @@ public:
     }
 
     /**
-     * @return Number of documents deleted.
+     * Waits until the oplog has more stones than it should keep, then truncates the oldest ones.
+     *
+     * @return true if it waited and truncated, false if the oplog is not there or went away.
      */
-    int64_t _deleteExcessDocuments() {
+    bool _deleteExcessDocuments() {
         if (!getGlobalServiceContext()->getGlobalStorageEngine()) {
             LOG(1) << "no global storage engine yet";
-            return 0;
+            return false;
         }
 
         OperationContextImpl txn;
@@ -87,46 +89,42 @@ public:
             Database* db = autoDb.getDb();
             if (!db) {
                 LOG(2) << "no local database yet";
-                return 0;
+                return false;
             }
 
             Lock::CollectionLock collectionLock(txn.lockState(), _ns.ns(), MODE_IX);
             Collection* collection = db->getCollection(_ns);
             if (!collection) {
                 LOG(2) << "no collection " << _ns;
-                return 0;
+                return false;
             }
 
             OldClientContext ctx(&txn, _ns.ns(), false);
             WiredTigerRecordStore* rs =
                 checked_cast<WiredTigerRecordStore*>(collection->getRecordStore());
-            WriteUnitOfWork wuow(&txn);
-            stdx::lock_guard<boost::timed_mutex> lock(rs->cappedDeleterMutex());  // NOLINT
-            int64_t removed = rs->cappedDeleteAsNeeded_inlock(&txn, RecordId::max());
-            wuow.commit();
-            return removed;
+
+            // Sleeps without holding any locks until inserts have filled enough stones.
+            if (!rs->yieldAndAwaitOplogDeletionRequest(&txn)) {
+                return false;  // The oplog went away.
+            }
+
+            rs->reclaimOplog(&txn);
         } catch (const std::exception& e) {
             severe() << "error in WiredTigerRecordStoreThread: " << e.what();
             fassertFailedNoTrace(!"error in WiredTigerRecordStoreThread");
         } catch (...) {
             fassertFailedNoTrace(!"unknown error in WiredTigerRecordStoreThread");
         }
+
+        return true;
     }
 
     virtual void run() {
         Client::initThread(_name.c_str());
 
         while (!inShutdown()) {
-            int64_t removed = _deleteExcessDocuments();
-            LOG(2) << "WiredTigerRecordStoreThread deleted " << removed;
-            if (removed == 0) {
-                // If we removed 0 documents, sleep a bit in case we're on a laptop
-                // or something to be nice.
-                sleepmillis(1000);
-            } else if (removed < 1000) {
-                // 1000 is the batch size, so we didn't even do a full batch,
-                // which is the most efficient.
-                sleepmillis(10);
+            if (!_deleteExcessDocuments()) {
+                sleepmillis(1000);  // The oplog isn't there yet, check again later.
             }
         }
 
@@ -0,0 +1,152 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <deque>
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+/**
+ * Markers ("stones") that divide the oplog into chunks of roughly equal size, used to truncate
+ * the oplog a whole chunk at a time instead of one document at a time.
+ *
+ * Inserts add their size to the chunk being filled once they commit. When that chunk reaches
+ * the minimum size a new stone is recorded at the highest RecordId inserted so far. Once there
+ * are more stones than the oplog should hold, the background reclaim thread is woken up and
+ * removes everything up to the oldest stone with a single range truncate.
+ */
+class WiredTigerRecordStore::OplogStones {
+public:
+    struct Stone {
+        int64_t records;      // Approximate number of records in this chunk of the oplog.
+        int64_t bytes;        // Approximate size of the records in this chunk of the oplog.
+        RecordId lastRecord;  // RecordId of the last record in this chunk of the oplog.
+    };
+
+    OplogStones(OperationContext* txn, WiredTigerRecordStore* rs);
+
+    bool isDead();
+
+    /**
+     * Wakes up the reclaim thread so it can notice that the record store is going away.
+     */
+    void kill();
+
+    bool hasExcessStones();
+
+    /**
+     * Blocks until there are more stones than the oplog should hold, or until kill() is called.
+     */
+    void awaitHasExcessStonesOrDead();
+
+    boost::optional<OplogStones::Stone> peekOldestStoneIfNeeded();
+
+    void popOldestStone();
+
+    void createNewStoneIfNeeded(const RecordId& lastRecord);
+
+    void updateCurrentStoneAfterInsertOnCommit(OperationContext* txn,
+                                               int64_t bytesInserted,
+                                               const RecordId& highestInserted,
+                                               int64_t countInserted);
+
+    void clearStonesOnCommit(OperationContext* txn);
+
+    /**
+     * Drops the stones that covered any of the removed records, and moves what is left of a
+     * partially removed chunk into the chunk being filled.
+     */
+    void updateStonesAfterCappedTruncateAfter(int64_t numRecordsRemoved,
+                                              int64_t dataSizeRemoved,
+                                              const RecordId& firstRemovedId);
+
+    // Only touched by the thread doing the truncation. The next truncate starts from here, so
+    // it does not have to step over what earlier truncates left behind.
+    RecordId firstRecord;
+
+    //
+    // The following methods are public only for use in tests.
+    //
+
+    size_t numStones() const;
+
+    int64_t currentBytes() const {
+        return _currentBytes.load();
+    }
+
+    int64_t currentRecords() const {
+        return _currentRecords.load();
+    }
+
+    void setMinBytesPerStone(int64_t size);
+
+    void setNumStonesToKeep(size_t numStones);
+
+private:
+    class InsertChange;
+    class TruncateChange;
+
+    void _calculateStones(OperationContext* txn);
+    void _calculateStonesByScanning(OperationContext* txn);
+    void _calculateStonesBySampling(OperationContext* txn,
+                                    int64_t estRecordsPerStone,
+                                    int64_t estBytesPerStone);
+
+    bool _hasExcessStones_inlock() const;
+    void _pokeReclaimThreadIfNeeded_inlock();
+
+    static const uint64_t kRandomSamplesPerStone = 10;
+
+    WiredTigerRecordStore* _rs;
+
+    // Protects everything below except the two counters. Also used with _oplogReclaimCv.
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _oplogReclaimCv;
+
+    // True once the record store has been destroyed, for example because repairDatabase was run
+    // on the "local" database.
+    bool _isDead = false;
+
+    size_t _numStonesToKeep;
+    int64_t _minBytesPerStone;
+
+    AtomicInt64 _currentRecords;  // Number of records in the chunk being filled.
+    AtomicInt64 _currentBytes;    // Number of bytes in the chunk being filled.
+
+    std::deque<OplogStones::Stone> _stones;  // front = oldest, back = newest.
+};
+
+}  // namespace mongo
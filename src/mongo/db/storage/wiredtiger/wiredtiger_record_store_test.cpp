@@ -42,6 +42,7 @@
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
@@ -203,6 +204,23 @@ TEST(WiredTigerRecordStoreTest, GenerateCreateStringValidConfigStringOption) {
               std::string("prefix_compression=true,"));
 }
 
+TEST(WiredTigerRecordStoreTest, GenerateCreateStringResidentCachePriority) {
+    BSONObj spec = fromjson("{cachePriority: 'resident'}");
+    ASSERT_EQ(WiredTigerRecordStore::parseOptionsField(spec), std::string("cache_resident=true,"));
+}
+
+TEST(WiredTigerRecordStoreTest, GenerateCreateStringNormalCachePriority) {
+    BSONObj spec = fromjson("{cachePriority: 'normal'}");
+    ASSERT_EQ(WiredTigerRecordStore::parseOptionsField(spec), std::string(""));
+}
+
+TEST(WiredTigerRecordStoreTest, GenerateCreateStringInvalidCachePriority) {
+    ASSERT_EQ(WiredTigerRecordStore::parseOptionsField(fromjson("{cachePriority: 'high'}")),
+              ErrorCodes::BadValue);
+    ASSERT_EQ(WiredTigerRecordStore::parseOptionsField(fromjson("{cachePriority: 1}")),
+              ErrorCodes::TypeMismatch);
+}
+
 TEST(WiredTigerRecordStoreTest, Isolation1) {
     unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
     unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
@@ -624,6 +642,57 @@ TEST(WiredTigerRecordStoreTest, OplogHack) {
     }
 }
 
+TEST(WiredTigerRecordStoreTest, OplogRegisterLowerAfterCappedTruncateAfter) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(harnessHelper.newCappedRecordStore("local.oplog.foo", 100000, -1));
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+        ASSERT_EQ(insertBSON(opCtx, rs, Timestamp(1, 1)).getValue(), RecordId(1, 1));
+        ASSERT_EQ(insertBSON(opCtx, rs, Timestamp(1, 2)).getValue(), RecordId(1, 2));
+        ASSERT_EQ(insertBSON(opCtx, rs, Timestamp(1, 3)).getValue(), RecordId(1, 3));
+    }
+
+    {
+        // As rollback does, drop everything after the common point.
+        unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+        rs->temp_cappedTruncateAfter(opCtx.get(), RecordId(1, 1), false);
+    }
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+        ASSERT_EQ(rs->oplogStartHack(opCtx.get(), RecordId(2, 0)), RecordId(1, 1));
+    }
+
+    // Oplog entries from the new primary reuse the removed RecordIds.
+    unique_ptr<OperationContext> writer(harnessHelper.newOperationContext());
+    unique_ptr<WriteUnitOfWork> wuow(new WriteUnitOfWork(writer.get()));
+    WiredTigerRecordStore* wrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+    ASSERT_OK(wrs->oplogDiskLocRegister(writer.get(), Timestamp(1, 2)));
+    BSONObj obj = BSON("ts" << Timestamp(1, 2));
+    ASSERT_EQ(rs->insertRecord(writer.get(), obj.objdata(), obj.objsize(), false).getValue(),
+              RecordId(1, 2));
+
+    {
+        // The new entry stays hidden until it commits.
+        unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+        auto cursor = rs->getCursor(opCtx.get());
+        ASSERT_EQ(RecordId(1, 1), cursor->next()->id);
+        ASSERT(!cursor->next());
+    }
+
+    wuow->commit();
+    wuow.reset();
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+        auto cursor = rs->getCursor(opCtx.get());
+        ASSERT_EQ(RecordId(1, 1), cursor->next()->id);
+        ASSERT_EQ(RecordId(1, 2), cursor->next()->id);
+        ASSERT(!cursor->next());
+    }
+}
+
 TEST(WiredTigerRecordStoreTest, OplogHackOnNonOplog) {
     WiredTigerHarnessHelper harnessHelper;
     unique_ptr<RecordStore> rs(harnessHelper.newNonCappedRecordStore("local.NOT_oplog.foo"));
@@ -703,6 +772,54 @@ TEST(WiredTigerRecordStoreTest, CappedOrder) {
     }
 }
 
+TEST(WiredTigerRecordStoreTest, CappedVisibilityAfterRollback) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("a.b", 100000, 10000));
+    WiredTigerRecordStore* wrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+
+    ASSERT(wrs->lowestCappedHiddenRecord().isNull());
+
+    RecordId loc1;
+    RecordId loc2;
+
+    {
+        // the first insert is left uncommitted, which hides the second until it is resolved
+        unique_ptr<OperationContext> t1(harnessHelper->newOperationContext());
+        unique_ptr<WriteUnitOfWork> w1(new WriteUnitOfWork(t1.get()));
+        StatusWith<RecordId> res = rs->insertRecord(t1.get(), "a", 2, false);
+        ASSERT_OK(res.getStatus());
+        loc1 = res.getValue();
+
+        {
+            unique_ptr<OperationContext> t2(harnessHelper->newOperationContext());
+            WriteUnitOfWork w2(t2.get());
+            res = rs->insertRecord(t2.get(), "b", 2, false);
+            ASSERT_OK(res.getStatus());
+            loc2 = res.getValue();
+            w2.commit();
+        }
+
+        ASSERT_EQ(loc1, wrs->lowestCappedHiddenRecord());
+        ASSERT(wrs->isCappedHidden(loc1));
+        ASSERT(wrs->isCappedHidden(loc2));
+
+        // roll back the first insert
+        w1.reset();
+    }
+
+    ASSERT(wrs->lowestCappedHiddenRecord().isNull());
+    ASSERT(!wrs->isCappedHidden(loc2));
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        auto cursor = rs->getCursor(opCtx.get());
+        auto record = cursor->next();
+        ASSERT(record);
+        ASSERT_EQ(loc2, record->id);
+        ASSERT(!cursor->next());
+    }
+}
+
 TEST(WiredTigerRecordStoreTest, CappedCursorRollover) {
     unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
     unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("a.b", 10000, 5));
@@ -877,4 +994,146 @@ TEST(WiredTigerRecordStoreTest, CappedCursorYieldFirst) {
     ASSERT(!cursor->next());
 }
 
+// Inserts an oplog entry whose BSON is exactly 'size' bytes.
+RecordId _oplogStonesInsert(OperationContext* txn,
+                            unique_ptr<RecordStore>& rs,
+                            const Timestamp& opTime,
+                            int size) {
+    const int emptySize = BSON("ts" << opTime << "pad"
+                                    << "").objsize();
+    invariant(size >= emptySize);
+    BSONObj obj = BSON("ts" << opTime << "pad" << string(size - emptySize, 'x'));
+    invariant(obj.objsize() == size);
+
+    WriteUnitOfWork wuow(txn);
+    StatusWith<RecordId> res = rs->insertRecord(txn, obj.objdata(), obj.objsize(), false);
+    ASSERT_OK(res.getStatus());
+    wuow.commit();
+    return res.getValue();
+}
+
+TEST(WiredTigerRecordStoreTest, OplogStones_CreateNewStone) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(harnessHelper.newCappedRecordStore("local.oplog.stones", 10240, -1));
+    WiredTigerRecordStore* wrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wrs->oplogStones();
+    ASSERT(oplogStones);
+
+    oplogStones->setMinBytesPerStone(100);
+
+    unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+    ASSERT_EQ(0U, oplogStones->numStones());
+
+    // A record smaller than the minimum doesn't fill a stone.
+    ASSERT_EQ(RecordId(1, 1), _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 1), 99));
+    ASSERT_EQ(0U, oplogStones->numStones());
+    ASSERT_EQ(1, oplogStones->currentRecords());
+    ASSERT_EQ(99, oplogStones->currentBytes());
+
+    // Going over the minimum creates a stone and starts a new one.
+    ASSERT_EQ(RecordId(1, 2), _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 2), 51));
+    ASSERT_EQ(1U, oplogStones->numStones());
+    ASSERT_EQ(0, oplogStones->currentRecords());
+    ASSERT_EQ(0, oplogStones->currentBytes());
+
+    ASSERT_EQ(RecordId(1, 3), _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 3), 50));
+    ASSERT_EQ(1U, oplogStones->numStones());
+    ASSERT_EQ(1, oplogStones->currentRecords());
+    ASSERT_EQ(50, oplogStones->currentBytes());
+
+    // Reaching the minimum exactly also creates a stone.
+    ASSERT_EQ(RecordId(1, 4), _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 4), 50));
+    ASSERT_EQ(2U, oplogStones->numStones());
+    ASSERT_EQ(0, oplogStones->currentRecords());
+    ASSERT_EQ(0, oplogStones->currentBytes());
+
+    // An insert that rolls back doesn't count towards a stone.
+    {
+        WriteUnitOfWork wuow(opCtx.get());
+        BSONObj obj = BSON("ts" << Timestamp(1, 5));
+        ASSERT_OK(rs->insertRecord(opCtx.get(), obj.objdata(), obj.objsize(), false).getStatus());
+    }
+    ASSERT_EQ(2U, oplogStones->numStones());
+    ASSERT_EQ(0, oplogStones->currentRecords());
+    ASSERT_EQ(0, oplogStones->currentBytes());
+}
+
+TEST(WiredTigerRecordStoreTest, OplogStones_ReclaimStones) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(harnessHelper.newCappedRecordStore("local.oplog.stones", 10240, -1));
+    WiredTigerRecordStore* wrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wrs->oplogStones();
+
+    oplogStones->setMinBytesPerStone(100);
+    oplogStones->setNumStonesToKeep(2);
+
+    unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+
+    _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 1), 100);
+    _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 2), 110);
+    ASSERT_EQ(2U, oplogStones->numStones());
+    ASSERT_FALSE(oplogStones->hasExcessStones());
+
+    // Inserts never truncate, they only create the stone the reclaim thread waits for.
+    _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 3), 120);
+    ASSERT_EQ(3U, oplogStones->numStones());
+    ASSERT_TRUE(oplogStones->hasExcessStones());
+    ASSERT_EQ(3, rs->numRecords(opCtx.get()));
+    ASSERT_EQ(330, rs->dataSize(opCtx.get()));
+
+    wrs->reclaimOplog(opCtx.get());
+    ASSERT_EQ(2U, oplogStones->numStones());
+    ASSERT_EQ(2, rs->numRecords(opCtx.get()));
+    ASSERT_EQ(230, rs->dataSize(opCtx.get()));
+
+    _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 4), 130);
+    _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 5), 50);
+    wrs->reclaimOplog(opCtx.get());
+    ASSERT_EQ(2U, oplogStones->numStones());
+    ASSERT_EQ(1, oplogStones->currentRecords());
+    ASSERT_EQ(50, oplogStones->currentBytes());
+    ASSERT_EQ(3, rs->numRecords(opCtx.get()));
+    ASSERT_EQ(300, rs->dataSize(opCtx.get()));
+
+    // Nothing left to reclaim.
+    wrs->reclaimOplog(opCtx.get());
+    ASSERT_EQ(3, rs->numRecords(opCtx.get()));
+
+    auto cursor = rs->getCursor(opCtx.get());
+    auto record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 3), record->id);
+}
+
+TEST(WiredTigerRecordStoreTest, OplogStones_CappedTruncateAfter) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(harnessHelper.newCappedRecordStore("local.oplog.stones", 10240, -1));
+    WiredTigerRecordStore* wrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wrs->oplogStones();
+
+    oplogStones->setMinBytesPerStone(100);
+
+    unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+
+    _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 1), 50);
+    _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 2), 50);
+    _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 3), 100);
+    _oplogStonesInsert(opCtx.get(), rs, Timestamp(1, 4), 60);
+    ASSERT_EQ(2U, oplogStones->numStones());
+    ASSERT_EQ(1, oplogStones->currentRecords());
+    ASSERT_EQ(60, oplogStones->currentBytes());
+
+    // Removing records from the stone being filled only shrinks it.
+    rs->temp_cappedTruncateAfter(opCtx.get(), RecordId(1, 4), true);
+    ASSERT_EQ(2U, oplogStones->numStones());
+    ASSERT_EQ(0, oplogStones->currentRecords());
+    ASSERT_EQ(0, oplogStones->currentBytes());
+
+    // Partly removing a stone drops it, and what's left of it goes into the stone being filled.
+    rs->temp_cappedTruncateAfter(opCtx.get(), RecordId(1, 1), false);
+    ASSERT_EQ(0U, oplogStones->numStones());
+    ASSERT_EQ(1, oplogStones->currentRecords());
+    ASSERT_EQ(50, oplogStones->currentBytes());
+}
+
 }  // namespace mongo
@@ -38,8 +38,6 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
-#include "mongo/stdx/condition_variable.h"
-#include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -47,34 +45,6 @@
 
 namespace mongo {
 
-namespace {
-struct WaitUntilDurableData {
-    WaitUntilDurableData() : numWaitingForSync(0), lastSyncTime(0) {}
-
-    void syncHappend() {
-        stdx::lock_guard<stdx::mutex> lk(mutex);
-        lastSyncTime++;
-        condvar.notify_all();
-    }
-
-    // return true if happened
-    bool waitUntilDurable() {
-        stdx::unique_lock<stdx::mutex> lk(mutex);
-        long long start = lastSyncTime;
-        numWaitingForSync.fetchAndAdd(1);
-        condvar.wait_for(lk, stdx::chrono::milliseconds(50));
-        numWaitingForSync.fetchAndAdd(-1);
-        return lastSyncTime > start;
-    }
-
-    AtomicUInt32 numWaitingForSync;
-
-    stdx::mutex mutex;  // this just protects lastSyncTime
-    stdx::condition_variable condvar;
-    long long lastSyncTime;
-} waitUntilDurableData;
-}
-
 WiredTigerRecoveryUnit::WiredTigerRecoveryUnit(WiredTigerSessionCache* sc)
     : _sessionCache(sc),
       _session(NULL),
@@ -188,7 +158,7 @@ bool WiredTigerRecoveryUnit::waitUntilDurable() {
         // we did a sync, so we're good
         return true;
     }
-    waitUntilDurableData.waitUntilDurable();
+    _sessionCache->waitUntilDurable();
     return true;
 }
 
@@ -304,8 +274,6 @@ void WiredTigerRecoveryUnit::_txnClose(bool commit) {
     if (commit) {
         invariantWTOK(s->commit_transaction(s, NULL));
         LOG(2) << "WT commit_transaction";
-        if (_syncing)
-            waitUntilDurableData.syncHappend();
     } else {
         invariantWTOK(s->rollback_transaction(s, NULL));
         LOG(2) << "WT rollback_transaction";
@@ -373,7 +341,6 @@ void WiredTigerRecoveryUnit::_txnOpen(OperationContext* opCtx) {
     _getTicket(opCtx);
 
     WT_SESSION* s = _session->getSession();
-    _syncing = _syncing || waitUntilDurableData.numWaitingForSync.load() > 0;
 
     if (_readFromMajorityCommittedSnapshot) {
         _majorityCommittedSnapshot =
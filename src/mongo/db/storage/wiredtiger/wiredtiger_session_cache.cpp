@@ -33,6 +33,7 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include "mongo/db/storage/wiredtiger/wiredtiger_cache_warmer.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
@@ -70,8 +71,10 @@ WT_CURSOR* WiredTigerSession::getCursor(const std::string& uri, uint64_t id, boo
         _session, uri.c_str(), NULL, forRecordStore ? "" : "overwrite=false", &c);
     if (ret != ENOENT)
         invariantWTOK(ret);
-    if (c)
+    if (c) {
         _cursorsOut++;
+        WiredTigerCacheWarmer::noteCursorOpened(uri);
+    }
     return c;
 }
 
@@ -121,7 +124,11 @@ uint64_t WiredTigerSession::genTableId() {
 // -----------------------
 
 WiredTigerSessionCache::WiredTigerSessionCache(WiredTigerKVEngine* engine)
-    : _engine(engine), _conn(engine->getConnection()), _snapshotManager(_conn), _shuttingDown(0) {}
+    : _engine(engine), _conn(engine->getConnection()), _snapshotManager(_conn), _shuttingDown(0) {
+    if (_engine->isDurable()) {
+        _journalFlusher.reset(new WiredTigerJournalFlusher(_conn));
+    }
+}
 
 WiredTigerSessionCache::WiredTigerSessionCache(WT_CONNECTION* conn)
     : _engine(NULL), _conn(conn), _snapshotManager(_conn), _shuttingDown(0) {}
@@ -147,6 +154,10 @@ void WiredTigerSessionCache::shuttingDown() {
         sleepmillis(1);
     }
 
+    if (_journalFlusher) {
+        _journalFlusher->shutdown();
+    }
+
     closeAll();
     _snapshotManager.shutdown();
 }
@@ -166,6 +177,12 @@ void WiredTigerSessionCache::closeAll() {
     }
 }
 
+void WiredTigerSessionCache::waitUntilDurable() {
+    if (_journalFlusher) {
+        _journalFlusher->waitUntilDurable();
+    }
+}
+
 WiredTigerSession* WiredTigerSessionCache::getSession() {
     // We should never be able to get here after _shuttingDown is set, because no new
     // operations should be allowed to start.
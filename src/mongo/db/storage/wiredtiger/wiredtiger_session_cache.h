@@ -32,11 +32,13 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <string>
 
 #include <boost/thread/shared_mutex.hpp>
 #include <wiredtiger.h>
 
+#include "mongo/db/storage/wiredtiger/wiredtiger_journal_flusher.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
@@ -152,6 +154,12 @@ public:
      */
     void shuttingDown();
 
+    /**
+     * Waits until all writes committed before this call are durable. Returns immediately if the
+     * journal is disabled. This method is thread safe.
+     */
+    void waitUntilDurable();
+
     WT_CONNECTION* conn() const {
         return _conn;
     }
@@ -168,6 +176,9 @@ private:
     WT_CONNECTION* _conn;         // not owned
     WiredTigerSnapshotManager _snapshotManager;
 
+    // Only set when the journal is enabled.
+    std::unique_ptr<WiredTigerJournalFlusher> _journalFlusher;
+
     // Used as follows:
     //   The low 31 bits are a count of active calls to releaseSession.
     //   The high bit is a flag that is set if and only if we're shutting down.
@@ -168,6 +168,16 @@ void WiredTigerSizeStorer::fillCache() {
     _entries.swap(m);
 }
 
+void WiredTigerSizeStorer::resetNegativeCounters() {
+    _checkMagic();
+    stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
+    for (Map::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+        if (it->second.rs) {
+            it->second.rs->resetNegativeCounters();
+        }
+    }
+}
+
 void WiredTigerSizeStorer::syncCache(bool syncToDisk) {
     stdx::lock_guard<stdx::mutex> cursorLock(_cursorMutex);
     _checkMagic();
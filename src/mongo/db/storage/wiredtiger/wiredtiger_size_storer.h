@@ -66,6 +66,11 @@ public:
      */
     void syncCache(bool syncToDisk);
 
+    /**
+     * Calls WiredTigerRecordStore::resetNegativeCounters() on every live record store.
+     */
+    void resetNegativeCounters();
+
 private:
     void _checkMagic() const;
 
@@ -35,6 +35,7 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "mongo/bson/bsonobjbuilder.h"
@@ -256,6 +257,89 @@ Status WiredTigerUtil::checkTableCreationOptions(const BSONElement& configElem)
     return Status::OK();
 }
 
+StatusWith<std::string> WiredTigerUtil::parseCachePriority(const BSONElement& priorityElem) {
+    invariant(priorityElem.fieldNameStringData() == "cachePriority");
+
+    if (priorityElem.type() != String) {
+        return {ErrorCodes::TypeMismatch, "'cachePriority' must be a string."};
+    }
+
+    StringData priority = priorityElem.valueStringData();
+    if (priority == "normal") {
+        return std::string();
+    }
+    if (priority == "resident") {
+        return std::string("cache_resident=true,");
+    }
+    return {ErrorCodes::BadValue,
+            str::stream() << "'cachePriority' must be \"normal\" or \"resident\", not \""
+                          << priority << "\"."};
+}
+
+// static
+Status WiredTigerUtil::checkResidentCacheLimit(WT_SESSION* session,
+                                               StringData config,
+                                               int maxPercent) {
+    WT_CONFIG_ITEM resident;
+    if (WiredTigerConfigParser(config).get("cache_resident", &resident) != 0 || !resident.val) {
+        return Status::OK();
+    }
+
+    StatusWith<int64_t> cacheBytes = getStatisticsValueAs<int64_t>(
+        session, "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_BYTES_MAX);
+    if (!cacheBytes.isOK()) {
+        warning() << "unable to check the space taken by cache resident tables, reading the "
+                  << "cache size failed: " << cacheBytes.getStatus();
+        return Status::OK();
+    }
+    StatusWith<int64_t> residentBytes = getResidentFilesSize(session);
+    if (!residentBytes.isOK()) {
+        return residentBytes.getStatus();
+    }
+
+    const int64_t limitBytes =
+        cacheBytes.getValue() / 100 * std::max(0, std::min(maxPercent, 100));
+    if (residentBytes.getValue() >= limitBytes) {
+        return {ErrorCodes::ExceededMemoryLimit,
+                str::stream() << "cannot create another cache resident table: the existing ones "
+                              << "take " << residentBytes.getValue() << " bytes on disk, and "
+                              << "at most " << maxPercent << "% of the "
+                              << cacheBytes.getValue() << " byte cache may be resident."};
+    }
+    return Status::OK();
+}
+
+// static
+StatusWith<int64_t> WiredTigerUtil::getResidentFilesSize(WT_SESSION* session) {
+    WT_CURSOR* cursor = NULL;
+    int ret = session->open_cursor(session, "metadata:", NULL, NULL, &cursor);
+    if (ret != 0) {
+        return wtRCToStatus(ret);
+    }
+    ON_BLOCK_EXIT(cursor->close, cursor);
+
+    int64_t total = 0;
+    while ((ret = cursor->next(cursor)) == 0) {
+        const char* uri;
+        const char* config;
+        invariantWTOK(cursor->get_key(cursor, &uri));
+        invariantWTOK(cursor->get_value(cursor, &config));
+        if (!StringData(uri).startsWith("file:")) {
+            continue;
+        }
+
+        WT_CONFIG_ITEM resident;
+        if (WiredTigerConfigParser(config).get("cache_resident", &resident) == 0 &&
+            resident.val) {
+            total += getIdentSize(session, uri);
+        }
+    }
+    if (ret != WT_NOTFOUND) {
+        return wtRCToStatus(ret);
+    }
+    return total;
+}
+
 // static
 StatusWith<uint64_t> WiredTigerUtil::getStatisticsValue(WT_SESSION* session,
                                                         const std::string& uri,
@@ -143,6 +143,28 @@ public:
      */
     static Status checkTableCreationOptions(const BSONElement& configElem);
 
+    /**
+     * Translates the 'cachePriority' collection or index creation option into WT_SESSION::create
+     * configuration. "normal" leaves pages subject to eviction like any other table. "resident"
+     * keeps the table's pages in cache once read, so that scans of other tables cannot evict it;
+     * see checkResidentCacheLimit() for how much of the cache such tables may take.
+     */
+    static StatusWith<std::string> parseCachePriority(const BSONElement& priorityElem);
+
+    /**
+     * Returns ExceededMemoryLimit if the WT_SESSION::create configuration 'config' asks for a
+     * cache resident table while the resident tables which already exist take 'maxPercent' or
+     * more of the cache. Resident pages are never evicted, so without a limit they can fill the
+     * cache and stall every other table. The tables are measured by the size of their files,
+     * which is less than what they take in the cache once read, so this is a lower bound.
+     */
+    static Status checkResidentCacheLimit(WT_SESSION* session, StringData config, int maxPercent);
+
+    /**
+     * Returns the total size of the files of the tables created with cache_resident=true.
+     */
+    static StatusWith<int64_t> getResidentFilesSize(WT_SESSION* session);
+
     /**
      * Reads individual statistics using URI.
      * List of statistics keys WT_STAT_* can be found in wiredtiger.h.
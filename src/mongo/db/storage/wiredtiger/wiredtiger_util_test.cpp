@@ -40,6 +40,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -239,6 +240,101 @@ TEST_F(WiredTigerUtilMetadataTest, CheckApplicationMetadataFormatVersionNumber)
         getOperationContext(), getURI(), 3, 3));
 }
 
+namespace {
+
+/**
+ * Creates 'uri' with 'config', inserts 'count' values of 'size' bytes, and takes a checkpoint so
+ * that the pages are clean and may be evicted.
+ */
+void fillTable(WT_SESSION* session, const char* uri, const char* config, int count, int size) {
+    ASSERT_OK(wtRCToStatus(session->create(session, uri, config)));
+    WT_CURSOR* cursor;
+    ASSERT_OK(wtRCToStatus(session->open_cursor(session, uri, NULL, NULL, &cursor)));
+    const std::string value(size, 'x');
+    for (int64_t i = 0; i < count; i++) {
+        cursor->set_key(cursor, i);
+        cursor->set_value(cursor, value.c_str());
+        ASSERT_OK(wtRCToStatus(cursor->insert(cursor)));
+    }
+    ASSERT_OK(wtRCToStatus(cursor->close(cursor)));
+    ASSERT_OK(wtRCToStatus(session->checkpoint(session, NULL)));
+}
+
+/**
+ * Reads all of 'uri', and returns how many bytes have been read into the cache for it so far.
+ */
+uint64_t scanTable(WT_SESSION* session, const std::string& uri) {
+    WT_CURSOR* cursor;
+    ASSERT_OK(wtRCToStatus(session->open_cursor(session, uri.c_str(), NULL, NULL, &cursor)));
+    int ret;
+    while ((ret = cursor->next(cursor)) == 0) {
+    }
+    ASSERT_EQUALS(WT_NOTFOUND, ret);
+    ASSERT_OK(wtRCToStatus(cursor->close(cursor)));
+
+    StatusWith<uint64_t> bytesRead = WiredTigerUtil::getStatisticsValue(
+        session, "statistics:" + uri, "statistics=(all)", WT_STAT_DSRC_CACHE_BYTES_READ);
+    ASSERT_OK(bytesRead.getStatus());
+    return bytesRead.getValue();
+}
+
+}  // namespace
+
+TEST(WiredTigerUtilTest, ResidentTableIsNotEvictedByLargeScans) {
+    unittest::TempDir dbpath("wt_test");
+    WiredTigerConnection connection(dbpath.path(), "cache_size=2M,statistics=(all)");
+    WT_CONNECTION* conn = connection.getConnection();
+    WT_SESSION* session;
+    ASSERT_OK(wtRCToStatus(conn->open_session(conn, NULL, NULL, &session)));
+    ON_BLOCK_EXIT(session->close, session, static_cast<const char*>(NULL));
+
+    fillTable(session,
+              "table:resident",
+              "key_format=q,value_format=S,cache_resident=true",
+              200,
+              1000);
+    fillTable(session, "table:normal", "key_format=q,value_format=S", 200, 1000);
+    fillTable(session, "table:large", "key_format=q,value_format=S", 8000, 1000);
+
+    // Read both small tables into the cache, then scan a table four times the size of the cache.
+    const uint64_t residentBytesRead = scanTable(session, "table:resident");
+    const uint64_t normalBytesRead = scanTable(session, "table:normal");
+    scanTable(session, "table:large");
+
+    // Only the normal table had to be read again.
+    ASSERT_EQUALS(residentBytesRead, scanTable(session, "table:resident"));
+    ASSERT_GREATER_THAN(scanTable(session, "table:normal"), normalBytesRead);
+}
+
+TEST(WiredTigerUtilTest, CheckResidentCacheLimit) {
+    unittest::TempDir dbpath("wt_test");
+    WiredTigerConnection connection(dbpath.path(), "cache_size=2M,statistics=(fast)");
+    WT_CONNECTION* conn = connection.getConnection();
+    WT_SESSION* session;
+    ASSERT_OK(wtRCToStatus(conn->open_session(conn, NULL, NULL, &session)));
+    ON_BLOCK_EXIT(session->close, session, static_cast<const char*>(NULL));
+
+    const char* residentConfig = "key_format=q,value_format=S,cache_resident=true";
+    const char* normalConfig = "key_format=q,value_format=S,cache_resident=false";
+
+    // Nothing is resident yet.
+    ASSERT_OK(WiredTigerUtil::checkResidentCacheLimit(session, residentConfig, 25));
+
+    // A resident table with more than 25% of the 2MB cache on disk.
+    fillTable(session, "table:resident", residentConfig, 600, 1000);
+    fillTable(session, "table:normal", normalConfig, 600, 1000);
+    StatusWith<int64_t> residentBytes = WiredTigerUtil::getResidentFilesSize(session);
+    ASSERT_OK(residentBytes.getStatus());
+    ASSERT_GREATER_THAN_OR_EQUALS(residentBytes.getValue(), 600 * 1000);
+    ASSERT_LESS_THAN(residentBytes.getValue(), 2 * 600 * 1000);
+
+    ASSERT_EQUALS(ErrorCodes::ExceededMemoryLimit,
+                  WiredTigerUtil::checkResidentCacheLimit(session, residentConfig, 25));
+    ASSERT_OK(WiredTigerUtil::checkResidentCacheLimit(session, residentConfig, 50));
+    ASSERT_OK(WiredTigerUtil::checkResidentCacheLimit(session, normalConfig, 25));
+    ASSERT_OK(WiredTigerUtil::checkResidentCacheLimit(session, "key_format=q", 25));
+}
+
 TEST(WiredTigerUtilTest, GetStatisticsValueMissingTable) {
     WiredTigerUtilHarnessHelper harnessHelper("statistics=(all)");
     WiredTigerRecoveryUnit recoveryUnit(harnessHelper.getSessionCache());
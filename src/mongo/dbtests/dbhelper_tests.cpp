@@ -36,6 +36,7 @@
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/range_arithmetic.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/unittest/unittest.h"
@@ -105,11 +106,69 @@ private:
     int _max;
 };
 
+/**
+ * Sets the rangeDeleterBatchSize server parameter for the lifetime of the object.
+ */
+class ScopedRangeDeleterBatchSize {
+public:
+    explicit ScopedRangeDeleterBatchSize(int batchSize)
+        : _param(ServerParameterSet::getGlobal()->getMap().find("rangeDeleterBatchSize")->second) {
+        BSONObjBuilder b;
+        _param->append(NULL, b, "value");
+        _oldValue = b.obj()["value"].numberInt();
+        ASSERT_OK(_param->setFromString(std::to_string(batchSize)));
+    }
+
+    ~ScopedRangeDeleterBatchSize() {
+        _param->setFromString(std::to_string(_oldValue));
+    }
+
+private:
+    ServerParameter* const _param;
+    int _oldValue;
+};
+
+/** Helpers::RemoveRange deleting one document per storage transaction. */
+class RemoveRangeOneDocumentPerBatch : public RemoveRange {
+public:
+    void run() {
+        ScopedRangeDeleterBatchSize batchSize(1);
+        RemoveRange::run();
+    }
+};
+
+/** Helpers::RemoveRange with several documents deleted per storage transaction. */
+class RemoveRangeInBatches : public RemoveRange {
+public:
+    void run() {
+        ScopedRangeDeleterBatchSize batchSize(3);
+
+        const BSONObj before = rangeDeleterMetrics();
+        RemoveRange::run();
+        const BSONObj after = rangeDeleterMetrics();
+
+        // The 4 documents in [4, 8) take a full batch of 3 and a partial batch of 1
+        ASSERT_EQUALS(4, after["docsDeleted"].numberLong() - before["docsDeleted"].numberLong());
+        ASSERT_EQUALS(2, after["batches"].numberLong() - before["batches"].numberLong());
+    }
+
+private:
+    static BSONObj rangeDeleterMetrics() {
+        OperationContextImpl txn;
+        DBDirectClient client(&txn);
+        BSONObj status;
+        ASSERT(client.runCommand("admin", BSON("serverStatus" << 1), status));
+        return status["metrics"]["rangeDeleter"].Obj().getOwned();
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("remove") {}
     void setupTests() {
         add<RemoveRange>();
+        add<RemoveRangeOneDocumentPerBatch>();
+        add<RemoveRangeInBatches>();
     }
 } myall;
 
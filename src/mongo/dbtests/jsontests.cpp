@@ -222,6 +222,26 @@ public:
     }
 };
 
+class NumberDoubleFormatting {
+public:
+    void run() {
+        BSONObjBuilder b;
+        b.append("a", 1.0);
+        b.append("b", -0.0);
+        b.append("c", 1e15);
+        b.append("d", 123456789012345.0);
+        b.append("e", 0.1);
+        b.append("f", -2.5e-7);
+        b.append("g", -42.0);
+        b.append("h", 1e19);
+        b.append("i", -1e300);
+        ASSERT_EQUALS(
+            "{ \"a\" : 1, \"b\" : -0, \"c\" : 1000000000000000, \"d\" : 123456789012345, "
+            "\"e\" : 0.1, \"f\" : -2.5e-07, \"g\" : -42, \"h\" : 1e+19, \"i\" : -1e+300 }",
+            b.done().jsonString(Strict));
+    }
+};
+
 class NumberDoubleNaN {
 public:
     void run() {
@@ -1737,6 +1757,32 @@ class NumberLongTest : public Base {
     }
 };
 
+class IntegerTypes {
+public:
+    void run() {
+        BSONObj obj = fromjson(
+            "{ a : 2147483647, b : 2147483648, c : -2147483648, d : -2147483649, "
+            "e : 123456789012345678, f : -1234567890123456789, g : 12345678901234567890, "
+            "h : -0, i : 1e3, j : 0x10, k : 007 }");
+        ASSERT_EQUALS(NumberInt, obj["a"].type());
+        ASSERT_EQUALS(NumberLong, obj["b"].type());
+        ASSERT_EQUALS(NumberInt, obj["c"].type());
+        ASSERT_EQUALS(NumberLong, obj["d"].type());
+        ASSERT_EQUALS(NumberLong, obj["e"].type());
+        ASSERT_EQUALS(123456789012345678LL, obj["e"].numberLong());
+        ASSERT_EQUALS(NumberLong, obj["f"].type());
+        ASSERT_EQUALS(-1234567890123456789LL, obj["f"].numberLong());
+        ASSERT_EQUALS(NumberDouble, obj["g"].type());
+        ASSERT_EQUALS(NumberInt, obj["h"].type());
+        ASSERT_EQUALS(NumberDouble, obj["i"].type());
+        ASSERT_EQUALS(1000.0, obj["i"].numberDouble());
+        ASSERT_EQUALS(NumberDouble, obj["j"].type());
+        ASSERT_EQUALS(16.0, obj["j"].numberDouble());
+        ASSERT_EQUALS(NumberInt, obj["k"].type());
+        ASSERT_EQUALS(7, obj["k"].numberInt());
+    }
+};
+
 class NumberLongMin : public Base {
     virtual BSONObj bson() const {
         BSONObjBuilder b;
@@ -2723,6 +2769,7 @@ public:
             add<JsonStringTests::NumberDecimalStrict>();
         }
 
+        add<JsonStringTests::NumberDoubleFormatting>();
         add<JsonStringTests::NumberDoubleNaN>();
         add<JsonStringTests::NumberDoubleInfinity>();
         add<JsonStringTests::NumberDoubleNegativeInfinity>();
@@ -2855,6 +2902,7 @@ public:
         add<FromJsonTests::DateStrictNegative>();
         add<FromJsonTests::DateNegative>();
         add<FromJsonTests::NumberLongTest>();
+        add<FromJsonTests::IntegerTypes>();
         add<FromJsonTests::NumberLongMin>();
         add<FromJsonTests::NumberIntTest>();
         add<FromJsonTests::NumberLongNeg>();
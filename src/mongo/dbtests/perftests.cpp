@@ -46,19 +46,36 @@
 #include <iostream>
 #include <mutex>
 
+#include "mongo/bson/bson_validate.h"
 #include "mongo/config.h"
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/client.h"
 #include "mongo/db/db.h"
+#include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/global_timestamp.h"
+#include "mongo/db/json.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/db/pipeline/document_internal.h"
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/repl/oplog.h"
+#include "mongo/db/storage/in_memory/in_memory_btree_impl.h"
+#include "mongo/db/storage/in_memory/in_memory_compressed_btree.h"
+#include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
+#include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
+#include "mongo/platform/random.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/striped_counter.h"
 #include "mongo/util/log.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/version.h"
@@ -444,6 +461,558 @@ public:
     }
 };
 
+/**
+ * Counter increments of the kind record stores make on every write. The threaded runs compare a
+ * single atomic, whose cache line moves between the writers' cores, with a striped counter.
+ */
+AtomicInt64 atomicCounter;
+class AtomicCounterIncrement : public B {
+public:
+    string name() {
+        return "atomic-counter-increment";
+    }
+    virtual int howLongMillis() {
+        return 500;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual bool testThreaded() {
+        return true;
+    }
+    void timed() {
+        atomicCounter.fetchAndAdd(1);
+    }
+    void timed2(DBClientBase*) {
+        atomicCounter.fetchAndAdd(1);
+    }
+};
+StripedInt64 stripedCounter;
+class StripedCounterIncrement : public B {
+public:
+    string name() {
+        return "striped-counter-increment";
+    }
+    virtual int howLongMillis() {
+        return 500;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual bool testThreaded() {
+        return true;
+    }
+    void timed() {
+        stripedCounter.add(1);
+    }
+    void timed2(DBClientBase*) {
+        stripedCounter.add(1);
+    }
+};
+
+
+/**
+ * Measures oplog write throughput the way replication writes it: an optime is reserved and
+ * registered with the record store under a mutex, then the entry is inserted and committed
+ * outside of it. The threaded run shows how well commit visibility scales with writers.
+ */
+class OplogInsert : public B {
+public:
+    string name() {
+        return "oplog-insert";
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual bool testThreaded() {
+        return true;
+    }
+    void prep() {
+        client()->dropCollection(kOplogNs);
+        client()->createCollection(kOplogNs, 64 * 1024 * 1024, true);
+    }
+    void timed() {
+        timed2(client());
+    }
+    void timed2(DBClientBase*) {
+        OperationContext* txn = cc().getOperationContext();
+        ScopedTransaction transaction(txn, MODE_IX);
+        AutoGetDb autoDb(txn, "local", MODE_IX);
+        Lock::CollectionLock collLock(txn->lockState(), kOplogNs, MODE_IX);
+        Collection* oplog = autoDb.getDb()->getCollection(kOplogNs);
+        invariant(oplog);
+
+        WriteUnitOfWork wuow(txn);
+        Timestamp ts;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_newOpMutex);
+            ts = getNextGlobalTimestamp();
+            ASSERT_OK(oplog->getRecordStore()->oplogDiskLocRegister(txn, ts));
+        }
+        BSONObj entry = BSON("ts" << ts << "h" << 0LL << "op"
+                                  << "n"
+                                  << "ns"
+                                  << ""
+                                  << "o" << BSONObj());
+        ASSERT_OK(oplog->insertDocument(txn, entry, false).getStatus());
+        wuow.commit();
+    }
+
+private:
+    static const char* const kOplogNs;
+    static stdx::mutex _newOpMutex;
+};
+
+const char* const OplogInsert::kOplogNs = "local.oplog.perftest";
+stdx::mutex OplogInsert::_newOpMutex;
+
+/**
+ * Encodes an insert of a large document as an oplog entry, the way the primary logs it, and
+ * applies it, the way a secondary does. Reports the oplog bytes per op, to compare plain with
+ * compressed payloads.
+ */
+class OplogApplyInsertBase : public B {
+public:
+    virtual bool showDurStats() {
+        return false;
+    }
+    void prep() {
+        client()->createCollection(ns());
+
+        BSONArrayBuilder items;
+        for (int i = 0; i < 100; i++) {
+            items.append(BSON("sku"
+                              << "item-" + std::to_string(i) << "qty" << i << "desc"
+                              << "a product description that is much the same for every item"));
+        }
+        _items = items.arr();
+    }
+    void timed() {
+        BSONObj o = BSON("_id" << _numOps << "items" << _items);
+        const bool compressed = compress() && repl::compressOplogPayload(&o);
+        const BSONObj op = BSON("ts" << Timestamp(0, _numOps) << "h" << 0LL << "v"
+                                     << (compressed ? repl::OPLOG_VERSION_COMPRESSED
+                                                    : repl::OPLOG_VERSION) << "op"
+                                     << "i"
+                                     << "ns" << ns() << "o" << o);
+        _oplogBytes += op.objsize();
+        _numOps++;
+
+        OperationContext* txn = cc().getOperationContext();
+        ScopedTransaction transaction(txn, MODE_IX);
+        AutoGetDb autoDb(txn, nsToDatabaseSubstring(ns()), MODE_X);
+        WriteUnitOfWork wuow(txn);
+        txn->setReplicatedWrites(false);
+        ASSERT_OK(repl::applyOperation_inlock(txn, autoDb.getDb(), op));
+        txn->setReplicatedWrites(true);
+        wuow.commit();
+    }
+    void post() {
+        cout << "stats " << setw(42) << left << name() + " oplog bytes/op" << ' ' << right
+             << setw(9) << _oplogBytes / std::max(_numOps, 1LL) << endl;
+    }
+
+protected:
+    virtual bool compress() = 0;
+
+private:
+    BSONArray _items;
+    long long _numOps = 0;
+    long long _oplogBytes = 0;
+};
+
+class OplogApplyInsert : public OplogApplyInsertBase {
+public:
+    string name() {
+        return "oplog-apply-insert";
+    }
+
+protected:
+    bool compress() {
+        return false;
+    }
+};
+
+class OplogApplyCompressedInsert : public OplogApplyInsertBase {
+public:
+    string name() {
+        return "oplog-apply-compressed-insert";
+    }
+
+protected:
+    bool compress() {
+        return true;
+    }
+};
+
+/**
+ * Measures point lookups in an in-memory index whose keys share long prefixes, like URLs, and
+ * reports the bytes the index takes, to compare the plain and the prefix compressed btree.
+ */
+class InMemoryIndexLookupBase : public B {
+public:
+    InMemoryIndexLookupBase() : _txn(new InMemoryRecoveryUnit()), _random(17) {}
+
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual unsigned batchSize() {
+        return 1000;
+    }
+    void prep() {
+        _index.reset(newIndex(Ordering::make(BSONObj()), &_data));
+        for (int i = 0; i < kNumKeys; i++) {
+            _keys.push_back(BSON("" << ("https://www.example.com/catalog/products/category/" +
+                                        std::to_string(i % 100) + "/item/" + std::to_string(i))));
+        }
+        // Insert out of order so that leaves split the way they do in a live index. 7919 is
+        // prime, so this visits every key once.
+        for (int j = 0; j < kNumKeys; j++) {
+            const int i = (j * 7919LL) % kNumKeys;
+            ASSERT_OK(_index->insert(&_txn, _keys[i], RecordId(1, i), false));
+        }
+        _cursor = _index->newCursor(&_txn);
+    }
+    void timed() {
+        const int i = static_cast<uint32_t>(_random.nextInt32()) % kNumKeys;
+        invariant(_cursor->seekExact(_keys[i]));
+    }
+    void post() {
+        cout << "stats " << setw(42) << left << name() + " bytes" << ' ' << right << setw(9)
+             << _index->getSpaceUsedBytes(&_txn) << endl;
+        _cursor.reset();
+        _index.reset();
+    }
+
+protected:
+    virtual SortedDataInterface* newIndex(const Ordering& ordering,
+                                          std::shared_ptr<void>* data) = 0;
+
+private:
+    static const int kNumKeys = 100 * 1000;
+
+    OperationContextNoop _txn;
+    PseudoRandom _random;
+    std::vector<BSONObj> _keys;
+    std::shared_ptr<void> _data;
+    std::unique_ptr<SortedDataInterface> _index;
+    std::unique_ptr<SortedDataInterface::Cursor> _cursor;
+};
+
+class InMemoryBtreeLookup : public InMemoryIndexLookupBase {
+public:
+    string name() {
+        return "inmemory-btree-lookup";
+    }
+
+protected:
+    SortedDataInterface* newIndex(const Ordering& ordering, std::shared_ptr<void>* data) {
+        return getInMemoryBtreeImpl(ordering, data);
+    }
+};
+
+class InMemoryCompressedBtreeLookup : public InMemoryIndexLookupBase {
+public:
+    string name() {
+        return "inmemory-compressed-btree-lookup";
+    }
+
+protected:
+    SortedDataInterface* newIndex(const Ordering& ordering, std::shared_ptr<void>* data) {
+        return getInMemoryCompressedBtreeImpl(ordering, data);
+    }
+};
+
+/**
+ * Validates documents of a few common shapes, as every insert does when objcheck is on, and
+ * reports the throughput in MB/s as well.
+ */
+class BSONValidateBase : public B {
+public:
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual int howLongMillis() {
+        return 2000;
+    }
+    void prep() {
+        _doc = makeDoc();
+    }
+    void timed() {
+        verify(validateBSON(_doc.objdata(), _doc.objsize()).isOK());
+        _bytes += _doc.objsize();
+    }
+    void post() {
+        cout << name() << " validated " << _bytes / (1024 * 1024) << "MB" << endl;
+    }
+
+protected:
+    virtual BSONObj makeDoc() = 0;
+
+private:
+    BSONObj _doc;
+    long long _bytes = 0;
+};
+
+class BSONValidateFlat : public BSONValidateBase {
+public:
+    string name() {
+        return "bson-validate-flat";
+    }
+
+protected:
+    BSONObj makeDoc() {
+        return BSON("_id" << OID::gen() << "name"
+                          << "Jane Smith"
+                          << "age" << 42 << "score" << 3.5 << "active" << true << "created"
+                          << Date_t::now());
+    }
+};
+
+class BSONValidateWide : public BSONValidateBase {
+public:
+    string name() {
+        return "bson-validate-wide";
+    }
+
+protected:
+    BSONObj makeDoc() {
+        BSONObjBuilder b;
+        b.append("_id", 1);
+        for (int i = 0; i < 50; i++) {
+            b.append("field" + std::to_string(i), i);
+        }
+        return b.obj();
+    }
+};
+
+class BSONValidateNested : public BSONValidateBase {
+public:
+    string name() {
+        return "bson-validate-nested";
+    }
+
+protected:
+    BSONObj makeDoc() {
+        BSONArrayBuilder items;
+        for (int i = 0; i < 20; i++) {
+            items.append(BSON("sku"
+                              << "item-" + std::to_string(i) << "qty" << i << "price" << 9.99
+                              << "tags" << BSON_ARRAY("red"
+                                                      << "large")));
+        }
+        return BSON("_id" << 7 << "customer"
+                          << BSON("name"
+                                  << "Jane Smith"
+                                  << "address" << BSON("city"
+                                                       << "New York"
+                                                       << "zip"
+                                                       << "10001")) << "items" << items.arr());
+    }
+};
+
+/**
+ * Matches a query with predicates on several fields against a wide document, which looks up each
+ * of the fields in the same document.
+ */
+class MatchSeveralFields : public B {
+public:
+    string name() {
+        return "match-several-fields";
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual int howLongMillis() {
+        return 2000;
+    }
+    void prep() {
+        BSONObjBuilder b;
+        b.append("_id", 1);
+        for (int i = 0; i < 50; i++) {
+            b.append("field" + std::to_string(i), i);
+        }
+        _doc = b.obj();
+
+        _query = BSON("field3" << 3 << "field20" << 20 << "field41" << BSON("$gt" << 0)
+                               << "field48" << 48 << "field10" << 10);
+        StatusWithMatchExpression parsed = MatchExpressionParser::parse(_query);
+        verify(parsed.isOK());
+        _expr = std::move(parsed.getValue());
+    }
+    void timed() {
+        verify(_expr->matchesBSON(_doc));
+    }
+
+private:
+    BSONObj _doc;
+    BSONObj _query;
+    std::unique_ptr<MatchExpression> _expr;
+};
+
+/**
+ * Converts an order-like document with nested objects, arrays, strings that need escaping and
+ * numbers of several types to and from JSON.
+ */
+class JsonBase : public B {
+public:
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual int howLongMillis() {
+        return 2000;
+    }
+    void prep() {
+        BSONArrayBuilder items;
+        for (int i = 0; i < 20; i++) {
+            items.append(BSON("sku"
+                              << "item-" + std::to_string(i) << "qty" << i << "price" << 9.99 + i
+                              << "note"
+                              << "Handle with care, \"fragile\"\n"));
+        }
+        _doc = BSON("_id" << OID::gen() << "customer" << BSON("name"
+                                                               << "Jane Smith"
+                                                               << "email"
+                                                               << "jane@example.com")
+                          << "total" << 1234567890123LL << "items" << items.arr());
+        _json = _doc.jsonString(Strict);
+    }
+
+protected:
+    BSONObj _doc;
+    std::string _json;
+};
+
+class JsonEncode : public JsonBase {
+public:
+    string name() {
+        return "json-encode";
+    }
+    void timed() {
+        verify(_doc.jsonString(Strict).size() == _json.size());
+    }
+};
+
+class JsonDecode : public JsonBase {
+public:
+    string name() {
+        return "json-decode";
+    }
+    void timed() {
+        verify(fromjson(_json).objsize() == _doc.objsize());
+    }
+};
+
+/**
+ * Runs a single aggregation stage over a document with sub documents and arrays. After timing it
+ * reports how many bytes of Document storage the stage copied for each document it returned.
+ */
+class PipelineStageBase : public B {
+public:
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual int howLongMillis() {
+        return 2000;
+    }
+    void prep() {
+        BSONObjBuilder b;
+        b.append("_id", 1);
+        for (int i = 0; i < 20; i++) {
+            b.append("field" + std::to_string(i), i);
+        }
+        BSONArrayBuilder lines;
+        for (int i = 0; i < 5; i++) {
+            lines.append("line " + std::to_string(i));
+        }
+        b.append("address",
+                 BSON("lines" << lines.arr() << "city"
+                              << "New York"
+                              << "zip"
+                              << "10001"));
+        _input = Document(b.obj());
+
+        boost::intrusive_ptr<ExpressionContext> expCtx(
+            new ExpressionContext(nullptr, NamespaceString(ns())));
+        _source = DocumentSourceMock::create();
+        _stage = createStage(fromjson(spec()).firstElement(), expCtx);
+        _stage->setSource(_source.get());
+
+        _docsOut = 0;
+        _clonedBytesBefore = DocumentStorage::clonedBytesOnThisThread();
+    }
+    void timed() {
+        _source->queue.push_back(_input);
+        while (_stage->getNext()) {
+            _docsOut++;
+        }
+    }
+    void post() {
+        const size_t clonedBytes = DocumentStorage::clonedBytesOnThisThread() - _clonedBytesBefore;
+        cout << "stats " << setw(42) << left << name() + " cloned bytes/doc" << ' ' << right
+             << setw(9) << (_docsOut ? clonedBytes / _docsOut : 0) << endl;
+    }
+
+protected:
+    virtual const char* spec() = 0;
+    virtual boost::intrusive_ptr<DocumentSource> createStage(
+        BSONElement spec, const boost::intrusive_ptr<ExpressionContext>& expCtx) = 0;
+
+private:
+    Document _input;
+    boost::intrusive_ptr<DocumentSourceMock> _source;
+    boost::intrusive_ptr<DocumentSource> _stage;
+    unsigned long long _docsOut;
+    size_t _clonedBytesBefore;
+};
+
+/** Keeps every field and adds a computed one, which is what an $addFields stage would do. */
+class PipelineProjectAddField : public PipelineStageBase {
+public:
+    string name() {
+        return "pipeline-project-add-field";
+    }
+    const char* spec() {
+        return "{$project: {field0: 1, field1: 1, field2: 1, field3: 1, field4: 1, field5: 1, "
+               "field6: 1, field7: 1, field8: 1, field9: 1, field10: 1, field11: 1, field12: 1, "
+               "field13: 1, field14: 1, field15: 1, field16: 1, field17: 1, field18: 1, "
+               "field19: 1, address: 1, sum: {$add: ['$field1', '$field2']}}}";
+    }
+    boost::intrusive_ptr<DocumentSource> createStage(
+        BSONElement spec, const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+        return DocumentSourceProject::createFromBson(spec, expCtx);
+    }
+};
+
+/** Projects a few fields out of a sub document. */
+class PipelineProjectNested : public PipelineStageBase {
+public:
+    string name() {
+        return "pipeline-project-nested";
+    }
+    const char* spec() {
+        return "{$project: {field0: 1, 'address.city': 1, 'address.zip': 1}}";
+    }
+    boost::intrusive_ptr<DocumentSource> createStage(
+        BSONElement spec, const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+        return DocumentSourceProject::createFromBson(spec, expCtx);
+    }
+};
+
+/** Unwinds an array in a sub document, which copies the documents along the path per output. */
+class PipelineUnwindNested : public PipelineStageBase {
+public:
+    string name() {
+        return "pipeline-unwind-nested";
+    }
+    const char* spec() {
+        return "{$unwind: '$address.lines'}";
+    }
+    boost::intrusive_ptr<DocumentSource> createStage(
+        BSONElement spec, const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+        return DocumentSourceUnwind::createFromBson(spec, expCtx);
+    }
+};
 
 class All : public Suite {
 public:
@@ -457,6 +1026,22 @@ public:
         add<boosttimed_mutexspeed>();
         add<stdmutexspeed>();
         add<stdtimed_mutexspeed>();
+        add<AtomicCounterIncrement>();
+        add<StripedCounterIncrement>();
+        add<OplogInsert>();
+        add<OplogApplyInsert>();
+        add<OplogApplyCompressedInsert>();
+        add<BSONValidateFlat>();
+        add<BSONValidateWide>();
+        add<BSONValidateNested>();
+        add<MatchSeveralFields>();
+        add<JsonEncode>();
+        add<JsonDecode>();
+        add<PipelineProjectAddField>();
+        add<PipelineProjectNested>();
+        add<PipelineUnwindNested>();
+        add<InMemoryBtreeLookup>();
+        add<InMemoryCompressedBtreeLookup>();
     }
 } myall;
 }
@@ -39,17 +39,21 @@
 #include "mongo/db/exec/fetch.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/queued_data_stage.h"
+#include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/fail_point_service.h"
 
 namespace QueryStageFetch {
 
 using std::set;
 using std::shared_ptr;
 using std::unique_ptr;
+using std::vector;
 using stdx::make_unique;
 
 class QueryStageFetchBase {
@@ -214,6 +218,229 @@ public:
     }
 };
 
+/**
+ * Makes the fetch stage read ahead on every fetch, 'kDepth' results at a time.
+ */
+class QueryStageFetchReadAheadBase : public QueryStageFetchBase {
+public:
+    static const int kDepth = 3;
+
+    QueryStageFetchReadAheadBase() : _oldDepth(internalQueryExecFetchReadaheadDepth) {
+        internalQueryExecFetchReadaheadDepth = kDepth;
+        readAheadFailPoint()->setMode(FailPoint::alwaysOn);
+    }
+
+    ~QueryStageFetchReadAheadBase() {
+        readAheadFailPoint()->setMode(FailPoint::off);
+        internalQueryExecFetchReadaheadDepth = _oldDepth;
+    }
+
+    static FailPoint* readAheadFailPoint() {
+        return getGlobalFailPointRegistry()->getFailPoint("fetchStageAlwaysReadAhead");
+    }
+
+    /**
+     * Inserts 'n' documents {foo: i} and returns their locs, in the order they were inserted.
+     */
+    vector<RecordId> insertDocs(Collection* coll, int n) {
+        for (int i = 0; i < n; ++i) {
+            insert(BSON("foo" << i));
+        }
+
+        vector<RecordId> locs(n);
+        auto cursor = coll->getCursor(&_txn);
+        while (auto record = cursor->next()) {
+            locs[record->data.toBson()["foo"].numberInt()] = record->id;
+        }
+        return locs;
+    }
+
+    /**
+     * Queues a member holding only 'loc' in 'mockStage', as an index scan would return it.
+     */
+    static void pushLoc(QueuedDataStage* mockStage, WorkingSet* ws, const RecordId& loc) {
+        WorkingSetID id = ws->allocate();
+        ws->get(id)->loc = loc;
+        ws->transitionToLocAndIdx(id);
+        mockStage->pushBack(id);
+    }
+
+    /**
+     * Works 'stage' until it returns something other than NEED_TIME.
+     */
+    static PlanStage::StageState workPastNeedTime(PlanStage* stage, WorkingSetID* id) {
+        PlanStage::StageState state;
+        do {
+            state = stage->work(id);
+        } while (PlanStage::NEED_TIME == state);
+        return state;
+    }
+
+private:
+    const int _oldDepth;
+};
+
+//
+// Test that results read ahead are returned in the order the child returned them.
+//
+class FetchStageReadAheadKeepsOrder : public QueryStageFetchReadAheadBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_txn, ns());
+        Collection* coll = ctx.getCollection();
+        if (!coll) {
+            WriteUnitOfWork wuow(&_txn);
+            coll = ctx.db()->createCollection(&_txn, ns());
+            wuow.commit();
+        }
+
+        const int kNumDocs = 10;
+        vector<RecordId> locs = insertDocs(coll, kNumDocs);
+
+        // Return the records in the opposite order to the one they are stored in.
+        WorkingSet ws;
+        auto mockStage = make_unique<QueuedDataStage>(&_txn, &ws);
+        for (int i = kNumDocs - 1; i >= 0; --i) {
+            pushLoc(mockStage.get(), &ws, locs[i]);
+        }
+        FetchStage fetchStage(&_txn, &ws, mockStage.release(), NULL, coll);
+
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        for (int i = kNumDocs - 1; i >= 0; --i) {
+            ASSERT_EQUALS(PlanStage::ADVANCED, workPastNeedTime(&fetchStage, &id));
+            ASSERT_EQUALS(i, ws.get(id)->obj.value()["foo"].numberInt());
+            ws.free(id);
+
+            if (i == kNumDocs - 1) {
+                // The first fetch read kDepth further results from the child.
+                unique_ptr<PlanStageStats> stats = fetchStage.getStats();
+                ASSERT_EQUALS(size_t(1 + kDepth), stats->children[0]->common.works);
+            }
+        }
+        ASSERT_EQUALS(PlanStage::IS_EOF, fetchStage.work(&id));
+    }
+};
+
+//
+// Test that a result which was read ahead, but not returned yet, survives the deletion of its
+// record.
+//
+class FetchStageReadAheadInvalidation : public QueryStageFetchReadAheadBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_txn, ns());
+        Collection* coll = ctx.getCollection();
+        if (!coll) {
+            WriteUnitOfWork wuow(&_txn);
+            coll = ctx.db()->createCollection(&_txn, ns());
+            wuow.commit();
+        }
+
+        vector<RecordId> locs = insertDocs(coll, 3);
+
+        WorkingSet ws;
+        auto mockStage = make_unique<QueuedDataStage>(&_txn, &ws);
+        for (const auto& loc : locs) {
+            pushLoc(mockStage.get(), &ws, loc);
+        }
+        FetchStage fetchStage(&_txn, &ws, mockStage.release(), NULL, coll);
+
+        // Fetching the first record reads the other two ahead.
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        ASSERT_EQUALS(PlanStage::ADVANCED, workPastNeedTime(&fetchStage, &id));
+        ASSERT_EQUALS(0, ws.get(id)->obj.value()["foo"].numberInt());
+        ws.free(id);
+
+        // Delete the last record, as a yield would let another operation do.
+        fetchStage.saveState();
+        fetchStage.invalidate(&_txn, locs[2], INVALIDATION_DELETION);
+        remove(BSON("foo" << 2));
+        fetchStage.restoreState();
+
+        ASSERT_EQUALS(PlanStage::ADVANCED, workPastNeedTime(&fetchStage, &id));
+        ASSERT_EQUALS(1, ws.get(id)->obj.value()["foo"].numberInt());
+        ws.free(id);
+
+        // The deleted record was fetched when it was invalidated.
+        ASSERT_EQUALS(PlanStage::ADVANCED, workPastNeedTime(&fetchStage, &id));
+        WorkingSetMember* member = ws.get(id);
+        ASSERT_FALSE(member->hasLoc());
+        ASSERT_EQUALS(2, member->obj.value()["foo"].numberInt());
+        ws.free(id);
+
+        ASSERT_EQUALS(PlanStage::IS_EOF, fetchStage.work(&id));
+    }
+};
+
+//
+// Test that a state other than ADVANCED or NEED_TIME which the child returned while we read
+// ahead is passed up once the results read before it are returned.
+//
+class FetchStageReadAheadStashedState : public QueryStageFetchReadAheadBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_txn, ns());
+        Collection* coll = ctx.getCollection();
+        if (!coll) {
+            WriteUnitOfWork wuow(&_txn);
+            coll = ctx.db()->createCollection(&_txn, ns());
+            wuow.commit();
+        }
+
+        vector<RecordId> locs = insertDocs(coll, 3);
+
+        checkStashedState(coll, locs, PlanStage::NEED_YIELD);
+        checkStashedState(coll, locs, PlanStage::FAILURE);
+        checkStashedState(coll, locs, PlanStage::IS_EOF);
+    }
+
+private:
+    void checkStashedState(Collection* coll,
+                           const vector<RecordId>& locs,
+                           PlanStage::StageState childState) {
+        // The child returns two results, then 'childState', then, unless it hit EOF, another
+        // result. Reading ahead kDepth results stops at 'childState'.
+        WorkingSet ws;
+        auto mockStage = make_unique<QueuedDataStage>(&_txn, &ws);
+        pushLoc(mockStage.get(), &ws, locs[0]);
+        pushLoc(mockStage.get(), &ws, locs[1]);
+        mockStage->pushBack(childState);
+        if (PlanStage::IS_EOF != childState) {
+            pushLoc(mockStage.get(), &ws, locs[2]);
+        }
+        FetchStage fetchStage(&_txn, &ws, mockStage.release(), NULL, coll);
+
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        ASSERT_EQUALS(PlanStage::ADVANCED, workPastNeedTime(&fetchStage, &id));
+        ASSERT_EQUALS(0, ws.get(id)->obj.value()["foo"].numberInt());
+        ws.free(id);
+        ASSERT_FALSE(fetchStage.isEOF());
+
+        ASSERT_EQUALS(PlanStage::ADVANCED, workPastNeedTime(&fetchStage, &id));
+        ASSERT_EQUALS(1, ws.get(id)->obj.value()["foo"].numberInt());
+        ws.free(id);
+        ASSERT_FALSE(fetchStage.isEOF());
+
+        ASSERT_EQUALS(childState, fetchStage.work(&id));
+        if (PlanStage::FAILURE == childState) {
+            // The child gave no reason, so we made one up.
+            ASSERT_NOT_EQUALS(WorkingSet::INVALID_ID, id);
+            ASSERT_FALSE(WorkingSetCommon::getMemberStatus(*ws.get(id)).isOK());
+            return;
+        }
+        if (PlanStage::IS_EOF == childState) {
+            ASSERT_TRUE(fetchStage.isEOF());
+            return;
+        }
+
+        // After a yield the child carries on where it left off.
+        ASSERT_EQUALS(PlanStage::ADVANCED, workPastNeedTime(&fetchStage, &id));
+        ASSERT_EQUALS(2, ws.get(id)->obj.value()["foo"].numberInt());
+        ws.free(id);
+        ASSERT_EQUALS(PlanStage::IS_EOF, fetchStage.work(&id));
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_fetch") {}
@@ -221,6 +448,9 @@ public:
     void setupTests() {
         add<FetchStageAlreadyFetched>();
         add<FetchStageFilter>();
+        add<FetchStageReadAheadKeepsOrder>();
+        add<FetchStageReadAheadInvalidation>();
+        add<FetchStageReadAheadStashedState>();
     }
 };
 
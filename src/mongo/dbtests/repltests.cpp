@@ -1360,6 +1360,64 @@ public:
     }
 };
 
+class ApplyCompressedPayloads : public Base {
+public:
+    void run() {
+        BSONObjBuilder docBuilder;
+        docBuilder.append("_id", 1);
+        BSONArrayBuilder items(docBuilder.subarrayStart("items"));
+        for (int i = 0; i < 200; i++) {
+            items.append(BSON("sku"
+                              << "item-" + std::to_string(i) << "desc"
+                              << "a description that repeats in every item"));
+        }
+        items.done();
+        const BSONObj doc = docBuilder.obj();
+
+        BSONObj smallPayload = BSON("_id" << 2);
+        ASSERT_FALSE(compressOplogPayload(&smallPayload));
+
+        BSONObj o = doc;
+        ASSERT_TRUE(compressOplogPayload(&o));
+        ASSERT_LESS_THAN(o.objsize(), doc.objsize());
+        ASSERT_EQUALS(1, o["_id"].numberInt());
+        apply(BSON("op"
+                   << "i"
+                   << "ns" << ns() << "v" << OPLOG_VERSION_COMPRESSED << "o" << o));
+        check(doc, one(BSON("_id" << 1)));
+
+        BSONObjBuilder replacementBuilder;
+        replacementBuilder.appendElements(doc);
+        replacementBuilder.append("updated", true);
+        const BSONObj replacement = replacementBuilder.obj();
+        o = replacement;
+        ASSERT_TRUE(compressOplogPayload(&o));
+        apply(BSON("op"
+                   << "u"
+                   << "ns" << ns() << "v" << OPLOG_VERSION_COMPRESSED << "o2" << BSON("_id" << 1)
+                   << "o" << o));
+        check(replacement, one(BSON("_id" << 1)));
+
+        // Only entries of the compressed version have their payloads uncompressed.
+        const BSONObj op = BSON("op"
+                                << "i"
+                                << "ns" << ns() << "v" << OPLOG_VERSION << "o" << o);
+        ASSERT_EQUALS(o, uncompressOplogPayload(op, o));
+    }
+
+private:
+    void apply(const BSONObj& op) {
+        ScopedTransaction transaction(&_txn, MODE_X);
+        Lock::GlobalWrite lk(_txn.lockState());
+        OldClientContext ctx(&_txn, ns());
+        WriteUnitOfWork wunit(&_txn);
+        _txn.setReplicatedWrites(false);
+        ASSERT_OK(applyOperation_inlock(&_txn, ctx.db(), op));
+        _txn.setReplicatedWrites(true);
+        wunit.commit();
+    }
+};
+
 class DatabaseIgnorerBasic {
 public:
     void run() {
@@ -1512,6 +1570,7 @@ public:
         add<Idempotence::ReplaySetPreexistingNoOpPull>();
         add<Idempotence::ReplayArrayFieldNotAppended>();
         add<DeleteOpIsIdBased>();
+        add<ApplyCompressedPayloads>();
         add<DatabaseIgnorerBasic>();
         add<DatabaseIgnorerUpdate>();
         add<ShouldRetry>();
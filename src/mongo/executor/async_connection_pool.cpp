@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/async_connection_pool.h"
+
+#include <set>
+
+#include "mongo/bson/bsonobjbuilder.h"
+
+namespace mongo {
+namespace executor {
+
+namespace {
+
+stdx::mutex poolsMutex;
+std::set<const AsyncConnectionPoolStatsSource*> pools;
+
+}  // namespace
+
+AsyncConnectionPoolHostStats& AsyncConnectionPoolHostStats::operator+=(
+    const AsyncConnectionPoolHostStats& other) {
+    available += other.available;
+    inUse += other.inUse;
+    connecting += other.connecting;
+    queued += other.queued;
+    created += other.created;
+    connectFailures += other.connectFailures;
+    requestsTimedOut += other.requestsTimedOut;
+    refreshed += other.refreshed;
+    latencyMillis = std::max(latencyMillis, other.latencyMillis);
+    return *this;
+}
+
+void AsyncConnectionPoolHostStats::append(BSONObjBuilder* builder) const {
+    builder->appendNumber("available", available);
+    builder->appendNumber("inUse", inUse);
+    builder->appendNumber("connecting", connecting);
+    builder->appendNumber("queued", queued);
+    builder->appendNumber("created", created);
+    builder->appendNumber("connectFailures", connectFailures);
+    builder->appendNumber("requestsTimedOut", requestsTimedOut);
+    builder->appendNumber("refreshed", refreshed);
+    if (latencyMillis >= 0) {
+        builder->append("latencyMillis", latencyMillis);
+    }
+}
+
+void registerAsyncConnectionPool(const AsyncConnectionPoolStatsSource* pool) {
+    stdx::lock_guard<stdx::mutex> lk(poolsMutex);
+    pools.insert(pool);
+}
+
+void unregisterAsyncConnectionPool(const AsyncConnectionPoolStatsSource* pool) {
+    stdx::lock_guard<stdx::mutex> lk(poolsMutex);
+    pools.erase(pool);
+}
+
+void appendAsyncConnectionPoolStats(BSONObjBuilder* builder) {
+    AsyncConnectionPoolStats stats;
+    {
+        stdx::lock_guard<stdx::mutex> lk(poolsMutex);
+        for (const auto pool : pools) {
+            pool->collectStats(&stats);
+        }
+    }
+
+    AsyncConnectionPoolHostStats totals;
+    BSONObjBuilder hostsBuilder(builder->subobjStart("hosts"));
+    for (const auto& entry : stats) {
+        BSONObjBuilder hostBuilder(hostsBuilder.subobjStart(entry.first));
+        entry.second.append(&hostBuilder);
+        hostBuilder.doneFast();
+
+        totals += entry.second;
+    }
+    hostsBuilder.doneFast();
+
+    builder->appendNumber("totalAvailable", totals.available);
+    builder->appendNumber("totalInUse", totals.inUse);
+    builder->appendNumber("totalCreated", totals.created);
+}
+
+}  // namespace executor
+}  // namespace mongo
@@ -0,0 +1,581 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+namespace executor {
+
+/**
+ * Tunables for AsyncConnectionPool. Every limit applies separately to each remote host.
+ */
+struct AsyncConnectionPoolOptions {
+    // Number of connections kept open to every host the pool has talked to, counting idle,
+    // in use and connecting ones. Missing connections are established in the background.
+    size_t minConnections = 1;
+
+    // Upper bound on the number of idle, in use and connecting connections. Requests that
+    // arrive while a host is at its limit queue until a connection is returned. The thread pool
+    // network interface never runs more than 52 commands at once, so the default leaves room
+    // for bursts without letting a slow host accumulate an unbounded number of sockets.
+    size_t maxConnections = 100;
+
+    // Idle connections that have not been used for this long are health checked.
+    Milliseconds refreshRequirement = Milliseconds(60 * 1000);
+
+    // Idle connections above minConnections are closed after being unused for this long.
+    Milliseconds idleTimeout = Milliseconds(5 * 60 * 1000);
+
+    // How often the owner of the pool is expected to call runHousekeeping().
+    Milliseconds housekeepingInterval = Milliseconds(500);
+
+    // Weight of the newest isMaster round trip time in each connection's latency score.
+    double latencyAlpha = 0.25;
+};
+
+/**
+ * Point in time statistics for the connections to a single host.
+ */
+struct AsyncConnectionPoolHostStats {
+    AsyncConnectionPoolHostStats& operator+=(const AsyncConnectionPoolHostStats& other);
+
+    void append(BSONObjBuilder* builder) const;
+
+    long long available = 0;
+    long long inUse = 0;
+    long long connecting = 0;
+    long long queued = 0;
+    long long created = 0;
+    long long connectFailures = 0;
+    long long requestsTimedOut = 0;
+    long long refreshed = 0;
+
+    // Smoothed round trip time to the host, or a negative value if nothing was measured yet.
+    // When several pools talk to the same host this is the highest of their scores.
+    double latencyMillis = -1;
+};
+
+using AsyncConnectionPoolStats = std::map<std::string, AsyncConnectionPoolHostStats>;
+
+/**
+ * Type-independent view of an AsyncConnectionPool used to report statistics. Every pool
+ * registers itself on construction, so connPoolStats can describe all of them.
+ */
+class AsyncConnectionPoolStatsSource {
+public:
+    virtual ~AsyncConnectionPoolStatsSource() = default;
+
+    /**
+     * Adds this pool's per-host statistics to 'stats', keyed by "host:port".
+     */
+    virtual void collectStats(AsyncConnectionPoolStats* stats) const = 0;
+};
+
+void registerAsyncConnectionPool(const AsyncConnectionPoolStatsSource* pool);
+void unregisterAsyncConnectionPool(const AsyncConnectionPoolStatsSource* pool);
+
+/**
+ * Appends the combined statistics of every live AsyncConnectionPool to 'builder'.
+ */
+void appendAsyncConnectionPoolStats(BSONObjBuilder* builder);
+
+/**
+ * A per-host pool of established connections for an asynchronous network layer.
+ *
+ * The pool does not perform any I/O itself. Whenever it needs a new connection to a host it
+ * calls the spawn function, and the owner later reports the outcome through
+ * connectionEstablished() or connectionFailed(). Idle connections that need a health check are
+ * handed to the refresh function, and come back through returnConnection() or
+ * dropConnection() like any other checked out connection.
+ *
+ * Requests for a connection are served from the idle connection with the lowest latency score,
+ * an exponentially weighted moving average of the round trip times of the isMaster commands
+ * run while establishing and health checking it. Other commands are not sampled because their
+ * duration mostly depends on the work they do on the remote host. When no connection is idle
+ * the request queues, in arrival order, until one is returned, one is established or its
+ * deadline passes.
+ *
+ * Callbacks are never run while the pool's mutex is held, so they may call back into the pool.
+ */
+template <typename Connection>
+class AsyncConnectionPool final : public AsyncConnectionPoolStatsSource {
+    MONGO_DISALLOW_COPYING(AsyncConnectionPool);
+
+public:
+    using ConnectionPtr = std::unique_ptr<Connection>;
+    using GetConnectionCallback = stdx::function<void(StatusWith<ConnectionPtr>)>;
+    using SpawnConnectionFn = stdx::function<void(const HostAndPort&)>;
+    using RefreshConnectionFn = stdx::function<void(const HostAndPort&, ConnectionPtr)>;
+    using RequestId = uint64_t;
+
+    AsyncConnectionPool(AsyncConnectionPoolOptions options,
+                        SpawnConnectionFn spawn,
+                        RefreshConnectionFn refresh)
+        : _options(std::move(options)), _spawn(std::move(spawn)), _refresh(std::move(refresh)) {
+        registerAsyncConnectionPool(this);
+    }
+
+    ~AsyncConnectionPool() {
+        unregisterAsyncConnectionPool(this);
+    }
+
+    const AsyncConnectionPoolOptions& getOptions() const {
+        return _options;
+    }
+
+    /**
+     * Requests a connection to 'host'. 'cb' receives either a checked out connection, which
+     * must eventually be passed to returnConnection() or dropConnection(), or an error if the
+     * deadline passed or establishing a connection failed. 'id' names the request in
+     * cancelRequest() and must be unique among the requests queued for 'host'.
+     */
+    void get(const HostAndPort& host,
+             RequestId id,
+             Date_t deadline,
+             Date_t now,
+             GetConnectionCallback cb) {
+        Work work;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            auto& pool = _pools[host];
+            pool.lastActive = now;
+            pool.requests.push_back({id, deadline, std::move(cb)});
+            _fulfillRequests_inlock(&pool, now, &work);
+            _scheduleSpawns_inlock(host, &pool, &work);
+        }
+        _run(&work);
+    }
+
+    /**
+     * Removes request 'id' from the queue for 'host' and fails it with 'status'. Does nothing
+     * if the request has already received a connection or an error.
+     */
+    void cancelRequest(const HostAndPort& host, RequestId id, const Status& status) {
+        Work work;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            auto it = _pools.find(host);
+            if (it == _pools.end()) {
+                return;
+            }
+            auto& requests = it->second.requests;
+            auto request = std::find_if(requests.begin(),
+                                        requests.end(),
+                                        [id](const Request& request) { return request.id == id; });
+            if (request == requests.end()) {
+                return;
+            }
+            work.deliveries.push_back({std::move(request->cb), status, nullptr});
+            requests.erase(request);
+        }
+        _run(&work);
+    }
+
+    /**
+     * Checks in a connection whose health check completed a round trip of 'latency'.
+     */
+    void returnConnection(const HostAndPort& host,
+                          ConnectionPtr conn,
+                          Date_t now,
+                          Milliseconds latency) {
+        _checkIn(host, std::move(conn), now, &latency);
+    }
+
+    /**
+     * Checks in a connection without a new latency sample.
+     */
+    void returnConnection(const HostAndPort& host, ConnectionPtr conn, Date_t now) {
+        _checkIn(host, std::move(conn), now, nullptr);
+    }
+
+    /**
+     * Discards a checked out connection that is no longer usable, for example after a network
+     * error, and replaces it if requests are waiting.
+     */
+    void dropConnection(const HostAndPort& host, ConnectionPtr conn) {
+        Work work;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            auto& pool = _pools[host];
+            const size_t erased = pool.inUse.erase(conn.get());
+            invariant(erased == 1);
+            _scheduleSpawns_inlock(host, &pool, &work);
+        }
+        conn.reset();
+        _run(&work);
+    }
+
+    /**
+     * Reports the successful outcome of a spawn request whose handshake took 'latency'.
+     */
+    void connectionEstablished(const HostAndPort& host,
+                               ConnectionPtr conn,
+                               Date_t now,
+                               Milliseconds latency) {
+        _addEstablished(host, std::move(conn), now, &latency);
+    }
+
+    /**
+     * Reports the successful outcome of a spawn request without a latency sample.
+     */
+    void connectionEstablished(const HostAndPort& host, ConnectionPtr conn, Date_t now) {
+        _addEstablished(host, std::move(conn), now, nullptr);
+    }
+
+    /**
+     * Reports the failure of a spawn request. The oldest queued request, if any, fails with
+     * 'status', as it would have had it established the connection itself.
+     */
+    void connectionFailed(const HostAndPort& host, const Status& status, Date_t now) {
+        Work work;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            auto& pool = _pools[host];
+            invariant(pool.connecting > 0);
+            --pool.connecting;
+            ++pool.connectFailures;
+            pool.lastConnectFailed = true;
+
+            _fulfillRequests_inlock(&pool, now, &work);
+            if (!pool.requests.empty()) {
+                work.deliveries.push_back({std::move(pool.requests.front().cb), status, nullptr});
+                pool.requests.pop_front();
+            }
+        }
+        _run(&work);
+    }
+
+    /**
+     * Expires queued requests, closes and health checks idle connections, warms hosts up to
+     * minConnections and forgets hosts that have not been used in a while.
+     */
+    void runHousekeeping(Date_t now) {
+        Work work;
+        std::vector<ConnectionPtr> toClose;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            for (auto it = _pools.begin(); it != _pools.end();) {
+                const HostAndPort& host = it->first;
+                HostPool& pool = it->second;
+
+                _expireRequests_inlock(&pool, now, &work);
+
+                auto idle = pool.idle.begin();
+                while (idle != pool.idle.end()) {
+                    const Date_t lastUsed = idle->info.lastUsed;
+                    if (pool.totalConnections() > _options.minConnections &&
+                        lastUsed + _options.idleTimeout <= now) {
+                        toClose.push_back(std::move(idle->conn));
+                        idle = pool.idle.erase(idle);
+                    } else if (lastUsed + _options.refreshRequirement <= now) {
+                        ++pool.refreshed;
+                        pool.inUse.emplace(idle->conn.get(), idle->info);
+                        work.refreshes.emplace_back(host, std::move(idle->conn));
+                        idle = pool.idle.erase(idle);
+                    } else {
+                        ++idle;
+                    }
+                }
+
+                _scheduleSpawns_inlock(host, &pool, &work);
+
+                if (pool.totalConnections() == 0 && pool.requests.empty() &&
+                    pool.lastActive + _options.idleTimeout <= now) {
+                    it = _pools.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        toClose.clear();
+        _run(&work);
+    }
+
+    void collectStats(AsyncConnectionPoolStats* stats) const override {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (const auto& entry : _pools) {
+            const HostPool& pool = entry.second;
+
+            AsyncConnectionPoolHostStats hostStats;
+            hostStats.available = pool.idle.size();
+            hostStats.inUse = pool.inUse.size();
+            hostStats.connecting = pool.connecting;
+            hostStats.queued = pool.requests.size();
+            hostStats.created = pool.created;
+            hostStats.connectFailures = pool.connectFailures;
+            hostStats.requestsTimedOut = pool.requestsTimedOut;
+            hostStats.refreshed = pool.refreshed;
+            hostStats.latencyMillis = pool.latencyMillis;
+
+            (*stats)[entry.first.toString()] += hostStats;
+        }
+    }
+
+private:
+    struct ConnectionInfo {
+        Date_t lastUsed;
+
+        // Negative until the first latency sample is taken on this connection.
+        double latencyMillis = -1;
+    };
+
+    struct IdleConnection {
+        ConnectionPtr conn;
+        ConnectionInfo info;
+    };
+
+    struct Request {
+        RequestId id;
+        Date_t deadline;
+        GetConnectionCallback cb;
+    };
+
+    struct HostPool {
+        size_t totalConnections() const {
+            return idle.size() + inUse.size() + connecting;
+        }
+
+        std::vector<IdleConnection> idle;
+        std::unordered_map<Connection*, ConnectionInfo> inUse;
+        size_t connecting = 0;
+        std::deque<Request> requests;
+
+        // Set when the latest attempt to connect failed, which suspends background warm-up
+        // until a request for the host succeeds in establishing a connection again.
+        bool lastConnectFailed = false;
+        Date_t lastActive;
+
+        // Smoothed round trip time over all connections, used to rank untried connections.
+        double latencyMillis = -1;
+
+        long long created = 0;
+        long long connectFailures = 0;
+        long long requestsTimedOut = 0;
+        long long refreshed = 0;
+    };
+
+    struct Delivery {
+        GetConnectionCallback cb;
+        Status status;
+        ConnectionPtr conn;
+    };
+
+    /**
+     * Callbacks collected under the mutex and run once it is released.
+     */
+    struct Work {
+        std::vector<Delivery> deliveries;
+        std::vector<std::pair<HostAndPort, ConnectionPtr>> refreshes;
+        std::vector<HostAndPort> spawns;
+    };
+
+    void _addEstablished(const HostAndPort& host,
+                         ConnectionPtr conn,
+                         Date_t now,
+                         const Milliseconds* latency) {
+        Work work;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            auto& pool = _pools[host];
+            invariant(pool.connecting > 0);
+            --pool.connecting;
+            ++pool.created;
+            pool.lastConnectFailed = false;
+
+            IdleConnection idle;
+            idle.conn = std::move(conn);
+            idle.info.lastUsed = now;
+            if (latency) {
+                _recordLatency_inlock(&pool, &idle.info, *latency);
+            }
+            pool.idle.push_back(std::move(idle));
+
+            _fulfillRequests_inlock(&pool, now, &work);
+        }
+        _run(&work);
+    }
+
+    void _checkIn(const HostAndPort& host,
+                  ConnectionPtr conn,
+                  Date_t now,
+                  const Milliseconds* latency) {
+        Work work;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            auto& pool = _pools[host];
+            auto it = pool.inUse.find(conn.get());
+            invariant(it != pool.inUse.end());
+
+            IdleConnection idle;
+            idle.conn = std::move(conn);
+            idle.info = it->second;
+            idle.info.lastUsed = now;
+            pool.inUse.erase(it);
+
+            if (latency) {
+                _recordLatency_inlock(&pool, &idle.info, *latency);
+            }
+
+            pool.lastActive = now;
+            pool.idle.push_back(std::move(idle));
+            _fulfillRequests_inlock(&pool, now, &work);
+        }
+        _run(&work);
+    }
+
+    void _recordLatency_inlock(HostPool* pool, ConnectionInfo* info, Milliseconds latency) {
+        const double sample = static_cast<double>(durationCount<Milliseconds>(latency));
+        info->latencyMillis = _smooth(info->latencyMillis, sample);
+        pool->latencyMillis = _smooth(pool->latencyMillis, sample);
+    }
+
+    double _smooth(double average, double sample) const {
+        if (average < 0)
+            return sample;
+        return _options.latencyAlpha * sample + (1 - _options.latencyAlpha) * average;
+    }
+
+    /**
+     * Hands idle connections to queued requests, best score first, failing expired requests.
+     */
+    void _fulfillRequests_inlock(HostPool* pool, Date_t now, Work* work) {
+        _expireRequests_inlock(pool, now, work);
+
+        while (!pool->requests.empty() && !pool->idle.empty()) {
+            // Connections without a sample yet are ranked by the host's score.
+            const double fallback = std::max(pool->latencyMillis, 0.0);
+            const auto score = [fallback](const IdleConnection& idle) {
+                return idle.info.latencyMillis < 0 ? fallback : idle.info.latencyMillis;
+            };
+            auto best = std::min_element(
+                pool->idle.begin(),
+                pool->idle.end(),
+                [&score](const IdleConnection& a, const IdleConnection& b) {
+                    return score(a) < score(b);
+                });
+
+            pool->inUse.emplace(best->conn.get(), best->info);
+            work->deliveries.push_back(
+                {std::move(pool->requests.front().cb), Status::OK(), std::move(best->conn)});
+            pool->requests.pop_front();
+            pool->idle.erase(best);
+        }
+    }
+
+    void _expireRequests_inlock(HostPool* pool, Date_t now, Work* work) {
+        auto it = pool->requests.begin();
+        while (it != pool->requests.end()) {
+            if (it->deadline > now) {
+                ++it;
+                continue;
+            }
+
+            ++pool->requestsTimedOut;
+            work->deliveries.push_back(
+                {std::move(it->cb),
+                 Status(ErrorCodes::ExceededTimeLimit,
+                        "Timed out waiting for a connection from the pool"),
+                 nullptr});
+            it = pool->requests.erase(it);
+        }
+    }
+
+    /**
+     * Starts one connection per queued request not already covered by a connection being
+     * established and, unless the host is failing, enough to reach minConnections, without
+     * exceeding maxConnections.
+     */
+    void _scheduleSpawns_inlock(const HostAndPort& host, HostPool* pool, Work* work) {
+        const size_t total = pool->totalConnections();
+
+        size_t wanted = 0;
+        if (pool->requests.size() > pool->connecting) {
+            wanted = pool->requests.size() - pool->connecting;
+        }
+        if (!pool->lastConnectFailed && total < _options.minConnections) {
+            wanted = std::max(wanted, _options.minConnections - total);
+        }
+        if (total >= _options.maxConnections) {
+            wanted = 0;
+        } else {
+            wanted = std::min(wanted, _options.maxConnections - total);
+        }
+
+        pool->connecting += wanted;
+        work->spawns.insert(work->spawns.end(), wanted, host);
+    }
+
+    void _run(Work* work) {
+        for (auto& delivery : work->deliveries) {
+            if (delivery.conn) {
+                delivery.cb(StatusWith<ConnectionPtr>(std::move(delivery.conn)));
+            } else {
+                delivery.cb(StatusWith<ConnectionPtr>(delivery.status));
+            }
+        }
+        for (auto& refresh : work->refreshes) {
+            _refresh(refresh.first, std::move(refresh.second));
+        }
+        for (const auto& host : work->spawns) {
+            _spawn(host);
+        }
+    }
+
+    const AsyncConnectionPoolOptions _options;
+    const SpawnConnectionFn _spawn;
+    const RefreshConnectionFn _refresh;
+
+    // Protects _pools.
+    mutable stdx::mutex _mutex;
+    std::unordered_map<HostAndPort, HostPool> _pools;
+};
+
+}  // namespace executor
+}  // namespace mongo
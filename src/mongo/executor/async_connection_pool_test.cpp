@@ -0,0 +1,393 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/executor/async_connection_pool.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace executor {
+namespace {
+
+struct MockConnection {
+    explicit MockConnection(int id) : id(id) {}
+
+    const int id;
+};
+
+using MockPool = AsyncConnectionPool<MockConnection>;
+using MockConnectionPtr = std::unique_ptr<MockConnection>;
+
+const HostAndPort testHost{"localhost", 20000};
+const Date_t start = Date_t::fromMillisSinceEpoch(1000 * 1000);
+
+/**
+ * Outcome of a request for a connection, filled in when the pool completes it.
+ */
+struct GetResult {
+    Status status{ErrorCodes::InternalError, "request not completed"};
+    MockConnectionPtr conn;
+};
+
+class AsyncConnectionPoolTest : public mongo::unittest::Test {
+public:
+    void makePool(AsyncConnectionPoolOptions options) {
+        _pool = stdx::make_unique<MockPool>(
+            std::move(options),
+            [this](const HostAndPort& host) { _spawned.push_back(host); },
+            [this](const HostAndPort& host, MockConnectionPtr conn) {
+                _refreshing.push_back(std::move(conn));
+            });
+    }
+
+    MockPool& pool() {
+        return *_pool;
+    }
+
+    std::shared_ptr<GetResult> get(Date_t deadline = Date_t::max()) {
+        auto result = std::make_shared<GetResult>();
+        pool().get(testHost,
+                   ++_nextRequestId,
+                   deadline,
+                   start,
+                   [result](StatusWith<MockConnectionPtr> swConn) {
+                       result->status = swConn.getStatus();
+                       if (swConn.isOK()) {
+                           result->conn = std::move(swConn.getValue());
+                       }
+                   });
+        return result;
+    }
+
+    void establish(int id, Date_t now = start) {
+        pool().connectionEstablished(testHost, stdx::make_unique<MockConnection>(id), now);
+    }
+
+    void establish(int id, Milliseconds handshakeLatency) {
+        pool().connectionEstablished(
+            testHost, stdx::make_unique<MockConnection>(id), start, handshakeLatency);
+    }
+
+    size_t numSpawned() const {
+        return _spawned.size();
+    }
+
+    std::vector<MockConnectionPtr>& refreshing() {
+        return _refreshing;
+    }
+
+    AsyncConnectionPoolHostStats stats() {
+        AsyncConnectionPoolStats stats;
+        pool().collectStats(&stats);
+        return stats[testHost.toString()];
+    }
+
+private:
+    MockPool::RequestId _nextRequestId = 0;
+    std::vector<HostAndPort> _spawned;
+    std::vector<MockConnectionPtr> _refreshing;
+    std::unique_ptr<MockPool> _pool;
+};
+
+TEST_F(AsyncConnectionPoolTest, GetSpawnsConnectionAndDeliversIt) {
+    makePool(AsyncConnectionPoolOptions());
+
+    auto result = get();
+    ASSERT_EQUALS(1U, numSpawned());
+    ASSERT_EQUALS(ErrorCodes::InternalError, result->status);
+
+    establish(1);
+    ASSERT_OK(result->status);
+    ASSERT_EQUALS(1, result->conn->id);
+
+    auto hostStats = stats();
+    ASSERT_EQUALS(1, hostStats.inUse);
+    ASSERT_EQUALS(0, hostStats.available);
+    ASSERT_EQUALS(1, hostStats.created);
+}
+
+TEST_F(AsyncConnectionPoolTest, ReturnedConnectionIsReused) {
+    makePool(AsyncConnectionPoolOptions());
+
+    auto first = get();
+    establish(1);
+    pool().returnConnection(testHost, std::move(first->conn), start, Milliseconds(3));
+
+    auto second = get();
+    ASSERT_EQUALS(1U, numSpawned());
+    ASSERT_OK(second->status);
+    ASSERT_EQUALS(1, second->conn->id);
+    ASSERT_EQUALS(3.0, stats().latencyMillis);
+}
+
+TEST_F(AsyncConnectionPoolTest, SelectsConnectionWithLowestLatencyScore) {
+    AsyncConnectionPoolOptions options;
+    options.minConnections = 3;
+    makePool(options);
+
+    auto slow = get();
+    auto fast = get();
+    auto untried = get();
+    ASSERT_EQUALS(3U, numSpawned());
+    establish(1);
+    establish(2);
+    establish(3);
+
+    pool().returnConnection(testHost, std::move(slow->conn), start, Milliseconds(50));
+    pool().returnConnection(testHost, std::move(fast->conn), start, Milliseconds(5));
+    pool().returnConnection(testHost, std::move(untried->conn), start);
+
+    // The untried connection is ranked by the host's average, which lies between the two.
+    auto best = get();
+    ASSERT_EQUALS(2, best->conn->id);
+    auto next = get();
+    ASSERT_EQUALS(3, next->conn->id);
+    auto last = get();
+    ASSERT_EQUALS(1, last->conn->id);
+    ASSERT_EQUALS(3U, numSpawned());
+}
+
+TEST_F(AsyncConnectionPoolTest, HandshakeLatencySeedsScore) {
+    AsyncConnectionPoolOptions options;
+    options.minConnections = 2;
+    makePool(options);
+
+    auto first = get();
+    auto second = get();
+    ASSERT_EQUALS(2U, numSpawned());
+    establish(1, Milliseconds(40));
+    establish(2, Milliseconds(4));
+    ASSERT_EQUALS(31.0, stats().latencyMillis);
+
+    // Returning without a sample keeps the score measured during the handshake.
+    pool().returnConnection(testHost, std::move(first->conn), start);
+    pool().returnConnection(testHost, std::move(second->conn), start);
+    auto best = get();
+    ASSERT_EQUALS(2, best->conn->id);
+}
+
+TEST_F(AsyncConnectionPoolTest, DefaultOptionsBoundConnectionsPerHost) {
+    const AsyncConnectionPoolOptions options;
+    makePool(options);
+
+    std::vector<std::shared_ptr<GetResult>> results;
+    for (size_t i = 0; i <= options.maxConnections; ++i) {
+        results.push_back(get());
+    }
+    ASSERT_EQUALS(options.maxConnections, numSpawned());
+    ASSERT_EQUALS(static_cast<long long>(options.maxConnections), stats().connecting);
+}
+
+TEST_F(AsyncConnectionPoolTest, RequestsQueueAtMaxConnections) {
+    AsyncConnectionPoolOptions options;
+    options.maxConnections = 1;
+    makePool(options);
+
+    auto first = get();
+    auto second = get();
+    ASSERT_EQUALS(1U, numSpawned());
+
+    establish(1);
+    ASSERT_OK(first->status);
+    ASSERT_EQUALS(1, stats().queued);
+
+    pool().returnConnection(testHost, std::move(first->conn), start, Milliseconds(1));
+    ASSERT_OK(second->status);
+    ASSERT_EQUALS(1, second->conn->id);
+    ASSERT_EQUALS(0, stats().queued);
+}
+
+TEST_F(AsyncConnectionPoolTest, QueuedRequestTimesOut) {
+    AsyncConnectionPoolOptions options;
+    options.maxConnections = 1;
+    makePool(options);
+
+    auto first = get();
+    establish(1);
+    auto second = get(start + Milliseconds(10));
+
+    pool().runHousekeeping(start + Milliseconds(5));
+    ASSERT_EQUALS(ErrorCodes::InternalError, second->status);
+
+    pool().runHousekeeping(start + Milliseconds(10));
+    ASSERT_EQUALS(ErrorCodes::ExceededTimeLimit, second->status);
+    ASSERT_EQUALS(1, stats().requestsTimedOut);
+    ASSERT_EQUALS(0, stats().queued);
+}
+
+TEST_F(AsyncConnectionPoolTest, CanceledRequestLeavesQueue) {
+    AsyncConnectionPoolOptions options;
+    options.maxConnections = 1;
+    makePool(options);
+
+    auto first = get();
+    establish(1);
+    auto second = get();
+    auto third = get();
+    ASSERT_EQUALS(2, stats().queued);
+
+    // Requests are numbered in the order they were made.
+    pool().cancelRequest(testHost, 2, Status(ErrorCodes::CallbackCanceled, "canceled"));
+    ASSERT_EQUALS(ErrorCodes::CallbackCanceled, second->status);
+    ASSERT_EQUALS(1, stats().queued);
+
+    // The returned connection goes to the request still waiting.
+    pool().returnConnection(testHost, std::move(first->conn), start, Milliseconds(1));
+    ASSERT_EQUALS(1, third->conn->id);
+    ASSERT_EQUALS(0, stats().queued);
+
+    // Canceling a request which already has its connection does nothing.
+    pool().cancelRequest(testHost, 3, Status(ErrorCodes::CallbackCanceled, "canceled"));
+    ASSERT_TRUE(third->conn);
+}
+
+TEST_F(AsyncConnectionPoolTest, DroppedConnectionIsReplacedForQueuedRequest) {
+    AsyncConnectionPoolOptions options;
+    options.maxConnections = 1;
+    makePool(options);
+
+    auto first = get();
+    establish(1);
+    auto second = get();
+    ASSERT_EQUALS(1U, numSpawned());
+
+    pool().dropConnection(testHost, std::move(first->conn));
+    ASSERT_EQUALS(2U, numSpawned());
+
+    establish(2);
+    ASSERT_EQUALS(2, second->conn->id);
+}
+
+TEST_F(AsyncConnectionPoolTest, ConnectFailureFailsOldestRequestAndStopsWarmUp) {
+    AsyncConnectionPoolOptions options;
+    options.minConnections = 2;
+    makePool(options);
+
+    auto result = get();
+    ASSERT_EQUALS(2U, numSpawned());
+
+    Status failure(ErrorCodes::HostUnreachable, "connection refused");
+    pool().connectionFailed(testHost, failure, start);
+    ASSERT_EQUALS(failure, result->status);
+
+    pool().connectionFailed(testHost, failure, start);
+    pool().runHousekeeping(start + Milliseconds(1));
+    ASSERT_EQUALS(2U, numSpawned());
+    ASSERT_EQUALS(2, stats().connectFailures);
+
+    // A request for the host still attempts to connect.
+    auto retry = get();
+    ASSERT_EQUALS(3U, numSpawned());
+}
+
+TEST_F(AsyncConnectionPoolTest, WarmUpResumesOnceHostRecovers) {
+    AsyncConnectionPoolOptions options;
+    options.minConnections = 2;
+    makePool(options);
+
+    auto result = get();
+    ASSERT_EQUALS(2U, numSpawned());
+    pool().connectionFailed(
+        testHost, Status(ErrorCodes::HostUnreachable, "connection refused"), start);
+    ASSERT_EQUALS(ErrorCodes::HostUnreachable, result->status);
+
+    // The remaining connection attempt serves the next request.
+    auto retry = get();
+    pool().runHousekeeping(start + Milliseconds(1));
+    ASSERT_EQUALS(2U, numSpawned());
+
+    establish(1);
+    ASSERT_OK(retry->status);
+    pool().runHousekeeping(start + Milliseconds(2));
+    ASSERT_EQUALS(3U, numSpawned());
+    ASSERT_EQUALS(1, stats().connecting);
+}
+
+TEST_F(AsyncConnectionPoolTest, IdleConnectionsAreRefreshedAndClosed) {
+    AsyncConnectionPoolOptions options;
+    options.minConnections = 1;
+    options.refreshRequirement = Milliseconds(100);
+    options.idleTimeout = Milliseconds(1000);
+    makePool(options);
+
+    auto first = get();
+    auto second = get();
+    establish(1);
+    establish(2);
+    pool().returnConnection(testHost, std::move(first->conn), start, Milliseconds(1));
+    pool().returnConnection(
+        testHost, std::move(second->conn), start + Milliseconds(500), Milliseconds(1));
+
+    // Only the connection unused for longer than refreshRequirement is health checked.
+    pool().runHousekeeping(start + Milliseconds(100));
+    ASSERT_EQUALS(1U, refreshing().size());
+    ASSERT_EQUALS(1, refreshing().front()->id);
+    ASSERT_EQUALS(1, stats().refreshed);
+    pool().returnConnection(testHost,
+                            std::move(refreshing().front()),
+                            start + Milliseconds(100),
+                            Milliseconds(1));
+    refreshing().clear();
+
+    // Both are past the idle timeout, but the pool keeps minConnections open.
+    pool().runHousekeeping(start + Milliseconds(1500));
+    auto hostStats = stats();
+    ASSERT_EQUALS(1, hostStats.available + hostStats.inUse);
+}
+
+TEST_F(AsyncConnectionPoolTest, StatsAreReportedForEveryPool) {
+    makePool(AsyncConnectionPoolOptions());
+
+    MockPool otherPool(AsyncConnectionPoolOptions(),
+                       [](const HostAndPort& host) {},
+                       [](const HostAndPort& host, MockConnectionPtr conn) {});
+    otherPool.get(testHost, 1, Date_t::max(), start, [](StatusWith<MockConnectionPtr> swConn) {});
+    otherPool.connectionEstablished(testHost, stdx::make_unique<MockConnection>(2), start);
+
+    get();
+    establish(1);
+
+    BSONObjBuilder builder;
+    appendAsyncConnectionPoolStats(&builder);
+    BSONObj obj = builder.obj();
+
+    BSONObj hostStats = obj["hosts"].Obj()[testHost.toString()].Obj();
+    ASSERT_EQUALS(2, hostStats["created"].numberLong());
+    ASSERT_EQUALS(2, obj["totalCreated"].numberLong());
+}
+
+}  // namespace
+}  // namespace executor
+}  // namespace mongo
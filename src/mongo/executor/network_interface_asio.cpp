@@ -32,6 +32,7 @@
 
 #include "mongo/executor/network_interface_asio.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "mongo/executor/async_stream_interface.h"
@@ -53,11 +54,25 @@ NetworkInterfaceASIO::NetworkInterfaceASIO(
 NetworkInterfaceASIO::NetworkInterfaceASIO(
     std::unique_ptr<AsyncStreamFactoryInterface> streamFactory,
     std::unique_ptr<NetworkConnectionHook> networkConnectionHook)
+    : NetworkInterfaceASIO(std::move(streamFactory),
+                           std::move(networkConnectionHook),
+                           AsyncConnectionPoolOptions()) {}
+
+NetworkInterfaceASIO::NetworkInterfaceASIO(
+    std::unique_ptr<AsyncStreamFactoryInterface> streamFactory,
+    std::unique_ptr<NetworkConnectionHook> networkConnectionHook,
+    AsyncConnectionPoolOptions connectionPoolOptions)
     : _io_service(),
       _hook(std::move(networkConnectionHook)),
       _resolver(_io_service),
       _state(State::kReady),
       _streamFactory(std::move(streamFactory)),
+      _connectionPool(std::move(connectionPoolOptions),
+                      [this](const HostAndPort& target) { _spawnConnection(target); },
+                      [this](const HostAndPort& target, std::unique_ptr<AsyncConnection> conn) {
+                          _refreshConnection(target, std::move(conn));
+                      }),
+      _housekeepingTimer(_io_service),
       _isExecutorRunnable(false) {}
 
 std::string NetworkInterfaceASIO::getDiagnosticString() {
@@ -77,12 +92,15 @@ void NetworkInterfaceASIO::startup() {
         _io_service.run();
     });
     _state.store(State::kRunning);
+    asio::post(_io_service, [this]() { _scheduleHousekeeping(); });
 }
 
 void NetworkInterfaceASIO::shutdown() {
     _state.store(State::kShutdown);
     _io_service.stop();
     _serviceRunner.join();
+    // The io_service thread is gone, so the timer can be touched from here.
+    _housekeepingTimer.cancel();
 }
 
 void NetworkInterfaceASIO::waitForWork() {
@@ -139,13 +157,27 @@ void NetworkInterfaceASIO::startCommand(const TaskExecutor::CallbackHandle& cbHa
 }
 
 void NetworkInterfaceASIO::cancelCommand(const TaskExecutor::CallbackHandle& cbHandle) {
-    stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
-    for (auto iter = _inProgress.begin(); iter != _inProgress.end(); ++iter) {
-        if (iter->first->cbHandle() == cbHandle) {
-            iter->first->cancel();
-            break;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
+        auto iter = _findOp_inlock(cbHandle);
+        if (iter == _inProgress.end()) {
+            return;
         }
+        iter->first->cancel();
     }
+
+    // An operation still waiting for a connection would otherwise only notice the cancellation
+    // once it gets one, keeping its place in the queue until then.
+    asio::post(_io_service, [this, cbHandle]() { _cancelConnectionRequest(cbHandle); });
+}
+
+NetworkInterfaceASIO::InProgressMap::iterator NetworkInterfaceASIO::_findOp_inlock(
+    const TaskExecutor::CallbackHandle& cbHandle) {
+    return std::find_if(_inProgress.begin(),
+                        _inProgress.end(),
+                        [&cbHandle](const InProgressMap::value_type& entry) {
+                            return entry.first->cbHandle() == cbHandle;
+                        });
 }
 
 void NetworkInterfaceASIO::setAlarm(Date_t when, const stdx::function<void()>& action) {
@@ -38,6 +38,7 @@
 
 #include "mongo/base/status.h"
 #include "mongo/base/system_error.h"
+#include "mongo/executor/async_connection_pool.h"
 #include "mongo/executor/network_connection_hook.h"
 #include "mongo/executor/network_interface.h"
 #include "mongo/executor/remote_command_request.h"
@@ -59,9 +60,16 @@ class AsyncStreamInterface;
 /**
  * Implementation of the replication system's network interface using Christopher
  * Kohlhoff's ASIO library instead of existing MongoDB networking primitives.
+ *
+ * Commands run over connections checked out of an AsyncConnectionPool. Connections are
+ * established, authenticated and passed through the NetworkConnectionHook once, when the pool
+ * asks for them, and are returned to the pool after every successful command.
  */
 class NetworkInterfaceASIO final : public NetworkInterface {
 public:
+    NetworkInterfaceASIO(std::unique_ptr<AsyncStreamFactoryInterface> streamFactory,
+                         std::unique_ptr<NetworkConnectionHook> networkConnectionHook,
+                         AsyncConnectionPoolOptions connectionPoolOptions);
     NetworkInterfaceASIO(std::unique_ptr<AsyncStreamFactoryInterface> streamFactory,
                          std::unique_ptr<NetworkConnectionHook> networkConnectionHook);
     NetworkInterfaceASIO(std::unique_ptr<AsyncStreamFactoryInterface> streamFactory);
@@ -161,7 +169,14 @@ private:
 
         AsyncConnection& connection();
 
-        void setConnection(AsyncConnection&& conn);
+        /**
+         * Attaches the connection this operation runs over. 'checkedOut' is true when the
+         * connection came from the connection pool and must be handed back to it when the
+         * operation completes.
+         */
+        void setConnection(std::unique_ptr<AsyncConnection> conn, bool checkedOut);
+        std::unique_ptr<AsyncConnection> releaseConnection();
+        bool hasCheckedOutConnection() const;
 
         // AsyncOp may run multiple commands over its lifetime (for example, an ismaster
         // command, the command provided to the NetworkInterface via startCommand(), etc.)
@@ -178,6 +193,13 @@ private:
 
         Date_t start() const;
 
+        /**
+         * Round trip time of the isMaster run while establishing the connection, which seeds
+         * the connection's latency score in the pool.
+         */
+        void setHandshakeLatency(Milliseconds latency);
+        boost::optional<Milliseconds> handshakeLatency() const;
+
         rpc::Protocol operationProtocol() const;
 
         void setOperationProtocol(rpc::Protocol proto);
@@ -190,10 +212,11 @@ private:
         RemoteCommandCompletionFn _onFinish;
 
         /**
-         * The connection state used to service this request. We wrap it in an optional
-         * as it is instantiated at some point after the AsyncOp is created.
+         * The connection state used to service this request. It is attached at some point
+         * after the AsyncOp is created.
          */
-        boost::optional<AsyncConnection> _connection;
+        std::unique_ptr<AsyncConnection> _connection;
+        bool _connectionCheckedOut = false;
 
         /**
          * The RPC protocol used for this operation. We wrap it in an optional as it
@@ -203,6 +226,8 @@ private:
 
         const Date_t _start;
 
+        boost::optional<Milliseconds> _handshakeLatency;
+
         AtomicUInt64 _canceled;
 
         /**
@@ -213,7 +238,26 @@ private:
         boost::optional<AsyncCommand> _command;
     };
 
+    using ConnectionPool = AsyncConnectionPool<AsyncConnection>;
+
+    using InProgressMap = std::unordered_map<AsyncOp*, std::unique_ptr<AsyncOp>>;
+
+    InProgressMap::iterator _findOp_inlock(const TaskExecutor::CallbackHandle& cbHandle);
+
     void _startCommand(AsyncOp* op);
+    void _cancelConnectionRequest(const TaskExecutor::CallbackHandle& cbHandle);
+
+    // Names an operation's request in the connection pool. An operation queues at most one
+    // request, and only while it is in _inProgress.
+    static ConnectionPool::RequestId _connectionRequestId(const AsyncOp* op) {
+        return reinterpret_cast<uintptr_t>(op);
+    }
+
+    // Connection pool
+    void _spawnConnection(const HostAndPort& target);
+    void _refreshConnection(const HostAndPort& target, std::unique_ptr<AsyncConnection> conn);
+    void _runOverPooledConnection(AsyncOp* op, std::unique_ptr<AsyncConnection> conn);
+    void _scheduleHousekeeping();
 
     /**
      * Wraps a completion handler in pre-condition checks.
@@ -243,6 +287,7 @@ private:
     void _runIsMaster(AsyncOp* op);
     void _runConnectionHook(AsyncOp* op);
     void _authenticate(AsyncOp* op);
+    void _completeConnecting(AsyncOp* op);
 
     // Communication state machine
     void _beginCommunication(AsyncOp* op);
@@ -265,8 +310,12 @@ private:
 
     std::unique_ptr<AsyncStreamFactoryInterface> _streamFactory;
 
+    // Declared after _streamFactory so that pooled streams are destroyed before it.
+    ConnectionPool _connectionPool;
+    asio::steady_timer _housekeepingTimer;
+
     stdx::mutex _inProgressMutex;
-    std::unordered_map<AsyncOp*, std::unique_ptr<AsyncOp>> _inProgress;
+    InProgressMap _inProgress;
 
     stdx::mutex _executorMutex;
     bool _isExecutorRunnable;
@@ -69,6 +69,7 @@ void NetworkInterfaceASIO::_runIsMaster(AsyncOp* op) {
         }
 
         auto commandReply = std::move(swCommandReply.getValue());
+        op->setHandshakeLatency(commandReply.elapsedMillis);
 
         if (_hook) {
             // Run the validation hook.
@@ -123,6 +123,11 @@ void asyncRecvMessageBody(AsyncStreamInterface& stream,
     stream.read(asio::buffer(mdView.data(), bodyLength), std::forward<Handler>(handler));
 }
 
+bool isIsMaster(const RemoteCommandRequest& request) {
+    const StringData commandName = request.cmdObj.firstElementFieldName();
+    return commandName == "isMaster" || commandName == "ismaster";
+}
+
 }  // namespace
 
 NetworkInterfaceASIO::AsyncCommand::AsyncCommand(AsyncConnection* conn,
@@ -183,8 +188,35 @@ void NetworkInterfaceASIO::_startCommand(AsyncOp* op) {
         return;
     }
 
-    // _connect() will continue the state machine.
-    _connect(op);
+    const auto& request = op->request();
+    _connectionPool.get(request.target,
+                        _connectionRequestId(op),
+                        request.expirationDate,
+                        now(),
+                        [this, op](StatusWith<std::unique_ptr<AsyncConnection>> swConn) {
+                            if (!swConn.isOK()) {
+                                return _completeOperation(op, swConn.getStatus());
+                            }
+                            _runOverPooledConnection(op, std::move(swConn.getValue()));
+                        });
+}
+
+void NetworkInterfaceASIO::_cancelConnectionRequest(const TaskExecutor::CallbackHandle& cbHandle) {
+    AsyncOp* op;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
+        auto iter = _findOp_inlock(cbHandle);
+        if (iter == _inProgress.end()) {
+            return;
+        }
+        op = iter->first;
+    }
+
+    // Operations only complete on this thread, so 'op' stays valid. If its request is still
+    // queued, the pool fails it, which completes the operation.
+    _connectionPool.cancelRequest(op->request().target,
+                                  _connectionRequestId(op),
+                                  Status(ErrorCodes::CallbackCanceled, "Callback canceled"));
 }
 
 void NetworkInterfaceASIO::_beginCommunication(AsyncOp* op) {
@@ -216,6 +248,23 @@ void NetworkInterfaceASIO::_networkErrorCallback(AsyncOp* op, const std::error_c
 // NOTE: This method may only be called by ASIO threads
 // (do not call from methods entered by TaskExecutor threads)
 void NetworkInterfaceASIO::_completeOperation(AsyncOp* op, const ResponseStatus& resp) {
+    if (op->hasCheckedOutConnection()) {
+        // Only a connection that completed its last round trip is known to be in a clean
+        // state. After an error or a cancellation its stream may still hold part of a message.
+        const HostAndPort& target = op->request().target;
+        auto conn = op->releaseConnection();
+        if (resp.isOK() && isIsMaster(op->request())) {
+            // isMaster does no work on the remote host, so its round trip time measures the
+            // connection itself. The duration of other commands depends on what they execute.
+            _connectionPool.returnConnection(
+                target, std::move(conn), now(), resp.getValue().elapsedMillis);
+        } else if (resp.isOK()) {
+            _connectionPool.returnConnection(target, std::move(conn), now());
+        } else {
+            _connectionPool.dropConnection(target, std::move(conn));
+        }
+    }
+
     op->finish(resp);
 
     {
@@ -274,7 +323,7 @@ void NetworkInterfaceASIO::_asyncRunCommand(AsyncCommand* cmd, NetworkOpHandler
 
 void NetworkInterfaceASIO::_runConnectionHook(AsyncOp* op) {
     if (!_hook) {
-        return _beginCommunication(op);
+        return _completeConnecting(op);
     }
 
     auto swOptionalRequest = _hook->makeRequest(op->request().target);
@@ -286,7 +335,7 @@ void NetworkInterfaceASIO::_runConnectionHook(AsyncOp* op) {
     auto optionalRequest = std::move(swOptionalRequest.getValue());
 
     if (optionalRequest == boost::none) {
-        return _beginCommunication(op);
+        return _completeConnecting(op);
     }
 
     auto& cmd = op->beginCommand(*optionalRequest, op->operationProtocol(), now());
@@ -305,7 +354,7 @@ void NetworkInterfaceASIO::_runConnectionHook(AsyncOp* op) {
             return _completeOperation(op, handleStatus);
         }
 
-        return _beginCommunication(op);
+        return _completeConnecting(op);
     };
 
     return _asyncRunCommand(&cmd,
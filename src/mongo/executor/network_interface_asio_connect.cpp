@@ -35,9 +35,11 @@
 #include <utility>
 
 #include "mongo/config.h"
+#include "mongo/db/jsobj.h"
 #include "mongo/executor/async_stream.h"
 #include "mongo/executor/async_stream_factory.h"
 #include "mongo/executor/async_stream_interface.h"
+#include "mongo/rpc/protocol.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/sock.h"
@@ -46,6 +48,7 @@ namespace mongo {
 namespace executor {
 
 using asio::ip::tcp;
+using ResponseStatus = TaskExecutor::ResponseStatus;
 
 NetworkInterfaceASIO::AsyncConnection::AsyncConnection(std::unique_ptr<AsyncStreamInterface> stream,
                                                        rpc::ProtocolSet protocols)
@@ -97,7 +100,9 @@ void NetworkInterfaceASIO::_setupSocket(AsyncOp* op, tcp::resolver::iterator end
     // TODO: Consider moving this call to post-auth so we only assign completed connections.
     {
         auto stream = _streamFactory->makeStream(&_io_service, op->request().target);
-        op->setConnection({std::move(stream), rpc::supports::kOpQueryOnly});
+        op->setConnection(
+            stdx::make_unique<AsyncConnection>(std::move(stream), rpc::supports::kOpQueryOnly),
+            false);
     }
 
     auto& stream = op->connection().stream();
@@ -108,5 +113,99 @@ void NetworkInterfaceASIO::_setupSocket(AsyncOp* op, tcp::resolver::iterator end
                    });
 }
 
+void NetworkInterfaceASIO::_completeConnecting(AsyncOp* op) {
+    const HostAndPort target = op->request().target;
+    auto conn = op->releaseConnection();
+    const auto latency = op->handshakeLatency();
+    invariant(latency);
+
+    {
+        // NOTE: op will be deleted in the call to erase() below.
+        stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
+        _inProgress.erase(op);
+    }
+
+    _connectionPool.connectionEstablished(target, std::move(conn), now(), *latency);
+}
+
+void NetworkInterfaceASIO::_spawnConnection(const HostAndPort& target) {
+    // Connections are established by an internal operation that runs the handshake (isMaster,
+    // authentication and the connection hook) and then hands the connection to the pool. Its
+    // completion function only runs if the handshake fails.
+    auto onFailure = [this, target](const ResponseStatus& status) {
+        _connectionPool.connectionFailed(target, status.getStatus(), now());
+    };
+    auto ownedOp = stdx::make_unique<AsyncOp>(TaskExecutor::CallbackHandle(),
+                                              RemoteCommandRequest(target, "admin", BSONObj()),
+                                              onFailure,
+                                              now());
+    AsyncOp* op = ownedOp.get();
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
+        _inProgress.emplace(op, std::move(ownedOp));
+    }
+
+    asio::post(_io_service, [this, op]() { _connect(op); });
+}
+
+void NetworkInterfaceASIO::_refreshConnection(const HostAndPort& target,
+                                              std::unique_ptr<AsyncConnection> conn) {
+    // A successful isMaster returns the connection to the pool with a fresh latency sample, see
+    // _completeOperation(); any failure drops it.
+    auto ownedOp = stdx::make_unique<AsyncOp>(
+        TaskExecutor::CallbackHandle(),
+        RemoteCommandRequest(target, "admin", BSON("isMaster" << 1)),
+        [](const ResponseStatus& status) {
+            if (!status.isOK()) {
+                LOG(2) << "Dropping pooled connection that failed its health check: "
+                       << status.getStatus();
+            }
+        },
+        now());
+    AsyncOp* op = ownedOp.get();
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
+        _inProgress.emplace(op, std::move(ownedOp));
+    }
+
+    _runOverPooledConnection(op, std::move(conn));
+}
+
+void NetworkInterfaceASIO::_runOverPooledConnection(AsyncOp* op,
+                                                    std::unique_ptr<AsyncConnection> conn) {
+    if (op->canceled()) {
+        // Nothing was sent over the connection yet, so it can go back to the pool.
+        _connectionPool.returnConnection(op->request().target, std::move(conn), now());
+        return _completeOperation(op, Status(ErrorCodes::CallbackCanceled, "Callback canceled"));
+    }
+
+    op->setConnection(std::move(conn), true);
+
+    // The protocols were learned when the connection was established, so the negotiation
+    // gives the same result as it did during the handshake.
+    auto negotiatedProtocol =
+        rpc::negotiate(op->connection().serverProtocols(), op->connection().clientProtocols());
+    if (!negotiatedProtocol.isOK()) {
+        return _completeOperation(op, negotiatedProtocol.getStatus());
+    }
+    op->setOperationProtocol(negotiatedProtocol.getValue());
+
+    _validateAndRun(op, std::error_code(), [this, op]() { _beginCommunication(op); });
+}
+
+void NetworkInterfaceASIO::_scheduleHousekeeping() {
+    _housekeepingTimer.expires_after(_connectionPool.getOptions().housekeepingInterval);
+    _housekeepingTimer.async_wait([this](std::error_code ec) {
+        if (ec) {
+            // The timer is canceled by shutdown().
+            return;
+        }
+        _connectionPool.runHousekeeping(now());
+        _scheduleHousekeeping();
+    });
+}
+
 }  // namespace executor
 }  // namespace mongo
@@ -82,23 +82,38 @@ const TaskExecutor::CallbackHandle& NetworkInterfaceASIO::AsyncOp::cbHandle() co
 }
 
 NetworkInterfaceASIO::AsyncConnection& NetworkInterfaceASIO::AsyncOp::connection() {
-    invariant(_connection.is_initialized());
+    invariant(_connection);
     return *_connection;
 }
 
-void NetworkInterfaceASIO::AsyncOp::setConnection(AsyncConnection&& conn) {
-    invariant(!_connection.is_initialized());
+void NetworkInterfaceASIO::AsyncOp::setConnection(std::unique_ptr<AsyncConnection> conn,
+                                                  bool checkedOut) {
+    invariant(!_connection);
     _connection = std::move(conn);
+    _connectionCheckedOut = checkedOut;
+}
+
+std::unique_ptr<NetworkInterfaceASIO::AsyncConnection>
+NetworkInterfaceASIO::AsyncOp::releaseConnection() {
+    invariant(_connection);
+    // Any command still referring to the connection goes with it.
+    _command = boost::none;
+    _connectionCheckedOut = false;
+    return std::move(_connection);
+}
+
+bool NetworkInterfaceASIO::AsyncOp::hasCheckedOutConnection() const {
+    return _connectionCheckedOut;
 }
 
 NetworkInterfaceASIO::AsyncCommand& NetworkInterfaceASIO::AsyncOp::beginCommand(
     Message&& newCommand, Date_t now) {
     // NOTE: We operate based on the assumption that AsyncOp's
     // AsyncConnection does not change over its lifetime.
-    invariant(_connection.is_initialized());
+    invariant(_connection);
 
     // Construct a new AsyncCommand object for each command.
-    _command.emplace(_connection.get_ptr(), std::move(newCommand), now);
+    _command.emplace(_connection.get(), std::move(newCommand), now);
     return _command.get();
 }
 
@@ -125,6 +140,14 @@ Date_t NetworkInterfaceASIO::AsyncOp::start() const {
     return _start;
 }
 
+void NetworkInterfaceASIO::AsyncOp::setHandshakeLatency(Milliseconds latency) {
+    _handshakeLatency = latency;
+}
+
+boost::optional<Milliseconds> NetworkInterfaceASIO::AsyncOp::handshakeLatency() const {
+    return _handshakeLatency;
+}
+
 rpc::Protocol NetworkInterfaceASIO::AsyncOp::operationProtocol() const {
     invariant(_operationProtocol.is_initialized());
     return *_operationProtocol;
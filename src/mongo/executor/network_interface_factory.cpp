@@ -59,16 +59,49 @@ MONGO_INITIALIZER(outboundNetworkImpl)(InitializerContext*) {
     return Status::OK();
 }
 
+// Connection pool limits for the ASIO network interface, per remote host.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(connectionPoolMinSize, int, 1);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(connectionPoolMaxSize, int, 100);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(connectionPoolRefreshRequirementMS, int, 60 * 1000);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(connectionPoolIdleTimeoutMS, int, 5 * 60 * 1000);
+MONGO_INITIALIZER(connectionPoolOptions)(InitializerContext*) {
+    if (connectionPoolMinSize < 0 || connectionPoolMaxSize < 1 ||
+        connectionPoolMinSize > connectionPoolMaxSize) {
+        return Status(ErrorCodes::BadValue,
+                      "connectionPoolMinSize must be between 0 and connectionPoolMaxSize, "
+                      "which must be positive");
+    }
+    if (connectionPoolRefreshRequirementMS <= 0 || connectionPoolIdleTimeoutMS <= 0) {
+        return Status(ErrorCodes::BadValue, "connection pool timeouts must be positive");
+    }
+    return Status::OK();
+}
+
+namespace {
+
+AsyncConnectionPoolOptions makeConnectionPoolOptions() {
+    AsyncConnectionPoolOptions options;
+    options.minConnections = connectionPoolMinSize;
+    options.maxConnections = connectionPoolMaxSize;
+    options.refreshRequirement = Milliseconds(connectionPoolRefreshRequirementMS);
+    options.idleTimeout = Milliseconds(connectionPoolIdleTimeoutMS);
+    return options;
+}
+
+}  // namespace
+
 std::unique_ptr<NetworkInterface> makeNetworkInterface() {
     if (outboundNetworkImpl == kNetworkImplASIO) {
 #ifdef MONGO_CONFIG_SSL
         if (SSLManagerInterface* manager = getSSLManager()) {
             auto factory = stdx::make_unique<AsyncSecureStreamFactory>(manager);
-            return stdx::make_unique<NetworkInterfaceASIO>(std::move(factory));
+            return stdx::make_unique<NetworkInterfaceASIO>(
+                std::move(factory), nullptr, makeConnectionPoolOptions());
         }
 #endif
         auto factory = stdx::make_unique<AsyncStreamFactory>();
-        return stdx::make_unique<NetworkInterfaceASIO>(std::move(factory));
+        return stdx::make_unique<NetworkInterfaceASIO>(
+            std::move(factory), nullptr, makeConnectionPoolOptions());
 
     } else {
         return stdx::make_unique<NetworkInterfaceImpl>();
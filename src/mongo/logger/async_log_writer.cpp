@@ -0,0 +1,301 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/logger/async_log_writer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/logger/message_event_utf8_encoder.h"
+#include "mongo/logger/rotatable_file_writer.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/concurrency/threadlocal.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+TSP_DEFINE(std::ostringstream, asyncLogLineBuffer);
+
+namespace logger {
+
+namespace {
+
+// How long the writer thread sleeps when the ring is empty, in case it misses a wakeup.
+const auto kWriterIdleWait = std::chrono::milliseconds(100);
+
+// How long a logging thread waits for room under OverflowPolicy::kBlock before checking again.
+const auto kSpaceWait = std::chrono::milliseconds(10);
+
+// How long flush() waits for the writer thread before giving up.
+const auto kFlushTimeout = std::chrono::seconds(5);
+
+// All live AsyncLogWriters, for flushAll(). Leaked so that flushAll() is still safe to call while
+// static destructors run at exit.
+stdx::mutex& registryMutex() {
+    static stdx::mutex* mutex = new stdx::mutex();
+    return *mutex;
+}
+
+std::vector<AsyncLogWriter*>& registry() {
+    static std::vector<AsyncLogWriter*>* writers = new std::vector<AsyncLogWriter*>();
+    return *writers;
+}
+
+uint64_t roundUpToPowerOfTwo(size_t capacity) {
+    uint64_t rounded = 2;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+}  // namespace
+
+AsyncLogWriter::AsyncLogWriter(RotatableFileWriter* writer,
+                               OverflowPolicy overflowPolicy,
+                               size_t capacity)
+    : _writer(writer),
+      _overflowPolicy(overflowPolicy),
+      _mask(roundUpToPowerOfTwo(capacity) - 1),
+      _slots(new Slot[_mask + 1]) {
+    for (uint64_t i = 0; i <= _mask; ++i) {
+        _slots[i].sequence.store(i);
+    }
+    _writerThread = stdx::thread([this] { _run(); });
+
+    stdx::lock_guard<stdx::mutex> lk(registryMutex());
+    registry().push_back(this);
+}
+
+AsyncLogWriter::~AsyncLogWriter() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(registryMutex());
+        auto& writers = registry();
+        writers.erase(std::remove(writers.begin(), writers.end(), this), writers.end());
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_wakeMutex);
+        _shutdown.store(1);
+        _wakeCondition.notify_one();
+    }
+    _writerThread.join();
+}
+
+void AsyncLogWriter::write(std::string line) {
+    while (!_tryPush(line)) {
+        // The writer thread can't wait for itself to make room.
+        if (_overflowPolicy == OverflowPolicy::kDrop || _onWriterThread()) {
+            _droppedCount.fetchAndAdd(1);
+            return;
+        }
+        _waitForSpace();
+    }
+
+    if (_writerWaiting.load()) {
+        _wakeWriter();
+    }
+}
+
+void AsyncLogWriter::flush() {
+    if (_onWriterThread()) {
+        return;
+    }
+
+    stdx::unique_lock<stdx::timed_mutex> lk(_consumerMutex, kFlushTimeout);
+    if (!lk.owns_lock()) {
+        return;
+    }
+    _drain();
+}
+
+void AsyncLogWriter::flushAll() {
+    stdx::lock_guard<stdx::mutex> lk(registryMutex());
+    for (auto writer : registry()) {
+        writer->flush();
+    }
+}
+
+Status AsyncLogWriter::status() {
+    if (!_writeFailed.load()) {
+        return Status::OK();
+    }
+    stdx::lock_guard<stdx::mutex> lk(_statusMutex);
+    return _status;
+}
+
+std::ostringstream& AsyncLogWriter::threadLineBuffer() {
+    std::ostringstream& buffer = *asyncLogLineBuffer.getMake();
+    buffer.str(std::string());
+    buffer.clear();
+    return buffer;
+}
+
+bool AsyncLogWriter::_tryPush(std::string& line) {
+    uint64_t position = _pushPosition.load();
+    Slot* slot;
+    while (true) {
+        slot = &_slots[position & _mask];
+        const int64_t lag = static_cast<int64_t>(slot->sequence.load() - position);
+        if (lag < 0) {
+            // The slot still holds the line from one lap ago, so the ring is full.
+            return false;
+        }
+        if (lag > 0) {
+            // Another thread claimed this position first.
+            position = _pushPosition.load();
+            continue;
+        }
+        const uint64_t seen = _pushPosition.compareAndSwap(position, position + 1);
+        if (seen == position) {
+            break;
+        }
+        position = seen;
+    }
+
+    slot->line = std::move(line);
+    slot->sequence.store(position + 1);
+    return true;
+}
+
+bool AsyncLogWriter::_tryPop(std::string* line) {
+    const uint64_t position = _popPosition.load();
+    Slot& slot = _slots[position & _mask];
+    if (slot.sequence.load() != position + 1) {
+        return false;
+    }
+
+    *line = std::move(slot.line);
+    slot.line.clear();
+    slot.sequence.store(position + _mask + 1);
+    _popPosition.store(position + 1);
+    return true;
+}
+
+bool AsyncLogWriter::_hasQueuedLine() const {
+    const uint64_t position = _popPosition.load();
+    return _slots[position & _mask].sequence.load() == position + 1;
+}
+
+void AsyncLogWriter::_wakeWriter() {
+    stdx::lock_guard<stdx::mutex> lk(_wakeMutex);
+    _wakeCondition.notify_one();
+}
+
+void AsyncLogWriter::_waitForSpace() {
+    _producersWaiting.fetchAndAdd(1);
+    _wakeWriter();
+    {
+        stdx::unique_lock<stdx::mutex> lk(_spaceMutex);
+        _spaceCondition.wait_for(lk, kSpaceWait);
+    }
+    _producersWaiting.fetchAndSubtract(1);
+}
+
+void AsyncLogWriter::_run() {
+    setThreadName("logWriter");
+
+    while (true) {
+        {
+            stdx::lock_guard<stdx::timed_mutex> lk(_consumerMutex);
+            _drain();
+        }
+
+        if (_producersWaiting.load()) {
+            stdx::lock_guard<stdx::mutex> lk(_spaceMutex);
+            _spaceCondition.notify_all();
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(_wakeMutex);
+        if (_shutdown.load()) {
+            break;
+        }
+
+        // Logging threads check _writerWaiting after publishing a line, so either they see it set
+        // and wake us, or we see their line here.
+        _writerWaiting.store(1);
+        if (!_hasQueuedLine() && !_producersWaiting.load()) {
+            _wakeCondition.wait_for(lk, kWriterIdleWait);
+        }
+        _writerWaiting.store(0);
+    }
+
+    stdx::lock_guard<stdx::timed_mutex> lk(_consumerMutex);
+    _drain();
+}
+
+void AsyncLogWriter::_drain() {
+    std::string line;
+    const bool haveLine = _tryPop(&line);
+    const uint64_t droppedCount = _droppedCount.load();
+    if (!haveLine && droppedCount == _droppedCountReported) {
+        return;
+    }
+
+    RotatableFileWriter::Use useWriter(_writer);
+    Status status = useWriter.status();
+    if (status.isOK()) {
+        std::ostream& stream = useWriter.stream();
+        if (droppedCount != _droppedCountReported) {
+            const std::string message = str::stream() << "log buffer was full, discarded "
+                                                      << droppedCount - _droppedCountReported
+                                                      << " log lines";
+            MessageEventDetailsEncoder().encode(
+                MessageEventEphemeral(
+                    Date_t::now(), LogSeverity::Warning(), getThreadName(), message),
+                stream);
+            _droppedCountReported = droppedCount;
+        }
+
+        if (haveLine) {
+            do {
+                stream << line;
+            } while (_tryPop(&line));
+        }
+        stream.flush();
+        status = useWriter.status();
+    } else {
+        // Still empty the ring, so that logging threads aren't stuck behind a broken file.
+        while (_tryPop(&line)) {
+        }
+    }
+
+    const bool failed = !status.isOK();
+    if (failed || _writeFailed.load()) {
+        stdx::lock_guard<stdx::mutex> lk(_statusMutex);
+        _status = status;
+        _writeFailed.store(failed);
+    }
+}
+
+}  // namespace logger
+}  // namespace mongo
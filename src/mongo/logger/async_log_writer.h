@@ -0,0 +1,185 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+namespace logger {
+
+class RotatableFileWriter;
+
+/**
+ * Writes log lines to a RotatableFileWriter from a background thread, so that threads which log
+ * don't wait for the log file.
+ *
+ * Logging threads format their lines themselves and hand them to a bounded ring buffer without
+ * taking a lock. A single writer thread takes lines off the ring in order and writes them to the
+ * file. The OverflowPolicy decides what happens to a line when the ring is full.
+ *
+ * Lines still in the ring are lost if the process exits without calling flush(), so fatal error
+ * and shutdown paths call flushAll().
+ */
+class AsyncLogWriter {
+    MONGO_DISALLOW_COPYING(AsyncLogWriter);
+
+public:
+    enum class OverflowPolicy {
+        // Wait for the writer thread to make room. No lines are lost.
+        kBlock,
+
+        // Discard the line and count it. The writer thread logs how many lines it lost once
+        // there is room again.
+        kDrop,
+    };
+
+    static const size_t kDefaultCapacity = 8192;
+
+    /**
+     * Starts a writer thread which writes to "writer". Caller must keep "writer" in scope at
+     * least as long as the constructed AsyncLogWriter. "capacity" is the number of lines the ring
+     * holds, rounded up to a power of two.
+     */
+    AsyncLogWriter(RotatableFileWriter* writer,
+                   OverflowPolicy overflowPolicy,
+                   size_t capacity = kDefaultCapacity);
+
+    /**
+     * Writes any queued lines and stops the writer thread.
+     */
+    ~AsyncLogWriter();
+
+    /**
+     * Queues "line" to be written, following the OverflowPolicy if the ring is full. "line" must
+     * include its trailing newline.
+     */
+    void write(std::string line);
+
+    /**
+     * Writes every queued line before returning. If the writer thread is stuck on the file for
+     * longer than a few seconds, gives up so that callers on their way to exiting still exit.
+     */
+    void flush();
+
+    /**
+     * Flushes every AsyncLogWriter in the process. Called before exiting on fatal errors.
+     */
+    static void flushAll();
+
+    /**
+     * Returns the status of the most recent write to the file.
+     */
+    Status status();
+
+    /**
+     * Returns how many lines were discarded because the ring was full.
+     */
+    uint64_t getDroppedCount() const {
+        return _droppedCount.load();
+    }
+
+    /**
+     * Returns a cleared stream for the calling thread to format its next line into. The stream
+     * is reused by later calls on the same thread.
+     */
+    static std::ostringstream& threadLineBuffer();
+
+private:
+    struct Slot {
+        // Equals the position that may next be written to this slot, or that position plus one
+        // once a line has been written and can be read.
+        AtomicUInt64 sequence;
+        std::string line;
+    };
+
+    bool _tryPush(std::string& line);
+    bool _tryPop(std::string* line);
+    bool _hasQueuedLine() const;
+
+    void _wakeWriter();
+    void _waitForSpace();
+    void _run();
+
+    // Writes out the ring. Must hold _consumerMutex.
+    void _drain();
+
+    bool _onWriterThread() const {
+        return stdx::this_thread::get_id() == _writerThread.get_id();
+    }
+
+    RotatableFileWriter* const _writer;
+    const OverflowPolicy _overflowPolicy;
+
+    const uint64_t _mask;
+    std::unique_ptr<Slot[]> _slots;
+
+    // Next position logging threads will write to. They claim a position by advancing this.
+    AtomicUInt64 _pushPosition;
+
+    // Next position to read from. Only advanced while holding _consumerMutex, which the writer
+    // thread holds while it is draining the ring and flush() takes to drain it from another
+    // thread. The writer thread peeks at it without the lock before going to sleep.
+    AtomicUInt64 _popPosition;
+    stdx::timed_mutex _consumerMutex;
+
+    AtomicUInt64 _droppedCount;
+    uint64_t _droppedCountReported = 0;  // Guarded by _consumerMutex.
+
+    // The writer thread sleeps on _wakeCondition when the ring is empty. Logging threads only
+    // take _wakeMutex to wake it if _writerWaiting is set.
+    stdx::mutex _wakeMutex;
+    stdx::condition_variable _wakeCondition;
+    AtomicUInt32 _writerWaiting;
+    AtomicUInt32 _shutdown;
+
+    // Logging threads waiting for room under OverflowPolicy::kBlock.
+    stdx::mutex _spaceMutex;
+    stdx::condition_variable _spaceCondition;
+    AtomicUInt32 _producersWaiting;
+
+    AtomicUInt32 _writeFailed;
+    stdx::mutex _statusMutex;
+    Status _status = Status::OK();  // Guarded by _statusMutex.
+
+    stdx::thread _writerThread;
+};
+
+}  // namespace logger
+}  // namespace mongo
@@ -0,0 +1,173 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <fstream>
+#include <memory>
+
+#include "mongo/logger/async_log_writer.h"
+#include "mongo/logger/async_rotatable_file_appender.h"
+#include "mongo/logger/message_event.h"
+#include "mongo/logger/message_event_utf8_encoder.h"
+#include "mongo/logger/rotatable_file_writer.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+using namespace mongo;
+using namespace mongo::logger;
+
+const std::string logFileName("LogTest_AsyncLogWriter.txt");
+
+class AsyncLogWriterTest : public mongo::unittest::Test {
+public:
+    AsyncLogWriterTest() {
+        unlink(logFileName.c_str());
+        RotatableFileWriter::Use writerUse(&_fileWriter);
+        ASSERT_OK(writerUse.setFileName(logFileName, false));
+    }
+
+    virtual ~AsyncLogWriterTest() {
+        unlink(logFileName.c_str());
+    }
+
+protected:
+    std::vector<std::string> readLines() {
+        std::vector<std::string> lines;
+        std::ifstream ifs(logFileName.c_str());
+        ASSERT_TRUE(ifs.is_open());
+        std::string input;
+        while (std::getline(ifs, input)) {
+            lines.push_back(input);
+        }
+        return lines;
+    }
+
+    RotatableFileWriter _fileWriter;
+};
+
+TEST_F(AsyncLogWriterTest, AppenderWritesEventsInOrder) {
+    {
+        AsyncLogWriter writer(&_fileWriter, AsyncLogWriter::OverflowPolicy::kBlock);
+        AsyncRotatableFileAppender<MessageEventEphemeral> appender(
+            new MessageEventDetailsEncoder(), &writer);
+        for (int i = 0; i < 100; ++i) {
+            const std::string message = "message " + std::to_string(i);
+            ASSERT_OK(appender.append(MessageEventEphemeral(
+                Date_t::now(), LogSeverity::Log(), "conn1", message)));
+        }
+        // Destroying the writer writes whatever is still queued.
+    }
+
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQUALS(100U, lines.size());
+    for (int i = 0; i < 100; ++i) {
+        const std::string suffix = "[conn1] message " + std::to_string(i);
+        ASSERT_GREATER_THAN_OR_EQUALS(lines[i].size(), suffix.size());
+        ASSERT_EQUALS(suffix, lines[i].substr(lines[i].size() - suffix.size()));
+    }
+}
+
+TEST_F(AsyncLogWriterTest, FlushWritesQueuedLines) {
+    AsyncLogWriter writer(&_fileWriter, AsyncLogWriter::OverflowPolicy::kBlock);
+    writer.write("first\n");
+    writer.write("second\n");
+    AsyncLogWriter::flushAll();
+
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQUALS(2U, lines.size());
+    ASSERT_EQUALS("first", lines[0]);
+    ASSERT_EQUALS("second", lines[1]);
+    ASSERT_OK(writer.status());
+}
+
+TEST_F(AsyncLogWriterTest, DropPolicyCountsDiscardedLines) {
+    AsyncLogWriter writer(&_fileWriter, AsyncLogWriter::OverflowPolicy::kDrop, 4);
+    {
+        // Stall the writer thread on the file so that the ring fills up.
+        RotatableFileWriter::Use stall(&_fileWriter);
+        for (int i = 0; i < 100; ++i) {
+            writer.write("line " + std::to_string(i) + "\n");
+        }
+    }
+    writer.flush();
+
+    // The writer thread can hold at most one line outside the ring.
+    const uint64_t dropped = writer.getDroppedCount();
+    ASSERT_GREATER_THAN_OR_EQUALS(dropped, 95U);
+
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQUALS(100U - dropped + 1, lines.size());
+    int previous = -1;
+    size_t written = 0;
+    for (const auto& line : lines) {
+        if (line.compare(0, 5, "line ") == 0) {
+            const int number = std::stoi(line.substr(5));
+            ASSERT_GREATER_THAN(number, previous);
+            previous = number;
+            ++written;
+        } else {
+            ASSERT_NOT_EQUALS(std::string::npos,
+                              line.find("discarded " + std::to_string(dropped) + " log lines"));
+        }
+    }
+    ASSERT_EQUALS(100U - dropped, written);
+}
+
+TEST_F(AsyncLogWriterTest, BlockPolicyWaitsForRoom) {
+    AsyncLogWriter writer(&_fileWriter, AsyncLogWriter::OverflowPolicy::kBlock, 4);
+    AtomicUInt32 linesQueued;
+    std::unique_ptr<RotatableFileWriter::Use> stall(new RotatableFileWriter::Use(&_fileWriter));
+
+    stdx::thread producer([&] {
+        for (int i = 0; i < 100; ++i) {
+            writer.write("line " + std::to_string(i) + "\n");
+            linesQueued.fetchAndAdd(1);
+        }
+    });
+
+    sleepmillis(50);
+    ASSERT_LESS_THAN_OR_EQUALS(linesQueued.load(), 5U);
+
+    stall.reset();
+    producer.join();
+    writer.flush();
+
+    ASSERT_EQUALS(0U, writer.getDroppedCount());
+    std::vector<std::string> lines = readLines();
+    ASSERT_EQUALS(100U, lines.size());
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQUALS("line " + std::to_string(i), lines[i]);
+    }
+}
+
+}  // namespace
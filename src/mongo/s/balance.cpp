@@ -40,6 +40,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/s/balancer_policy.h"
@@ -57,6 +58,7 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/client/shard_registry.h"
+#include "mongo/s/shard_util.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -74,9 +76,108 @@ using std::vector;
 
 MONGO_FP_DECLARE(skipBalanceRound);
 
+// Use BalancerPolicy::balanceByCost instead of balancing by chunk counts
+MONGO_EXPORT_SERVER_PARAMETER(balancerUseCostModel, bool, false);
+
+// Upper bound on the number of migrations the cost model schedules per collection and round
+MONGO_EXPORT_SERVER_PARAMETER(balancerMaxMigrationsPerCollection, int, 4);
+
+// How long a chunk's data size estimate is reused before it is fetched from the shard again
+MONGO_EXPORT_SERVER_PARAMETER(balancerChunkSizeRefreshSecs, int, 10 * 60);
+
+// Upper bound on the number of dataSize commands the cost model sends per collection and round
+MONGO_EXPORT_SERVER_PARAMETER(balancerMaxChunkSizeFetchesPerCollection, int, 32);
+
+/**
+ * Gathers per chunk data sizes from the shards for the cost based balancer policy. Sizes come
+ * from the dataSize command and are cached per chunk for a while, since they are comparatively
+ * expensive to compute. Each round only fetches a bounded number of missing or expired sizes, so
+ * a collection with many chunks is measured over several rounds. Until then, expired sizes keep
+ * being used and chunks without any size are left to the policy, which assumes they have the
+ * average size.
+ */
+class ChunkStatsCollector {
+    MONGO_DISALLOW_COPYING(ChunkStatsCollector);
+
+public:
+    ChunkStatsCollector() = default;
+
+    void collect(const std::string& ns,
+                 const BSONObj& keyPattern,
+                 const ShardToChunksMap& shardToChunks,
+                 ChunkStatsMap* chunkStats);
+
+private:
+    struct CachedSize {
+        BSONObj max;
+        long long bytes;
+        Date_t fetched;
+    };
+
+    // Cached chunk sizes per namespace, keyed by chunk min
+    std::map<std::string, std::map<BSONObj, CachedSize>> _sizes;
+};
+
+void ChunkStatsCollector::collect(const string& ns,
+                                  const BSONObj& keyPattern,
+                                  const ShardToChunksMap& shardToChunks,
+                                  ChunkStatsMap* chunkStats) {
+    const Date_t now = Date_t::now();
+    const Seconds sizeRefreshInterval(balancerChunkSizeRefreshSecs);
+    int fetchesLeft = balancerMaxChunkSizeFetchesPerCollection;
+
+    const std::map<BSONObj, CachedSize>& oldSizes = _sizes[ns];
+    std::map<BSONObj, CachedSize> newSizes;
+
+    for (const auto& shardEntry : shardToChunks) {
+        const ShardId& shardId = shardEntry.first;
+
+        for (const ChunkType& chunk : shardEntry.second) {
+            auto cachedIt = oldSizes.find(chunk.getMin());
+            const bool cached =
+                (cachedIt != oldSizes.end() && cachedIt->second.max == chunk.getMax());
+
+            if (!cached || now - cachedIt->second.fetched >= sizeRefreshInterval) {
+                if (fetchesLeft > 0) {
+                    fetchesLeft--;
+
+                    auto sizeStatus = shardutil::retrieveChunkDataSize(shardId,
+                                                                       grid.shardRegistry(),
+                                                                       ns,
+                                                                       keyPattern,
+                                                                       chunk.getMin(),
+                                                                       chunk.getMax());
+                    if (sizeStatus.isOK()) {
+                        newSizes[chunk.getMin()] =
+                            CachedSize{chunk.getMax(), sizeStatus.getValue(), now};
+                        continue;
+                    }
+
+                    LOG(1) << "could not get data size of chunk " << chunk << " on " << shardId
+                           << causedBy(sizeStatus.getStatus());
+                }
+            }
+
+            if (cached) {
+                newSizes.insert(*cachedIt);
+            }
+        }
+    }
+
+    for (const auto& size : newSizes) {
+        (*chunkStats)[size.first] = ChunkStats(size.second.bytes);
+    }
+
+    // Only keep sizes of chunks which still exist
+    _sizes[ns].swap(newSizes);
+}
+
 Balancer balancer;
 
-Balancer::Balancer() : _balancedLastTime(0), _policy(new BalancerPolicy()) {}
+Balancer::Balancer()
+    : _balancedLastTime(0),
+      _policy(new BalancerPolicy()),
+      _chunkStatsCollector(new ChunkStatsCollector()) {}
 
 Balancer::~Balancer() = default;
 
@@ -430,6 +531,21 @@ void Balancer::_doBalanceRound(OperationContext* txn,
             continue;
         }
 
+        if (balancerUseCostModel) {
+            ChunkStatsMap chunkStats;
+            _chunkStatsCollector->collect(
+                nss.ns(), cm->getShardKeyPattern().toBSON(), shardToChunksMap, &chunkStats);
+
+            vector<shared_ptr<MigrateInfo>> migrations = BalancerPolicy::balanceByCost(
+                nss.ns(),
+                status,
+                chunkStats,
+                std::max(1, static_cast<int>(balancerMaxMigrationsPerCollection)));
+
+            candidateChunks->insert(candidateChunks->end(), migrations.begin(), migrations.end());
+            continue;
+        }
+
         shared_ptr<MigrateInfo> migrateInfo(_policy->balance(nss.ns(), status, _balancedLastTime));
         if (migrateInfo) {
             candidateChunks->push_back(migrateInfo);
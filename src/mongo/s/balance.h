@@ -36,6 +36,7 @@
 namespace mongo {
 
 class BalancerPolicy;
+class ChunkStatsCollector;
 struct MigrateInfo;
 class OperationContext;
 struct WriteConcernOptions;
@@ -49,6 +50,10 @@ struct WriteConcernOptions;
  * The balancer does act continuously but in "rounds". At a given round, it would decide if
  * there is an imbalance by checking the difference in chunks between the most and least
  * loaded shards. It would issue a request for a chunk migration per round, if it found so.
+ *
+ * If the balancerUseCostModel server parameter is set, the imbalance is instead measured by the
+ * data size of the chunks on each shard, and a round may contain several migrations per
+ * collection between disjoint pairs of shards.
  */
 class Balancer : public BackgroundJob {
 public:
@@ -76,6 +81,9 @@ private:
     // decide which chunks to move; owned here.
     std::unique_ptr<BalancerPolicy> _policy;
 
+    // gathers chunk sizes for the cost based policy; owned here.
+    std::unique_ptr<ChunkStatsCollector> _chunkStatsCollector;
+
     /**
      * Checks that the balancer can connect to all servers it needs to do its job.
      *
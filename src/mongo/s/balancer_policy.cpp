@@ -53,11 +53,17 @@ namespace mongo {
 using std::map;
 using std::numeric_limits;
 using std::set;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
 namespace {
 
+// A cost based move is only worth making if, after the move, the recipient's load is still at
+// least this much (as a fraction of a fair share) below the donor's load before the move. This
+// keeps chunks from bouncing between shards over small fluctuations in load.
+const double kMinLoadGap = 0.1;
+
 /**
  * Executes the serverStatus command against the specified shard and obtains the version of the
  * running MongoD service.
@@ -85,6 +91,168 @@ std::string retrieveShardMongoDVersion(ShardId shardId, ShardRegistry* shardRegi
     return versionElement.str();
 }
 
+/**
+ * Returns a migration which is required regardless of how balanced the collection is, because a
+ * chunk lives on a draining shard or on a shard without the chunk's tag, or NULL if there is no
+ * such chunk. Caller owns the returned MigrateInfo.
+ */
+MigrateInfo* getMandatoryMigration(const string& ns, const DistributionStatus& distribution) {
+    // 1) check things we have to move
+    {
+        for (const ShardId& shardId : distribution.shardIds()) {
+            const ShardInfo& info = distribution.shardInfo(shardId);
+
+            if (!info.isDraining())
+                continue;
+
+            if (distribution.numberOfChunksInShard(shardId) == 0)
+                continue;
+
+            // now we know we need to move to chunks off this shard
+            // we will if we are allowed
+            const vector<ChunkType>& chunks = distribution.getChunks(shardId);
+            unsigned numJumboChunks = 0;
+
+            // since we have to move all chunks, lets just do in order
+            for (unsigned i = 0; i < chunks.size(); i++) {
+                const ChunkType& chunkToMove = chunks[i];
+                if (chunkToMove.getJumbo()) {
+                    numJumboChunks++;
+                    continue;
+                }
+
+                string tag = distribution.getTagForChunk(chunkToMove);
+                const ShardId to = distribution.getBestReceieverShard(tag);
+
+                if (to.size() == 0) {
+                    warning() << "want to move chunk: " << chunkToMove << "(" << tag << ") "
+                              << "from " << shardId << " but can't find anywhere to put it";
+                    continue;
+                }
+
+                log() << "going to move " << chunkToMove << " from " << shardId << "(" << tag << ")"
+                      << " to " << to;
+
+                return new MigrateInfo(ns, to, shardId, chunkToMove.toBSON());
+            }
+
+            warning() << "can't find any chunk to move from: " << shardId << " but we want to. "
+                      << " numJumboChunks: " << numJumboChunks;
+        }
+    }
+
+    // 2) tag violations
+    if (distribution.tags().size() > 0) {
+        for (const ShardId& shardId : distribution.shardIds()) {
+            const ShardInfo& info = distribution.shardInfo(shardId);
+
+            const vector<ChunkType>& chunks = distribution.getChunks(shardId);
+            for (unsigned j = 0; j < chunks.size(); j++) {
+                const ChunkType& chunk = chunks[j];
+                string tag = distribution.getTagForChunk(chunk);
+
+                if (info.hasTag(tag))
+                    continue;
+
+                // uh oh, this chunk is in the wrong place
+                log() << "chunk " << chunk << " is not on a shard with the right tag: " << tag;
+
+                if (chunk.getJumbo()) {
+                    warning() << "chunk " << chunk << " is jumbo, so cannot be moved";
+                    continue;
+                }
+
+                const ShardId to = distribution.getBestReceieverShard(tag);
+                if (to.size() == 0) {
+                    log() << "no where to put it :(";
+                    continue;
+                }
+                verify(to != shardId);
+                log() << " going to move to: " << to;
+                return new MigrateInfo(ns, to, shardId, chunk.toBSON());
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Converts chunk statistics into normalized costs, such that the total cost of all the chunks
+ * of a collection is the number of shards. A shard holding exactly its fair share of bytes thus
+ * has a load of 1.
+ */
+class ChunkCostModel {
+public:
+    ChunkCostModel(const DistributionStatus& distribution, const ChunkStatsMap& chunkStats)
+        : _chunkStats(chunkStats) {
+        size_t numChunks = 0;
+        size_t numKnownChunks = 0;
+        double knownBytes = 0;
+
+        for (const ShardId& shardId : distribution.shardIds()) {
+            if (distribution.numberOfChunksInShard(shardId) == 0) {
+                continue;
+            }
+
+            for (const ChunkType& chunk : distribution.getChunks(shardId)) {
+                numChunks++;
+
+                ChunkStatsMap::const_iterator it = _chunkStats.find(chunk.getMin());
+                if (it != _chunkStats.end()) {
+                    numKnownChunks++;
+                    knownBytes += it->second.dataSizeBytes;
+                }
+            }
+        }
+
+        // Without any statistics every chunk weighs the same, which degenerates into balancing
+        // by chunk count
+        if (numKnownChunks > 0) {
+            _defaultStats = ChunkStats(knownBytes / numKnownChunks);
+        } else {
+            _defaultStats = ChunkStats(1);
+        }
+
+        const double numUnknownChunks = numChunks - numKnownChunks;
+        const double totalBytes = knownBytes + numUnknownChunks * _defaultStats.dataSizeBytes;
+        const double numShards = std::max<size_t>(distribution.shardIds().size(), 1);
+
+        _bytesPerShard = totalBytes / numShards;
+    }
+
+    double cost(const ChunkType& chunk) const {
+        ChunkStatsMap::const_iterator it = _chunkStats.find(chunk.getMin());
+        const ChunkStats& stats = (it != _chunkStats.end()) ? it->second : _defaultStats;
+
+        if (_bytesPerShard <= 0) {
+            return 0;
+        }
+        return stats.dataSizeBytes / _bytesPerShard;
+    }
+
+    std::map<ShardId, double> shardLoads(const DistributionStatus& distribution) const {
+        std::map<ShardId, double> loads;
+        for (const ShardId& shardId : distribution.shardIds()) {
+            double& load = loads[shardId];
+            if (distribution.numberOfChunksInShard(shardId) == 0) {
+                continue;
+            }
+
+            for (const ChunkType& chunk : distribution.getChunks(shardId)) {
+                load += cost(chunk);
+            }
+        }
+        return loads;
+    }
+
+private:
+    const ChunkStatsMap& _chunkStats;
+
+    ChunkStats _defaultStats;
+    double _bytesPerShard;
+};
+
 }  // namespace
 
 string TagRange::toString() const {
@@ -344,81 +512,9 @@ MigrateInfo* BalancerPolicy::balance(const string& ns,
 
     // ----
 
-    // 1) check things we have to move
-    {
-        for (const ShardId& shardId : distribution.shardIds()) {
-            const ShardInfo& info = distribution.shardInfo(shardId);
-
-            if (!info.isDraining())
-                continue;
-
-            if (distribution.numberOfChunksInShard(shardId) == 0)
-                continue;
-
-            // now we know we need to move to chunks off this shard
-            // we will if we are allowed
-            const vector<ChunkType>& chunks = distribution.getChunks(shardId);
-            unsigned numJumboChunks = 0;
-
-            // since we have to move all chunks, lets just do in order
-            for (unsigned i = 0; i < chunks.size(); i++) {
-                const ChunkType& chunkToMove = chunks[i];
-                if (chunkToMove.getJumbo()) {
-                    numJumboChunks++;
-                    continue;
-                }
-
-                string tag = distribution.getTagForChunk(chunkToMove);
-                const ShardId to = distribution.getBestReceieverShard(tag);
-
-                if (to.size() == 0) {
-                    warning() << "want to move chunk: " << chunkToMove << "(" << tag << ") "
-                              << "from " << shardId << " but can't find anywhere to put it";
-                    continue;
-                }
-
-                log() << "going to move " << chunkToMove << " from " << shardId << "(" << tag << ")"
-                      << " to " << to;
-
-                return new MigrateInfo(ns, to, shardId, chunkToMove.toBSON());
-            }
-
-            warning() << "can't find any chunk to move from: " << shardId << " but we want to. "
-                      << " numJumboChunks: " << numJumboChunks;
-        }
-    }
-
-    // 2) tag violations
-    if (distribution.tags().size() > 0) {
-        for (const ShardId& shardId : distribution.shardIds()) {
-            const ShardInfo& info = distribution.shardInfo(shardId);
-
-            const vector<ChunkType>& chunks = distribution.getChunks(shardId);
-            for (unsigned j = 0; j < chunks.size(); j++) {
-                const ChunkType& chunk = chunks[j];
-                string tag = distribution.getTagForChunk(chunk);
-
-                if (info.hasTag(tag))
-                    continue;
-
-                // uh oh, this chunk is in the wrong place
-                log() << "chunk " << chunk << " is not on a shard with the right tag: " << tag;
-
-                if (chunk.getJumbo()) {
-                    warning() << "chunk " << chunk << " is jumbo, so cannot be moved";
-                    continue;
-                }
-
-                const ShardId to = distribution.getBestReceieverShard(tag);
-                if (to.size() == 0) {
-                    log() << "no where to put it :(";
-                    continue;
-                }
-                verify(to != shardId);
-                log() << " going to move to: " << to;
-                return new MigrateInfo(ns, to, shardId, chunk.toBSON());
-            }
-        }
+    MigrateInfo* mandatoryMigration = getMandatoryMigration(ns, distribution);
+    if (mandatoryMigration) {
+        return mandatoryMigration;
     }
 
     // 3) for each tag balance
@@ -502,6 +598,128 @@ MigrateInfo* BalancerPolicy::balance(const string& ns,
 }
 
 
+vector<shared_ptr<MigrateInfo>> BalancerPolicy::balanceByCost(
+    const string& ns,
+    const DistributionStatus& distribution,
+    const ChunkStatsMap& chunkStats,
+    size_t maxMigrations) {
+    vector<shared_ptr<MigrateInfo>> migrations;
+    if (maxMigrations == 0) {
+        return migrations;
+    }
+
+    // Draining shards and tag violations take precedence, exactly as for count based balancing
+    shared_ptr<MigrateInfo> mandatoryMigration(getMandatoryMigration(ns, distribution));
+    if (mandatoryMigration) {
+        migrations.push_back(mandatoryMigration);
+        return migrations;
+    }
+
+    const ChunkCostModel model(distribution, chunkStats);
+    map<ShardId, double> loads = model.shardLoads(distribution);
+
+    // A shard can only take part in one migration at a time, so every shard which already
+    // donates or receives a chunk in this round is excluded from further moves
+    set<ShardId> busyShards;
+
+    while (migrations.size() < maxMigrations) {
+        // Least loaded shard which may receive a chunk with the given tag, computed lazily
+        map<string, ShardId> receiverForTag;
+
+        const ChunkType* bestChunk = NULL;
+        ShardId bestFrom;
+        ShardId bestTo;
+        double bestImprovement = 0;
+
+        for (const ShardId& from : distribution.shardIds()) {
+            if (busyShards.count(from) || distribution.numberOfChunksInShard(from) == 0) {
+                continue;
+            }
+
+            for (const ChunkType& chunk : distribution.getChunks(from)) {
+                if (chunk.getJumbo()) {
+                    continue;
+                }
+
+                const string tag = distribution.getTagForChunk(chunk);
+
+                map<string, ShardId>::const_iterator receiverIt = receiverForTag.find(tag);
+                if (receiverIt == receiverForTag.end()) {
+                    ShardId receiver;
+                    double receiverLoad = numeric_limits<double>::max();
+
+                    for (const ShardId& to : distribution.shardIds()) {
+                        const ShardInfo& info = distribution.shardInfo(to);
+                        if (busyShards.count(to) || info.isDraining() || info.isSizeMaxed() ||
+                            !info.hasTag(tag)) {
+                            continue;
+                        }
+
+                        if (loads[to] < receiverLoad) {
+                            receiver = to;
+                            receiverLoad = loads[to];
+                        }
+                    }
+
+                    receiverIt = receiverForTag.insert(make_pair(tag, receiver)).first;
+                }
+
+                const ShardId& to = receiverIt->second;
+                if (to.empty() || to == from) {
+                    continue;
+                }
+
+                // Moving a chunk of cost c from a shard with load d to one with load r changes
+                // the sum of squared loads by 2c(r - d + c), so the reduction is 2c * gap
+                const double chunkCost = model.cost(chunk);
+                const double gap = loads[from] - loads[to] - chunkCost;
+                if (gap <= kMinLoadGap) {
+                    continue;
+                }
+
+                const double improvement = chunkCost * gap;
+                if (improvement > bestImprovement) {
+                    bestChunk = &chunk;
+                    bestFrom = from;
+                    bestTo = to;
+                    bestImprovement = improvement;
+                }
+            }
+        }
+
+        if (!bestChunk) {
+            break;
+        }
+
+        const double chunkCost = model.cost(*bestChunk);
+
+        LOG(1) << "collection : " << ns;
+        LOG(1) << "donor      : " << bestFrom << " load " << loads[bestFrom];
+        LOG(1) << "receiver   : " << bestTo << " load " << loads[bestTo];
+        LOG(1) << "chunk cost : " << chunkCost;
+
+        log() << " ns: " << ns << " going to move " << *bestChunk << " from: " << bestFrom
+              << " to: " << bestTo << " to reduce load imbalance";
+
+        loads[bestFrom] -= chunkCost;
+        loads[bestTo] += chunkCost;
+
+        busyShards.insert(bestFrom);
+        busyShards.insert(bestTo);
+
+        migrations.push_back(
+            std::make_shared<MigrateInfo>(ns, bestTo, bestFrom, bestChunk->toBSON()));
+    }
+
+    return migrations;
+}
+
+map<ShardId, double> BalancerPolicy::computeShardLoads(const DistributionStatus& distribution,
+                                                       const ChunkStatsMap& chunkStats) {
+    return ChunkCostModel(distribution, chunkStats).shardLoads(distribution);
+}
+
+
 ShardInfo::ShardInfo(long long maxSizeMB,
                      long long currSizeMB,
                      bool draining,
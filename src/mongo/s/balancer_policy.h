@@ -134,6 +134,20 @@ struct MigrateInfo {
 typedef std::map<ShardId, ShardInfo> ShardInfoMap;
 typedef std::map<ShardId, std::vector<ChunkType>> ShardToChunksMap;
 
+/**
+ * Size of a single chunk, as used by the cost based balancing policy.
+ */
+struct ChunkStats {
+    ChunkStats() = default;
+    explicit ChunkStats(long long a_dataSizeBytes) : dataSizeBytes(a_dataSizeBytes) {}
+
+    // Estimated number of bytes of documents in the chunk
+    long long dataSizeBytes{0};
+};
+
+// Statistics for the chunks of a collection, keyed by the chunk's min bound
+typedef std::map<BSONObj, ChunkStats> ChunkStatsMap;
+
 
 class DistributionStatus {
     MONGO_DISALLOW_COPYING(DistributionStatus);
@@ -234,6 +248,32 @@ public:
     static MigrateInfo* balance(const std::string& ns,
                                 const DistributionStatus& distribution,
                                 int balancedLastTime);
+
+    /**
+     * Cost based alternative to balance(). Instead of equalizing chunk counts, it tries to
+     * minimize the variance across shards of a per-shard load, which is the shard's share of the
+     * collection's bytes. Chunks without an entry in 'chunkStats' are assumed to have the average
+     * size of the chunks which do.
+     *
+     * Draining shards and tag violations are handled exactly as in balance() and take
+     * precedence over cost based moves.
+     *
+     * @returns up to 'maxMigrations' migrations for the collection, no two of which share a
+     *          donor or recipient shard, so that they can all be executed in the same round.
+     */
+    static std::vector<std::shared_ptr<MigrateInfo>> balanceByCost(
+        const std::string& ns,
+        const DistributionStatus& distribution,
+        const ChunkStatsMap& chunkStats,
+        size_t maxMigrations);
+
+    /**
+     * Returns the load of each shard in 'distribution' as computed by balanceByCost(). Loads are
+     * normalized so that a perfectly balanced collection has the same load of about 1 on every
+     * shard.
+     */
+    static std::map<ShardId, double> computeShardLoads(const DistributionStatus& distribution,
+                                                       const ChunkStatsMap& chunkStats);
 };
 
 }  // namespace mongo
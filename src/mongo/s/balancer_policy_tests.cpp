@@ -620,4 +620,239 @@ TEST(BalancerPolicyTests, Simulation) {
     }
 }
 
+/**
+ * Applies every migration of a cost based round to the chunk distribution, checking that no
+ * shard takes part in more than one migration and that jumbo chunks are never moved.
+ */
+void applyCostRound(ShardToChunksMap& chunks, const vector<std::shared_ptr<MigrateInfo>>& round) {
+    std::set<string> busyShards;
+    for (const auto& m : round) {
+        ASSERT(busyShards.insert(m->from).second);
+        ASSERT(busyShards.insert(m->to).second);
+
+        for (const ChunkType& chunk : chunks[m->from]) {
+            if (chunk.getMin() == m->chunk.min) {
+                ASSERT(!chunk.getJumbo());
+            }
+        }
+
+        moveChunk(chunks, m.get());
+    }
+}
+
+/**
+ * Runs cost based balancing rounds until the policy stops suggesting migrations, and returns
+ * the number of rounds it took. Fails if the policy does not converge within 'maxRounds'.
+ */
+int simulateCostRounds(ShardToChunksMap& chunks,
+                       const ShardInfoMap& shards,
+                       const ChunkStatsMap& stats,
+                       size_t maxMigrationsPerRound,
+                       int maxRounds) {
+    for (int round = 0; round < maxRounds; round++) {
+        DistributionStatus d(shards, chunks);
+        const auto migrations =
+            BalancerPolicy::balanceByCost("ns", d, stats, maxMigrationsPerRound);
+        if (migrations.empty()) {
+            return round;
+        }
+
+        ASSERT_LESS_THAN_OR_EQUALS(migrations.size(), maxMigrationsPerRound);
+        applyCostRound(chunks, migrations);
+    }
+
+    FAIL("cost based balancing did not converge");
+    return maxRounds;
+}
+
+std::pair<double, double> minMaxLoad(const ShardToChunksMap& chunks,
+                                     const ShardInfoMap& shards,
+                                     const ChunkStatsMap& stats) {
+    DistributionStatus d(shards, chunks);
+    const map<string, double> loads = BalancerPolicy::computeShardLoads(d, stats);
+
+    double minLoad = std::numeric_limits<double>::max();
+    double maxLoad = 0;
+    for (const auto& entry : loads) {
+        minLoad = std::min(minLoad, entry.second);
+        maxLoad = std::max(maxLoad, entry.second);
+    }
+    return std::make_pair(minLoad, maxLoad);
+}
+
+TEST(BalancerPolicyTests, CostModelWithoutStatsBalancesChunkCounts) {
+    ShardToChunksMap chunks;
+    addShard(chunks, 10, false);
+    addShard(chunks, 0, true);
+
+    ShardInfoMap shards;
+    shards["shard0"] = ShardInfo(0, 10, false);
+    shards["shard1"] = ShardInfo(0, 0, false);
+
+    simulateCostRounds(chunks, shards, ChunkStatsMap(), 1, 20);
+
+    ASSERT_EQUALS(5U, chunks["shard0"].size());
+    ASSERT_EQUALS(5U, chunks["shard1"].size());
+}
+
+TEST(BalancerPolicyTests, CostModelMovesDataBetweenShardsWithEqualChunkCounts) {
+    ShardToChunksMap chunks;
+    addShard(chunks, 4, false);
+    addShard(chunks, 4, true);
+
+    // All of the data lives in the chunks of shard0
+    ChunkStatsMap stats;
+    for (const ChunkType& chunk : chunks["shard0"]) {
+        stats[chunk.getMin()] = ChunkStats(64 * 1024 * 1024);
+    }
+    for (const ChunkType& chunk : chunks["shard1"]) {
+        stats[chunk.getMin()] = ChunkStats(1024);
+    }
+
+    ShardInfoMap shards;
+    shards["shard0"] = ShardInfo(0, 256, false);
+    shards["shard1"] = ShardInfo(0, 0, false);
+
+    // Count based balancing sees nothing to do
+    {
+        DistributionStatus d(shards, chunks);
+        std::unique_ptr<MigrateInfo> m(BalancerPolicy::balance("ns", d, 0));
+        ASSERT(!m);
+    }
+
+    simulateCostRounds(chunks, shards, stats, 1, 20);
+
+    size_t bigChunksOnShard1 = 0;
+    for (const ChunkType& chunk : chunks["shard1"]) {
+        if (stats[chunk.getMin()].dataSizeBytes > 1024) {
+            bigChunksOnShard1++;
+        }
+    }
+    ASSERT_EQUALS(2U, bigChunksOnShard1);
+}
+
+TEST(BalancerPolicyTests, CostModelAssumesAverageSizeForChunksWithoutStats) {
+    ShardToChunksMap chunks;
+    addShard(chunks, 4, false);
+    addShard(chunks, 4, true);
+
+    // Only the sizes of shard0's chunks are known, so shard1's are assumed to be the same
+    ChunkStatsMap stats;
+    for (const ChunkType& chunk : chunks["shard0"]) {
+        stats[chunk.getMin()] = ChunkStats(64 * 1024 * 1024);
+    }
+
+    ShardInfoMap shards;
+    shards["shard0"] = ShardInfo(0, 256, false);
+    shards["shard1"] = ShardInfo(0, 256, false);
+
+    DistributionStatus d(shards, chunks);
+    ASSERT(BalancerPolicy::balanceByCost("ns", d, stats, 4).empty());
+
+    const map<string, double> loads = BalancerPolicy::computeShardLoads(d, stats);
+    ASSERT_APPROX_EQUAL(1.0, loads.at("shard0"), 0.001);
+    ASSERT_APPROX_EQUAL(1.0, loads.at("shard1"), 0.001);
+}
+
+TEST(BalancerPolicyTests, CostModelSchedulesDisjointMigrations) {
+    ShardToChunksMap chunks;
+    addShard(chunks, 10, false);
+    addShard(chunks, 10, false);
+    addShard(chunks, 0, false);
+    addShard(chunks, 0, true);
+
+    ShardInfoMap shards;
+    shards["shard0"] = ShardInfo(0, 10, false);
+    shards["shard1"] = ShardInfo(0, 10, false);
+    shards["shard2"] = ShardInfo(0, 0, false);
+    shards["shard3"] = ShardInfo(0, 0, false);
+
+    DistributionStatus d(shards, chunks);
+    const auto migrations = BalancerPolicy::balanceByCost("ns", d, ChunkStatsMap(), 4);
+
+    // Only two pairs of shards can be formed
+    ASSERT_EQUALS(2U, migrations.size());
+    applyCostRound(chunks, migrations);
+}
+
+TEST(BalancerPolicyTests, CostModelNeverMovesJumboChunks) {
+    ShardToChunksMap chunks;
+    addShard(chunks, 6, false);
+    addShard(chunks, 0, true);
+
+    for (ChunkType& chunk : chunks["shard0"]) {
+        chunk.setJumbo(true);
+    }
+
+    ShardInfoMap shards;
+    shards["shard0"] = ShardInfo(0, 6, false);
+    shards["shard1"] = ShardInfo(0, 0, false);
+
+    DistributionStatus d(shards, chunks);
+    ASSERT(BalancerPolicy::balanceByCost("ns", d, ChunkStatsMap(), 4).empty());
+}
+
+TEST(BalancerPolicyTests, CostModelDrainsFirst) {
+    ShardToChunksMap chunks;
+    addShard(chunks, 2, false);
+    addShard(chunks, 10, true);
+
+    ShardInfoMap shards;
+    shards["shard0"] = ShardInfo(0, 2, true);
+    shards["shard1"] = ShardInfo(0, 10, false);
+
+    DistributionStatus d(shards, chunks);
+    const auto migrations = BalancerPolicy::balanceByCost("ns", d, ChunkStatsMap(), 4);
+
+    ASSERT_EQUALS(1U, migrations.size());
+    ASSERT_EQUALS("shard0", migrations[0]->from);
+    ASSERT_EQUALS("shard1", migrations[0]->to);
+}
+
+/**
+ * Randomized simulation of the cost based policy: shards start with random numbers of chunks of
+ * random size, and we run rounds until the policy is satisfied. The per-shard loads
+ * must end up much closer together than they started, and each round may only pair up each
+ * shard once.
+ */
+TEST(BalancerPolicyTests, CostModelSimulation) {
+    // Hardcode seed here, make test deterministic.
+    int64_t seed = 1337;
+    PseudoRandom rng(seed);
+
+    for (int test = 0; test < 10; test++) {
+        const int numShards = 5;
+
+        ShardToChunksMap chunks;
+        ShardInfoMap shards;
+        ChunkStatsMap stats;
+
+        for (int i = 0; i < numShards; i++) {
+            const int numShardChunks = 20 + rng.nextInt32(60);
+            addShard(chunks, numShardChunks, i == numShards - 1);
+            shards[str::stream() << "shard" << i] = ShardInfo(0, numShardChunks, false);
+        }
+
+        for (const auto& shardEntry : chunks) {
+            for (const ChunkType& chunk : shardEntry.second) {
+                // Mostly small chunks, with the occasional big one
+                const long long bytes = (1 + rng.nextInt32(rng.nextInt32(10) == 0 ? 64 : 8)) *
+                    1024LL * 1024LL;
+                stats[chunk.getMin()] = ChunkStats(bytes);
+            }
+        }
+
+        const auto before = minMaxLoad(chunks, shards, stats);
+        const int rounds = simulateCostRounds(chunks, shards, stats, numShards / 2, 1000);
+        const auto after = minMaxLoad(chunks, shards, stats);
+
+        log() << "cost model simulation " << test << " converged after " << rounds
+              << " rounds, load spread went from " << before.second - before.first << " to "
+              << after.second - after.first;
+
+        ASSERT_LESS_THAN_OR_EQUALS(after.second - after.first, before.second - before.first);
+        ASSERT_LESS_THAN(after.second - after.first, 0.5);
+    }
+}
+
 }  // namespace
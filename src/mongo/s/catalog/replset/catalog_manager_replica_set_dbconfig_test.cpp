@@ -0,0 +1,222 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/client/remote_command_targeter_mock.h"
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/executor/network_interface_mock.h"
+#include "mongo/s/catalog/replset/catalog_manager_replica_set_test_fixture.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/catalog/type_collection.h"
+#include "mongo/s/catalog/type_database.h"
+#include "mongo/s/catalog/type_shard.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/s/config.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+using executor::RemoteCommandRequest;
+using std::vector;
+
+const char kNs[] = "TestDB.TestColl";
+
+/**
+ * Gives the tests access to the collections and the refreshes in progress of a DBConfig.
+ */
+class DBConfigForTest : public DBConfig {
+public:
+    explicit DBConfigForTest(const DatabaseType& dbt)
+        : DBConfig(dbt.getName(), dbt, repl::OpTime()) {}
+
+    /**
+     * Caches 'coll' as sharded. Loads its chunks from the config server.
+     */
+    void addShardedCollection(OperationContext* txn, const CollectionType& coll) {
+        CollectionInfo ci(txn, coll, repl::OpTime());
+        stdx::lock_guard<stdx::mutex> lk(_lock);
+        _collections[coll.getNs().ns()] = ci;
+    }
+
+    bool isRefreshing(const std::string& ns) {
+        stdx::lock_guard<stdx::mutex> lk(_lock);
+        return _refreshes.count(ns);
+    }
+
+    /**
+     * Returns the number of threads waiting for the refresh of 'ns' in progress.
+     */
+    long refreshWaiters(const std::string& ns) {
+        stdx::lock_guard<stdx::mutex> lk(_lock);
+        auto it = _refreshes.find(ns);
+        invariant(it != _refreshes.end());
+
+        // The other references are held by the map and by the refreshing thread
+        return it->second.use_count() - 2;
+    }
+};
+
+/**
+ * Operation context which can be killed, unlike OperationContextNoop.
+ */
+class KillableOperationContext : public OperationContextNoop {
+public:
+    void checkForInterrupt() override {
+        uassertStatusOK(checkForInterruptNoAssert());
+    }
+
+    Status checkForInterruptNoAssert() override {
+        if (isKillPending()) {
+            return Status(ErrorCodes::Interrupted, "operation was interrupted");
+        }
+        return Status::OK();
+    }
+};
+
+class DBConfigRefreshTest : public CatalogManagerReplSetTestFixture {
+protected:
+    void setUp() override {
+        CatalogManagerReplSetTestFixture::setUp();
+        configTargeter()->setFindHostReturnValue(HostAndPort("TestHost1"));
+
+        ShardType shard;
+        shard.setName("shard0000");
+        shard.setHost("shard0000:12345");
+        setupShards({shard});
+
+        DatabaseType db;
+        db.setName("TestDB");
+        db.setPrimary("shard0000");
+        db.setSharded(true);
+        _config = stdx::make_unique<DBConfigForTest>(db);
+
+        const OID epoch = OID::gen();
+
+        CollectionType coll;
+        coll.setNs(NamespaceString(kNs));
+        coll.setUpdatedAt(network()->now());
+        coll.setEpoch(epoch);
+        coll.setKeyPattern(KeyPattern(BSON("a" << 1)));
+        coll.setUnique(false);
+
+        _chunk.setName("chunk0000");
+        _chunk.setNS(kNs);
+        _chunk.setMin(BSON("a" << MINKEY));
+        _chunk.setMax(BSON("a" << MAXKEY));
+        _chunk.setVersion({1, 0, epoch});
+        _chunk.setShard("shard0000");
+
+        auto future =
+            launchAsync([this, coll] { _config->addShardedCollection(operationContext(), coll); });
+        expectGetChunks();
+        future.timed_get(kFutureTimeout);
+    }
+
+    void tearDown() override {
+        _config.reset();
+        CatalogManagerReplSetTestFixture::tearDown();
+    }
+
+    /**
+     * Waits for a query on the chunks of kNs and responds with the collection's only chunk.
+     */
+    void expectGetChunks() {
+        onFindCommand([this](const RemoteCommandRequest& request) {
+            const NamespaceString nss(request.dbname, request.cmdObj.firstElement().String());
+            ASSERT_EQ(ChunkType::ConfigNS, nss.ns());
+            return vector<BSONObj>{_chunk.toBSON()};
+        });
+    }
+
+    /**
+     * Waits until 'waiters' threads wait for the refresh of kNs in progress.
+     */
+    void waitForRefreshWaiters(long waiters) {
+        while (!_config->isRefreshing(kNs) || _config->refreshWaiters(kNs) < waiters) {
+            sleepmillis(1);
+        }
+    }
+
+    std::unique_ptr<DBConfigForTest> _config;
+    ChunkType _chunk;
+};
+
+TEST_F(DBConfigRefreshTest, ConcurrentRefreshesAreCoalesced) {
+    auto refresher = launchAsync(
+        [this] { return _config->getChunkManager(operationContext(), kNs, true); });
+    waitForRefreshWaiters(0);
+
+    auto waiter = launchAsync([this] {
+        OperationContextNoop txn;
+        return _config->getChunkManager(&txn, kNs, true);
+    });
+    waitForRefreshWaiters(1);
+
+    // Only the refreshing thread queries the config server
+    expectGetChunks();
+
+    const auto refreshed = refresher.timed_get(kFutureTimeout);
+    ASSERT(refreshed);
+    ASSERT_EQ(refreshed, waiter.timed_get(kFutureTimeout));
+    ASSERT_FALSE(_config->isRefreshing(kNs));
+
+    network()->enterNetwork();
+    ASSERT_FALSE(network()->hasReadyRequests());
+    network()->exitNetwork();
+}
+
+TEST_F(DBConfigRefreshTest, WaitingForRefreshCanBeInterrupted) {
+    auto refresher = launchAsync(
+        [this] { return _config->getChunkManager(operationContext(), kNs, true); });
+    waitForRefreshWaiters(0);
+
+    KillableOperationContext waiterTxn;
+    auto waiter = launchAsync([this, &waiterTxn] {
+        ASSERT_THROWS_CODE(_config->getChunkManager(&waiterTxn, kNs, true),
+                           DBException,
+                           ErrorCodes::Interrupted);
+    });
+    waitForRefreshWaiters(1);
+
+    // The waiter gives up while the refresh is still blocked on the config server
+    waiterTxn.markKilled();
+    waiter.timed_get(kFutureTimeout);
+    ASSERT_TRUE(_config->isRefreshing(kNs));
+
+    expectGetChunks();
+    ASSERT(refresher.timed_get(kFutureTimeout));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -33,10 +33,13 @@
 #include "mongo/s/config.h"
 
 
+#include "mongo/base/counter.h"
 #include "mongo/client/connpool.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/catalog/catalog_manager.h"
@@ -54,6 +57,7 @@
 #include "mongo/s/cluster_write.h"
 #include "mongo/s/grid.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -62,6 +66,28 @@ using std::string;
 using std::unique_ptr;
 using std::vector;
 
+namespace {
+
+// How often an operation waiting for another thread's refresh checks whether it was killed
+const Milliseconds kRefreshInterruptCheckInterval(100);
+
+// Time spent by the thread performing an incremental chunk manager refresh
+TimerStats chunkManagerRefreshStats;
+ServerStatusMetricField<TimerStats> displayChunkManagerRefreshStats(
+    "sharding.chunkManagerRefresh.latency", &chunkManagerRefreshStats);
+
+// Time spent by other operations waiting for a refresh of the same namespace to complete
+TimerStats chunkManagerRefreshBlockedStats;
+ServerStatusMetricField<TimerStats> displayChunkManagerRefreshBlockedStats(
+    "sharding.chunkManagerRefresh.blocked", &chunkManagerRefreshBlockedStats);
+
+// Number of refresh requests which were satisfied by joining an already running refresh
+Counter64 chunkManagerRefreshJoinedCounter;
+ServerStatusMetricField<Counter64> displayChunkManagerRefreshJoinedCounter(
+    "sharding.chunkManagerRefresh.joined", &chunkManagerRefreshJoinedCounter);
+
+}  // namespace
+
 CollectionInfo::CollectionInfo(OperationContext* txn,
                                const CollectionType& coll,
                                repl::OpTime opTime)
@@ -282,9 +308,10 @@ std::shared_ptr<ChunkManager> DBConfig::getChunkManager(OperationContext* txn,
     BSONObj key;
     ChunkVersion oldVersion;
     ChunkManagerPtr oldManager;
+    std::shared_ptr<CollectionRefresh> refresh;
 
     {
-        stdx::lock_guard<stdx::mutex> lk(_lock);
+        stdx::unique_lock<stdx::mutex> lk(_lock);
 
         bool earlyReload = !_collections[ns].isSharded() && (shouldReload || forceReload);
         if (earlyReload) {
@@ -307,10 +334,79 @@ std::shared_ptr<ChunkManager> DBConfig::getChunkManager(OperationContext* txn,
             oldManager = ci.getCM();
             oldVersion = ci.getCM()->getVersion();
         }
+
+        // Forced reloads must always go to the config server, so they neither join nor publish
+        // incremental refreshes
+        if (!forceReload) {
+            CollectionRefreshMap::iterator it = _refreshes.find(ns);
+            if (it == _refreshes.end()) {
+                refresh = std::make_shared<CollectionRefresh>(oldVersion);
+                _refreshes[ns] = refresh;
+            } else if (it->second->baseVersion.equals(oldVersion)) {
+                // Somebody else is already refreshing from the same chunk manager we consider
+                // stale, so their result is at least as new as anything we would load
+                std::shared_ptr<CollectionRefresh> inProgress = it->second;
+
+                // Wake up regularly to check whether the operation was killed, since the
+                // refresh being waited for is not bounded in time
+                Timer t;
+                while (!_refreshCompleted.wait_for(lk,
+                                                   kRefreshInterruptCheckInterval,
+                                                   [&inProgress] { return inProgress->done; })) {
+                    txn->checkForInterrupt();
+                }
+                chunkManagerRefreshBlockedStats.recordMillis(t.millis());
+                chunkManagerRefreshJoinedCounter.increment();
+
+                uassertStatusOK(inProgress->status);
+                return inProgress->result;
+            }
+        }
     }
 
     invariant(!key.isEmpty());
 
+    if (!refresh) {
+        return _refreshChunkManager(txn, ns, oldManager, oldVersion, forceReload);
+    }
+
+    ChunkManagerPtr result;
+    try {
+        Timer t;
+        result = _refreshChunkManager(txn, ns, oldManager, oldVersion, forceReload);
+        chunkManagerRefreshStats.recordMillis(t.millis());
+    } catch (const DBException& ex) {
+        _completeRefresh(ns, refresh, ChunkManagerPtr(), ex.toStatus());
+        throw;
+    }
+
+    _completeRefresh(ns, refresh, result, Status::OK());
+    return result;
+}
+
+void DBConfig::_completeRefresh(const string& ns,
+                                const std::shared_ptr<CollectionRefresh>& refresh,
+                                ChunkManagerPtr result,
+                                Status status) {
+    stdx::lock_guard<stdx::mutex> lk(_lock);
+
+    refresh->done = true;
+    refresh->status = std::move(status);
+    refresh->result = std::move(result);
+
+    CollectionRefreshMap::iterator it = _refreshes.find(ns);
+    if (it != _refreshes.end() && it->second == refresh) {
+        _refreshes.erase(it);
+    }
+
+    _refreshCompleted.notify_all();
+}
+
+ChunkManagerPtr DBConfig::_refreshChunkManager(OperationContext* txn,
+                                               const string& ns,
+                                               ChunkManagerPtr oldManager,
+                                               ChunkVersion oldVersion,
+                                               bool forceReload) {
     // TODO: We need to keep this first one-chunk check in until we have a more efficient way of
     // creating/reusing a chunk manager, as doing so requires copying the full set of chunks
     // currently
@@ -32,7 +32,9 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/optime.h"
+#include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
@@ -176,6 +178,44 @@ public:
 protected:
     typedef std::map<std::string, CollectionInfo> CollectionInfoMap;
 
+    /**
+     * An incremental chunk manager refresh which is currently running for some namespace. Threads
+     * which need a newer routing table than the one the refresh started from wait for it to
+     * complete instead of issuing their own config server queries. While a refresh is running,
+     * the previously installed chunk manager stays visible to all other readers.
+     */
+    struct CollectionRefresh {
+        CollectionRefresh(ChunkVersion version) : baseVersion(std::move(version)) {}
+
+        // Version of the chunk manager which the refresh is building on
+        const ChunkVersion baseVersion;
+
+        // Set once the refresh has finished, along with its outcome
+        bool done{false};
+        Status status{Status::OK()};
+        std::shared_ptr<ChunkManager> result;
+    };
+
+    typedef std::map<std::string, std::shared_ptr<CollectionRefresh>> CollectionRefreshMap;
+
+    /**
+     * Performs the actual config server round trips for an incremental (or forced) reload of the
+     * chunk manager for 'ns' and installs the result. Must be called without holding '_lock'.
+     */
+    std::shared_ptr<ChunkManager> _refreshChunkManager(OperationContext* txn,
+                                                       const std::string& ns,
+                                                       std::shared_ptr<ChunkManager> oldManager,
+                                                       ChunkVersion oldVersion,
+                                                       bool forceReload);
+
+    /**
+     * Publishes the outcome of a refresh started by this thread and wakes up any waiters.
+     */
+    void _completeRefresh(const std::string& ns,
+                          const std::shared_ptr<CollectionRefresh>& refresh,
+                          std::shared_ptr<ChunkManager> result,
+                          Status status);
+
     bool _dropShardedCollections(OperationContext* txn,
                                  int& num,
                                  std::set<ShardId>& shardIds,
@@ -198,6 +238,11 @@ protected:
     stdx::mutex _lock;
     CollectionInfoMap _collections;
 
+    // Incremental refreshes currently in progress, keyed by namespace. Protected by '_lock', with
+    // '_refreshCompleted' signalled every time a refresh finishes.
+    CollectionRefreshMap _refreshes;
+    stdx::condition_variable _refreshCompleted;
+
     // OpTime of config server when the database definition was loaded.
     repl::OpTime _configOpTime;
 
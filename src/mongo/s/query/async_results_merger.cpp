@@ -38,6 +38,7 @@
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -101,7 +102,9 @@ bool AsyncResultsMerger::readySorted_inlock() {
         }
     }
 
-    return true;
+    // The end of the stream may only be reported once no callbacks are outstanding, since the
+    // caller is free to destroy an exhausted ARM.
+    return !_mergeQueue.empty() || !haveOutstandingBatchRequests_inlock();
 }
 
 bool AsyncResultsMerger::readyUnsorted_inlock() {
@@ -116,7 +119,8 @@ bool AsyncResultsMerger::readyUnsorted_inlock() {
         }
     }
 
-    return allExhausted;
+    // See readySorted_inlock() for why outstanding callbacks matter.
+    return allExhausted && !haveOutstandingBatchRequests_inlock();
 }
 
 StatusWith<boost::optional<BSONObj>> AsyncResultsMerger::nextReady() {
@@ -201,9 +205,55 @@ Status AsyncResultsMerger::askForNextBatch_inlock(size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+
+    if (!remote.cursorId && remote.hedgeHostAndPort) {
+        // Failing to arm the timer only means this request will not be hedged.
+        auto timerStatus = _executor->scheduleWorkAt(
+            _executor->now() + remote.hedgeDelay,
+            stdx::bind(
+                &AsyncResultsMerger::handleHedgeTimer, this, stdx::placeholders::_1, remoteIndex));
+        if (timerStatus.isOK()) {
+            remote.hedgeTimerHandle = timerStatus.getValue();
+        }
+    }
+
     return Status::OK();
 }
 
+void AsyncResultsMerger::handleHedgeTimer(const executor::TaskExecutor::CallbackArgs& cbData,
+                                          size_t remoteIndex) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto& remote = _remotes[remoteIndex];
+    remote.hedgeTimerHandle = executor::TaskExecutor::CallbackHandle();
+
+    if (_lifecycleState != kAlive) {
+        completeKillIfDone_inlock();
+        return;
+    }
+
+    // Nothing to do if the timer was canceled or the remote has answered in the meantime.
+    if (!cbData.status.isOK() || !remote.cbHandle.isValid() || remote.gotFirstResponse) {
+        signalCurrentEvent_inlock();
+        return;
+    }
+
+    LOG(1) << "Hedging " << remote.cmdObj.firstElementFieldName() << " on " << _params.nsString
+           << " to " << *remote.hedgeHostAndPort << " after " << remote.hedgeDelay
+           << " without a reply from " << remote.hostAndPort;
+
+    executor::RemoteCommandRequest request(
+        *remote.hedgeHostAndPort, _params.nsString.db().toString(), remote.cmdObj);
+
+    auto callbackStatus = _executor->scheduleRemoteCommand(
+        request,
+        stdx::bind(
+            &AsyncResultsMerger::handleBatchResponse, this, stdx::placeholders::_1, remoteIndex));
+    if (callbackStatus.isOK()) {
+        remote.hedgeCbHandle = callbackStatus.getValue();
+    }
+}
+
 StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
 
@@ -243,7 +293,12 @@ StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent()
         return eventStatus;
     }
     _currentEvent = eventStatus.getValue();
-    return _currentEvent;
+
+    // Callbacks which do not deliver results, such as a canceled hedge, can make us ready
+    // without any further remote work.
+    auto currentEvent = _currentEvent;
+    signalCurrentEvent_inlock();
+    return currentEvent;
 }
 
 void AsyncResultsMerger::handleBatchResponse(
@@ -252,9 +307,27 @@ void AsyncResultsMerger::handleBatchResponse(
 
     auto& remote = _remotes[remoteIndex];
 
+    // The callback of a hedged request which lost the race and was canceled. The cursor may
+    // have reached the end of the stream in the meantime, in which case this was the last
+    // thing it was waiting for.
+    if (remote.abandonedCbHandle.isValid() && cbData.myHandle == remote.abandonedCbHandle) {
+        remote.abandonedCbHandle = executor::TaskExecutor::CallbackHandle();
+        if (_lifecycleState != kAlive) {
+            completeKillIfDone_inlock();
+        } else {
+            signalCurrentEvent_inlock();
+        }
+        return;
+    }
+
     // Clear the callback handle. This indicates that we are no longer waiting on a response from
-    // 'remote'.
-    remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+    // 'remote' over this request.
+    const bool isHedge = remote.hedgeCbHandle.isValid() && cbData.myHandle == remote.hedgeCbHandle;
+    if (isHedge) {
+        remote.hedgeCbHandle = executor::TaskExecutor::CallbackHandle();
+    } else {
+        remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+    }
 
     // If we're in the process of shutting down then there's no need to process the batch.
     if (_lifecycleState != kAlive) {
@@ -264,21 +337,37 @@ void AsyncResultsMerger::handleBatchResponse(
         signalCurrentEvent_inlock();
 
         // If we're killed and we're not waiting on any more batches to come back, then we are ready
-        // to kill the cursors on the remote hosts and clean up this cursor. Schedule the
-        // killCursors command and signal that this cursor is safe now safe to destroy. We have to
-        // promise not to touch any members of this class because 'this' could become invalid as
-        // soon as we signal the event.
-        if (!haveOutstandingBatchRequests_inlock()) {
-            // If the event handle is invalid, then the executor is in the middle of shutting down,
-            // and we can't schedule any more work for it to complete.
-            if (_killCursorsScheduledEvent.isValid()) {
-                scheduleKillCursors_inlock();
-                _executor->signalEvent(_killCursorsScheduledEvent);
-            }
+        // to kill the cursors on the remote hosts and clean up this cursor.
+        completeKillIfDone_inlock();
+        return;
+    }
 
-            _lifecycleState = kKillComplete;
+    if (remote.hedgeTimerHandle.isValid()) {
+        // The remote replied before we decided to hedge.
+        _executor->cancel(remote.hedgeTimerHandle);
+    }
+
+    auto& otherCbHandle = isHedge ? remote.cbHandle : remote.hedgeCbHandle;
+    if (otherCbHandle.isValid()) {
+        // A hedged request is still racing this one. Failures are ignored while the other side
+        // can still succeed. The first success wins and the other request is canceled.
+        if (!cbData.response.isOK() ||
+            !GetMoreResponse::parseFromBSON(cbData.response.getValue().data).isOK()) {
+            return;
         }
-        return;
+
+        remote.abandonedCbHandle = otherCbHandle;
+        otherCbHandle = executor::TaskExecutor::CallbackHandle();
+        _executor->cancel(remote.abandonedCbHandle);
+    }
+
+    if (isHedge) {
+        // getMores must go to the host which holds the cursor.
+        remote.hostAndPort = cbData.request.target;
+    }
+
+    if (cbData.response.isOK() && remote.latencyObserver) {
+        remote.latencyObserver(cbData.request.target, cbData.response.getValue().elapsedMillis);
     }
 
     // Early return from this point on signal anyone waiting on an event, if ready() is true.
@@ -349,7 +438,7 @@ void AsyncResultsMerger::signalCurrentEvent_inlock() {
 
 bool AsyncResultsMerger::haveOutstandingBatchRequests_inlock() {
     for (const auto& remote : _remotes) {
-        if (remote.cbHandle.isValid()) {
+        if (remote.hasOutstandingCallbacks()) {
             return true;
         }
     }
@@ -357,6 +446,22 @@ bool AsyncResultsMerger::haveOutstandingBatchRequests_inlock() {
     return false;
 }
 
+void AsyncResultsMerger::completeKillIfDone_inlock() {
+    invariant(_lifecycleState != kAlive);
+    if (_lifecycleState == kKillComplete || haveOutstandingBatchRequests_inlock()) {
+        return;
+    }
+
+    // If the event handle is invalid, then the executor is in the middle of shutting down,
+    // and we can't schedule any more work for it to complete.
+    if (_killCursorsScheduledEvent.isValid()) {
+        scheduleKillCursors_inlock();
+        _executor->signalEvent(_killCursorsScheduledEvent);
+    }
+
+    _lifecycleState = kKillComplete;
+}
+
 void AsyncResultsMerger::scheduleKillCursors_inlock() {
     invariant(_lifecycleState == kKillStarted);
     invariant(_killCursorsScheduledEvent.isValid());
@@ -393,8 +498,13 @@ executor::TaskExecutor::EventHandle AsyncResultsMerger::kill() {
 
     // Cancel callbacks.
     for (const auto& remote : _remotes) {
-        if (remote.cbHandle.isValid()) {
-            _executor->cancel(remote.cbHandle);
+        for (const auto& handle : {remote.cbHandle,
+                                   remote.hedgeTimerHandle,
+                                   remote.hedgeCbHandle,
+                                   remote.abandonedCbHandle}) {
+            if (handle.isValid()) {
+                _executor->cancel(handle);
+            }
         }
     }
 
@@ -429,7 +539,11 @@ executor::TaskExecutor::EventHandle AsyncResultsMerger::kill() {
 
 AsyncResultsMerger::RemoteCursorData::RemoteCursorData(
     const ClusterClientCursorParams::Remote& params)
-    : hostAndPort(params.hostAndPort), cmdObj(params.cmdObj) {}
+    : hostAndPort(params.hostAndPort),
+      cmdObj(params.cmdObj),
+      hedgeHostAndPort(params.hedgeHostAndPort),
+      hedgeDelay(params.hedgeDelay),
+      latencyObserver(params.latencyObserver) {}
 
 bool AsyncResultsMerger::RemoteCursorData::hasNext() const {
     return !docBuffer.empty();
@@ -439,6 +553,11 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
     return cursorId && (*cursorId == 0);
 }
 
+bool AsyncResultsMerger::RemoteCursorData::hasOutstandingCallbacks() const {
+    return cbHandle.isValid() || hedgeTimerHandle.isValid() || hedgeCbHandle.isValid() ||
+        abandonedCbHandle.isValid();
+}
+
 //
 // AsyncResultsMerger::MergingComparator
 //
@@ -160,6 +160,11 @@ private:
          */
         bool exhausted() const;
 
+        /**
+         * Returns whether any callback scheduled on behalf of this remote has yet to run.
+         */
+        bool hasOutstandingCallbacks() const;
+
         HostAndPort hostAndPort;
         BSONObj cmdObj;
         boost::optional<CursorId> cursorId;
@@ -167,6 +172,22 @@ private:
         executor::TaskExecutor::CallbackHandle cbHandle;
         Status status = Status::OK();
 
+        // Hedging of the command which establishes the cursor. See
+        // ClusterClientCursorParams::Remote.
+        boost::optional<HostAndPort> hedgeHostAndPort;
+        Milliseconds hedgeDelay;
+        stdx::function<void(const HostAndPort&, Milliseconds)> latencyObserver;
+
+        // Fires 'hedgeDelay' after the initial command was sent.
+        executor::TaskExecutor::CallbackHandle hedgeTimerHandle;
+
+        // The initial command as sent to 'hedgeHostAndPort'.
+        executor::TaskExecutor::CallbackHandle hedgeCbHandle;
+
+        // Whichever of the two initial commands lost the race. It has been canceled, but we must
+        // still wait for its callback to run.
+        executor::TaskExecutor::CallbackHandle abandonedCbHandle;
+
         // Set to true once we have heard from the remote node at least once.
         bool gotFirstResponse = false;
     };
@@ -228,6 +249,20 @@ private:
     void handleBatchResponse(const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData,
                              size_t remoteIndex);
 
+    /**
+     * Callback run 'hedgeDelay' after the initial command was sent to a remote with a hedge
+     * host. If that command is still outstanding, sends it to the hedge host too.
+     */
+    void handleHedgeTimer(const executor::TaskExecutor::CallbackArgs& cbData, size_t remoteIndex);
+
+    /**
+     * Once killing has started and there are no more outstanding callbacks, schedules the
+     * killCursors commands and signals '_killCursorsScheduledEvent'. We have to promise not to
+     * touch any members of this class after that because 'this' could become invalid as soon as
+     * we signal the event.
+     */
+    void completeKillIfDone_inlock();
+
     /**
      * If there is a valid unsignaled event that has been requested via nextReady(), signals that
      * event.
@@ -235,7 +270,8 @@ private:
     void signalCurrentEvent_inlock();
 
     /**
-     * Returns true if this async cursor is waiting to receive another batch from a remote.
+     * Returns true if this async cursor is waiting to receive another batch from a remote, or
+     * for any other callback it has scheduled.
      */
     bool haveOutstandingBatchRequests_inlock();
 
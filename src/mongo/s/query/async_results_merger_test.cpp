@@ -92,6 +92,40 @@ protected:
         arm = stdx::make_unique<AsyncResultsMerger>(executor, params);
     }
 
+    /**
+     * Like makeCursorFromFindCmd, but for a single remote whose initial find is hedged to
+     * 'hedgeHost' after 'hedgeDelay'. Successful replies are recorded in 'observedLatencies'.
+     */
+    void makeHedgedCursorFromFindCmd(const BSONObj& findCmd,
+                                     const HostAndPort& host,
+                                     const HostAndPort& hedgeHost,
+                                     Milliseconds hedgeDelay) {
+        params = ClusterClientCursorParams(_nss);
+
+        ClusterClientCursorParams::Remote remoteParams;
+        remoteParams.hostAndPort = host;
+        remoteParams.cmdObj = findCmd;
+        remoteParams.hedgeHostAndPort = hedgeHost;
+        remoteParams.hedgeDelay = hedgeDelay;
+        remoteParams.latencyObserver = [this](const HostAndPort& target, Milliseconds latency) {
+            observedLatencies.push_back(target);
+        };
+        params.remotes.push_back(remoteParams);
+
+        arm = stdx::make_unique<AsyncResultsMerger>(executor, params);
+    }
+
+    /**
+     * Must be called from within the network. Answers a request previously taken off the mock
+     * network with getNextReadyRequest().
+     */
+    void respondTo(executor::NetworkInterfaceMock::NetworkOperationIterator noi,
+                   executor::TaskExecutor::ResponseStatus response) {
+        executor::NetworkInterfaceMock* net = getNet();
+        net->scheduleResponse(noi, net->now(), response);
+        net->runReadyNetworkOperations();
+    }
+
     /**
      * Schedules a list of getMore responses to be returned by the mock network.
      */
@@ -153,6 +187,8 @@ protected:
 
     ClusterClientCursorParams params;
     std::unique_ptr<AsyncResultsMerger> arm;
+
+    std::vector<HostAndPort> observedLatencies;
 };
 
 TEST_F(AsyncResultsMergerTest, ClusterFind) {
@@ -735,6 +771,234 @@ TEST_F(AsyncResultsMergerTest, KillCalledTwice) {
     executor->waitForEvent(killedEvent2);
 }
 
+TEST_F(AsyncResultsMergerTest, HedgeNotSentWhenRemoteRepliesInTime) {
+    BSONObj findCmd = fromjson("{find: 'testcoll'}");
+    makeHedgedCursorFromFindCmd(findCmd, _remotes[0], _remotes[1], Milliseconds(10));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    std::vector<GetMoreResponse> responses;
+    std::vector<BSONObj> batch = {fromjson("{_id: 1}")};
+    responses.emplace_back(_nss, CursorId(0), batch);
+    scheduleNetworkResponses(responses);
+    executor->waitForEvent(readyEvent);
+
+    // Letting the hedge delay pass must not send anything to the hedge host.
+    executor::NetworkInterfaceMock* net = getNet();
+    net->enterNetwork();
+    net->runUntil(net->now() + Milliseconds(20));
+    ASSERT_FALSE(net->hasReadyRequests());
+    net->exitNetwork();
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT(!unittest::assertGet(arm->nextReady()));
+
+    ASSERT_EQ(1U, observedLatencies.size());
+    ASSERT_EQ(_remotes[0], observedLatencies[0]);
+}
+
+TEST_F(AsyncResultsMergerTest, HedgedRequestWinsWhenRemoteIsSlow) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', batchSize: 1}");
+    makeHedgedCursorFromFindCmd(findCmd, _remotes[0], _remotes[1], Milliseconds(10));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    // Take the request to the first host off the network but don't answer it yet.
+    executor::NetworkInterfaceMock* net = getNet();
+    net->enterNetwork();
+    ASSERT_TRUE(net->hasReadyRequests());
+    auto slowRequest = net->getNextReadyRequest();
+    ASSERT_EQ(_remotes[0], slowRequest->getRequest().target);
+    net->runUntil(net->now() + Milliseconds(10));
+    net->exitNetwork();
+
+    // The same command goes to the hedge host, which answers first.
+    net->enterNetwork();
+    ASSERT_TRUE(net->hasReadyRequests());
+    auto hedgeRequest = net->getNextReadyRequest();
+    ASSERT_EQ(_remotes[1], hedgeRequest->getRequest().target);
+    ASSERT_EQ(findCmd, hedgeRequest->getRequest().cmdObj);
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}")};
+    respondTo(hedgeRequest,
+              RemoteCommandResponse(
+                  GetMoreResponse(_nss, CursorId(5), batch1).toBSON(), BSONObj(), Milliseconds(1)));
+    net->exitNetwork();
+
+    executor->waitForEvent(readyEvent);
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_FALSE(arm->ready());
+    readyEvent = unittest::assertGet(arm->nextEvent());
+
+    // The slow host eventually answers too, but its request has been canceled.
+    net->enterNetwork();
+    respondTo(slowRequest,
+              RemoteCommandResponse(
+                  GetMoreResponse(_nss, CursorId(7), batch1).toBSON(), BSONObj(), Milliseconds(1)));
+    net->exitNetwork();
+
+    // The getMore goes to the host that holds the cursor we kept.
+    net->enterNetwork();
+    ASSERT_TRUE(net->hasReadyRequests());
+    auto getMoreRequest = net->getNextReadyRequest();
+    ASSERT_EQ(_remotes[1], getMoreRequest->getRequest().target);
+    ASSERT_EQ(std::string("getMore"), getMoreRequest->getRequest().cmdObj.firstElementFieldName());
+    ASSERT_EQ(5, getMoreRequest->getRequest().cmdObj.firstElement().numberLong());
+    ASSERT_FALSE(net->hasReadyRequests());
+
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 2}")};
+    respondTo(getMoreRequest,
+              RemoteCommandResponse(
+                  GetMoreResponse(_nss, CursorId(0), batch2).toBSON(), BSONObj(), Milliseconds(1)));
+    net->exitNetwork();
+
+    executor->waitForEvent(readyEvent);
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT(!unittest::assertGet(arm->nextReady()));
+
+    ASSERT_EQ(2U, observedLatencies.size());
+    ASSERT_EQ(_remotes[1], observedLatencies[0]);
+    ASSERT_EQ(_remotes[1], observedLatencies[1]);
+}
+
+TEST_F(AsyncResultsMergerTest, EndOfStreamWaitsForCanceledHedge) {
+    BSONObj findCmd = fromjson("{find: 'testcoll'}");
+    makeHedgedCursorFromFindCmd(findCmd, _remotes[0], _remotes[1], Milliseconds(10));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    executor::NetworkInterfaceMock* net = getNet();
+    net->enterNetwork();
+    auto slowRequest = net->getNextReadyRequest();
+    net->runUntil(net->now() + Milliseconds(10));
+    net->exitNetwork();
+
+    // The hedge returns everything, but the ARM can't be destroyed while the canceled request's
+    // callback is still pending.
+    net->enterNetwork();
+    ASSERT_TRUE(net->hasReadyRequests());
+    auto hedgeRequest = net->getNextReadyRequest();
+    std::vector<BSONObj> batch = {fromjson("{_id: 1}")};
+    respondTo(hedgeRequest,
+              RemoteCommandResponse(
+                  GetMoreResponse(_nss, CursorId(0), batch).toBSON(), BSONObj(), Milliseconds(1)));
+    net->exitNetwork();
+
+    executor->waitForEvent(readyEvent);
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_FALSE(arm->ready());
+    readyEvent = unittest::assertGet(arm->nextEvent());
+
+    net->enterNetwork();
+    respondTo(slowRequest, Status(ErrorCodes::HostUnreachable, "host unreachable"));
+    net->exitNetwork();
+
+    executor->waitForEvent(readyEvent);
+    ASSERT_TRUE(arm->ready());
+    ASSERT(!unittest::assertGet(arm->nextReady()));
+}
+
+TEST_F(AsyncResultsMergerTest, HedgedRequestHidesErrorFromSlowRemote) {
+    BSONObj findCmd = fromjson("{find: 'testcoll'}");
+    makeHedgedCursorFromFindCmd(findCmd, _remotes[0], _remotes[1], Milliseconds(10));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    executor::NetworkInterfaceMock* net = getNet();
+    net->enterNetwork();
+    auto slowRequest = net->getNextReadyRequest();
+    net->runUntil(net->now() + Milliseconds(10));
+    net->exitNetwork();
+
+    // An error from one side is not reported while the other side may still succeed.
+    net->enterNetwork();
+    ASSERT_TRUE(net->hasReadyRequests());
+    auto hedgeRequest = net->getNextReadyRequest();
+    respondTo(slowRequest, Status(ErrorCodes::HostUnreachable, "host unreachable"));
+    net->exitNetwork();
+
+    net->enterNetwork();
+    ASSERT_FALSE(arm->ready());
+    std::vector<BSONObj> batch = {fromjson("{_id: 1}")};
+    respondTo(hedgeRequest,
+              RemoteCommandResponse(
+                  GetMoreResponse(_nss, CursorId(0), batch).toBSON(), BSONObj(), Milliseconds(1)));
+    net->exitNetwork();
+
+    executor->waitForEvent(readyEvent);
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT(!unittest::assertGet(arm->nextReady()));
+}
+
+TEST_F(AsyncResultsMergerTest, HedgedRequestsBothFail) {
+    BSONObj findCmd = fromjson("{find: 'testcoll'}");
+    makeHedgedCursorFromFindCmd(findCmd, _remotes[0], _remotes[1], Milliseconds(10));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    executor::NetworkInterfaceMock* net = getNet();
+    net->enterNetwork();
+    auto slowRequest = net->getNextReadyRequest();
+    net->runUntil(net->now() + Milliseconds(10));
+    net->exitNetwork();
+
+    net->enterNetwork();
+    ASSERT_TRUE(net->hasReadyRequests());
+    auto hedgeRequest = net->getNextReadyRequest();
+    respondTo(hedgeRequest, Status(ErrorCodes::HostUnreachable, "hedge host unreachable"));
+    net->exitNetwork();
+
+    net->enterNetwork();
+    respondTo(slowRequest, Status(ErrorCodes::HostUnreachable, "host unreachable"));
+    net->exitNetwork();
+
+    // Only the last error is reported.
+    executor->waitForEvent(readyEvent);
+    ASSERT_TRUE(arm->ready());
+    auto statusWithNext = arm->nextReady();
+    ASSERT_EQ(ErrorCodes::HostUnreachable, statusWithNext.getStatus().code());
+    ASSERT_EQ("host unreachable", statusWithNext.getStatus().reason());
+
+    auto killEvent = arm->kill();
+    executor->waitForEvent(killEvent);
+}
+
+TEST_F(AsyncResultsMergerTest, KillWhileHedgedRequestsOutstanding) {
+    BSONObj findCmd = fromjson("{find: 'testcoll'}");
+    makeHedgedCursorFromFindCmd(findCmd, _remotes[0], _remotes[1], Milliseconds(10));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    executor::NetworkInterfaceMock* net = getNet();
+    net->enterNetwork();
+    auto slowRequest = net->getNextReadyRequest();
+    net->runUntil(net->now() + Milliseconds(10));
+    net->exitNetwork();
+
+    net->enterNetwork();
+    ASSERT_TRUE(net->hasReadyRequests());
+    net->exitNetwork();
+
+    // The hedged request is canceled, but the ARM is not safe to destroy until the request
+    // already being processed by the network has also completed.
+    auto killEvent = arm->kill();
+    runReadyNetworkOperations();
+
+    net->enterNetwork();
+    respondTo(slowRequest, Status(ErrorCodes::HostUnreachable, "host unreachable"));
+    net->exitNetwork();
+
+    executor->waitForEvent(killEvent);
+    executor->waitForEvent(readyEvent);
+}
+
 }  // namespace
 
 }  // namespace mongo
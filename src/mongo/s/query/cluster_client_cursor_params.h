@@ -33,6 +33,9 @@
 
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -46,6 +49,17 @@ struct ClusterClientCursorParams {
 
         // The raw command parameters to send to this remote (e.g. the find command specification).
         BSONObj cmdObj;
+
+        // If set, the command establishing the cursor is hedged: should 'hostAndPort' not have
+        // replied within 'hedgeDelay', 'cmdObj' is also sent to this host and the cursor is
+        // established on whichever of the two replies successfully first. The other request is
+        // canceled without reading its reply, so only set this for commands which are safe to run
+        // twice and never leave a cursor open on the remote, such as single batch finds.
+        boost::optional<HostAndPort> hedgeHostAndPort;
+        Milliseconds hedgeDelay{0};
+
+        // Optional. Told the round trip time of every successful reply from this remote.
+        stdx::function<void(const HostAndPort&, Milliseconds)> latencyObserver;
     };
 
     ClusterClientCursorParams() {}
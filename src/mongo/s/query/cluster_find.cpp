@@ -38,9 +38,11 @@
 #include "mongo/base/status_with.h"
 #include "mongo/client/read_preference.h"
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/client/replica_set_monitor.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/getmore_request.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/client/shard_registry.h"
@@ -55,6 +57,48 @@ namespace mongo {
 
 namespace {
 
+/**
+ * When true, a find which may read from a secondary also sends its initial find command to a
+ * second eligible member of each replica set shard if the first has not replied within that
+ * member's hedge delay. See ReplicaSetMonitor::getHedgeDelay.
+ */
+MONGO_EXPORT_SERVER_PARAMETER(clusterHedgedReads, bool, false);
+
+/**
+ * Sets up hedging of the initial find command for 'remote' if it targets a replica set shard
+ * and there is another member matching 'readPref'. Also feeds reply latencies back to the
+ * shard's ReplicaSetMonitor so that it can compute the hedge delay.
+ */
+void setUpHedging(const Shard& shard,
+                  const ReadPreferenceSetting& readPref,
+                  ClusterClientCursorParams::Remote* remote) {
+    const ConnectionString& connStr = shard.getConnString();
+    if (connStr.type() != ConnectionString::SET) {
+        return;
+    }
+
+    auto monitor = ReplicaSetMonitor::get(connStr.getSetName());
+    if (!monitor) {
+        return;
+    }
+
+    auto hedgeHost = monitor->getHedgeHost(readPref, remote->hostAndPort);
+    if (hedgeHost.empty()) {
+        return;
+    }
+
+    remote->hedgeHostAndPort = std::move(hedgeHost);
+    remote->hedgeDelay = monitor->getHedgeDelay(remote->hostAndPort);
+
+    // Only hold on to the monitor weakly, as the set may be removed while the cursor lives on.
+    std::weak_ptr<ReplicaSetMonitor> weakMonitor = monitor;
+    remote->latencyObserver = [weakMonitor](const HostAndPort& host, Milliseconds latency) {
+        if (auto monitor = weakMonitor.lock()) {
+            monitor->recordOperationLatency(host, latency);
+        }
+    };
+}
+
 /**
  * Given the LiteParsedQuery 'lpq' being executed by mongos, returns a copy of the query which is
  * suitable for forwarding to the targeted hosts.
@@ -126,6 +170,17 @@ StatusWith<CursorId> runQueryWithoutRetrying(OperationContext* txn,
 
     const auto lpqToForward = transformQueryForShards(query.getParsed());
 
+    // Finds are safe to run twice, but tailable cursors are long-lived and PrimaryPreferred reads
+    // would be hedged to a secondary while the primary is up. The losing request is canceled and
+    // its reply never read, so only finds which cannot leave a cursor open on the shard are
+    // hedged.
+    const bool opensNoCursor = !lpqToForward->wantMore() ||
+        (lpqToForward->getLimit() && *lpqToForward->getLimit() == 1 &&
+         (!lpqToForward->getBatchSize() || *lpqToForward->getBatchSize() > 0));
+    const bool hedge = clusterHedgedReads && opensNoCursor && !query.getParsed().isTailable() &&
+        readPref.pref != ReadPreference::PrimaryOnly &&
+        readPref.pref != ReadPreference::PrimaryPreferred;
+
     // Use read pref to target a particular host from each shard. Also construct the find command
     // that we will forward to each shard.
     params.remotes.resize(shards.size());
@@ -148,6 +203,10 @@ StatusWith<CursorId> runQueryWithoutRetrying(OperationContext* txn,
         }
 
         params.remotes[i].cmdObj = cmdBuilder.obj();
+
+        if (hedge) {
+            setUpHedging(*shard, readPref, &params.remotes[i]);
+        }
     }
 
     auto ccc =
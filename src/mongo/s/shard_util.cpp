@@ -33,6 +33,8 @@
 #include "mongo/base/status_with.h"
 #include "mongo/client/read_preference.h"
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -65,5 +67,39 @@ StatusWith<long long> retrieveTotalShardSize(ShardId shardId, ShardRegistry* sha
     return totalSizeElem.numberLong();
 }
 
+StatusWith<long long> retrieveChunkDataSize(ShardId shardId,
+                                            ShardRegistry* shardRegistry,
+                                            const std::string& ns,
+                                            const BSONObj& keyPattern,
+                                            const BSONObj& min,
+                                            const BSONObj& max) {
+    auto shard = shardRegistry->getShard(shardId);
+    if (!shard) {
+        return {ErrorCodes::ShardNotFound, str::stream() << "shard " << shardId << " not found"};
+    }
+
+    auto shardHostStatus =
+        shard->getTargeter()->findHost({ReadPreference::PrimaryPreferred, TagSet::primaryOnly()});
+    if (!shardHostStatus.isOK()) {
+        return shardHostStatus.getStatus();
+    }
+
+    BSONObj cmdObj = BSON("dataSize" << ns << "keyPattern" << keyPattern << "min" << min << "max"
+                                     << max << "estimate" << true);
+
+    auto dataSizeStatus =
+        shardRegistry->runCommand(shardHostStatus.getValue(), nsToDatabase(ns), cmdObj);
+    if (!dataSizeStatus.isOK()) {
+        return dataSizeStatus.getStatus();
+    }
+
+    BSONElement sizeElem = dataSizeStatus.getValue()["size"];
+    if (!sizeElem.isNumber()) {
+        return {ErrorCodes::NoSuchKey, "size field not found in dataSize"};
+    }
+
+    return sizeElem.numberLong();
+}
+
 }  // namespace shardutil
 }  // namespace mongo
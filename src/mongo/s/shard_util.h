@@ -34,6 +34,7 @@
 
 namespace mongo {
 
+class BSONObj;
 class ShardRegistry;
 template <typename T>
 class StatusWith;
@@ -51,6 +52,22 @@ namespace shardutil {
  *  NoSuchKey if the total shard size could not be retrieved
  */
 StatusWith<long long> retrieveTotalShardSize(ShardId shardId, ShardRegistry* shardRegistry);
+
+/**
+ * Executes the dataSize command with estimation enabled against the specified shard, and obtains
+ * the approximate number of bytes of documents of collection 'ns' between 'min' (inclusive) and
+ * 'max' (exclusive) on the given shard key pattern.
+ *
+ * Returns OK with the size or an error. Known errors are:
+ *  ShardNotFound if shard by that id is not available on the registry
+ *  NoSuchKey if the size could not be retrieved
+ */
+StatusWith<long long> retrieveChunkDataSize(ShardId shardId,
+                                            ShardRegistry* shardRegistry,
+                                            const std::string& ns,
+                                            const BSONObj& keyPattern,
+                                            const BSONObj& min,
+                                            const BSONObj& max);
 };
 
 }  // namespace mongo
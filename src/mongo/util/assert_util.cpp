@@ -46,6 +46,7 @@ using namespace std;
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/config.h"
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/debugger.h"
 #include "mongo/util/exit.h"
@@ -126,6 +127,7 @@ NOINLINE_DECL void wasserted(const char* expr, const char* file, unsigned line)
 #if defined(MONGO_CONFIG_DEBUG_BUILD)
     // this is so we notice in buildbot
     log() << "\n\n***aborting after wassert() failure in a debug/test build\n\n" << endl;
+    logger::AsyncLogWriter::flushAll();
     quickExit(EXIT_ABRUPT);
 #endif
 }
@@ -141,6 +143,7 @@ NOINLINE_DECL void verifyFailed(const char* expr, const char* file, unsigned lin
 #if defined(MONGO_CONFIG_DEBUG_BUILD)
     // this is so we notice in buildbot
     log() << "\n\n***aborting after verify() failure as this is a debug/test build\n\n" << endl;
+    logger::AsyncLogWriter::flushAll();
     quickExit(EXIT_ABRUPT);
 #endif
     throw e;
@@ -150,6 +153,7 @@ NOINLINE_DECL void invariantFailed(const char* expr, const char* file, unsigned
     log() << "Invariant failure " << expr << ' ' << file << ' ' << dec << line << endl;
     breakpoint();
     log() << "\n\n***aborting after invariant() failure\n\n" << endl;
+    logger::AsyncLogWriter::flushAll();
     std::abort();
 }
 
@@ -162,6 +166,7 @@ NOINLINE_DECL void invariantOKFailed(const char* expr,
     logContext();
     breakpoint();
     log() << "\n\n***aborting after invariant() failure\n\n" << endl;
+    logger::AsyncLogWriter::flushAll();
     quickExit(EXIT_ABRUPT);
 }
 
@@ -169,6 +174,7 @@ NOINLINE_DECL void fassertFailed(int msgid) {
     log() << "Fatal Assertion " << msgid << endl;
     breakpoint();
     log() << "\n\n***aborting after fassert() failure\n\n" << endl;
+    logger::AsyncLogWriter::flushAll();
     std::abort();
 }
 
@@ -176,6 +182,7 @@ NOINLINE_DECL void fassertFailedNoTrace(int msgid) {
     log() << "Fatal Assertion " << msgid << endl;
     breakpoint();
     log() << "\n\n***aborting after fassert() failure\n\n" << endl;
+    logger::AsyncLogWriter::flushAll();
     quickExit(EXIT_ABRUPT);
 }
 
@@ -184,6 +191,7 @@ MONGO_COMPILER_NORETURN void fassertFailedWithStatus(int msgid, const Status& st
     logContext();
     breakpoint();
     log() << "\n\n***aborting after fassert() failure\n\n" << endl;
+    logger::AsyncLogWriter::flushAll();
     quickExit(EXIT_ABRUPT);
 }
 
@@ -191,6 +199,7 @@ MONGO_COMPILER_NORETURN void fassertFailedWithStatusNoTrace(int msgid, const Sta
     log() << "Fatal assertion " << msgid << " " << status;
     breakpoint();
     log() << "\n\n***aborting after fassert() failure\n\n" << endl;
+    logger::AsyncLogWriter::flushAll();
     quickExit(EXIT_ABRUPT);
 }
 
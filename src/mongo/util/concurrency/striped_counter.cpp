@@ -0,0 +1,81 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/striped_counter.h"
+
+#include "mongo/platform/compiler.h"
+#include "mongo/util/concurrency/threadlocal.h"
+
+namespace mongo {
+
+namespace {
+
+AtomicUInt32 nextStripe;
+
+// The calling thread's stripe plus one, or 0 if it has not been assigned one yet.
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL size_t threadStripe;
+
+}  // namespace
+
+StripedInt64::StripedInt64(int64_t value) {
+    store(value);
+}
+
+int64_t StripedInt64::load() const {
+    int64_t sum = 0;
+    for (const Stripe& stripe : _stripes) {
+        sum += stripe.value.load();
+    }
+    return sum;
+}
+
+void StripedInt64::store(int64_t value) {
+    _stripes[0].value.store(value);
+    for (size_t i = 1; i < kNumStripes; i++) {
+        _stripes[i].value.store(0);
+    }
+}
+
+void StripedInt64::resetIfNegative() {
+    const int64_t value = load();
+    if (value < 0) {
+        _stripes[0].value.fetchAndAdd(-value);
+    }
+}
+
+size_t StripedInt64::_threadStripe() {
+    if (MONGO_unlikely(threadStripe == 0)) {
+        threadStripe = nextStripe.fetchAndAdd(1) % kNumStripes + 1;
+    }
+    return threadStripe - 1;
+}
+
+}  // namespace mongo
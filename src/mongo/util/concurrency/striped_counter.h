@@ -0,0 +1,90 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+/**
+ * A 64-bit counter for statistics which are updated far more often than they are read, such as
+ * the record count of a collection. Each thread adds to one of several stripes, and every stripe
+ * sits on its own cache line, so writers running on different cores do not bounce a single line
+ * between them. Reading sums the stripes, which costs more than reading an AtomicInt64, and a read
+ * which races with updates may include some of them but not others.
+ */
+class StripedInt64 {
+    MONGO_DISALLOW_COPYING(StripedInt64);
+
+public:
+    static const size_t kNumStripes = 16;
+
+    explicit StripedInt64(int64_t value = 0);
+
+    void add(int64_t delta) {
+        _stripes[_threadStripe()].value.fetchAndAdd(delta);
+    }
+
+    int64_t load() const;
+
+    /**
+     * Replaces the value. Updates which race with a store() may be lost, so this is meant for
+     * initialization and corrections, not for regular updates.
+     */
+    void store(int64_t value);
+
+    /**
+     * Raises the value to zero if it is negative. Unlike store(), this never loses updates which
+     * race with it.
+     */
+    void resetIfNegative();
+
+private:
+    static const size_t kCacheLineSize = 64;
+
+    struct Stripe {
+        AtomicInt64 value;
+        char padding[kCacheLineSize - sizeof(AtomicInt64)];
+    };
+
+    /**
+     * Returns the stripe used by the calling thread. Threads are assigned stripes round robin the
+     * first time they update any StripedInt64.
+     */
+    static size_t _threadStripe();
+
+    Stripe _stripes[kNumStripes];
+};
+
+}  // namespace mongo
@@ -0,0 +1,95 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/striped_counter.h"
+
+namespace mongo {
+namespace {
+
+TEST(StripedInt64, StartsAtInitialValue) {
+    ASSERT_EQUALS(0, StripedInt64().load());
+    ASSERT_EQUALS(42, StripedInt64(42).load());
+}
+
+TEST(StripedInt64, AddAndStore) {
+    StripedInt64 counter(10);
+    counter.add(5);
+    counter.add(-20);
+    ASSERT_EQUALS(-5, counter.load());
+
+    counter.store(7);
+    ASSERT_EQUALS(7, counter.load());
+    counter.add(1);
+    ASSERT_EQUALS(8, counter.load());
+}
+
+TEST(StripedInt64, ResetIfNegative) {
+    StripedInt64 counter;
+    counter.add(-100);
+    counter.resetIfNegative();
+    ASSERT_EQUALS(0, counter.load());
+
+    // Once reset, later additions count in full.
+    counter.add(50);
+    ASSERT_EQUALS(50, counter.load());
+    counter.resetIfNegative();
+    ASSERT_EQUALS(50, counter.load());
+}
+
+TEST(StripedInt64, ConcurrentAddsAreNotLost) {
+    const int kThreads = 2 * StripedInt64::kNumStripes + 1;
+    const int kAdds = 10000;
+
+    StripedInt64 counter;
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kThreads; i++) {
+        threads.emplace_back([&counter, i] {
+            for (int j = 0; j < kAdds; j++) {
+                counter.add(i % 2 ? 3 : -1);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    // Odd-numbered threads add 3 and even-numbered threads subtract 1.
+    const int64_t oddThreads = kThreads / 2;
+    const int64_t evenThreads = kThreads - oddThreads;
+    ASSERT_EQUALS((3 * oddThreads - evenThreads) * kAdds, counter.load());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -850,6 +850,15 @@ void Socket::setTimeout(double secs) {
 // -1 : never check
 const int Socket::errorPollIntervalSecs(5);
 
+bool Socket::hasBufferedData() const {
+#ifdef MONGO_CONFIG_SSL
+    if (_sslConnection.get()) {
+        return _sslManager->SSL_pending(_sslConnection.get()) > 0;
+    }
+#endif
+    return false;
+}
+
 // Patch to allow better tolerance of flaky network connections that get broken
 // while we aren't looking.
 // TODO: Remove when better async changes come.
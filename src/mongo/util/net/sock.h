@@ -306,6 +306,12 @@ public:
     void setTimeout(double secs);
     bool isStillConnected();
 
+    /**
+     * Returns true if data from the peer has been received but not read yet, for example by the
+     * SSL layer. Such data does not make the socket readable as far as poll() is concerned.
+     */
+    bool hasBufferedData() const;
+
     void setHandshakeReceived() {
         _awaitingHandshake = false;
     }
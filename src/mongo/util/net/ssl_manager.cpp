@@ -206,6 +206,8 @@ public:
 
     virtual int SSL_get_error(const SSLConnection* conn, int ret);
 
+    virtual int SSL_pending(const SSLConnection* conn);
+
     virtual int SSL_shutdown(SSLConnection* conn);
 
     virtual void SSL_free(SSLConnection* conn);
@@ -509,6 +511,10 @@ int SSLManager::SSL_get_error(const SSLConnection* conn, int ret) {
     return ::SSL_get_error(conn->ssl, ret);
 }
 
+int SSLManager::SSL_pending(const SSLConnection* conn) {
+    return ::SSL_pending(conn->ssl) + static_cast<int>(BIO_ctrl_pending(conn->internalBIO));
+}
+
 int SSLManager::SSL_shutdown(SSLConnection* conn) {
     int status;
     do {
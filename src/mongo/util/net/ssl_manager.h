@@ -148,6 +148,12 @@ public:
 
     virtual int SSL_get_error(const SSLConnection* conn, int ret) = 0;
 
+    /**
+     * Returns the number of bytes received on 'conn' which have not been read yet, whether
+     * already decrypted or still waiting to be.
+     */
+    virtual int SSL_pending(const SSLConnection* conn) = 0;
+
     virtual int SSL_shutdown(SSLConnection* conn) = 0;
 
     virtual void SSL_free(SSLConnection* conn) = 0;
@@ -44,6 +44,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/string_data.h"
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/logger/log_domain.h"
 #include "mongo/logger/logger.h"
 #include "mongo/stdx/thread.h"
@@ -150,6 +151,7 @@ void writeMallocFreeStreamToLog() {
     logger::globalLogDomain()->append(logger::MessageEventEphemeral(
         Date_t::now(), logger::LogSeverity::Severe(), getThreadName(), mallocFreeOStream.str()));
     mallocFreeOStream.rewind();
+    logger::AsyncLogWriter::flushAll();
 }
 
 // must hold MallocFreeOStreamGuard to call